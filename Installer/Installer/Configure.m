@@ -170,7 +170,7 @@ bail:
     for(attempts = 0; attempts < MAX_ENABLE_ATTEMPTS; attempts++)
     {
         //install extension via 'pluginkit -a <path 2 ext>
-        results = execTask(PLUGIN_KIT, @[@"-a", extension]);
+        results = execTaskWithTimeout(PLUGIN_KIT, @[@"-a", extension], TASK_TIMEOUT);
         if(0 != [results[EXIT_CODE] intValue])
         {
             //err msg
@@ -182,7 +182,7 @@ bail:
         
         //was installed?
         // query plugin db, and look for response
-        results = execTask(PLUGIN_KIT, @[@"-m", @"-i", EXTENSION_BUNDLE_ID]);
+        results = execTaskWithTimeout(PLUGIN_KIT, @[@"-m", @"-i", EXTENSION_BUNDLE_ID], TASK_TIMEOUT);
         if(0 != [results[STDOUT] length])
         {
             //ok
@@ -212,7 +212,7 @@ bail:
     for(attempts = 0; attempts < MAX_ENABLE_ATTEMPTS; attempts++)
     {
         //enable extension via 'pluginkit -e use -i <ext bundle id>
-        results = execTask(PLUGIN_KIT, @[@"-e", @"use", @"-i", EXTENSION_BUNDLE_ID]);
+        results = execTaskWithTimeout(PLUGIN_KIT, @[@"-e", @"use", @"-i", EXTENSION_BUNDLE_ID], TASK_TIMEOUT);
         if(0 != [results[EXIT_CODE] intValue])
         {
             //err msg
@@ -224,7 +224,7 @@ bail:
         
         //was enabled?
         // query plugin db, and look for '+'
-        results = execTask(PLUGIN_KIT, @[@"-m", @"-i", EXTENSION_BUNDLE_ID]);
+        results = execTaskWithTimeout(PLUGIN_KIT, @[@"-m", @"-i", EXTENSION_BUNDLE_ID], TASK_TIMEOUT);
         if(YES == [[[NSString alloc] initWithData:results[STDOUT] encoding:NSUTF8StringEncoding] hasPrefix:@"+"])
         {
             //ok
@@ -268,8 +268,8 @@ bail:
     //return/status var
     BOOL wasUninstalled = NO;
     
-    //pid of finder sync
-    pid_t processID = -1;
+    //pids of finder sync
+    NSArray* processIDs = nil;
     
     //path to finder sync
     NSString* extension = nil;
@@ -317,27 +317,32 @@ bail:
     
     //remove extension
     // plugin kit prints err, but it still works
-    execTask(PLUGIN_KIT, @[@"-r", extension]);
+    execTaskWithTimeout(PLUGIN_KIT, @[@"-r", extension], TASK_TIMEOUT);
 
-    //find pid of extension instance(s)
-    // and if any are found, kill them via SIGKILL!
-    do
+    //find pids of extension instance(s)
+    // one snapshot, for all of them
+    processIDs = findProcessesInSnapshot(processSnapshot(), @"WhatsYourSign");
+    
+    //kill them all via SIGKILL!
+    // then (re)snapshot only to confirm they exited, killing any stragglers
+    for(NSUInteger attempt = 0; (0 != processIDs.count) && (attempt < PROCESS_KILL_ATTEMPTS); attempt++)
     {
-        //find process by name
-        processID = findProcess(@"WhatsYourSign");
-        if(-1 != processID)
+        //kill each
+        for(NSNumber* processID in processIDs)
         {
             //dbg msg
-            //logMsg(LOG_DEBUG, [NSString stringWithFormat:@"sending SIGKILL to %d", processID]);
+            //logMsg(LOG_DEBUG, [NSString stringWithFormat:@"sending SIGKILL to %@", processID]);
 
             //kill
-            kill(processID, SIGKILL);
-            
-            //nap
-            [NSThread sleepForTimeInterval:0.1f];
+            kill(processID.intValue, SIGKILL);
         }
         
-    } while (processID != -1);
+        //nap
+        [NSThread sleepForTimeInterval:0.1f];
+        
+        //any still around?
+        processIDs = findProcessesInSnapshot(processSnapshot(), @"WhatsYourSign");
+    }
 
     //happy
     wasUninstalled = YES;
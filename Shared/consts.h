@@ -47,6 +47,40 @@
 //key for exit code
 #define EXIT_CODE @"exitCode"
 
+//key for task being killed, as it didn't exit in time
+#define TASK_TIMED_OUT @"timedOut"
+
+//key for task's output being truncated
+#define TASK_TRUNCATED @"truncated"
+
+//max output (per stream) kept from a task
+// rest is drained (so task doesn't block), but dropped
+#define TASK_MAX_OUTPUT (16*1024*1024)
+
+//timeout (seconds) for short-lived tasks
+// e.g. 'file', 'spctl', 'pluginkit'
+#define TASK_TIMEOUT 30.0
+
+//interval (ms) to check if a task exited
+// once its pipes are closed
+#define TASK_REAP_INTERVAL 10
+
+//process snapshot: paths
+// pid -> path
+#define KEY_PROCESS_PATHS @"paths"
+
+//process snapshot: names
+// name -> pids
+#define KEY_PROCESS_NAMES @"names"
+
+//slack when listing pids
+// as processes may be spawned in the meantime
+#define PROCESS_LIST_SLACK 64
+
+//max # of times to check killed processes exited
+// each is 0.1s apart
+#define PROCESS_KILL_ATTEMPTS 50
+
 //max enable attempts
 #define MAX_ENABLE_ATTEMPTS 10
 
@@ -73,8 +107,9 @@
 #define KEY_SIGNING_CDHASH_SHA1     @"cdhash_sha1"
 #define KEY_SIGNING_CDHASH_SHA256   @"cdhash_sha256"
 
-//entitlements
-#define KEY_SIGNING_ENTITLEMENTS @"entitlements"
+//has entitlements?
+// (only) decoded when viewed
+#define KEY_SIGNING_HAS_ENTITLEMENTS @"hasEntitlements"
 
 //file belongs to apple?
 #define KEY_SIGNING_IS_APPLE @"signedByApple"
@@ -88,6 +123,93 @@
 //is notarized?
 #define KEY_SIGNING_IS_NOTARIZED @"notarized"
 
+//first (code) page that doesn't match its hash
+#define KEY_SIGNING_BAD_PAGE @"badPage"
+
+//offset (in file) of that page
+#define KEY_SIGNING_BAD_PAGE_OFFSET @"badPageOffset"
+
+//(first) nested code that failed validation
+#define KEY_SIGNING_NESTED_FAILURE @"nestedFailure"
+
+//resources that don't match bundle's seal
+#define KEY_SIGNING_RESOURCES @"resources"
+
+//resources (added)
+#define KEY_RESOURCES_ADDED @"added"
+
+//resources (removed)
+#define KEY_RESOURCES_REMOVED @"removed"
+
+//resources (modified)
+#define KEY_RESOURCES_MODIFIED @"modified"
+
+//max # of resources shown (per kind)
+#define RESOURCES_MAX_SHOWN 3
+
+//package components (files in its heap)
+// each has a name, and results of checking its archived & extracted checksums
+#define KEY_PACKAGE_COMPONENTS @"components"
+
+//component: name
+// path, within package
+#define KEY_COMPONENT_NAME @"name"
+
+//component: archived checksum result
+#define KEY_COMPONENT_ARCHIVED @"archived"
+
+//component: extracted checksum result
+#define KEY_COMPONENT_EXTRACTED @"extracted"
+
+//component: binaries (payloads only)
+// summary of each mach-o in the payload
+#define KEY_COMPONENT_BINARIES @"binaries"
+
+//binary: path
+// within payload
+#define KEY_BINARY_PATH @"path"
+
+//binary: sha256 (of entire file)
+#define KEY_BINARY_SHA256 @"sha256"
+
+//binary: signature status
+#define KEY_BINARY_STATUS @"status"
+
+//binary: (signing) identifier
+#define KEY_BINARY_IDENTIFIER @"identifier"
+
+//binary: team id
+#define KEY_BINARY_TEAM_ID @"teamID"
+
+//binary: cd hash
+#define KEY_BINARY_CDHASH @"cdhash"
+
+//binary: were (code) pages verified?
+#define KEY_BINARY_PAGES_VERIFIED @"pagesVerified"
+
+//binary: ad-hoc signed?
+// status is then unsigned, as there's no signer to trust
+#define KEY_BINARY_ADHOC @"adhoc"
+
+//disk image (UDIF) checks
+// data fork, master checksum, partitions (each w/ a name, and extracted checksum result), and signing details
+#define KEY_DISKIMAGE @"diskImage"
+
+//disk image: data fork checksum result
+#define KEY_DISKIMAGE_DATA_FORK @"dataFork"
+
+//disk image: master checksum result
+#define KEY_DISKIMAGE_MASTER @"master"
+
+//disk image: partitions
+#define KEY_DISKIMAGE_PARTITIONS @"partitions"
+
+//disk image: (signing) identifier
+#define KEY_DISKIMAGE_IDENTIFIER @"identifier"
+
+//disk image: cd hash
+#define KEY_DISKIMAGE_CDHASH @"cdhash"
+
 //path to file binary
 #define FILE @"/usr/bin/file"
 
@@ -160,6 +282,16 @@
 //key sha512
 #define KEY_HASH_SHA512 @"SHA512"
 
+//hashing: size of each chunk read
+#define HASH_CHUNK_SIZE (4*1024*1024)
+
+//hashing: # of chunks (buffers) in flight
+#define HASH_RING_SLOTS 4
+
+//batch: # of items verified at once
+// each verification is (itself) multi-threaded, so keep this low
+#define BATCH_MAX_CONCURRENT 4
+
 //app group
 #define APP_GROUP @"group.com.objective-see.WYS"
 
@@ -170,4 +302,12 @@
 // enable on external drive
 #define PREF_ENABLE_ON_EXTERNAL_DRIVES @"enableExternalDrives"
 
+//pref
+// time (seconds) cached revocation/notarization results are trusted, 0 disables cache
+#define PREF_VERDICT_TTL @"verdictTTL"
+
+//pref
+// path to write (Chrome) trace of verification stages to, unset disables tracing
+#define PREF_TRACE_FILE @"traceFile"
+
 #endif
@@ -13,6 +13,26 @@
 @import AppKit;
 @import Foundation;
 
+//process table backend
+// lists pids, and gets each's path (w/ a scratch buffer that's reused across calls)
+typedef struct
+{
+    //list (all) pids
+    // returns # of pids, or -1 on error (if 'pids' is NULL, just how many there are)
+    int (*listPids)(pid_t* pids, int count);
+    
+    //get a process's path
+    // returns NO if it couldn't be determined
+    BOOL (*pidPath)(pid_t pid, char* path, size_t pathSize, char* arguments, size_t argumentsSize);
+    
+    //size of scratch buffer
+    size_t (*argumentsSize)(void);
+    
+} ProcessBackend;
+
+//libproc backend
+extern const ProcessBackend libprocBackend;
+
 /* FUNCTIONS */
 
 //get app's version
@@ -37,11 +57,58 @@ NSString* getAppVersion(void);
 //exec a process and grab it's output
 NSMutableDictionary* execTask(NSString* binaryPath, NSArray* arguments);
 
+//exec a process and grab it's output
+// killed if it doesn't exit before timeout (0 for none)
+NSMutableDictionary* execTaskWithTimeout(NSString* binaryPath, NSArray* arguments, NSTimeInterval timeout);
+
+//exec processes (in parallel) and grab their output
+// each command is @[path, @[arguments]], and (optional) timeout applies to all
+NSArray* execTasks(NSArray* commands, NSTimeInterval timeout);
+
 //find a process by name
 pid_t findProcess(NSString* processName);
 
+//get process's path
+NSString* getProcessPath(pid_t pid);
+
+//take a snapshot of the process table
+// every pid's path, and an index of names (last path component) to pids, in a single pass
+NSDictionary* processSnapshot(void);
+
+//take a snapshot of the process table
+// via a specific backend
+NSDictionary* processSnapshotWithBackend(const ProcessBackend* backend);
+
+//find a process by name in a snapshot
+// returns (first) pid, or -1 if there's no such process
+pid_t findProcessInSnapshot(NSDictionary* snapshot, NSString* processName);
+
+//find all processes by name in a snapshot
+// returns their pids (empty if there's no such process)
+NSArray* findProcessesInSnapshot(NSDictionary* snapshot, NSString* processName);
+
+//read exactly 'size' bytes at 'offset'
+// retries if interrupted, or on short reads
+BOOL readAt(int fd, void* buffer, size_t size, uint64_t offset);
+
+//convert bytes to hex string
+// e.g. digests, cd hashes
+NSString* bytesToHex(const uint8_t* bytes, size_t length, BOOL uppercase);
+
+//get directory for (shared) caches
+// the app group container, unless overridden
+NSURL* cachesDirectory(void);
+
+//override directory for (shared) caches
+// e.g. so benchmarks don't touch the user's caches (note: call before any cache is used)
+void setCachesDirectory(NSURL* directory);
+
+//get path of the file to hash
+// for bundles, this is their main binary
+NSString* hashablePath(NSString* itemPath);
+
 //hash a file
-// md5/sha1/sha256
+// md5/sha1/sha256/sha512
 NSDictionary* hashFile(NSString* filePath);
 
 //restart Finder.app
@@ -9,9 +9,16 @@
 #import "consts.h"
 #import "utilities.h"
 
+#import <time.h>
+#import <poll.h>
+#import <spawn.h>
+#import <fcntl.h>
 #import <signal.h>
 #import <unistd.h>
+#import <os/log.h>
+#import <stdatomic.h>
 #import <libproc.h>
+#import <sys/wait.h>
 #import <sys/sysctl.h>
 #import <Security/Security.h>
 #import <CommonCrypto/CommonDigest.h>
@@ -19,6 +26,14 @@
 
 @import Foundation;
 
+//environment
+// passed on to spawned tasks
+extern char** environ;
+
+//directory for (shared) caches
+// nil, unless overridden
+static NSURL* cachesOverride = nil;
+
 //get app's version
 // ->extracted from Info.plist
 NSString* getAppVersion(void)
@@ -141,492 +156,1318 @@ bail:
     return isFat;
 }
 
-//exec a process and grab it's stdout/stderr/exit code
-NSMutableDictionary* execTask(NSString* binaryPath, NSArray* arguments)
+//running task
+// its pipes, (captured) output, and how it ended
+typedef struct
 {
-    //task
-    NSTask* task = nil;
+    //spawned?
+    BOOL spawned;
     
-    //output pipe for stdout
-    NSPipe* stdOutPipe = nil;
+    //pid
+    // 0 once reaped
+    pid_t pid;
     
-    //output pipe for stderr
-    NSPipe* stdErrPipe = nil;
+    //read ends of stdout/stderr pipes
+    // -1 once closed
+    int pipes[2];
     
-    //read handle for stdout
-    NSFileHandle* stdOutReadHandle = nil;
+    //output (stdout/stderr)
+    uint8_t* output[2];
+    size_t length[2];
+    size_t capacity[2];
     
-    //read handle for stderr
-    NSFileHandle* stdErrReadHandle = nil;
+    //wait status
+    int status;
     
-    //results dictionary
-    NSMutableDictionary* results = nil;
+    //killed, as deadline passed?
+    BOOL timedOut;
     
-    //output for stdout
-    NSMutableData *stdOutData = nil;
+    //output was capped?
+    BOOL truncated;
     
-    //output for stderr
-    NSMutableData *stdErrData = nil;
+} RunningTask;
+
+//current time (seconds)
+// monotonic, so unaffected by clock changes
+static double monotonicTime(void)
+{
+    //now
+    struct timespec now = {0};
     
-    //init dictionary for results
-    results = [NSMutableDictionary dictionary];
+    //get
+    clock_gettime(CLOCK_MONOTONIC, &now);
     
-    //init task
-    task = [NSTask new];
+    return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+//close a file descriptor
+// and reset it
+static void closeDescriptor(int* fd)
+{
+    //close
+    if(-1 != *fd)
+    {
+        close(*fd);
+        *fd = -1;
+    }
     
-    //init stdout pipe
-    stdOutPipe = [NSPipe pipe];
+    return;
+}
+
+//spawn a task
+// stdout/stderr go to (non-blocking) pipes, stdin is /dev/null
+static BOOL spawnTask(RunningTask* task, const char* path, char* const* argv)
+{
+    //flag
+    BOOL spawned = NO;
     
-    //init stderr pipe
-    stdErrPipe = [NSPipe pipe];
+    //stdout pipe
+    int outPipe[2] = {-1, -1};
     
-    //init stdout read handle
-    stdOutReadHandle = [stdOutPipe fileHandleForReading];
+    //stderr pipe
+    int errPipe[2] = {-1, -1};
     
-    //init stderr read handle
-    stdErrReadHandle = [stdErrPipe fileHandleForReading];
-
-    //init stdout output buffer
-    stdOutData = [NSMutableData data];
+    //file actions
+    posix_spawn_file_actions_t actions;
     
-    //init stderr output buffer
-    stdErrData = [NSMutableData data];
+    //attributes
+    posix_spawnattr_t attributes;
     
-    //set task's path
-    task.launchPath = binaryPath;
+    //file actions init'd?
+    BOOL actionsInit = NO;
     
-    //set task's args
-    task.arguments = arguments;
+    //attributes init'd?
+    BOOL attributesInit = NO;
     
-    //set task's stdout
-    task.standardOutput = stdOutPipe;
+    //init
+    memset(task, 0, sizeof(RunningTask));
+    task->pipes[0] = -1;
+    task->pipes[1] = -1;
     
-    //set task's stderr
-    task.standardError = stdErrPipe;
+    //create pipes
+    if( (0 != pipe(outPipe)) ||
+        (0 != pipe(errPipe)) )
+    {
+        //bail
+        goto bail;
+    }
     
-    //dbg msg
-    //logMsg(LOG_DEBUG, [NSString stringWithFormat:@"execing task, %@ (arguments: %@)", task.launchPath, task.arguments]);
+    //don't leak read ends
+    // into this, or any other, child
+    fcntl(outPipe[0], F_SETFD, FD_CLOEXEC);
+    fcntl(errPipe[0], F_SETFD, FD_CLOEXEC);
     
-    //wrap task launch
-    @try
+    //init file actions
+    if(0 != posix_spawn_file_actions_init(&actions))
     {
-        //launch
-        [task launch];
+        //bail
+        goto bail;
     }
-    @catch(NSException *exception)
+    
+    //set flag
+    actionsInit = YES;
+    
+    //stdin from /dev/null
+    // stdout/stderr to pipes (then close originals)
+    if( (0 != posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0)) ||
+        (0 != posix_spawn_file_actions_adddup2(&actions, outPipe[1], STDOUT_FILENO)) ||
+        (0 != posix_spawn_file_actions_adddup2(&actions, errPipe[1], STDERR_FILENO)) ||
+        (0 != posix_spawn_file_actions_addclose(&actions, outPipe[1])) ||
+        (0 != posix_spawn_file_actions_addclose(&actions, errPipe[1])) )
     {
         //bail
         goto bail;
     }
     
-    //read in stdout/stderr
-    while(YES == [task isRunning])
+    //init attributes
+    if(0 != posix_spawnattr_init(&attributes))
     {
-        //accumulate stdout
-        [stdOutData appendData:[stdOutReadHandle readDataToEndOfFile]];
-        
-        //accumulate stderr
-        [stdErrData appendData:[stdErrReadHandle readDataToEndOfFile]];
+        //bail
+        goto bail;
     }
     
-    //grab any leftover stdout
-    [stdOutData appendData:[stdOutReadHandle readDataToEndOfFile]];
+    //set flag
+    attributesInit = YES;
     
-    //grab any leftover stderr
-    [stdErrData appendData:[stdErrReadHandle readDataToEndOfFile]];
+    #ifdef POSIX_SPAWN_CLOEXEC_DEFAULT
     
-    //add stdout
-    if(0 != stdOutData.length)
+    //only inherit stdin/stdout/stderr
+    // even if other threads are creating (or spawning w/) descriptors
+    if(0 != posix_spawnattr_setflags(&attributes, POSIX_SPAWN_CLOEXEC_DEFAULT))
     {
-        //add
-        results[STDOUT] = stdOutData;
+        //bail
+        goto bail;
     }
     
-    //add stderr
-    if(0 != stdErrData.length)
+    #endif
+    
+    //spawn
+    if(0 != posix_spawn(&task->pid, path, &actions, &attributes, argv, environ))
     {
-        //add
-        results[STDERR] = stdErrData;
+        //unset
+        task->pid = 0;
+        
+        //bail
+        goto bail;
     }
-
-    //add exit code
-    results[EXIT_CODE] = [NSNumber numberWithInteger:task.terminationStatus];
+    
+    //save read ends
+    task->pipes[0] = outPipe[0];
+    task->pipes[1] = errPipe[0];
+    outPipe[0] = -1;
+    errPipe[0] = -1;
+    
+    //make non-blocking
+    // so both can be drained, as data arrives
+    fcntl(task->pipes[0], F_SETFL, O_NONBLOCK);
+    fcntl(task->pipes[1], F_SETFL, O_NONBLOCK);
+    
+    //happy
+    task->spawned = YES;
+    spawned = YES;
     
 bail:
     
-    return results;
+    //close write ends
+    // and read ends (if not saved)
+    closeDescriptor(&outPipe[0]);
+    closeDescriptor(&outPipe[1]);
+    closeDescriptor(&errPipe[0]);
+    closeDescriptor(&errPipe[1]);
+    
+    //destroy file actions
+    if(YES == actionsInit)
+    {
+        posix_spawn_file_actions_destroy(&actions);
+    }
+    
+    //destroy attributes
+    if(YES == attributesInit)
+    {
+        posix_spawnattr_destroy(&attributes);
+    }
+    
+    return spawned;
 }
 
-//get OS's major or minor version
-SInt32 getVersion(OSType selector)
+//add output
+// once 'maxOutput' is reached, rest is dropped (but pipe is still drained)
+static void addOutput(RunningTask* task, int stream, const uint8_t* bytes, size_t length, size_t maxOutput)
 {
-    //version
-    // ->major or minor
-    SInt32 version = -1;
+    //new capacity
+    size_t capacity = 0;
     
-    //get version info
-    if(noErr != Gestalt(selector, &version))
+    //buffer
+    uint8_t* buffer = NULL;
+    
+    //cap
+    if(length > maxOutput - task->length[stream])
     {
-        //reset version
-        version = -1;
+        //cap
+        length = maxOutput - task->length[stream];
         
-        //err
-        goto bail;
+        //set flag
+        task->truncated = YES;
     }
     
-bail:
+    //nothing (more) to add?
+    if(0 == length)
+    {
+        return;
+    }
     
-    return version;
+    //grow
+    if(task->length[stream] + length > task->capacity[stream])
+    {
+        //double
+        // but don't go over cap
+        capacity = MIN(MAX(task->capacity[stream] * 2, task->length[stream] + length), maxOutput);
+        
+        //realloc
+        buffer = realloc(task->output[stream], capacity);
+        if(NULL == buffer)
+        {
+            //set flag
+            task->truncated = YES;
+            
+            return;
+        }
+        
+        //save
+        task->output[stream] = buffer;
+        task->capacity[stream] = capacity;
+    }
+    
+    //add
+    memcpy(task->output[stream] + task->length[stream], bytes, length);
+    task->length[stream] += length;
+    
+    return;
 }
 
-//get process's path
-NSString* getProcessPath(pid_t pid)
+//drain a pipe
+// reads until it'd block, closing it on EOF (or error)
+static void drainPipe(RunningTask* task, int stream, size_t maxOutput)
 {
-    //task path
-    NSString* processPath = nil;
+    //buffer
+    uint8_t buffer[16*1024];
     
-    //buffer for process path
-    char pathBuffer[PROC_PIDPATHINFO_MAXSIZE] = {0};
+    //bytes read
+    ssize_t bytesRead = 0;
+    
+    //read
+    while(-1 != task->pipes[stream])
+    {
+        //read
+        bytesRead = read(task->pipes[stream], buffer, sizeof(buffer));
+        
+        //data?
+        if(bytesRead > 0)
+        {
+            //add
+            addOutput(task, stream, buffer, (size_t)bytesRead, maxOutput);
+        }
+        //would block?
+        // come back when there's more
+        else if( (-1 == bytesRead) &&
+                 ( (EAGAIN == errno) || (EINTR == errno) ) )
+        {
+            break;
+        }
+        //EOF, or error
+        else
+        {
+            closeDescriptor(&task->pipes[stream]);
+        }
+    }
     
-    //status
-    int status = -1;
+    return;
+}
+
+//reap a task
+// 'block' waits for it to exit
+static void reapTask(RunningTask* task, BOOL block)
+{
+    //result
+    pid_t result = 0;
     
-    //'management info base' array
-    int mib[3] = {0};
+    //already reaped?
+    if(0 == task->pid)
+    {
+        return;
+    }
     
-    //system's size for max args
-    int systemMaxArgs = 0;
+    //wait
+    // retry if interrupted
+    do
+    {
+        result = waitpid(task->pid, &task->status, (YES == block) ? 0 : WNOHANG);
+        
+    } while( (-1 == result) && (EINTR == errno) );
     
-    //process's args
-    char* taskArgs = NULL;
+    //exited (or gone)?
+    if(0 != result)
+    {
+        task->pid = 0;
+    }
+    
+    return;
+}
+
+//wait for tasks
+// drains all their pipes (via a single poll loop), until they've all exited, or deadline (if any) passes
+static void awaitTasks(RunningTask* tasks, size_t count, double timeout, size_t maxOutput)
+{
+    //poll descriptors
+    struct pollfd* descriptors = NULL;
     
-    //# of args
-    int numberOfArgs = 0;
+    //owners of descriptors
+    // task index * 2 + stream
+    size_t* owners = NULL;
     
-    //size of buffers, etc
-    size_t size = 0;
+    //# of descriptors
+    nfds_t polled = 0;
     
-    //reset buffer
-    bzero(pathBuffer, PROC_PIDPATHINFO_MAXSIZE);
+    //deadline
+    double deadline = 0;
     
-    //first attempt to get path via 'proc_pidpath()'
-    status = proc_pidpath(pid, pathBuffer, sizeof(pathBuffer));
-    if(0 != status)
+    //time remaining
+    double remaining = 0;
+    
+    //poll timeout (ms)
+    int pollTimeout = -1;
+    
+    //any still running?
+    BOOL running = NO;
+    
+    //init deadline
+    if(timeout > 0)
     {
-        //init task's name
-        processPath = [NSString stringWithUTF8String:pathBuffer];
+        deadline = monotonicTime() + timeout;
     }
-    //otherwise
-    // ->try via task's args ('KERN_PROCARGS2')
-    else
+    
+    //alloc
+    descriptors = calloc(MAX(count * 2, 1), sizeof(struct pollfd));
+    owners = calloc(MAX(count * 2, 1), sizeof(size_t));
+    if( (NULL == descriptors) ||
+        (NULL == owners) )
     {
-        //init mib
-        // ->want system's size for max args
-        mib[0] = CTL_KERN;
-        mib[1] = KERN_ARGMAX;
-        
-        //set size
-        size = sizeof(systemMaxArgs);
+        //bail
+        goto bail;
+    }
+    
+    //wait
+    while(YES)
+    {
+        //reset
+        polled = 0;
+        running = NO;
         
-        //get system's size for max args
-        if(-1 == sysctl(mib, 2, &systemMaxArgs, &size, NULL, 0))
+        //reap exited tasks
+        // and collect open pipes
+        for(size_t i = 0; i < count; i++)
         {
-            //bail
-            goto bail;
+            //reap
+            reapTask(&tasks[i], NO);
+            if(0 != tasks[i].pid)
+            {
+                running = YES;
+            }
+            
+            //add open pipes
+            for(int stream = 0; stream < 2; stream++)
+            {
+                if(-1 != tasks[i].pipes[stream])
+                {
+                    descriptors[polled].fd = tasks[i].pipes[stream];
+                    descriptors[polled].events = POLLIN;
+                    descriptors[polled].revents = 0;
+                    owners[polled] = i * 2 + (size_t)stream;
+                    polled++;
+                }
+            }
         }
         
-        //alloc space for args
-        taskArgs = malloc(systemMaxArgs);
-        if(NULL == taskArgs)
+        //all done?
+        if( (0 == polled) &&
+            (YES != running) )
         {
-            //bail
-            goto bail;
+            break;
         }
         
-        //init mib
-        // ->want process args
-        mib[0] = CTL_KERN;
-        mib[1] = KERN_PROCARGS2;
-        mib[2] = pid;
-        
-        //set size
-        size = (size_t)systemMaxArgs;
+        //init poll timeout
+        // forever, unless there's a deadline
+        pollTimeout = -1;
+        if(0 != deadline)
+        {
+            //time left
+            remaining = deadline - monotonicTime();
+            
+            //out of time?
+            if(remaining <= 0)
+            {
+                //kill all still running
+                for(size_t i = 0; i < count; i++)
+                {
+                    //kill
+                    if(0 != tasks[i].pid)
+                    {
+                        kill(tasks[i].pid, SIGKILL);
+                        tasks[i].timedOut = YES;
+                    }
+                    
+                    //reap
+                    reapTask(&tasks[i], YES);
+                    
+                    //close pipes
+                    // e.g. a grandchild might still have them open
+                    closeDescriptor(&tasks[i].pipes[0]);
+                    closeDescriptor(&tasks[i].pipes[1]);
+                }
+                
+                break;
+            }
+            
+            //set
+            // rounding up, so don't spin
+            pollTimeout = (int)(remaining * 1000) + 1;
+        }
         
-        //get process's args
-        if(-1 == sysctl(mib, 3, taskArgs, &size, NULL, 0))
+        //pipes are closed, but task is still running?
+        // check back (shortly) to reap it
+        if(0 == polled)
         {
-            //bail
-            goto bail;
+            pollTimeout = (-1 == pollTimeout) ? TASK_REAP_INTERVAL : MIN(pollTimeout, TASK_REAP_INTERVAL);
         }
         
-        //sanity check
-        // ->ensure buffer is somewhat sane
-        if(size <= sizeof(int))
+        //wait for output (or EOF)
+        if(-1 == poll(descriptors, polled, pollTimeout))
         {
+            //interrupted?
+            if(EINTR == errno)
+            {
+                continue;
+            }
+            
             //bail
             goto bail;
         }
         
-        //extract number of args
-        // ->at start of buffer
-        memcpy(&numberOfArgs, taskArgs, sizeof(numberOfArgs));
-        
-        //extract task's name
-        // ->follows # of args (int) and is NULL-terminated
-        processPath = [NSString stringWithUTF8String:taskArgs + sizeof(int)];
+        //drain ready pipes
+        for(nfds_t i = 0; i < polled; i++)
+        {
+            if(0 != descriptors[i].revents)
+            {
+                drainPipe(&tasks[owners[i] / 2], (int)(owners[i] % 2), maxOutput);
+            }
+        }
     }
     
 bail:
     
-    //free process args
-    if(NULL != taskArgs)
+    //(still) cleanup
+    // e.g. poll failed
+    for(size_t i = 0; i < count; i++)
     {
-        //free
-        free(taskArgs);
+        //close pipes
+        closeDescriptor(&tasks[i].pipes[0]);
+        closeDescriptor(&tasks[i].pipes[1]);
         
-        //reset
-        taskArgs = NULL;
+        //kill any still running
+        // otherwise (blocking) reap could wait on it forever
+        if(0 != tasks[i].pid)
+        {
+            kill(tasks[i].pid, SIGKILL);
+        }
+        
+        //reap
+        reapTask(&tasks[i], YES);
     }
     
-    return processPath;
+    //free
+    if(NULL != descriptors)
+    {
+        free(descriptors);
+        descriptors = NULL;
+    }
+    
+    //free
+    if(NULL != owners)
+    {
+        free(owners);
+        owners = NULL;
+    }
+    
+    return;
 }
 
-
-//find a process by name
-pid_t findProcess(NSString* processName)
+//exec processes (in parallel) and grab their stdout/stderr/exit codes
+// each command is @[path, @[arguments]], and (optional) timeout applies to all
+NSArray* execTasks(NSArray* commands, NSTimeInterval timeout)
 {
-    //pid
-    pid_t processID = -1;
-    
-    //status
-    int status = -1;
-    
-    //# of procs
-    int numberOfProcesses = 0;
+    //results
+    NSMutableArray* results = nil;
     
-    //array of pids
-    pid_t* pids = NULL;
-    
-    //process path
-    NSString* processPath = nil;
+    //tasks
+    RunningTask* tasks = NULL;
     
-    //get # of procs
-    numberOfProcesses = proc_listpids(PROC_ALL_PIDS, 0, NULL, 0);
+    //arguments
+    char** argv = NULL;
     
-    //alloc buffer for pids
-    pids = calloc(numberOfProcesses, sizeof(pid_t));
+    //init results
+    results = [NSMutableArray array];
     
-    //get list of pids
-    status = proc_listpids(PROC_ALL_PIDS, 0, pids, numberOfProcesses * sizeof(pid_t));
-    if(status < 0)
+    //alloc tasks
+    tasks = calloc(MAX(commands.count, 1), sizeof(RunningTask));
+    if(NULL == tasks)
     {
         //bail
         goto bail;
     }
     
-    //iterate over all pids
-    // ->get name for each via helper function
-    for(int i = 0; i < numberOfProcesses; ++i)
+    //spawn each
+    for(NSUInteger i = 0; i < commands.count; i++)
     {
-        //skip blank pids
-        if(0 == pids[i])
+        //path
+        NSString* path = commands[i][0];
+        
+        //arguments
+        NSArray* arguments = commands[i][1];
+        
+        //alloc argv
+        // path, arguments, NULL
+        argv = calloc(arguments.count + 2, sizeof(char*));
+        if(NULL == argv)
         {
-            //skip
             continue;
         }
         
-        //get name
-        processPath = getProcessPath(pids[i]);
-        if( (nil == processPath) ||
-            (0 == processPath.length) )
+        //init argv
+        // note: only needs to be valid until spawned
+        argv[0] = (char*)path.fileSystemRepresentation;
+        for(NSUInteger j = 0; j < arguments.count; j++)
         {
-            //skip
+            argv[j + 1] = (char*)[arguments[j] UTF8String];
+        }
+        
+        //spawn
+        if(YES != spawnTask(&tasks[i], path.fileSystemRepresentation, argv))
+        {
+            //dbg msg
+            os_log_debug(OS_LOG_DEFAULT, "WYS: failed to spawn %{public}@ (errno: %d)", path, errno);
+        }
+        
+        //free
+        free(argv);
+        argv = NULL;
+    }
+    
+    //wait for all
+    awaitTasks(tasks, commands.count, timeout, TASK_MAX_OUTPUT);
+    
+    //build results
+    // ...same as NSTask: exit code, or signal (if killed)
+    for(NSUInteger i = 0; i < commands.count; i++)
+    {
+        //task results
+        NSMutableDictionary* taskResults = [NSMutableDictionary dictionary];
+        
+        //didn't spawn?
+        if(YES != tasks[i].spawned)
+        {
+            //add (empty)
+            [results addObject:taskResults];
             continue;
         }
         
-        //match?
-        // last path component is name
-        if(YES == [processPath.lastPathComponent isEqualToString:processName])
+        //add stdout
+        // buffer is now owned by data
+        if(0 != tasks[i].length[0])
         {
-            //save
-            processID = pids[i];
-            
-            //pau
-            break;
+            taskResults[STDOUT] = [NSData dataWithBytesNoCopy:tasks[i].output[0] length:tasks[i].length[0] freeWhenDone:YES];
+            tasks[i].output[0] = NULL;
+        }
+        
+        //add stderr
+        // buffer is now owned by data
+        if(0 != tasks[i].length[1])
+        {
+            taskResults[STDERR] = [NSData dataWithBytesNoCopy:tasks[i].output[1] length:tasks[i].length[1] freeWhenDone:YES];
+            tasks[i].output[1] = NULL;
+        }
+        
+        //add exit code
+        taskResults[EXIT_CODE] = [NSNumber numberWithInteger:WIFEXITED(tasks[i].status) ? WEXITSTATUS(tasks[i].status) : (WIFSIGNALED(tasks[i].status) ? WTERMSIG(tasks[i].status) : -1)];
+        
+        //timed out?
+        if(YES == tasks[i].timedOut)
+        {
+            taskResults[TASK_TIMED_OUT] = @YES;
+        }
+        
+        //truncated?
+        if(YES == tasks[i].truncated)
+        {
+            taskResults[TASK_TRUNCATED] = @YES;
         }
         
-    }//all procs
+        //add
+        [results addObject:taskResults];
+    }
     
 bail:
     
-    //free buffer
-    if(NULL != pids)
+    //free tasks
+    if(NULL != tasks)
     {
+        //free (unused) output
+        for(NSUInteger i = 0; i < commands.count; i++)
+        {
+            free(tasks[i].output[0]);
+            free(tasks[i].output[1]);
+        }
+        
         //free
-        free(pids);
+        free(tasks);
+        tasks = NULL;
     }
     
-    return processID;
+    return results;
 }
 
-//hash a file
-// md5/sha1/sha256
-NSDictionary* hashFile(NSString* itemPath)
+//exec a process and grab it's stdout/stderr/exit code
+// killed if it doesn't exit before timeout (0 for none)
+NSMutableDictionary* execTaskWithTimeout(NSString* binaryPath, NSArray* arguments, NSTimeInterval timeout)
 {
-    //file hashes
-    NSDictionary* hashes = nil;
-    
-    //flag
-    BOOL isDirectory = NO;
+    return [execTasks(@[@[binaryPath, arguments ?: @[]]], timeout) firstObject];
+}
+
+//exec a process and grab it's stdout/stderr/exit code
+NSMutableDictionary* execTask(NSString* binaryPath, NSArray* arguments)
+{
+    return execTaskWithTimeout(binaryPath, arguments, 0);
+}
+
+//get OS's major or minor version
+SInt32 getVersion(OSType selector)
+{
+    //version
+    // ->major or minor
+    SInt32 version = -1;
     
-    //bundle
-    NSBundle* bundle = nil;
+    //get version info
+    if(noErr != Gestalt(selector, &version))
+    {
+        //reset version
+        version = -1;
+        
+        //err
+        goto bail;
+    }
     
-    //handle
-    NSFileHandle* handle = nil;
+bail:
+    
+    return version;
+}
+
+//libproc backend: list pids
+// returns # of pids (or, if 'pids' is NULL, how many there (about) are)
+static int libprocListPids(pid_t* pids, int count)
+{
+    //bytes
+    int bytes = 0;
+    
+    //list
+    bytes = proc_listpids(PROC_ALL_PIDS, 0, pids, (int)(count * sizeof(pid_t)));
+    
+    return (bytes < 0) ? -1 : (int)(bytes / sizeof(pid_t));
+}
+
+//libproc backend: size of (scratch) buffer for process args
+// system's max, as given by 'KERN_ARGMAX'
+static size_t libprocArgumentsSize(void)
+{
+    //once
+    static dispatch_once_t once = 0;
+    
+    //max args
+    static int systemMaxArgs = 0;
+    
+    //get (just once)
+    dispatch_once(&once, ^{
+        
+        //'management info base' array
+        int mib[2] = {CTL_KERN, KERN_ARGMAX};
+        
+        //size
+        size_t size = sizeof(systemMaxArgs);
+        
+        //get system's size for max args
+        if(-1 == sysctl(mib, 2, &systemMaxArgs, &size, NULL, 0))
+        {
+            //unset
+            systemMaxArgs = 0;
+        }
+    });
+    
+    return (size_t)MAX(systemMaxArgs, 0);
+}
+
+//libproc backend: get path of a process
+// first via 'proc_pidpath()', then via its args ('KERN_PROCARGS2'), using caller's (reused) buffer
+static BOOL libprocPidPath(pid_t pid, char* path, size_t pathSize, char* arguments, size_t argumentsSize)
+{
+    //'management info base' array
+    int mib[3] = {CTL_KERN, KERN_PROCARGS2, pid};
+    
+    //size
+    size_t size = argumentsSize;
+    
+    //length of path
+    size_t length = 0;
+    
+    //first attempt via 'proc_pidpath()'
+    if(proc_pidpath(pid, path, (uint32_t)pathSize) > 0)
+    {
+        //happy
+        return YES;
+    }
+    
+    //no buffer?
+    if( (NULL == arguments) ||
+        (argumentsSize <= sizeof(int)) )
+    {
+        return NO;
+    }
+    
+    //get process's args
+    // and ensure buffer is somewhat sane
+    if( (-1 == sysctl(mib, 3, arguments, &size, NULL, 0)) ||
+        (size <= sizeof(int)) )
+    {
+        return NO;
+    }
+    
+    //path follows # of args (int)
+    // and should be NULL-terminated
+    length = strnlen(arguments + sizeof(int), size - sizeof(int));
+    if( (0 == length) ||
+        (length == size - sizeof(int)) ||
+        (length >= pathSize) )
+    {
+        return NO;
+    }
+    
+    //copy
+    memcpy(path, arguments + sizeof(int), length + 1);
+    
+    return YES;
+}
+
+//libproc backend
+const ProcessBackend libprocBackend = {libprocListPids, libprocPidPath, libprocArgumentsSize};
+
+//get process's path
+NSString* getProcessPath(pid_t pid)
+{
+    //task path
+    NSString* processPath = nil;
+    
+    //buffer for process path
+    char pathBuffer[PROC_PIDPATHINFO_MAXSIZE] = {0};
+    
+    //process's args
+    char* taskArgs = NULL;
+    
+    //alloc space for args
+    // only used if 'proc_pidpath()' fails, but that's not known yet
+    taskArgs = malloc(MAX(libprocArgumentsSize(), 1));
+    
+    //get path
+    if(YES == libprocPidPath(pid, pathBuffer, sizeof(pathBuffer), taskArgs, (NULL != taskArgs) ? libprocArgumentsSize() : 0))
+    {
+        //init task's path
+        processPath = [NSString stringWithUTF8String:pathBuffer];
+    }
+    
+    //free process args
+    if(NULL != taskArgs)
+    {
+        //free
+        free(taskArgs);
+        
+        //reset
+        taskArgs = NULL;
+    }
+    
+    return processPath;
+}
+
+//take a snapshot of the process table
+// every pid's path, and an index of names (last path component) to pids, in a single pass
+NSDictionary* processSnapshotWithBackend(const ProcessBackend* backend)
+{
+    //snapshot
+    NSDictionary* snapshot = nil;
+    
+    //paths
+    // pid -> path
+    NSMutableDictionary* paths = nil;
+    
+    //names
+    // name -> pids
+    NSMutableDictionary* names = nil;
+    
+    //# of procs
+    int numberOfProcesses = 0;
+    
+    //array of pids
+    pid_t* pids = NULL;
+    
+    //buffer for process path
+    char pathBuffer[PROC_PIDPATHINFO_MAXSIZE] = {0};
+    
+    //process's args
+    // one buffer, reused for all processes
+    char* taskArgs = NULL;
+    
+    //size of args buffer
+    size_t taskArgsSize = 0;
+    
+    //get # of procs
+    numberOfProcesses = backend->listPids(NULL, 0);
+    if(numberOfProcesses < 0)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //add some slack
+    // as processes may be spawned in the meantime
+    numberOfProcesses += PROCESS_LIST_SLACK;
+    
+    //alloc buffer for pids
+    pids = calloc(numberOfProcesses, sizeof(pid_t));
+    if(NULL == pids)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //get list of pids
+    numberOfProcesses = backend->listPids(pids, numberOfProcesses);
+    if(numberOfProcesses < 0)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //alloc space for args
+    // note: if this fails, paths are just from the first attempt
+    taskArgsSize = backend->argumentsSize();
+    if(0 != taskArgsSize)
+    {
+        taskArgs = malloc(taskArgsSize);
+    }
+    
+    //init
+    paths = [NSMutableDictionary dictionaryWithCapacity:numberOfProcesses];
+    names = [NSMutableDictionary dictionaryWithCapacity:numberOfProcesses];
+    
+    //get path of each
+    // and index it by name
+    for(int i = 0; i < numberOfProcesses; ++i)
+    {
+        //process path
+        NSString* processPath = nil;
+        
+        //pid
+        NSNumber* processID = nil;
+        
+        //skip blank pids
+        if(0 == pids[i])
+        {
+            //skip
+            continue;
+        }
+        
+        //get path
+        if(YES != backend->pidPath(pids[i], pathBuffer, sizeof(pathBuffer), taskArgs, (NULL != taskArgs) ? taskArgsSize : 0))
+        {
+            //skip
+            continue;
+        }
+        
+        //init path
+        processPath = [NSString stringWithUTF8String:pathBuffer];
+        if(0 == processPath.length)
+        {
+            //skip
+            continue;
+        }
+        
+        //init pid
+        processID = [NSNumber numberWithInt:pids[i]];
+        
+        //save path
+        paths[processID] = processPath;
+        
+        //index by name
+        // last path component is name
+        if(nil == names[processPath.lastPathComponent])
+        {
+            names[processPath.lastPathComponent] = [NSMutableArray array];
+        }
+        [names[processPath.lastPathComponent] addObject:processID];
+    }
+    
+    //init snapshot
+    snapshot = @{KEY_PROCESS_PATHS:paths, KEY_PROCESS_NAMES:names};
+    
+bail:
+    
+    //free args
+    if(NULL != taskArgs)
+    {
+        //free
+        free(taskArgs);
+        taskArgs = NULL;
+    }
+    
+    //free buffer
+    if(NULL != pids)
+    {
+        //free
+        free(pids);
+        pids = NULL;
+    }
+    
+    return snapshot;
+}
+
+//take a snapshot of the process table
+// via libproc
+NSDictionary* processSnapshot(void)
+{
+    return processSnapshotWithBackend(&libprocBackend);
+}
+
+//find a process by name in a snapshot
+// returns (first) pid, or -1 if there's no such process
+pid_t findProcessInSnapshot(NSDictionary* snapshot, NSString* processName)
+{
+    //pids
+    NSArray* pids = snapshot[KEY_PROCESS_NAMES][processName];
+    
+    return (0 != pids.count) ? [pids.firstObject intValue] : -1;
+}
+
+//find all processes by name in a snapshot
+// returns their pids (empty if there's no such process)
+NSArray* findProcessesInSnapshot(NSDictionary* snapshot, NSString* processName)
+{
+    //pids
+    NSArray* pids = snapshot[KEY_PROCESS_NAMES][processName];
+    
+    return (nil != pids) ? pids : @[];
+}
+
+//find a process by name
+pid_t findProcess(NSString* processName)
+{
+    return findProcessInSnapshot(processSnapshot(), processName);
+}
+
+//hash ring slot
+// a chunk of the file, shared by all digest workers
+typedef struct
+{
+    //bytes
+    uint8_t* bytes;
+    
+    //length
+    size_t length;
+    
+    //# of digest workers that still have to hash it
+    atomic_int pending;
+    
+} HashSlot;
+
+//read exactly 'size' bytes at 'offset'
+// retries if interrupted, or on short reads
+BOOL readAt(int fd, void* buffer, size_t size, uint64_t offset)
+{
+    //bytes read
+    ssize_t bytesRead = 0;
+    
+    //total read
+    size_t total = 0;
+    
+    //read
+    while(total < size)
+    {
+        //read
+        bytesRead = pread(fd, (uint8_t*)buffer + total, size - total, (off_t)(offset + total));
+        
+        //interrupted?
+        if( (-1 == bytesRead) &&
+            (EINTR == errno) )
+        {
+            //retry
+            continue;
+        }
+        
+        //error or EOF?
+        if(bytesRead <= 0)
+        {
+            return NO;
+        }
+        
+        //update
+        total += (size_t)bytesRead;
+    }
+    
+    return YES;
+}
+
+//convert bytes to hex string
+// e.g. digests, cd hashes
+NSString* bytesToHex(const uint8_t* bytes, size_t length, BOOL uppercase)
+{
+    //digits
+    const char* digits = (YES == uppercase) ? "0123456789ABCDEF" : "0123456789abcdef";
+    
+    //chars
+    char* chars = NULL;
+    
+    //nothing to convert?
+    if(0 == length)
+    {
+        return @"";
+    }
+    
+    //alloc
+    chars = malloc(length * 2);
+    if(NULL == chars)
+    {
+        return nil;
+    }
+    
+    //convert
+    for(size_t i = 0; i < length; i++)
+    {
+        chars[i*2] = digits[bytes[i] >> 4];
+        chars[i*2 + 1] = digits[bytes[i] & 0xF];
+    }
+    
+    //init string
+    // takes ownership of chars
+    return [[NSString alloc] initWithBytesNoCopy:chars length:length * 2 encoding:NSASCIIStringEncoding freeWhenDone:YES];
+}
+
+//get directory for (shared) caches
+// the app group container, unless overridden
+NSURL* cachesDirectory(void)
+{
+    return (nil != cachesOverride) ? cachesOverride : [NSFileManager.defaultManager containerURLForSecurityApplicationGroupIdentifier:APP_GROUP];
+}
+
+//override directory for (shared) caches
+// e.g. so benchmarks don't touch the user's caches (note: call before any cache is used)
+void setCachesDirectory(NSURL* directory)
+{
+    cachesOverride = directory;
+}
+
+//get path of the file to hash
+// for bundles, this is their main binary (directories can't be hashed)
+NSString* hashablePath(NSString* itemPath)
+{
+    //path
+    NSString* path = nil;
+    
+    //flag
+    BOOL isDirectory = NO;
+    
+    //bundle
+    NSBundle* bundle = nil;
+    
+    //set directory flag
+    [NSFileManager.defaultManager fileExistsAtPath:itemPath isDirectory:&isDirectory];
+    
+    //not a directory
+    // can hash as is
+    if(YES != isDirectory)
+    {
+        //set
+        path = itemPath;
+        
+        //done
+        goto bail;
+    }
+    
+    //directories might be bundles
+    // in that case get main binary to hash
+    if(YES != [NSWorkspace.sharedWorkspace isFilePackageAtPath:itemPath])
+    {
+        //bail
+        goto bail;
+    }
+    
+    //load bundle
+    bundle = [NSBundle bundleWithPath:itemPath];
+    
+    //set path
+    // nil if bundle has no executable
+    path = bundle.executablePath;
+    
+bail:
+    
+    return path;
+}
+
+//hash a file
+// md5/sha1/sha256/sha512
+// file is read once (into a ring of buffers), with each algorithm on its own queue
+NSDictionary* hashFile(NSString* itemPath)
+{
+    //file hashes
+    NSDictionary* hashes = nil;
+    
+    //file descriptor
+    int fd = -1;
     
     //path
     // might be app's binary
     NSString* path = nil;
     
-    //offset
-    NSUInteger offset = 0;
+    //ring of buffers
+    HashSlot slots[HASH_RING_SLOTS] = {0};
+    
+    //slot
+    HashSlot* slot = NULL;
+    
+    //free slots
+    dispatch_semaphore_t freeSlots = NULL;
     
-    //file's contents
-    // per chunk (to handle big files)
-    NSData* chunk = nil;
+    //group for digest workers
+    dispatch_group_t group = NULL;
+    
+    //digest worker queues
+    // one per algorithm, serial, so chunks are hashed in order
+    dispatch_queue_t queues[4] = {NULL};
+    
+    //bytes read
+    ssize_t bytesRead = 0;
+    
+    //error flag
+    BOOL readError = NO;
+    
+    //chunk counter
+    NSUInteger chunks = 0;
     
     //md5 context
-    CC_MD5_CTX md5Context = {0};
+    __block CC_MD5_CTX md5Context = {0};
     
     //hash digest (md5)
     uint8_t md5Digest[CC_MD5_DIGEST_LENGTH] = {0};
     
-    //md5 hash as string
-    NSMutableString* md5 = nil;
-    
     //sha1 context
-    CC_SHA1_CTX sha1Context = {0};
+    __block CC_SHA1_CTX sha1Context = {0};
     
     //hash digest (sha1)
     uint8_t sha1Digest[CC_SHA1_DIGEST_LENGTH] = {0};
     
-    //sha1 hash as string
-    NSMutableString* sha1 = nil;
-    
     //sha256 context
-    CC_SHA256_CTX sha256Context = {0};
+    __block CC_SHA256_CTX sha256Context = {0};
     
     //hash digest (sha256)
     uint8_t sha256Digest[CC_SHA256_DIGEST_LENGTH] = {0};
     
-    //sha256 hash as string
-    NSMutableString* sha256 = nil;
-    
     //sha512 context
-    CC_SHA512_CTX sha512Context = {0};
+    __block CC_SHA512_CTX sha512Context = {0};
     
     //hash digest (sha512)
     uint8_t sha512Digest[CC_SHA512_DIGEST_LENGTH] = {0};
     
-    //sha512 hash as string
-    NSMutableString* sha512 = nil;
-    
-    //index var
-    NSUInteger index = 0;
-    
-    //init md5 hash string
-    md5 = [NSMutableString string];
-    
-    //init sha1 hash string
-    sha1 = [NSMutableString string];
-    
-    //init sha256 string
-    sha256 = [NSMutableString string];
-    
-    //init sha512 string
-    sha512 = [NSMutableString string];
+    //get path to hash
+    // for bundles, this is their main binary
+    path = hashablePath(itemPath);
+    if(nil == path)
+    {
+        goto bail;
+    }
     
-    //init path
-    // might be updated if app bundle
-    path = itemPath;
+    //open file
+    fd = open(path.fileSystemRepresentation, O_RDONLY);
+    if(-1 == fd)
+    {
+        goto bail;
+    }
     
-    //set directory flag
-    [NSFileManager.defaultManager fileExistsAtPath:itemPath isDirectory:&isDirectory];
+    //file is read sequentially
+    // so ask for aggressive read ahead
+    fcntl(fd, F_RDAHEAD, 1);
     
-    //directories might be bundles
-    // in that case get main binary to hash
-    if(isDirectory) {
-        
-        //is bundle?
-        if([NSWorkspace.sharedWorkspace isFilePackageAtPath:itemPath]) {
-            
-            //load bundle
-            bundle = [NSBundle bundleWithPath:itemPath];
-            
-            //sanity check
-            // bundle w/ executable path?
-            if( (nil == bundle) ||
-                (nil == bundle.executablePath) )
-            {
-                //bail
-                goto bail;
-            }
-            
-            //update path
-            path = bundle.executablePath;
-        }
-        
-        //not bundle
-        // can't hash a directory, so bail
-        else
+    //alloc ring buffers
+    for(NSUInteger i = 0; i < HASH_RING_SLOTS; i++)
+    {
+        //alloc
+        slots[i].bytes = malloc(HASH_CHUNK_SIZE);
+        if(NULL == slots[i].bytes)
         {
+            //bail
             goto bail;
         }
     }
     
-    //open handle to file
-    handle = [NSFileHandle fileHandleForReadingAtPath:path];
-    if(nil == handle)
-    {
-        goto bail;
-    }
-    
     //init hash contexts
     CC_MD5_Init(&md5Context);
     CC_SHA1_Init(&sha1Context);
     CC_SHA256_Init(&sha256Context);
     CC_SHA512_Init(&sha512Context);
-                 
-    //read/hash file
-    // in chunks, to handle large files
+    
+    //init semaphore
+    // all slots start out free
+    freeSlots = dispatch_semaphore_create(HASH_RING_SLOTS);
+    
+    //init group
+    group = dispatch_group_create();
+    
+    //init worker queues
+    queues[0] = dispatch_queue_create("com.objective-see.wys.md5", DISPATCH_QUEUE_SERIAL);
+    queues[1] = dispatch_queue_create("com.objective-see.wys.sha1", DISPATCH_QUEUE_SERIAL);
+    queues[2] = dispatch_queue_create("com.objective-see.wys.sha256", DISPATCH_QUEUE_SERIAL);
+    queues[3] = dispatch_queue_create("com.objective-see.wys.sha512", DISPATCH_QUEUE_SERIAL);
+    
+    //read file (once)
+    // each chunk is handed off to all digest workers
     while(YES)
     {
-        //wrap
-        // 'readDataOfLength' can throw
-        @try
+        //wait for a free slot
+        dispatch_semaphore_wait(freeSlots, DISPATCH_TIME_FOREVER);
+        
+        //grab (next) slot
+        slot = &slots[chunks++ % HASH_RING_SLOTS];
+        
+        //read in chunk
+        // retry if interrupted
+        do
         {
-            //read in chunk
-            chunk = [handle readDataOfLength:1024*1024];
-            if(chunk.length == 0) break;
-        }
-        @catch(NSException* exception)
+            bytesRead = read(fd, slot->bytes, HASH_CHUNK_SIZE);
+            
+        } while( (-1 == bytesRead) && (EINTR == errno) );
+        
+        //error or EOF?
+        if(bytesRead <= 0)
         {
-            //bail
-            goto bail;
+            //error?
+            readError = (bytesRead < 0);
+            
+            //release slot
+            dispatch_semaphore_signal(freeSlots);
+            
+            //done
+            break;
         }
         
-        //hash updates
-        CC_MD5_Update(&md5Context, (const void *)chunk.bytes, (CC_LONG)chunk.length);
-        CC_SHA1_Update(&sha1Context, (const void *)chunk.bytes, (CC_LONG)chunk.length);
-        CC_SHA256_Update(&sha256Context, (const void *)chunk.bytes, (CC_LONG)chunk.length);
-        CC_SHA512_Update(&sha512Context, (const void *)chunk.bytes, (CC_LONG)chunk.length);
+        //init slot
+        slot->length = (size_t)bytesRead;
+        atomic_store(&slot->pending, 4);
         
-        //inc
-        offset += chunk.length;
-
-        //advance handle
-        [handle seekToFileOffset:offset];
+        //md5
+        dispatch_group_async(group, queues[0], ^{
+            CC_MD5_Update(&md5Context, slot->bytes, (CC_LONG)slot->length);
+            if(1 == atomic_fetch_sub(&slot->pending, 1)) dispatch_semaphore_signal(freeSlots);
+        });
+        
+        //sha1
+        dispatch_group_async(group, queues[1], ^{
+            CC_SHA1_Update(&sha1Context, slot->bytes, (CC_LONG)slot->length);
+            if(1 == atomic_fetch_sub(&slot->pending, 1)) dispatch_semaphore_signal(freeSlots);
+        });
+        
+        //sha256
+        dispatch_group_async(group, queues[2], ^{
+            CC_SHA256_Update(&sha256Context, slot->bytes, (CC_LONG)slot->length);
+            if(1 == atomic_fetch_sub(&slot->pending, 1)) dispatch_semaphore_signal(freeSlots);
+        });
+        
+        //sha512
+        dispatch_group_async(group, queues[3], ^{
+            CC_SHA512_Update(&sha512Context, slot->bytes, (CC_LONG)slot->length);
+            if(1 == atomic_fetch_sub(&slot->pending, 1)) dispatch_semaphore_signal(freeSlots);
+        });
+    }
+    
+    //wait for all workers to finish
+    dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+    
+    //read error?
+    if(YES == readError)
+    {
+        //bail
+        goto bail;
     }
     
     //finalize hashes
@@ -635,45 +1476,31 @@ NSDictionary* hashFile(NSString* itemPath)
     CC_SHA256_Final(sha256Digest, &sha256Context);
     CC_SHA512_Final(sha512Digest, &sha512Context);
     
-    //convert md5 to NSString
-    for(index=0; index < CC_MD5_DIGEST_LENGTH; index++)
-    {
-        //format/append
-        [md5 appendFormat:@"%02lX", (unsigned long)md5Digest[index]];
-    }
-    
-    //convert sha1 to NSString
-    for(index=0; index < CC_SHA1_DIGEST_LENGTH; index++)
-    {
-        //format/append
-        [sha1 appendFormat:@"%02lX", (unsigned long)sha1Digest[index]];
-    }
+    //init hash dictionary
+    hashes = @{KEY_HASH_MD5:bytesToHex(md5Digest, CC_MD5_DIGEST_LENGTH, YES),
+               KEY_HASH_SHA1:bytesToHex(sha1Digest, CC_SHA1_DIGEST_LENGTH, YES),
+               KEY_HASH_SHA256:bytesToHex(sha256Digest, CC_SHA256_DIGEST_LENGTH, YES),
+               KEY_HASH_SHA512:bytesToHex(sha512Digest, CC_SHA512_DIGEST_LENGTH, YES)};
     
-    //convert sha256 to NSString
-    for(index=0; index < CC_SHA256_DIGEST_LENGTH; index++)
-    {
-        //format/append
-        [sha256 appendFormat:@"%02lX", (unsigned long)sha256Digest[index]];
-    }
+bail:
     
-    //convert sha256 to NSString
-    for(index=0; index < CC_SHA512_DIGEST_LENGTH; index++)
+    //free ring buffers
+    for(NSUInteger i = 0; i < HASH_RING_SLOTS; i++)
     {
-        //format/append
-        [sha512 appendFormat:@"%02lX", (unsigned long)sha512Digest[index]];
+        //free
+        if(NULL != slots[i].bytes)
+        {
+            free(slots[i].bytes);
+            slots[i].bytes = NULL;
+        }
     }
-    
-    //init hash dictionary
-    hashes = @{KEY_HASH_MD5:md5, KEY_HASH_SHA1:sha1, KEY_HASH_SHA256:sha256, KEY_HASH_SHA512:sha512};
-    
-bail:
 
-    //close handle?
-    if(nil != handle)
+    //close file
+    if(-1 != fd)
     {
         //close
-        [handle closeFile];
-        handle = nil;
+        close(fd);
+        fd = -1;
     }
     
     return hashes;
@@ -684,7 +1511,7 @@ void restartFinder(void)
 {
     //relaunch Finder
     // ensures plugin gets loaded, etc
-    execTask(KILLALL, @[@"-SIGHUP", @"Finder"]);
+    execTaskWithTimeout(KILLALL, @[@"-SIGHUP", @"Finder"], TASK_TIMEOUT);
     
     //give it a second to restart
     [NSThread sleepForTimeInterval:1.0f];
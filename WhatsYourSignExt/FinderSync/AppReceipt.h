@@ -13,52 +13,10 @@
 @import Foundation;
 
 #import <Security/CMSDecoder.h>
-#import <Security/SecAsn1Coder.h>
 #import <CommonCrypto/CommonDigest.h>
-#import <Security/SecAsn1Templates.h>
-
 
 //from 'Receipt Fields' section (Apple's 'Receipt Validation Programming Guide')
-
-//ANS.1 data struct
-typedef struct
-{
-    size_t          length;
-    unsigned char   *data;
-} ASN1_Data;
-
-//receipt attribute struct
-typedef struct
-{
-    ASN1_Data type;     // INTEGER
-    ASN1_Data version;  // INTEGER
-    ASN1_Data value;    // OCTET STRING
-    
-} ReceiptAttribute;
-
-//receipt payload struct
-typedef struct
-{
-    ReceiptAttribute **attrs;
-    
-} ReceiptPayload;
-
-//ASN.1 receipt attribute template (from [1])
-static const SecAsn1Template kReceiptAttributeTemplate[] =
-{
-    { SEC_ASN1_SEQUENCE, 0, NULL, sizeof(ReceiptAttribute) },
-    { SEC_ASN1_INTEGER, offsetof(ReceiptAttribute, type), NULL, 0 },
-    { SEC_ASN1_INTEGER, offsetof(ReceiptAttribute, version), NULL, 0 },
-    { SEC_ASN1_OCTET_STRING, offsetof(ReceiptAttribute, value), NULL, 0 },
-    { 0, 0, NULL, 0 }
-};
-
-//ASN.1 receipt template set (from [1])
-static const SecAsn1Template kSetOfReceiptAttributeTemplate[] =
-{
-    { SEC_ASN1_SET_OF, 0, kReceiptAttributeTemplate, sizeof(ReceiptPayload) },
-    { 0, 0, NULL, 0 }
-};
+// payload is a set of attributes, each a sequence of: type (INTEGER), version (INTEGER), value (OCTET STRING)
 
 //attribute type for bundle ID
 #define RECEIPT_ATTR_BUNDLE_ID 2
@@ -87,6 +45,9 @@ static const SecAsn1Template kSetOfReceiptAttributeTemplate[] =
 //key for receipt's sha-1 hash
 #define KEY_RECEIPT_HASH @"receiptHash"
 
+//max # of (cached) receipts
+#define RECEIPT_CACHE_MAX 256
+
 //class interface
 @interface AppReceipt : NSObject
 {
@@ -97,14 +58,21 @@ static const SecAsn1Template kSetOfReceiptAttributeTemplate[] =
 
 //init with app path
 // ->locate/load receipt, etc
+// note: parsed components are cached (per receipt), until receipt changes
 -(instancetype)init:(NSBundle *)bundle;
 
+//parse decoded receipt
+// ->extract out items such as bundle id, app version, etc.
+-(NSMutableDictionary*)parse;
+
 /* PROPERTIES */
 
 //encoded receipt data
+// mapped, and nil if components were cached
 @property (nonatomic, retain) NSData* encodedData;
 
 //decoded receipt data
+// payload, which (if possible) points into encoded data
 @property (nonatomic, retain) NSData* decodedData;
 
 //receipt components
@@ -6,47 +6,183 @@
 //  Copyright (c) 2016 Objective-See. All rights reserved.
 //
 
+#import "Der.h"
 #import "AppReceipt.h"
 
-//helper function from [1]
-// ->extract an int from ASN.1 data
-inline static int getIntValueFromASN1Data(const ASN1_Data *asn1Data)
+#import <os/lock.h>
+#import <sys/stat.h>
+
+//OID: pkcs7-signedData (1.2.840.113549.1.7.2)
+static const uint8_t oidSignedData[] = {0x2A, 0x86, 0x48, 0x86, 0xF7, 0x0D, 0x01, 0x07, 0x02};
+
+//OID: pkcs7-data (1.2.840.113549.1.7.1)
+static const uint8_t oidData[] = {0x2A, 0x86, 0x48, 0x86, 0xF7, 0x0D, 0x01, 0x07, 0x01};
+
+//lock
+// for receipt cache
+static os_unfair_lock receiptsLock = OS_UNFAIR_LOCK_INIT;
+
+//cached receipts
+// path -> [identity, components (or null if invalid)]
+static NSMutableDictionary* receipts = nil;
+
+//get identity of a receipt
+// changes whenever receipt is modified or replaced
+static NSData* receiptIdentity(const struct stat* info)
+{
+    //identity
+    int64_t identity[] = {(int64_t)info->st_dev, (int64_t)info->st_ino, (int64_t)info->st_size, info->st_mtimespec.tv_sec, info->st_mtimespec.tv_nsec, info->st_ctimespec.tv_sec, info->st_ctimespec.tv_nsec};
+    
+    return [NSData dataWithBytes:identity length:sizeof(identity)];
+}
+
+//get cached receipt components
+// returns null if receipt was invalid, nil if not (or no longer) cached
+static id cachedReceipt(NSString* path, NSData* identity)
 {
-    int ret = 0;
-    for (int i = 0; i < asn1Data->length; i++)
+    //components
+    id components = nil;
+    
+    //cached
+    NSArray* cached = nil;
+    
+    //lock
+    os_unfair_lock_lock(&receiptsLock);
+    
+    //still same receipt?
+    cached = receipts[path];
+    if(YES == [cached.firstObject isEqualToData:identity])
     {
-        ret = (ret << 8) | asn1Data->data[i];
+        //grab
+        components = cached.lastObject;
     }
-    return ret;
+    
+    //unlock
+    os_unfair_lock_unlock(&receiptsLock);
+    
+    return components;
 }
 
-//helper function from [1]
-// ->decode string from ASN.1 data
-inline static NSString *decodeUTF8StringFromASN1Data(SecAsn1CoderRef decoder, ASN1_Data srcData)
+//cache receipt components
+// nil components means receipt is invalid
+static void cacheReceipt(NSString* path, NSData* identity, NSDictionary* components)
 {
-    //data struct
-    ASN1_Data asn1Data = {0};
+    //lock
+    os_unfair_lock_lock(&receiptsLock);
     
-    //decoded string
-    NSString* decodedString = nil;
+    //init
+    if(nil == receipts)
+    {
+        receipts = [NSMutableDictionary dictionary];
+    }
     
-    //status
-    OSStatus status = -1;
+    //full?
+    // just start over
+    if(receipts.count >= RECEIPT_CACHE_MAX)
+    {
+        [receipts removeAllObjects];
+    }
     
-    //decode
-    status = SecAsn1Decode(decoder, srcData.data, srcData.length, kSecAsn1UTF8StringTemplate, &asn1Data);
-    if(noErr != status)
+    //save
+    receipts[path] = @[identity, (nil != components) ? [components copy] : [NSNull null]];
+    
+    //unlock
+    os_unfair_lock_unlock(&receiptsLock);
+    
+    return;
+}
+
+//find payload in (encoded) receipt
+// walks ContentInfo -> SignedData -> EncapsulatedContentInfo -> eContent, without copying
+// note: fails if receipt isn't DER (e.g. has indefinite lengths), as then CMS decoder has to extract it
+static BOOL findPayload(const uint8_t* bytes, size_t length, DERItem* payload)
+{
+    //flag
+    BOOL found = NO;
+    
+    //cursor
+    DERCursor cursor = {0};
+    
+    //item
+    DERItem item = {0};
+    
+    //content info
+    if(YES != derDecode(bytes, length, DER_TAG_SEQUENCE, &item))
+    {
+        //bail
+        goto bail;
+    }
+    
+    //content type should be signed data
+    derEnter(&cursor, &item);
+    if( (YES != derNextExpect(&cursor, DER_TAG_OID, &item)) ||
+        (YES != derOIDEqual(&item, oidSignedData, sizeof(oidSignedData))) )
+    {
+        //bail
+        goto bail;
+    }
+    
+    //content
+    // [0] EXPLICIT SignedData
+    if( (YES != derNextExpect(&cursor, DER_TAG_CONTEXT(0), &item)) ||
+        (YES != derDecode(item.data, item.length, DER_TAG_SEQUENCE, &item)) )
+    {
+        //bail
+        goto bail;
+    }
+    
+    //skip version, digest algorithms
+    // then grab encapsulated content info
+    derEnter(&cursor, &item);
+    if( (YES != derNextExpect(&cursor, DER_TAG_INTEGER, &item)) ||
+        (YES != derNextExpect(&cursor, DER_TAG_SET, &item)) ||
+        (YES != derNextExpect(&cursor, DER_TAG_SEQUENCE, &item)) )
+    {
+        //bail
+        goto bail;
+    }
+    
+    //content type should be data
+    derEnter(&cursor, &item);
+    if( (YES != derNextExpect(&cursor, DER_TAG_OID, &item)) ||
+        (YES != derOIDEqual(&item, oidData, sizeof(oidData))) )
+    {
+        //bail
+        goto bail;
+    }
+    
+    //content
+    // [0] EXPLICIT OCTET STRING
+    if( (YES != derNextExpect(&cursor, DER_TAG_CONTEXT(0), &item)) ||
+        (YES != derDecode(item.data, item.length, DER_TAG_OCTET_STRING, payload)) )
     {
         //bail
         goto bail;
     }
     
-    //convert to string
-    decodedString = [[NSString alloc] initWithBytes:asn1Data.data length:asn1Data.length encoding:NSUTF8StringEncoding];
+    //happy
+    found = YES;
     
 bail:
     
-    return decodedString;
+    return found;
+}
+
+//decode (DER) string from attribute's value
+// e.g. bundle id or app version, which are UTF8 strings
+static NSString* decodeUTF8String(const DERItem* value)
+{
+    //string
+    DERItem string = {0};
+    
+    //decode
+    if(YES != derDecode(value->data, value->length, DER_TAG_UTF8_STRING, &string))
+    {
+        //bail
+        return nil;
+    }
+    
+    return [[NSString alloc] initWithBytes:string.data length:string.length encoding:NSUTF8StringEncoding];
 }
 
 //class implementation
@@ -59,21 +195,55 @@ bail:
 
 //init with app path
 // ->locate/load/decode receipt, etc
+// note: parsed components are cached (per receipt), until receipt changes
 -(instancetype)init:(NSBundle *)bundle
 {
+    //receipt path
+    NSString* path = nil;
+    
+    //receipt info
+    struct stat info = {0};
+    
+    //receipt identity
+    NSData* identity = nil;
+    
+    //cached components
+    id cached = nil;
+    
     //init
     if(self = [super init])
     {
         //first check for receipt
-        if( (nil == bundle.appStoreReceiptURL) ||
-            (YES != [[NSFileManager defaultManager] fileExistsAtPath:bundle.appStoreReceiptURL.path]) )
+        path = bundle.appStoreReceiptURL.path;
+        if( (nil == path) ||
+            (0 != stat(path.fileSystemRepresentation, &info)) )
         {
             //bail
             return nil;
         }
         
+        //check cache
+        identity = receiptIdentity(&info);
+        cached = cachedReceipt(path, identity);
+        if(nil != cached)
+        {
+            //invalid?
+            if(YES == [cached isKindOfClass:[NSNull class]])
+            {
+                //bail
+                return nil;
+            }
+            
+            //save
+            self.components = [cached mutableCopy];
+            
+            //done
+            return self;
+        }
+        
         //load encoded receipt data
-        self.encodedData = [NSData dataWithContentsOfURL:bundle.appStoreReceiptURL];
+        // mapped, as payload is parsed in place
+        self.encodedData = [NSData dataWithContentsOfFile:path options:NSDataReadingMappedIfSafe error:NULL];
         if(nil == self.encodedData)
         {
             //bail
@@ -84,6 +254,9 @@ bail:
         self.decodedData = [self decode];
         if(nil == self.decodedData)
         {
+            //cache
+            cacheReceipt(path, identity, nil);
+            
             //bail
             return nil;
         }
@@ -94,9 +267,15 @@ bail:
         if( (nil == self.components) ||
             (0 == self.components.count) )
         {
+            //cache
+            cacheReceipt(path, identity, nil);
+            
             //bail
             return nil;
         }
+        
+        //cache
+        cacheReceipt(path, identity, self.components);
     }
     
     return self;
@@ -104,11 +283,15 @@ bail:
 
 //decode receipt data
 // ->some validations performed here too
+// note: if receipt is DER, returned payload points into encoded data (no copy)
 -(NSData*)decode
 {
     //decoded data
     NSData* decoded = nil;
     
+    //payload
+    DERItem payload = {0};
+    
     //decoder
     CMSDecoderRef decoder = NULL;
     
@@ -185,7 +368,20 @@ bail:
         goto bail;
     }
     
-    //grab decoded content
+    //find payload
+    // it's in the encoded data, so just point to it
+    if(YES == findPayload(self.encodedData.bytes, self.encodedData.length, &payload))
+    {
+        //init
+        // note: only valid as long as encoded data is
+        decoded = [NSData dataWithBytesNoCopy:(void*)payload.data length:payload.length freeWhenDone:NO];
+        
+        //done
+        goto bail;
+    }
+    
+    //not DER
+    // so grab (copy of) decoded content
     status = CMSDecoderCopyContent(decoder, &data);
     if(noErr != status)
     {
@@ -232,34 +428,23 @@ bail:
 
 //parse decoded receipt
 // ->extract out items such as bundle id, app version, etc.
+// note: walks payload in place, only creating objects for the items of interest
 -(NSMutableDictionary*)parse
 {
-    //decoder
-    SecAsn1CoderRef decoder = NULL;
+    //attributes
+    DERItem set = {0};
     
-    //status
-    OSStatus status = -1;
-    
-    //payload struct
-    ReceiptPayload payload = {0};
+    //cursor
+    DERCursor attributes = {0};
     
     //attribute
-    ReceiptAttribute *attribute;
+    DERItem attribute = {0};
     
     //dictionary for items
     NSMutableDictionary* items = nil;
     
-    //create decoder
-    status = SecAsn1CoderCreate(&decoder);
-    if(noErr != status)
-    {
-        //bail
-        goto bail;
-    }
-    
-    //decode
-    status = SecAsn1Decode(decoder, self.decodedData.bytes, self.decodedData.length, kSetOfReceiptAttributeTemplate, &payload);
-    if(noErr != status)
+    //payload is a set of attributes
+    if(YES != derDecode(self.decodedData.bytes, self.decodedData.length, DER_TAG_SET, &set))
     {
         //bail
         goto bail;
@@ -270,20 +455,51 @@ bail:
     
     //extact attributes
     // ->save those of interest
-    for(int i = 0; (attribute = payload.attrs[i]); i++)
+    derEnter(&attributes, &set);
+    while(YES == derNext(&attributes, &attribute))
     {
+        //fields
+        DERCursor fields = {0};
+        
+        //type
+        DERItem type = {0};
+        
+        //version
+        DERItem version = {0};
+        
+        //value
+        DERItem value = {0};
+        
+        //type (value)
+        int64_t typeValue = 0;
+        
+        //attribute is a sequence of type, version, and value
+        derEnter(&fields, &attribute);
+        if( (DER_TAG_SEQUENCE != attribute.tag) ||
+            (YES != derNextExpect(&fields, DER_TAG_INTEGER, &type)) ||
+            (YES != derInteger(&type, &typeValue)) ||
+            (YES != derNextExpect(&fields, DER_TAG_INTEGER, &version)) ||
+            (YES != derNextExpect(&fields, DER_TAG_OCTET_STRING, &value)) )
+        {
+            //malformed
+            items = nil;
+            
+            //bail
+            goto bail;
+        }
+        
         //process each type
-        switch(getIntValueFromASN1Data(&attribute->type))
+        switch(typeValue)
         {
             //bundle id
             // ->save bundle id and data
             case RECEIPT_ATTR_BUNDLE_ID:
             {
                 //save bundle id
-                items[KEY_BUNDLE_ID] = decodeUTF8StringFromASN1Data(decoder, attribute->value);
+                items[KEY_BUNDLE_ID] = decodeUTF8String(&value);
                 
                 //save bundle id data
-                items[KEY_BUNDLE_DATA] = [NSData dataWithBytes:attribute->value.data length:attribute->value.length];
+                items[KEY_BUNDLE_DATA] = [NSData dataWithBytes:value.data length:value.length];
                 
                 break;
             }
@@ -292,7 +508,7 @@ bail:
             case RECEIPT_ATTR_APP_VERSION:
             {
                 //save
-                items[KEY_APP_VERSION] = decodeUTF8StringFromASN1Data(decoder, attribute->value);
+                items[KEY_APP_VERSION] = decodeUTF8String(&value);
                 
                 break;
                 
@@ -302,7 +518,7 @@ bail:
             case RECEIPT_ATTR_OPAQUE_VALUE:
             {
                 //save
-                items[KEY_OPAQUE_VALUE] = [NSData dataWithBytes:attribute->value.data length:attribute->value.length];
+                items[KEY_OPAQUE_VALUE] = [NSData dataWithBytes:value.data length:value.length];
                 
                 break;
             }
@@ -311,7 +527,7 @@ bail:
             case RECEIPT_ATTR_RECEIPT_HASH:
             {
                 //save
-                items[KEY_RECEIPT_HASH] = [NSData dataWithBytes:attribute->value.data length:attribute->value.length];
+                items[KEY_RECEIPT_HASH] = [NSData dataWithBytes:value.data length:value.length];
                 
                 break;
             }
@@ -326,15 +542,16 @@ bail:
         }//switch
         
     }//for all attributes
-
-bail:
     
-    //release decoder
-    if(NULL != decoder)
+    //malformed?
+    // e.g. attribute ran past end of set
+    if(YES != derDone(&attributes))
     {
-        //release
-        SecAsn1CoderRelease(decoder);
+        //unset
+        items = nil;
     }
+
+bail:
     
     return items;
 }
@@ -0,0 +1,54 @@
+//
+//  BatchWindowController.h
+//  WhatsYourSignExt
+//
+//  Created by Patrick Wardle on 10/17/26.
+//  Copyright (c) 2026 Objective-See. All rights reserved.
+//
+
+@import Cocoa;
+
+@interface BatchWindowController : NSWindowController <NSWindowDelegate, NSTableViewDataSource, NSTableViewDelegate>
+{
+
+}
+
+/* PROPERTIES */
+
+//selected items (URLs)
+// folders are expanded (recursively)
+@property(nonatomic, retain)NSArray* items;
+
+//results
+// one per item, added as each is verified
+@property(nonatomic, retain)NSMutableArray* results;
+
+//table
+@property(nonatomic, retain)NSTableView* tableView;
+
+//status (progress, throughput, ETA)
+@property(nonatomic, retain)NSTextField* status;
+
+//progress bar
+@property(nonatomic, retain)NSProgressIndicator* progressIndicator;
+
+//# of items (to verify)
+@property NSUInteger total;
+
+//start time
+@property(nonatomic, retain)NSDate* startTime;
+
+//cancelled?
+// set when window is closed
+@property BOOL cancelled;
+
+/* METHODS */
+
+//init with (selected) items
+-(id)initWithItems:(NSArray*)selectedItems;
+
+//start verifying items
+// results are added to table as each item is completed
+-(void)start;
+
+@end
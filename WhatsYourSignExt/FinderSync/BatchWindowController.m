@@ -0,0 +1,517 @@
+//
+//  BatchWindowController.m
+//  WhatsYourSignExt
+//
+//  Created by Patrick Wardle on 10/17/26.
+//  Copyright (c) 2026 Objective-See. All rights reserved.
+//
+
+#import "Item.h"
+#import "Consts.h"
+#import "Utilities.h"
+#import "BatchWindowController.h"
+
+#import <os/log.h>
+
+@import Security;
+
+//columns
+// also keys of results
+#define COLUMN_NAME @"name"
+#define COLUMN_TYPE @"type"
+#define COLUMN_SIGNATURE @"signature"
+#define COLUMN_SIGNER @"signer"
+#define COLUMN_NOTARIZED @"notarized"
+#define COLUMN_PATH @"path"
+
+//key for (raw) status
+// signature column is sorted by this
+#define KEY_STATUS @"status"
+
+@implementation BatchWindowController
+
+@synthesize items;
+@synthesize total;
+@synthesize status;
+@synthesize results;
+@synthesize cancelled;
+@synthesize startTime;
+@synthesize tableView;
+@synthesize progressIndicator;
+
+//init with (selected) items
+// builds window (table, progress bar, and status)
+-(id)initWithItems:(NSArray*)selectedItems
+{
+    //window
+    NSWindow* window = nil;
+    
+    //scroll view
+    NSScrollView* scrollView = nil;
+    
+    //init window
+    window = [[NSWindow alloc] initWithContentRect:NSMakeRect(0, 0, 860, 480) styleMask:NSWindowStyleMaskTitled | NSWindowStyleMaskClosable | NSWindowStyleMaskMiniaturizable | NSWindowStyleMaskResizable backing:NSBackingStoreBuffered defer:YES];
+    window.title = NSLocalizedString(@"Code Signing Info", @"Code Signing Info");
+    window.minSize = NSMakeSize(480, 240);
+    window.releasedWhenClosed = NO;
+    
+    //super
+    self = [super initWithWindow:window];
+    if(nil == self)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //init
+    self.items = selectedItems;
+    self.results = [NSMutableArray array];
+    
+    //init table
+    self.tableView = [[NSTableView alloc] initWithFrame:NSZeroRect];
+    self.tableView.usesAlternatingRowBackgroundColors = YES;
+    self.tableView.columnAutoresizingStyle = NSTableViewUniformColumnAutoresizingStyle;
+    self.tableView.dataSource = self;
+    self.tableView.delegate = self;
+    
+    //add columns
+    // note: signature is sorted by (raw) status
+    [self addColumn:COLUMN_NAME title:NSLocalizedString(@"Name", @"Name") width:160 sortKey:COLUMN_NAME];
+    [self addColumn:COLUMN_TYPE title:NSLocalizedString(@"Type", @"Type") width:160 sortKey:COLUMN_TYPE];
+    [self addColumn:COLUMN_SIGNATURE title:NSLocalizedString(@"Signature", @"Signature") width:100 sortKey:KEY_STATUS];
+    [self addColumn:COLUMN_SIGNER title:NSLocalizedString(@"Signer", @"Signer") width:140 sortKey:COLUMN_SIGNER];
+    [self addColumn:COLUMN_NOTARIZED title:NSLocalizedString(@"Notarized", @"Notarized") width:70 sortKey:COLUMN_NOTARIZED];
+    [self addColumn:COLUMN_PATH title:NSLocalizedString(@"Path", @"Path") width:220 sortKey:COLUMN_PATH];
+    
+    //init scroll view
+    scrollView = [[NSScrollView alloc] initWithFrame:NSMakeRect(0, 44, 860, 436)];
+    scrollView.autoresizingMask = NSViewWidthSizable | NSViewHeightSizable;
+    scrollView.hasVerticalScroller = YES;
+    scrollView.hasHorizontalScroller = YES;
+    scrollView.documentView = self.tableView;
+    [window.contentView addSubview:scrollView];
+    
+    //init progress bar
+    self.progressIndicator = [[NSProgressIndicator alloc] initWithFrame:NSMakeRect(12, 14, 200, 16)];
+    self.progressIndicator.style = NSProgressIndicatorStyleBar;
+    self.progressIndicator.indeterminate = YES;
+    self.progressIndicator.autoresizingMask = NSViewMaxXMargin | NSViewMaxYMargin;
+    [window.contentView addSubview:self.progressIndicator];
+    
+    //init status
+    self.status = [NSTextField labelWithString:NSLocalizedString(@"Finding items...", @"Finding items...")];
+    self.status.frame = NSMakeRect(224, 12, 624, 18);
+    self.status.autoresizingMask = NSViewWidthSizable | NSViewMaxYMargin;
+    self.status.lineBreakMode = NSLineBreakByTruncatingTail;
+    [window.contentView addSubview:self.status];
+    
+    //delegate
+    // for close notification
+    window.delegate = self;
+
+bail:
+    
+    return self;
+}
+
+//add a (sortable) column
+-(void)addColumn:(NSString*)identifier title:(NSString*)title width:(CGFloat)width sortKey:(NSString*)sortKey
+{
+    //column
+    NSTableColumn* column = nil;
+    
+    //init
+    column = [[NSTableColumn alloc] initWithIdentifier:identifier];
+    column.title = title;
+    column.width = width;
+    column.minWidth = 50;
+    
+    //sortable
+    // strings sort like Finder, status sorts numerically
+    column.sortDescriptorPrototype = [NSSortDescriptor sortDescriptorWithKey:sortKey ascending:YES selector:(YES == [sortKey isEqualToString:KEY_STATUS]) ? @selector(compare:) : @selector(localizedStandardCompare:)];
+    
+    //add
+    [self.tableView addTableColumn:column];
+    
+    return;
+}
+
+//start verifying items
+// results are added to table as each item is completed
+-(void)start
+{
+    //save start time
+    self.startTime = [NSDate date];
+    
+    //expand/verify in background
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+        
+        //paths
+        NSArray* paths = nil;
+        
+        //slots
+        // bounds # of items being verified at once
+        dispatch_semaphore_t slots = dispatch_semaphore_create(BATCH_MAX_CONCURRENT);
+        
+        //expand items
+        // folders are replaced with their contents
+        paths = [self expand:self.items];
+        
+        //dbg msg
+        os_log_debug(OS_LOG_DEFAULT, "WYS: batch verifying %lu items", (unsigned long)paths.count);
+        
+        //init total/progress
+        dispatch_async(dispatch_get_main_queue(), ^{
+            
+            //save
+            self.total = paths.count;
+            
+            //init progress bar
+            self.progressIndicator.indeterminate = NO;
+            self.progressIndicator.maxValue = MAX(paths.count, 1);
+            
+            //update status
+            [self updateStatus];
+        
+        });
+        
+        //verify each
+        for(NSString* path in paths)
+        {
+            //window closed?
+            if(YES == self.cancelled)
+            {
+                break;
+            }
+            
+            //wait for free slot
+            dispatch_semaphore_wait(slots, DISPATCH_TIME_FOREVER);
+            
+            //verify
+            dispatch_async(dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+                
+                //result
+                NSDictionary* result = nil;
+                
+                //item
+                Item* item = nil;
+                
+                //window closed?
+                if(YES != self.cancelled)
+                {
+                    //init item
+                    // note: don't kick off (async) verification
+                    item = [[Item alloc] init:path verify:NO];
+                    
+                    //verify
+                    [item verify];
+                    
+                    //summarize
+                    result = [self summarize:item];
+                    
+                    //add on main thread
+                    dispatch_async(dispatch_get_main_queue(), ^{
+                        [self addResult:result];
+                    });
+                }
+                
+                //free slot
+                dispatch_semaphore_signal(slots);
+            });
+        }
+    });
+    
+    return;
+}
+
+//expand items
+// folders (not bundles) are replaced, recursively, with their contents
+-(NSArray*)expand:(NSArray*)selectedItems
+{
+    //paths
+    NSMutableArray* paths = nil;
+    
+    //init
+    paths = [NSMutableArray array];
+    
+    //expand each
+    for(NSURL* item in selectedItems)
+    {
+        //directory flag
+        BOOL isDirectory = NO;
+        
+        //enumerator
+        NSDirectoryEnumerator* enumerator = nil;
+        
+        //not a folder?
+        // bundles are verified as a whole
+        if( (YES != [NSFileManager.defaultManager fileExistsAtPath:item.path isDirectory:&isDirectory]) ||
+            (YES != isDirectory) ||
+            (YES == [NSWorkspace.sharedWorkspace isFilePackageAtPath:item.path]) )
+        {
+            //add
+            [paths addObject:item.path];
+            
+            //next
+            continue;
+        }
+        
+        //init enumerator
+        // skip hidden files, as Finder does
+        enumerator = [NSFileManager.defaultManager enumeratorAtURL:item includingPropertiesForKeys:@[NSURLIsDirectoryKey, NSURLIsPackageKey] options:NSDirectoryEnumerationSkipsHiddenFiles errorHandler:nil];
+        
+        //add each
+        for(NSURL* url in enumerator)
+        {
+            //directory?
+            NSNumber* directory = nil;
+            
+            //package?
+            NSNumber* package = nil;
+            
+            //get properties
+            [url getResourceValue:&directory forKey:NSURLIsDirectoryKey error:nil];
+            [url getResourceValue:&package forKey:NSURLIsPackageKey error:nil];
+            
+            //folder?
+            // descend into it
+            if( (YES == directory.boolValue) &&
+                (YES != package.boolValue) )
+            {
+                continue;
+            }
+            
+            //package?
+            // verified as a whole
+            if(YES == package.boolValue)
+            {
+                [enumerator skipDescendants];
+            }
+            
+            //add
+            [paths addObject:url.path];
+        }
+    }
+    
+    return paths;
+}
+
+//summarize an item's signing info
+// into what's shown in the table
+-(NSDictionary*)summarize:(Item*)item
+{
+    //signature
+    NSString* signature = nil;
+    
+    //signer
+    NSString* signer = @"-";
+    
+    //notarized
+    NSString* notarized = @"-";
+    
+    //status
+    NSInteger signatureStatus = [item.signingInfo[KEY_SIGNATURE_STATUS] integerValue];
+    
+    //signature
+    switch(signatureStatus)
+    {
+        case errSecSuccess:
+            signature = NSLocalizedString(@"valid", @"valid");
+            break;
+        
+        case errSecCSUnsigned:
+            signature = NSLocalizedString(@"unsigned", @"unsigned");
+            break;
+        
+        case CSSMERR_TP_CERT_REVOKED:
+            signature = NSLocalizedString(@"revoked", @"revoked");
+            break;
+        
+        case kPOSIXErrorEACCES:
+            signature = NSLocalizedString(@"not accessible", @"not accessible");
+            break;
+        
+        default:
+            signature = [NSString stringWithFormat:NSLocalizedString(@"error (%ld)", @"error (%ld)"), (long)signatureStatus];
+            break;
+    }
+    
+    //signed?
+    // determine signer and notarization
+    if( (errSecSuccess == signatureStatus) ||
+        (CSSMERR_TP_CERT_REVOKED == signatureStatus) )
+    {
+        //apple
+        if(YES == [item.signingInfo[KEY_SIGNING_IS_APPLE] boolValue])
+        {
+            signer = NSLocalizedString(@"Apple", @"Apple");
+        }
+        //app store
+        else if(YES == [item.signingInfo[KEY_SIGNING_IS_APP_STORE] boolValue])
+        {
+            signer = NSLocalizedString(@"Mac App Store", @"Mac App Store");
+        }
+        //dev id
+        else if(YES == [item.signingInfo[KEY_SIGNING_IS_APPLE_DEV_ID] boolValue])
+        {
+            signer = NSLocalizedString(@"Apple Developer ID", @"Apple Developer ID");
+        }
+        //ad hoc
+        else if(kSecCodeSignatureAdhoc & [item.signingInfo[KEY_SIGNING_FLAGS] unsignedIntValue])
+        {
+            signer = NSLocalizedString(@"ad-hoc", @"ad-hoc");
+        }
+        //other
+        // use leaf's name
+        else if(0 != [item.signingInfo[KEY_SIGNING_AUTHORITIES] count])
+        {
+            signer = [item.signingInfo[KEY_SIGNING_AUTHORITIES] firstObject];
+        }
+        
+        //notarized?
+        if(nil == item.signingInfo[KEY_SIGNING_IS_NOTARIZED])
+        {
+            notarized = NSLocalizedString(@"no", @"no");
+        }
+        else if(errSecSuccess == [item.signingInfo[KEY_SIGNING_IS_NOTARIZED] integerValue])
+        {
+            notarized = NSLocalizedString(@"yes", @"yes");
+        }
+        else if(errSecCSRevokedNotarization == [item.signingInfo[KEY_SIGNING_IS_NOTARIZED] integerValue])
+        {
+            notarized = NSLocalizedString(@"revoked", @"revoked");
+        }
+    }
+    
+    return @{COLUMN_NAME:item.name ?: item.path.lastPathComponent,
+             COLUMN_TYPE:item.type ?: @"",
+             COLUMN_SIGNATURE:signature,
+             COLUMN_SIGNER:signer,
+             COLUMN_NOTARIZED:notarized,
+             COLUMN_PATH:item.path,
+             KEY_STATUS:[NSNumber numberWithInteger:signatureStatus]};
+}
+
+//add a result
+// keeps table sorted (per user's choice)
+-(void)addResult:(NSDictionary*)result
+{
+    //add
+    [self.results addObject:result];
+    
+    //sort
+    if(0 != self.tableView.sortDescriptors.count)
+    {
+        [self.results sortUsingDescriptors:self.tableView.sortDescriptors];
+    }
+    
+    //reload
+    [self.tableView reloadData];
+    
+    //update progress
+    self.progressIndicator.doubleValue = self.results.count;
+    
+    //update status
+    [self updateStatus];
+    
+    return;
+}
+
+//update status
+// items completed, throughput, and ETA
+-(void)updateStatus
+{
+    //elapsed time
+    NSTimeInterval elapsed = 0;
+    
+    //throughput
+    double rate = 0;
+    
+    //formatter
+    NSDateComponentsFormatter* formatter = nil;
+    
+    //init elapsed/rate
+    elapsed = MAX(-self.startTime.timeIntervalSinceNow, 0.001);
+    rate = self.results.count / elapsed;
+    
+    //init formatter
+    formatter = [[NSDateComponentsFormatter alloc] init];
+    formatter.unitsStyle = NSDateComponentsFormatterUnitsStyleAbbreviated;
+    formatter.allowedUnits = NSCalendarUnitHour | NSCalendarUnitMinute | NSCalendarUnitSecond;
+    
+    //done?
+    if(self.results.count >= self.total)
+    {
+        //set
+        self.status.stringValue = [NSString stringWithFormat:NSLocalizedString(@"Verified %lu items in %@ (%.1f items/sec)", @"Verified %lu items in %@ (%.1f items/sec)"), (unsigned long)self.results.count, [formatter stringFromTimeInterval:elapsed], rate];
+    }
+    //in progress
+    // show throughput and ETA (once there's a rate)
+    else
+    {
+        //set
+        self.status.stringValue = [NSString stringWithFormat:NSLocalizedString(@"Verified %lu of %lu items (%.1f items/sec, %@ remaining)", @"Verified %lu of %lu items (%.1f items/sec, %@ remaining)"), (unsigned long)self.results.count, (unsigned long)self.total, rate, (0 != self.results.count) ? [formatter stringFromTimeInterval:(self.total - self.results.count) / rate] : @"-"];
+    }
+    
+    return;
+}
+
+#pragma mark - table
+
+//# of rows
+-(NSInteger)numberOfRowsInTableView:(NSTableView*)table
+{
+    return self.results.count;
+}
+
+//view for cell
+-(NSView*)tableView:(NSTableView*)table viewForTableColumn:(NSTableColumn*)tableColumn row:(NSInteger)row
+{
+    //cell
+    NSTextField* cell = nil;
+    
+    //reuse
+    cell = [table makeViewWithIdentifier:tableColumn.identifier owner:self];
+    if(nil == cell)
+    {
+        //init
+        cell = [NSTextField labelWithString:@""];
+        cell.identifier = tableColumn.identifier;
+        cell.lineBreakMode = (YES == [tableColumn.identifier isEqualToString:COLUMN_PATH]) ? NSLineBreakByTruncatingMiddle : NSLineBreakByTruncatingTail;
+    }
+    
+    //set
+    cell.stringValue = self.results[row][tableColumn.identifier] ?: @"";
+    
+    //path as tooltip
+    cell.toolTip = self.results[row][COLUMN_PATH];
+    
+    return cell;
+}
+
+//sort changed
+// (re)sort results
+-(void)tableView:(NSTableView*)table sortDescriptorsDidChange:(NSArray<NSSortDescriptor*>*)oldDescriptors
+{
+    //sort
+    [self.results sortUsingDescriptors:table.sortDescriptors];
+    
+    //reload
+    [table reloadData];
+    
+    return;
+}
+
+#pragma mark - window
+
+//window closing
+// stop verifying (remaining) items
+-(void)windowWillClose:(NSNotification*)notification
+{
+    //cancel
+    self.cancelled = YES;
+    
+    return;
+}
+
+@end
@@ -0,0 +1,44 @@
+//
+//  CodeResources.h
+//  WhatsYourSign
+//
+//  Created by Patrick Wardle on 10/17/26.
+//  Copyright (c) 2026 Objective-See. All rights reserved.
+//
+
+#ifndef CodeResources_h
+#define CodeResources_h
+
+@import Foundation;
+
+//resource manifest
+// relative to bundle's contents
+#define CODE_RESOURCES_PATH @"_CodeSignature/CodeResources"
+
+//max # of resources being hashed at once
+// this is an I/O bound workload, so more than # of cores
+#define CODE_RESOURCES_MAX_IN_FLIGHT 32
+
+//read size, when hashing resources
+#define CODE_RESOURCES_READ_SIZE (128*1024)
+
+//resource status
+typedef NS_ENUM(uint8_t, ResourceStatus)
+{
+    ResourceStatusValid = 0,
+    ResourceStatusModified,
+    ResourceStatusRemoved
+};
+
+/* FUNCTIONS */
+
+//load a bundle's resource manifest
+// parsed (streamed) from its '_CodeSignature/CodeResources', or nil if it has none
+NSDictionary* codeResourcesManifest(NSString* bundlePath);
+
+//verify a bundle's (sealed) resources
+// 'manifest' is the (already authenticated) resource manifest, or nil to load it from the bundle
+// returns added, removed, and modified resources (or nil if bundle has no resource manifest)
+NSDictionary* verifyCodeResources(NSString* bundlePath, NSDictionary* manifest);
+
+#endif /* CodeResources_h */
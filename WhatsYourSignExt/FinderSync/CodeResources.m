@@ -0,0 +1,618 @@
+//
+//  CodeResources.m
+//  FinderSync
+//
+//  Created by Patrick Wardle on 10/17/26.
+//  Copyright (c) 2026 Objective-See. All rights reserved.
+//
+
+#import "consts.h"
+#import "NestedCode.h"
+#import "CodeResources.h"
+
+#import <fcntl.h>
+#import <unistd.h>
+#import <os/log.h>
+#import <sys/stat.h>
+#import <CommonCrypto/CommonDigest.h>
+
+//resource rule
+// from manifest's 'rules2' (or 'rules')
+@interface ResourceRule : NSObject
+
+//pattern
+@property(nonatomic, retain)NSRegularExpression* regex;
+
+//omitted from seal?
+@property BOOL omit;
+
+//optional?
+@property BOOL optional;
+
+//nested code?
+@property BOOL nested;
+
+//weight
+// highest weight match wins
+@property double weight;
+
+@end
+
+@implementation ResourceRule
+
+@synthesize omit;
+@synthesize regex;
+@synthesize nested;
+@synthesize weight;
+@synthesize optional;
+
+@end
+
+//parse resource rules
+// value is either 'true' or a dictionary of (omit, optional, nested, weight)
+static NSArray* parseRules(NSDictionary* rules)
+{
+    //parsed rules
+    NSMutableArray* parsedRules = nil;
+    
+    //init
+    parsedRules = [NSMutableArray array];
+    
+    //parse each
+    for(NSString* pattern in rules)
+    {
+        //value
+        id value = rules[pattern];
+        
+        //rule
+        ResourceRule* rule = nil;
+        
+        //'false'?
+        // rule doesn't apply
+        if( (YES != [value isKindOfClass:[NSDictionary class]]) &&
+            (YES != [value boolValue]) )
+        {
+            //skip
+            continue;
+        }
+        
+        //init
+        rule = [[ResourceRule alloc] init];
+        rule.weight = 1;
+        
+        //compile pattern
+        rule.regex = [NSRegularExpression regularExpressionWithPattern:pattern options:0 error:nil];
+        if(nil == rule.regex)
+        {
+            //skip
+            continue;
+        }
+        
+        //dictionary?
+        // extract options
+        if(YES == [value isKindOfClass:[NSDictionary class]])
+        {
+            //init
+            rule.omit = [value[@"omit"] boolValue];
+            rule.optional = [value[@"optional"] boolValue];
+            rule.nested = [value[@"nested"] boolValue];
+            
+            //weight
+            if(nil != value[@"weight"])
+            {
+                rule.weight = [value[@"weight"] doubleValue];
+            }
+        }
+        
+        //add
+        [parsedRules addObject:rule];
+    }
+    
+    return parsedRules;
+}
+
+//find rule for a (relative) path
+// highest weight wins, nil if no rule matches (i.e. path isn't sealed)
+static ResourceRule* matchRule(NSArray* rules, NSString* path)
+{
+    //match
+    ResourceRule* match = nil;
+    
+    //check each
+    for(ResourceRule* rule in rules)
+    {
+        //can't beat current match?
+        if( (nil != match) &&
+            (rule.weight <= match.weight) )
+        {
+            //skip
+            continue;
+        }
+        
+        //match?
+        if(nil != [rule.regex firstMatchInString:path options:0 range:NSMakeRange(0, path.length)])
+        {
+            //save
+            match = rule;
+        }
+    }
+    
+    return match;
+}
+
+//hash a resource
+// SHA-256 for 'files2', SHA-1 for (legacy) 'files'
+static NSData* hashResource(NSString* path, BOOL sha256)
+{
+    //hash
+    NSMutableData* hash = nil;
+    
+    //file descriptor
+    int fd = -1;
+    
+    //buffer
+    uint8_t* buffer = NULL;
+    
+    //bytes read
+    ssize_t bytesRead = 0;
+    
+    //sha1 context
+    CC_SHA1_CTX sha1Context = {0};
+    
+    //sha256 context
+    CC_SHA256_CTX sha256Context = {0};
+    
+    //open
+    // don't follow links, these are sealed as links
+    fd = open(path.fileSystemRepresentation, O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+    if(-1 == fd)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //alloc
+    buffer = malloc(CODE_RESOURCES_READ_SIZE);
+    if(NULL == buffer)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //init
+    CC_SHA1_Init(&sha1Context);
+    CC_SHA256_Init(&sha256Context);
+    
+    //read/hash
+    while(YES)
+    {
+        //read
+        bytesRead = read(fd, buffer, CODE_RESOURCES_READ_SIZE);
+        if( (-1 == bytesRead) &&
+            (EINTR == errno) )
+        {
+            //retry
+            continue;
+        }
+        
+        //error or EOF?
+        if(bytesRead <= 0)
+        {
+            break;
+        }
+        
+        //update
+        if(YES == sha256)
+        {
+            CC_SHA256_Update(&sha256Context, buffer, (CC_LONG)bytesRead);
+        }
+        else
+        {
+            CC_SHA1_Update(&sha1Context, buffer, (CC_LONG)bytesRead);
+        }
+    }
+    
+    //error?
+    if(bytesRead < 0)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //finalize
+    if(YES == sha256)
+    {
+        hash = [NSMutableData dataWithLength:CC_SHA256_DIGEST_LENGTH];
+        CC_SHA256_Final(hash.mutableBytes, &sha256Context);
+    }
+    else
+    {
+        hash = [NSMutableData dataWithLength:CC_SHA1_DIGEST_LENGTH];
+        CC_SHA1_Final(hash.mutableBytes, &sha1Context);
+    }
+
+bail:
+    
+    //free
+    if(NULL != buffer)
+    {
+        free(buffer);
+        buffer = NULL;
+    }
+    
+    //close
+    if(-1 != fd)
+    {
+        close(fd);
+        fd = -1;
+    }
+    
+    return hash;
+}
+
+//check a (sealed) resource
+// against its hash, or link target
+static ResourceStatus checkResource(NSString* root, NSString* resource, id seal, ResourceRule* rule)
+{
+    //path
+    NSString* path = nil;
+    
+    //file info
+    struct stat info = {0};
+    
+    //expected hash
+    NSData* expected = nil;
+    
+    //SHA-256?
+    BOOL sha256 = NO;
+    
+    //init path
+    path = [root stringByAppendingPathComponent:resource];
+    
+    //missing?
+    if(0 != lstat(path.fileSystemRepresentation, &info))
+    {
+        //ok, if optional
+        return ( (YES == rule.optional) ||
+                 ( (YES == [seal isKindOfClass:[NSDictionary class]]) && (YES == [seal[@"optional"] boolValue]) ) ) ? ResourceStatusValid : ResourceStatusRemoved;
+    }
+    
+    //legacy
+    // just a SHA-1 hash
+    if(YES == [seal isKindOfClass:[NSData class]])
+    {
+        //init
+        expected = seal;
+    }
+    else if(YES == [seal isKindOfClass:[NSDictionary class]])
+    {
+        //symlink?
+        // compare target
+        if(nil != seal[@"symlink"])
+        {
+            //link target
+            NSString* target = [NSFileManager.defaultManager destinationOfSymbolicLinkAtPath:path error:nil];
+            
+            return (YES == [target isEqualToString:seal[@"symlink"]]) ? ResourceStatusValid : ResourceStatusModified;
+        }
+        
+        //nested code?
+        // must (still) be the code that was sealed, i.e. satisfy seal's requirement and match its cdhash
+        // note: only its code directory is validated here, as (all of) it is validated on its own (see 'NestedCode.m')
+        if( (nil != seal[@"cdhash"]) ||
+            (nil != seal[@"requirement"]) )
+        {
+            return (errSecSuccess == checkNestedSeal(path, seal, kSecCSBasicValidateOnly)) ? ResourceStatusValid : ResourceStatusModified;
+        }
+        
+        //prefer SHA-256
+        expected = seal[@"hash2"];
+        sha256 = (nil != expected);
+        if(nil == expected)
+        {
+            expected = seal[@"hash"];
+        }
+    }
+    
+    //nothing to check?
+    if(YES != [expected isKindOfClass:[NSData class]])
+    {
+        return ResourceStatusValid;
+    }
+    
+    //not a file (anymore)?
+    if(YES != S_ISREG(info.st_mode))
+    {
+        return ResourceStatusModified;
+    }
+    
+    return (YES == [hashResource(path, sha256) isEqualToData:expected]) ? ResourceStatusValid : ResourceStatusModified;
+}
+
+//check all (sealed) resources
+// concurrently, but w/ a cap on how many are in flight
+static void checkResources(NSString* root, NSArray* resources, NSDictionary* seals, NSArray* rules, ResourceStatus* statuses)
+{
+    //group
+    dispatch_group_t group = NULL;
+    
+    //semaphore
+    // limits # in flight
+    dispatch_semaphore_t inFlight = NULL;
+    
+    //init group
+    group = dispatch_group_create();
+    
+    //init semaphore
+    inFlight = dispatch_semaphore_create(CODE_RESOURCES_MAX_IN_FLIGHT);
+    
+    //check each
+    for(NSUInteger i = 0; i < resources.count; i++)
+    {
+        //wait for a free spot
+        dispatch_semaphore_wait(inFlight, DISPATCH_TIME_FOREVER);
+        
+        //check
+        dispatch_group_async(group, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+            
+            //check
+            statuses[i] = checkResource(root, resources[i], seals[resources[i]], matchRule(rules, resources[i]));
+            
+            //free spot
+            dispatch_semaphore_signal(inFlight);
+        });
+    }
+    
+    //wait for all
+    dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+    
+    return;
+}
+
+//find resources that were added
+// i.e. would be sealed (per rules), but aren't in the manifest
+static NSArray* findAdded(NSString* root, NSDictionary* seals, NSArray* rules, NSString* executable)
+{
+    //added
+    NSMutableArray* added = nil;
+    
+    //enumerator
+    NSDirectoryEnumerator* enumerator = nil;
+    
+    //init
+    added = [NSMutableArray array];
+    
+    //init enumerator
+    enumerator = [NSFileManager.defaultManager enumeratorAtPath:root];
+    
+    //check each
+    for(NSString* resource in enumerator)
+    {
+        //rule
+        ResourceRule* rule = nil;
+        
+        //skip signature itself
+        if(YES == [resource isEqualToString:@"_CodeSignature"])
+        {
+            //skip
+            [enumerator skipDescendants];
+            continue;
+        }
+        
+        //skip main executable
+        // and (legacy) top-level manifest
+        if( (YES == [resource isEqualToString:executable]) ||
+            (YES == [resource isEqualToString:@"CodeResources"]) )
+        {
+            //skip
+            continue;
+        }
+        
+        //sealed?
+        if(nil != seals[resource])
+        {
+            //sealed directory (e.g. nested bundle)
+            // its contents are covered by its own seal
+            if(YES == [enumerator.fileAttributes.fileType isEqualToString:NSFileTypeDirectory])
+            {
+                [enumerator skipDescendants];
+            }
+            
+            //next
+            continue;
+        }
+        
+        //get rule
+        // no rule, or omitted, means it's not sealed
+        rule = matchRule(rules, resource);
+        if( (nil == rule) ||
+            (YES == rule.omit) )
+        {
+            //skip
+            continue;
+        }
+        
+        //directory?
+        if(YES == [enumerator.fileAttributes.fileType isEqualToString:NSFileTypeDirectory])
+        {
+            //new nested bundle?
+            // report it (not all its contents)
+            if( (YES == rule.nested) &&
+                (0 != resource.pathExtension.length) )
+            {
+                //add
+                [added addObject:resource];
+                
+                //skip
+                [enumerator skipDescendants];
+            }
+            
+            //next
+            continue;
+        }
+        
+        //add
+        [added addObject:resource];
+    }
+    
+    return added;
+}
+
+//load a bundle's resource manifest
+// parsed (streamed) from its '_CodeSignature/CodeResources', or nil if it has none
+NSDictionary* codeResourcesManifest(NSString* bundlePath)
+{
+    //stream
+    NSInputStream* stream = nil;
+    
+    //manifest
+    NSDictionary* manifest = nil;
+    
+    //open manifest
+    stream = [NSInputStream inputStreamWithFileAtPath:[[bundleContents(bundlePath) stringByResolvingSymlinksInPath] stringByAppendingPathComponent:CODE_RESOURCES_PATH]];
+    [stream open];
+    
+    //parse (streamed)
+    manifest = [NSPropertyListSerialization propertyListWithStream:stream options:NSPropertyListImmutable format:NULL error:nil];
+    [stream close];
+    
+    //sanity check
+    if(YES != [manifest isKindOfClass:[NSDictionary class]])
+    {
+        //unset
+        manifest = nil;
+    }
+    
+    return manifest;
+}
+
+//verify a bundle's (sealed) resources
+// 'manifest' is the (already authenticated) resource manifest, or nil to load it from the bundle
+// returns added, removed, and modified resources (or nil if bundle has no resource manifest)
+NSDictionary* verifyCodeResources(NSString* bundlePath, NSDictionary* manifest)
+{
+    //results
+    NSDictionary* results = nil;
+    
+    //root
+    NSString* root = nil;
+    
+    //seals
+    NSDictionary* seals = nil;
+    
+    //rules
+    NSArray* rules = nil;
+    
+    //(sealed) resources
+    NSArray* resources = nil;
+    
+    //statuses
+    ResourceStatus* statuses = NULL;
+    
+    //main executable
+    // relative to root
+    NSString* executable = nil;
+    
+    //removed
+    NSMutableArray* removed = nil;
+    
+    //modified
+    NSMutableArray* modified = nil;
+    
+    //get root
+    root = [bundleContents(bundlePath) stringByResolvingSymlinksInPath];
+    
+    //load manifest
+    // unless caller already has it
+    if(nil == manifest)
+    {
+        //load
+        manifest = codeResourcesManifest(bundlePath);
+    }
+    
+    //sanity check
+    if(YES != [manifest isKindOfClass:[NSDictionary class]])
+    {
+        //bail
+        goto bail;
+    }
+    
+    //v2 seals/rules
+    seals = manifest[@"files2"];
+    rules = parseRules(manifest[@"rules2"]);
+    
+    //fall back to v1
+    if(nil == seals)
+    {
+        //init
+        seals = manifest[@"files"];
+        rules = parseRules(manifest[@"rules"]);
+    }
+    
+    //sanity check
+    if(YES != [seals isKindOfClass:[NSDictionary class]])
+    {
+        //bail
+        goto bail;
+    }
+    
+    //init executable
+    executable = [[NSBundle bundleWithPath:bundlePath].executablePath stringByResolvingSymlinksInPath];
+    if(YES == [executable hasPrefix:[root stringByAppendingString:@"/"]])
+    {
+        //make relative
+        executable = [executable substringFromIndex:root.length + 1];
+    }
+    
+    //init resources
+    // sorted, so results are too
+    resources = [seals.allKeys sortedArrayUsingSelector:@selector(compare:)];
+    
+    //alloc statuses
+    statuses = calloc(resources.count + 1, sizeof(ResourceStatus));
+    if(NULL == statuses)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //check all
+    checkResources(root, resources, seals, rules, statuses);
+    
+    //init
+    removed = [NSMutableArray array];
+    modified = [NSMutableArray array];
+    
+    //process
+    for(NSUInteger i = 0; i < resources.count; i++)
+    {
+        //removed?
+        if(ResourceStatusRemoved == statuses[i])
+        {
+            [removed addObject:resources[i]];
+        }
+        //modified?
+        else if(ResourceStatusModified == statuses[i])
+        {
+            [modified addObject:resources[i]];
+        }
+    }
+    
+    //init results
+    // note: also finds added resources
+    results = @{KEY_RESOURCES_ADDED:findAdded(root, seals, rules, executable), KEY_RESOURCES_REMOVED:removed, KEY_RESOURCES_MODIFIED:modified};
+    
+    //dbg msg
+    os_log_debug(OS_LOG_DEFAULT, "WYS: %{public}@ resources: %{public}@", bundlePath, results);
+
+bail:
+    
+    //free
+    if(NULL != statuses)
+    {
+        free(statuses);
+        statuses = NULL;
+    }
+    
+    return results;
+}
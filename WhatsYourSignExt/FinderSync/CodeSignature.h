@@ -0,0 +1,110 @@
+//
+//  CodeSignature.h
+//  WhatsYourSign
+//
+//  Created by Patrick Wardle on 10/17/26.
+//  Copyright (c) 2026 Objective-See. All rights reserved.
+//
+//  note: (embedded) code signature format, see: xnu's 'osfmk/kern/cs_blobs.h'
+
+#ifndef CodeSignature_h
+#define CodeSignature_h
+
+@import Foundation;
+
+#import "MachO.h"
+
+//max size of a code signature
+#define CODESIGN_MAX_SIZE (256*1024*1024)
+
+//blob magics
+#define CODESIGN_MAGIC_EMBEDDED_SIGNATURE 0xfade0cc0
+#define CODESIGN_MAGIC_CODEDIRECTORY 0xfade0c02
+#define CODESIGN_MAGIC_ENTITLEMENTS 0xfade7171
+#define CODESIGN_MAGIC_DER_ENTITLEMENTS 0xfade7172
+#define CODESIGN_MAGIC_BLOBWRAPPER 0xfade0b01
+
+//slots
+#define CODESIGN_SLOT_CODEDIRECTORY 0
+#define CODESIGN_SLOT_ENTITLEMENTS 5
+#define CODESIGN_SLOT_DER_ENTITLEMENTS 7
+#define CODESIGN_SLOT_ALTERNATE_CODEDIRECTORIES 0x1000
+#define CODESIGN_SLOT_ALTERNATE_CODEDIRECTORY_MAX 5
+#define CODESIGN_SLOT_SIGNATURE 0x10000
+
+//hash types
+#define CODESIGN_HASHTYPE_SHA1 1
+#define CODESIGN_HASHTYPE_SHA256 2
+#define CODESIGN_HASHTYPE_SHA256_TRUNCATED 3
+#define CODESIGN_HASHTYPE_SHA384 4
+
+//code directory version that added team id
+#define CODESIGN_SUPPORTS_TEAMID 0x20200
+
+//code directory version that added 64-bit code limit
+#define CODESIGN_SUPPORTS_CODELIMIT64 0x20300
+
+//# of pages hashed per work item
+#define CODESIGN_PAGES_PER_STRIPE 64
+
+//all pages are valid
+#define CODESIGN_PAGES_VALID -1
+
+//pages couldn't be verified
+// e.g. not a mach-o, unsigned, unsupported hash type
+#define CODESIGN_PAGES_UNVERIFIED -2
+
+//code directory
+// only (leading) fields WYS needs, all big-endian
+typedef struct
+{
+    uint32_t magic;
+    uint32_t length;
+    uint32_t version;
+    uint32_t flags;
+    uint32_t hashOffset;
+    uint32_t identOffset;
+    uint32_t nSpecialSlots;
+    uint32_t nCodeSlots;
+    uint32_t codeLimit;
+    uint8_t hashSize;
+    uint8_t hashType;
+    uint8_t platform;
+    uint8_t pageSize;
+    uint32_t spare2;
+    
+    //version 0x20100+
+    uint32_t scatterOffset;
+    
+    //version 0x20200+
+    uint32_t teamOffset;
+    
+    //version 0x20300+
+    uint32_t spare3;
+    uint64_t codeLimit64;
+
+} __attribute__((packed)) CodeDirectory;
+
+/* FUNCTIONS */
+
+//read (embedded) code signature of a slice
+// this is a SuperBlob, of all the signature's blobs
+NSData* codeSignatureRead(int fd, const MachOSlice* slice);
+
+//find a blob in a code signature
+// returns blob (incl. its header), or nil if there isn't one
+NSData* codeSignatureBlob(NSData* signature, uint32_t slot);
+
+//find a blob in a code signature
+// returns (borrowed) pointer to blob (incl. its header), and its length
+BOOL codeSignatureBlobBytes(NSData* signature, uint32_t slot, const uint8_t** blob, size_t* blobLength);
+
+//find code directory w/ strongest hash type
+// checks primary and alternate code directories
+NSData* codeSignatureBestCodeDirectory(NSData* signature);
+
+//verify (code) page hashes of a binary's best slice
+// returns index of first bad page, or CODESIGN_PAGES_VALID/CODESIGN_PAGES_UNVERIFIED
+int64_t codeSignatureFirstBadPage(NSString* path, uint64_t* badOffset);
+
+#endif /* CodeSignature_h */
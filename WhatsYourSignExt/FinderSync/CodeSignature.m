@@ -0,0 +1,522 @@
+//
+//  CodeSignature.m
+//  FinderSync
+//
+//  Created by Patrick Wardle on 10/17/26.
+//  Copyright (c) 2026 Objective-See. All rights reserved.
+//
+
+#import "utilities.h"
+#import "CodeSignature.h"
+
+#import <fcntl.h>
+#import <unistd.h>
+#import <stdatomic.h>
+#import <CommonCrypto/CommonDigest.h>
+
+//strength of a hash type
+// higher is stronger, 0 means unsupported
+static int hashStrength(uint8_t hashType)
+{
+    switch(hashType)
+    {
+        case CODESIGN_HASHTYPE_SHA1:
+            return 1;
+        
+        case CODESIGN_HASHTYPE_SHA256_TRUNCATED:
+            return 2;
+        
+        case CODESIGN_HASHTYPE_SHA256:
+            return 3;
+        
+        case CODESIGN_HASHTYPE_SHA384:
+            return 4;
+        
+        default:
+            return 0;
+    }
+}
+
+//hash a page
+// note: CommonCrypto uses the CPU's SHA extensions, when present
+static void hashPage(uint8_t hashType, const void* bytes, size_t length, uint8_t* digest)
+{
+    switch(hashType)
+    {
+        case CODESIGN_HASHTYPE_SHA1:
+            CC_SHA1(bytes, (CC_LONG)length, digest);
+            break;
+        
+        //truncated is compared on (just) its first bytes
+        case CODESIGN_HASHTYPE_SHA256:
+        case CODESIGN_HASHTYPE_SHA256_TRUNCATED:
+            CC_SHA256(bytes, (CC_LONG)length, digest);
+            break;
+        
+        case CODESIGN_HASHTYPE_SHA384:
+            CC_SHA384(bytes, (CC_LONG)length, digest);
+            break;
+        
+        default:
+            break;
+    }
+    
+    return;
+}
+
+//read (embedded) code signature of a slice
+// this is a SuperBlob, of all the signature's blobs
+NSData* codeSignatureRead(int fd, const MachOSlice* slice)
+{
+    //signature
+    NSMutableData* signature = nil;
+    
+    //unsigned?
+    if( (0 == slice->signatureSize) ||
+        (slice->signatureSize > CODESIGN_MAX_SIZE) )
+    {
+        //bail
+        goto bail;
+    }
+    
+    //alloc
+    signature = [NSMutableData dataWithLength:slice->signatureSize];
+    
+    //read
+    if(YES != readAt(fd, signature.mutableBytes, signature.length, slice->signatureOffset))
+    {
+        //unset
+        signature = nil;
+        
+        //bail
+        goto bail;
+    }
+    
+    //check magic
+    // all fields are big-endian
+    if( (signature.length < 12) ||
+        (CODESIGN_MAGIC_EMBEDDED_SIGNATURE != OSReadBigInt32(signature.bytes, 0)) )
+    {
+        //unset
+        signature = nil;
+    }
+
+bail:
+    
+    return signature;
+}
+
+//find a blob in a code signature
+// returns (borrowed) pointer to blob (incl. its header), and its length
+BOOL codeSignatureBlobBytes(NSData* signature, uint32_t slot, const uint8_t** blob, size_t* blobLength)
+{
+    //flag
+    BOOL found = NO;
+    
+    //bytes
+    const uint8_t* bytes = NULL;
+    
+    //# of blobs
+    uint32_t count = 0;
+    
+    //sanity check
+    // magic, length, count
+    if(signature.length < 12)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //init
+    bytes = signature.bytes;
+    count = OSReadBigInt32(bytes, 8);
+    
+    //sanity check
+    // each index entry is type and offset
+    if(count > (signature.length - 12) / 8)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //find slot
+    for(uint32_t i = 0; i < count; i++)
+    {
+        //offset of blob
+        uint32_t offset = 0;
+        
+        //length of blob
+        uint32_t length = 0;
+        
+        //not slot?
+        if(slot != OSReadBigInt32(bytes, 12 + i * 8))
+        {
+            //next
+            continue;
+        }
+        
+        //get offset
+        offset = OSReadBigInt32(bytes, 12 + i * 8 + 4);
+        
+        //sanity check
+        if((uint64_t)offset + 8 > signature.length)
+        {
+            break;
+        }
+        
+        //get length
+        // follows blob's magic
+        length = OSReadBigInt32(bytes, offset + 4);
+        
+        //sanity check
+        if( (length < 8) ||
+            ((uint64_t)offset + length > signature.length) )
+        {
+            break;
+        }
+        
+        //save
+        *blob = bytes + offset;
+        *blobLength = length;
+        
+        //happy
+        found = YES;
+        
+        break;
+    }
+
+bail:
+    
+    return found;
+}
+
+//find a blob in a code signature
+// returns blob (incl. its header), or nil if there isn't one
+NSData* codeSignatureBlob(NSData* signature, uint32_t slot)
+{
+    //blob
+    NSData* blob = nil;
+    
+    //bytes of blob
+    const uint8_t* bytes = NULL;
+    
+    //length of blob
+    size_t length = 0;
+    
+    //find
+    // and copy out
+    if(YES == codeSignatureBlobBytes(signature, slot, &bytes, &length))
+    {
+        blob = [NSData dataWithBytes:bytes length:length];
+    }
+    
+    return blob;
+}
+
+//find code directory w/ strongest hash type
+// checks primary and alternate code directories
+NSData* codeSignatureBestCodeDirectory(NSData* signature)
+{
+    //best code directory
+    NSData* bestCodeDirectory = nil;
+    
+    //its strength
+    int bestStrength = 0;
+    
+    //check primary, then alternates
+    for(uint32_t i = 0; i <= CODESIGN_SLOT_ALTERNATE_CODEDIRECTORY_MAX; i++)
+    {
+        //code directory
+        NSData* codeDirectory = nil;
+        
+        //header
+        const CodeDirectory* header = NULL;
+        
+        //strength
+        int strength = 0;
+        
+        //get code directory
+        codeDirectory = codeSignatureBlob(signature, (0 == i) ? CODESIGN_SLOT_CODEDIRECTORY : CODESIGN_SLOT_ALTERNATE_CODEDIRECTORIES + i - 1);
+        if(codeDirectory.length < offsetof(CodeDirectory, scatterOffset))
+        {
+            //next
+            continue;
+        }
+        
+        //init header
+        header = codeDirectory.bytes;
+        
+        //sanity check
+        if(CODESIGN_MAGIC_CODEDIRECTORY != OSSwapBigToHostInt32(header->magic))
+        {
+            //next
+            continue;
+        }
+        
+        //stronger?
+        strength = hashStrength(header->hashType);
+        if(strength > bestStrength)
+        {
+            //save
+            bestCodeDirectory = codeDirectory;
+            bestStrength = strength;
+        }
+    }
+    
+    return bestCodeDirectory;
+}
+
+//verify (code) page hashes of a binary's best slice
+// pages are hashed concurrently (in stripes), stopping early once a bad page is found
+int64_t codeSignatureFirstBadPage(NSString* path, uint64_t* badOffset)
+{
+    //result
+    int64_t result = CODESIGN_PAGES_UNVERIFIED;
+    
+    //file descriptor
+    int fd = -1;
+    
+    //index
+    MachOIndex index = {0};
+    
+    //best slice
+    const MachOSlice* slice = NULL;
+    
+    //signature
+    NSData* signature = nil;
+    
+    //code directory
+    NSData* codeDirectory = nil;
+    
+    //its header
+    const CodeDirectory* header = NULL;
+    
+    //code limit
+    uint64_t codeLimit = 0;
+    
+    //page size
+    uint64_t pageSize = 0;
+    
+    //# of pages
+    uint64_t pageCount = 0;
+    
+    //hash offset
+    uint64_t hashOffset = 0;
+    
+    //hash type
+    uint8_t hashType = 0;
+    
+    //hash size
+    uint8_t hashSize = 0;
+    
+    //(code) page hashes
+    const uint8_t* hashes = NULL;
+    
+    //first bad page
+    _Atomic int64_t firstBad = INT64_MAX;
+    
+    //pointer to first bad page
+    // as blocks can't capture atomics by reference
+    _Atomic int64_t* firstBadPtr = &firstBad;
+    
+    //read error?
+    _Atomic bool readError = false;
+    
+    //pointer to read error
+    _Atomic bool* readErrorPtr = &readError;
+    
+    //open
+    fd = open(path.fileSystemRepresentation, O_RDONLY | O_CLOEXEC);
+    if(-1 == fd)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //index
+    // and find slice loader would run
+    if( (YES != machoIndexFile(fd, &index)) ||
+        (NULL == (slice = machoBestSlice(&index))) )
+    {
+        //bail
+        goto bail;
+    }
+    
+    //read signature
+    signature = codeSignatureRead(fd, slice);
+    if(nil == signature)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //get code directory
+    codeDirectory = codeSignatureBestCodeDirectory(signature);
+    if(nil == codeDirectory)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //init
+    header = codeDirectory.bytes;
+    hashType = header->hashType;
+    hashSize = header->hashSize;
+    hashOffset = OSSwapBigToHostInt32(header->hashOffset);
+    pageCount = OSSwapBigToHostInt32(header->nCodeSlots);
+    codeLimit = OSSwapBigToHostInt32(header->codeLimit);
+    
+    //64-bit code limit?
+    if( (OSSwapBigToHostInt32(header->version) >= CODESIGN_SUPPORTS_CODELIMIT64) &&
+        (codeDirectory.length >= sizeof(CodeDirectory)) &&
+        (0 != header->codeLimit64) )
+    {
+        //use
+        codeLimit = OSSwapBigToHostInt64(header->codeLimit64);
+    }
+    
+    //init page size
+    // 0 means 'infinite' (i.e. single page)
+    pageSize = (0 != header->pageSize) ? (1ULL << MIN(header->pageSize, 63)) : codeLimit;
+    
+    //sanity checks
+    // hashes must be within code directory, pages within slice
+    if( (0 == hashSize) ||
+        (hashSize > CC_SHA384_DIGEST_LENGTH) ||
+        (header->pageSize > 24) ||
+        (codeLimit > slice->size) ||
+        (hashOffset + pageCount * hashSize > codeDirectory.length) ||
+        ( (0 != pageSize) && (pageCount != (codeLimit + pageSize - 1) / pageSize) ) )
+    {
+        //bail
+        goto bail;
+    }
+    
+    //no code?
+    if(0 == pageCount)
+    {
+        //valid
+        result = CODESIGN_PAGES_VALID;
+        
+        //done
+        goto bail;
+    }
+    
+    //init hashes
+    hashes = (const uint8_t*)codeDirectory.bytes + hashOffset;
+    
+    //hash stripes of pages, concurrently
+    dispatch_apply((size_t)((pageCount + CODESIGN_PAGES_PER_STRIPE - 1) / CODESIGN_PAGES_PER_STRIPE), DISPATCH_APPLY_AUTO, ^(size_t stripe)
+    {
+        //first page
+        uint64_t first = stripe * CODESIGN_PAGES_PER_STRIPE;
+        
+        //last page
+        uint64_t last = MIN(first + CODESIGN_PAGES_PER_STRIPE, pageCount);
+        
+        //offset of stripe
+        uint64_t start = first * pageSize;
+        
+        //length of stripe
+        // last page may be partial
+        uint64_t length = MIN(last * pageSize, codeLimit) - start;
+        
+        //buffer
+        uint8_t* buffer = NULL;
+        
+        //digest
+        uint8_t digest[CC_SHA384_DIGEST_LENGTH] = {0};
+        
+        //already found an earlier bad page (or error)?
+        if( ((int64_t)first > atomic_load(firstBadPtr)) ||
+            (true == atomic_load(readErrorPtr)) )
+        {
+            //skip
+            return;
+        }
+        
+        //alloc
+        buffer = malloc((size_t)length);
+        
+        //read stripe
+        // single read, as pages are contiguous
+        if( (NULL == buffer) ||
+            (YES != readAt(fd, buffer, (size_t)length, slice->offset + start)) )
+        {
+            //error
+            atomic_store(readErrorPtr, true);
+            
+            //free
+            free(buffer);
+            
+            return;
+        }
+        
+        //check each page
+        for(uint64_t page = first; page < last; page++)
+        {
+            //current (first) bad page
+            int64_t current = 0;
+            
+            //hash
+            hashPage(hashType, buffer + (page - first) * pageSize, (size_t)MIN(pageSize, codeLimit - page * pageSize), digest);
+            
+            //match?
+            if(0 == memcmp(digest, hashes + page * hashSize, hashSize))
+            {
+                //next
+                continue;
+            }
+            
+            //save, if earliest
+            current = atomic_load(firstBadPtr);
+            while( ((int64_t)page < current) &&
+                   (true != atomic_compare_exchange_weak(firstBadPtr, &current, (int64_t)page)) ) {}
+            
+            //done
+            // rest of stripe comes after this page
+            break;
+        }
+        
+        //free
+        free(buffer);
+    });
+    
+    //read error?
+    if(true == readError)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //all good?
+    if(INT64_MAX == firstBad)
+    {
+        //valid
+        result = CODESIGN_PAGES_VALID;
+        
+        //done
+        goto bail;
+    }
+    
+    //save bad page
+    result = firstBad;
+    
+    //and its offset (in file)
+    if(NULL != badOffset)
+    {
+        //set
+        *badOffset = slice->offset + (uint64_t)firstBad * pageSize;
+    }
+
+bail:
+    
+    //close
+    if(-1 != fd)
+    {
+        close(fd);
+        fd = -1;
+    }
+    
+    return result;
+}
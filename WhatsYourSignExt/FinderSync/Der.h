@@ -0,0 +1,102 @@
+//
+//  Der.h
+//  WhatsYourSign
+//
+//  Created by Patrick Wardle on 10/17/26.
+//  Copyright (c) 2026 Objective-See. All rights reserved.
+//
+//  note: minimal DER reader
+//        items point into the caller's buffer, so nothing is copied (or allocated)
+//        only single-byte tags and definite lengths are supported
+
+#ifndef Der_h
+#define Der_h
+
+@import Foundation;
+
+//tags
+#define DER_TAG_BOOLEAN 0x01
+#define DER_TAG_INTEGER 0x02
+#define DER_TAG_BIT_STRING 0x03
+#define DER_TAG_OCTET_STRING 0x04
+#define DER_TAG_NULL 0x05
+#define DER_TAG_OID 0x06
+#define DER_TAG_UTF8_STRING 0x0C
+#define DER_TAG_PRINTABLE_STRING 0x13
+#define DER_TAG_T61_STRING 0x14
+#define DER_TAG_IA5_STRING 0x16
+#define DER_TAG_UTC_TIME 0x17
+#define DER_TAG_GENERALIZED_TIME 0x18
+#define DER_TAG_UNIVERSAL_STRING 0x1C
+#define DER_TAG_BMP_STRING 0x1E
+#define DER_TAG_SEQUENCE 0x30
+#define DER_TAG_SET 0x31
+
+//context-specific (constructed) tag
+// e.g. '[0]' in CMS, X.509
+#define DER_TAG_CONTEXT(n) (0xA0 | (n))
+
+//application (constructed) tag
+// e.g. '[APPLICATION 16]' in (DER) entitlements
+#define DER_TAG_APPLICATION(n) (0x60 | (n))
+
+//item
+// tag, and its contents (in caller's buffer)
+typedef struct
+{
+    //tag
+    uint8_t tag;
+    
+    //contents
+    const uint8_t* data;
+    
+    //length of contents
+    size_t length;
+
+} DERItem;
+
+//cursor
+// walks a buffer (or contents of a constructed item), item by item
+typedef struct
+{
+    //next item
+    const uint8_t* next;
+    
+    //end of buffer
+    const uint8_t* end;
+
+} DERCursor;
+
+/* FUNCTIONS */
+
+//init cursor over a buffer
+void derInit(DERCursor* cursor, const uint8_t* bytes, size_t length);
+
+//init cursor over contents of an item
+// e.g. to walk the items of a sequence or set
+void derEnter(DERCursor* cursor, const DERItem* item);
+
+//read next item
+// returns NO at end, or if item is malformed (e.g. its length runs past end)
+BOOL derNext(DERCursor* cursor, DERItem* item);
+
+//read next item
+// but only if it has the expected tag
+BOOL derNextExpect(DERCursor* cursor, uint8_t tag, DERItem* item);
+
+//check if cursor is done
+// i.e. all items were read, and none were malformed
+BOOL derDone(const DERCursor* cursor);
+
+//decode (single) item that must span an entire buffer
+BOOL derDecode(const uint8_t* bytes, size_t length, uint8_t tag, DERItem* item);
+
+//decode an integer
+// fails if it doesn't fit in 64 bits
+BOOL derInteger(const DERItem* item, int64_t* value);
+
+//check if an item (OID) matches
+// 'oid' is the encoded contents, without tag/length
+BOOL derOIDEqual(const DERItem* item, const uint8_t* oid, size_t length);
+
+#endif /* Der_h */
@@ -0,0 +1,198 @@
+//
+//  Der.m
+//  FinderSync
+//
+//  Created by Patrick Wardle on 10/17/26.
+//  Copyright (c) 2026 Objective-See. All rights reserved.
+//
+
+#import "Der.h"
+
+//init cursor over a buffer
+void derInit(DERCursor* cursor, const uint8_t* bytes, size_t length)
+{
+    //init
+    cursor->next = bytes;
+    cursor->end = bytes + length;
+    
+    return;
+}
+
+//init cursor over contents of an item
+// e.g. to walk the items of a sequence or set
+void derEnter(DERCursor* cursor, const DERItem* item)
+{
+    //init
+    derInit(cursor, item->data, item->length);
+    
+    return;
+}
+
+//read next item
+// returns NO at end, or if item is malformed (e.g. its length runs past end)
+BOOL derNext(DERCursor* cursor, DERItem* item)
+{
+    //flag
+    BOOL decoded = NO;
+    
+    //current
+    const uint8_t* current = cursor->next;
+    
+    //length byte
+    uint8_t first = 0;
+    
+    //# of length bytes
+    size_t count = 0;
+    
+    //length
+    size_t length = 0;
+    
+    //need at least tag and length
+    // note: all comparisons are on remaining bytes, so can't overflow
+    if( (NULL == current) ||
+        (cursor->end - current < 2) )
+    {
+        //bail
+        goto bail;
+    }
+    
+    //tag
+    // high tag numbers (multi-byte) aren't supported
+    item->tag = *current++;
+    if(0x1F == (item->tag & 0x1F))
+    {
+        //bail
+        goto bail;
+    }
+    
+    //length
+    first = *current++;
+    
+    //short form
+    if(0 == (first & 0x80))
+    {
+        //init
+        length = first;
+    }
+    //long form
+    // note: indefinite form (0x80) isn't valid DER
+    else
+    {
+        //# of length bytes
+        count = first & 0x7F;
+        if( (0 == count) ||
+            (count > sizeof(size_t)) ||
+            (count > (size_t)(cursor->end - current)) )
+        {
+            //bail
+            goto bail;
+        }
+        
+        //init
+        for(size_t i = 0; i < count; i++)
+        {
+            length = (length << 8) | *current++;
+        }
+    }
+    
+    //check length
+    if(length > (size_t)(cursor->end - current))
+    {
+        //bail
+        goto bail;
+    }
+    
+    //init item
+    item->data = current;
+    item->length = length;
+    
+    //advance
+    cursor->next = current + length;
+    
+    //happy
+    decoded = YES;
+
+bail:
+    
+    //malformed?
+    // poison cursor, so any further reads also fail (and caller can tell)
+    if( (YES != decoded) &&
+        (cursor->next != cursor->end) )
+    {
+        cursor->next = NULL;
+    }
+    
+    return decoded;
+}
+
+//read next item
+// but only if it has the expected tag
+BOOL derNextExpect(DERCursor* cursor, uint8_t tag, DERItem* item)
+{
+    return (YES == derNext(cursor, item)) && (tag == item->tag);
+}
+
+//check if cursor is done
+// i.e. all items were read, and none were malformed
+BOOL derDone(const DERCursor* cursor)
+{
+    return (cursor->next == cursor->end);
+}
+
+//decode (single) item that must span an entire buffer
+BOOL derDecode(const uint8_t* bytes, size_t length, uint8_t tag, DERItem* item)
+{
+    //cursor
+    DERCursor cursor = {0};
+    
+    //init
+    derInit(&cursor, bytes, length);
+    
+    //decode
+    // and make sure nothing's left over
+    return (YES == derNextExpect(&cursor, tag, item)) && (YES == derDone(&cursor));
+}
+
+//decode an integer
+// fails if it doesn't fit in 64 bits
+BOOL derInteger(const DERItem* item, int64_t* value)
+{
+    //value
+    uint64_t decoded = 0;
+    
+    //sanity check
+    if( (DER_TAG_INTEGER != item->tag) ||
+        (0 == item->length) ||
+        (item->length > sizeof(int64_t)) )
+    {
+        //bail
+        return NO;
+    }
+    
+    //sign extend
+    // as integers are two's complement
+    if(0 != (item->data[0] & 0x80))
+    {
+        decoded = UINT64_MAX;
+    }
+    
+    //decode
+    for(size_t i = 0; i < item->length; i++)
+    {
+        decoded = (decoded << 8) | item->data[i];
+    }
+    
+    //save
+    *value = (int64_t)decoded;
+    
+    return YES;
+}
+
+//check if an item (OID) matches
+// 'oid' is the encoded contents, without tag/length
+BOOL derOIDEqual(const DERItem* item, const uint8_t* oid, size_t length)
+{
+    return (DER_TAG_OID == item->tag) &&
+           (length == item->length) &&
+           (0 == memcmp(item->data, oid, length));
+}
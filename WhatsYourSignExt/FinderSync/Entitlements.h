@@ -0,0 +1,59 @@
+//
+//  Entitlements.h
+//  WhatsYourSign
+//
+//  Created by Patrick Wardle on 10/17/26.
+//  Copyright (c) 2026 Objective-See. All rights reserved.
+//
+//  note: entitlements are read straight from (best slice of) a binary's code signature
+//        DER blob is preferred, falling back to XML (plist) blob for older signatures
+//        both are decoded in place, over the (borrowed) bytes of the signature
+
+#ifndef Entitlements_h
+#define Entitlements_h
+
+@import Foundation;
+
+#import "Der.h"
+
+//size of (XML/DER) entitlements blob header
+// magic, then length
+#define ENTITLEMENTS_HEADER_SIZE 8
+
+//(DER) entitlements version
+#define ENTITLEMENTS_DER_VERSION 1
+
+//(DER) entitlements: tag of wrapper
+// '[APPLICATION 16]', holding version and dictionary
+#define ENTITLEMENTS_DER_TAG_WRAPPER DER_TAG_APPLICATION(16)
+
+//(DER) entitlements: tag of a dictionary
+// '[CONTEXT 16]', holding (sequence) key/value pairs
+#define ENTITLEMENTS_DER_TAG_DICTIONARY DER_TAG_CONTEXT(16)
+
+//max nesting of (DER) entitlements
+#define ENTITLEMENTS_MAX_DEPTH 32
+
+//# of entitlements rendered per batch
+// first batch is shown as soon as its ready, rest are appended
+#define ENTITLEMENTS_RENDER_BATCH 32
+
+/* FUNCTIONS */
+
+//check if an item has entitlements
+// only reads its signature's index, nothing is decoded
+BOOL entitlementsExist(NSString* path);
+
+//get entitlements of an item
+// for bundles, this is its executable's
+NSDictionary* entitlementsForPath(NSString* path);
+
+//decode (XML or DER) entitlements blob
+// 'blob' includes its header, and is only borrowed
+NSDictionary* entitlementsDecode(const uint8_t* blob, size_t length);
+
+//render (some) entitlements
+// each is a 'key = value;' line, in the style of a dictionary's description
+NSString* entitlementsRender(NSDictionary* entitlements, NSArray* keys, NSRange range);
+
+#endif /* Entitlements_h */
@@ -0,0 +1,497 @@
+//
+//  Entitlements.m
+//  FinderSync
+//
+//  Created by Patrick Wardle on 10/17/26.
+//  Copyright (c) 2026 Objective-See. All rights reserved.
+//
+
+#import "MachO.h"
+#import "CodeSignature.h"
+#import "Entitlements.h"
+
+#import <fcntl.h>
+#import <unistd.h>
+
+//fwd decl
+static NSDictionary* derDictionary(const DERItem* item, NSUInteger depth);
+
+//read signature of an item
+// for bundles, this is its executable's (best slice)
+static NSData* readSignature(NSString* path)
+{
+    //signature
+    NSData* signature = nil;
+    
+    //file descriptor
+    int fd = -1;
+    
+    //index
+    MachOIndex index = {0};
+    
+    //best slice
+    const MachOSlice* slice = NULL;
+    
+    //flag
+    BOOL isDirectory = NO;
+    
+    //bundle?
+    // use its executable
+    if( (YES == [NSFileManager.defaultManager fileExistsAtPath:path isDirectory:&isDirectory]) &&
+        (YES == isDirectory) )
+    {
+        //init
+        path = [NSBundle bundleWithPath:path].executablePath;
+    }
+    
+    //sanity check
+    if(nil == path)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //open
+    fd = open(path.fileSystemRepresentation, O_RDONLY | O_CLOEXEC);
+    if(-1 == fd)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //index
+    // and find slice loader would run
+    if( (YES != machoIndexFile(fd, &index)) ||
+        (NULL == (slice = machoBestSlice(&index))) )
+    {
+        //bail
+        goto bail;
+    }
+    
+    //read signature
+    signature = codeSignatureRead(fd, slice);
+
+bail:
+    
+    //close
+    if(-1 != fd)
+    {
+        close(fd);
+        fd = -1;
+    }
+    
+    return signature;
+}
+
+//decode a (DER) entitlement's value
+// boolean, integer, string, array (sequence), or dictionary
+static id derValue(const DERItem* item, NSUInteger depth)
+{
+    //value
+    id value = nil;
+    
+    //integer
+    int64_t integer = 0;
+    
+    //cursor
+    // for arrays
+    DERCursor cursor = {0};
+    
+    //element
+    DERItem element = {0};
+    
+    //too deep?
+    if(depth > ENTITLEMENTS_MAX_DEPTH)
+    {
+        //bail
+        goto bail;
+    }
+    
+    switch(item->tag)
+    {
+        //boolean
+        case DER_TAG_BOOLEAN:
+            
+            //sanity check
+            if(1 != item->length)
+            {
+                break;
+            }
+            
+            //init
+            value = [NSNumber numberWithBool:(0 != item->data[0])];
+            
+            break;
+        
+        //integer
+        case DER_TAG_INTEGER:
+            
+            //decode
+            if(YES == derInteger(item, &integer))
+            {
+                //init
+                value = [NSNumber numberWithLongLong:integer];
+            }
+            
+            break;
+        
+        //string
+        case DER_TAG_UTF8_STRING:
+            
+            //init
+            value = [[NSString alloc] initWithBytes:item->data length:item->length encoding:NSUTF8StringEncoding];
+            
+            break;
+        
+        //array
+        case DER_TAG_SEQUENCE:
+            
+            //init
+            value = [NSMutableArray array];
+            
+            //decode each element
+            derEnter(&cursor, item);
+            while(YES == derNext(&cursor, &element))
+            {
+                //element's value
+                id elementValue = derValue(&element, depth + 1);
+                if(nil == elementValue)
+                {
+                    break;
+                }
+                
+                //add
+                [value addObject:elementValue];
+            }
+            
+            //malformed?
+            if(YES != derDone(&cursor))
+            {
+                //unset
+                value = nil;
+            }
+            
+            break;
+        
+        //dictionary
+        case ENTITLEMENTS_DER_TAG_DICTIONARY:
+            
+            //decode
+            value = derDictionary(item, depth + 1);
+            
+            break;
+        
+        //unknown
+        default:
+            break;
+    }
+
+bail:
+    
+    return value;
+}
+
+//decode a (DER) entitlements dictionary
+// each entry is a sequence of (string) key, and value
+static NSDictionary* derDictionary(const DERItem* item, NSUInteger depth)
+{
+    //dictionary
+    NSMutableDictionary* dictionary = nil;
+    
+    //cursor
+    DERCursor cursor = {0};
+    
+    //entry
+    DERItem entry = {0};
+    
+    //init
+    dictionary = [NSMutableDictionary dictionary];
+    
+    //decode each entry
+    derEnter(&cursor, item);
+    while(YES == derNextExpect(&cursor, DER_TAG_SEQUENCE, &entry))
+    {
+        //cursor for entry
+        DERCursor entryCursor = {0};
+        
+        //key
+        DERItem keyItem = {0};
+        
+        //value
+        DERItem valueItem = {0};
+        
+        //key
+        NSString* key = nil;
+        
+        //value
+        id value = nil;
+        
+        //get key and value
+        derEnter(&entryCursor, &entry);
+        if( (YES != derNextExpect(&entryCursor, DER_TAG_UTF8_STRING, &keyItem)) ||
+            (YES != derNext(&entryCursor, &valueItem)) ||
+            (YES != derDone(&entryCursor)) )
+        {
+            //unset
+            dictionary = nil;
+            
+            //bail
+            goto bail;
+        }
+        
+        //decode key
+        key = [[NSString alloc] initWithBytes:keyItem.data length:keyItem.length encoding:NSUTF8StringEncoding];
+        
+        //decode value
+        value = derValue(&valueItem, depth);
+        
+        //sanity check
+        if( (nil == key) ||
+            (nil == value) )
+        {
+            //unset
+            dictionary = nil;
+            
+            //bail
+            goto bail;
+        }
+        
+        //add
+        dictionary[key] = value;
+    }
+    
+    //malformed?
+    if(YES != derDone(&cursor))
+    {
+        //unset
+        dictionary = nil;
+    }
+
+bail:
+    
+    return dictionary;
+}
+
+//decode (DER) entitlements
+// '[APPLICATION 16]' wrapper, holding version and dictionary
+static NSDictionary* decodeDER(const uint8_t* bytes, size_t length)
+{
+    //entitlements
+    NSDictionary* entitlements = nil;
+    
+    //wrapper
+    DERItem wrapper = {0};
+    
+    //cursor
+    DERCursor cursor = {0};
+    
+    //version
+    DERItem versionItem = {0};
+    
+    //version
+    int64_t version = 0;
+    
+    //dictionary
+    DERItem dictionary = {0};
+    
+    //decode wrapper
+    if(YES != derDecode(bytes, length, ENTITLEMENTS_DER_TAG_WRAPPER, &wrapper))
+    {
+        //bail
+        goto bail;
+    }
+    
+    //get version and dictionary
+    derEnter(&cursor, &wrapper);
+    if( (YES != derNextExpect(&cursor, DER_TAG_INTEGER, &versionItem)) ||
+        (YES != derInteger(&versionItem, &version)) ||
+        (ENTITLEMENTS_DER_VERSION != version) ||
+        (YES != derNextExpect(&cursor, ENTITLEMENTS_DER_TAG_DICTIONARY, &dictionary)) ||
+        (YES != derDone(&cursor)) )
+    {
+        //bail
+        goto bail;
+    }
+    
+    //decode
+    entitlements = derDictionary(&dictionary, 0);
+
+bail:
+    
+    return entitlements;
+}
+
+//decode (XML) entitlements
+// a plist, parsed w/o copying its bytes
+static NSDictionary* decodeXML(const uint8_t* bytes, size_t length)
+{
+    //entitlements
+    NSDictionary* entitlements = nil;
+    
+    //(borrowed) data
+    NSData* data = nil;
+    
+    //init
+    // note: buffer isn't owned (or freed)
+    data = [NSData dataWithBytesNoCopy:(void*)bytes length:length freeWhenDone:NO];
+    
+    //parse
+    entitlements = [NSPropertyListSerialization propertyListWithData:data options:NSPropertyListImmutable format:NULL error:NULL];
+    if(YES != [entitlements isKindOfClass:[NSDictionary class]])
+    {
+        //unset
+        entitlements = nil;
+    }
+    
+    return entitlements;
+}
+
+//check if an item has entitlements
+// only reads its signature's index, nothing is decoded
+BOOL entitlementsExist(NSString* path)
+{
+    //signature
+    NSData* signature = nil;
+    
+    //blob
+    const uint8_t* blob = NULL;
+    
+    //length of blob
+    size_t length = 0;
+    
+    //read signature
+    signature = readSignature(path);
+    if(nil == signature)
+    {
+        //none
+        return NO;
+    }
+    
+    //DER or XML blob w/ contents?
+    return ( (YES == codeSignatureBlobBytes(signature, CODESIGN_SLOT_DER_ENTITLEMENTS, &blob, &length)) ||
+             (YES == codeSignatureBlobBytes(signature, CODESIGN_SLOT_ENTITLEMENTS, &blob, &length)) ) &&
+           (length > ENTITLEMENTS_HEADER_SIZE);
+}
+
+//get entitlements of an item
+// for bundles, this is its executable's
+NSDictionary* entitlementsForPath(NSString* path)
+{
+    //entitlements
+    NSDictionary* entitlements = nil;
+    
+    //signature
+    NSData* signature = nil;
+    
+    //blob
+    const uint8_t* blob = NULL;
+    
+    //length of blob
+    size_t length = 0;
+    
+    //read signature
+    signature = readSignature(path);
+    if(nil == signature)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //DER blob?
+    // preferred, as its cheaper to decode
+    if(YES == codeSignatureBlobBytes(signature, CODESIGN_SLOT_DER_ENTITLEMENTS, &blob, &length))
+    {
+        //decode
+        entitlements = entitlementsDecode(blob, length);
+    }
+    
+    //no (valid) DER blob?
+    // fall back to XML blob
+    if( (nil == entitlements) &&
+        (YES == codeSignatureBlobBytes(signature, CODESIGN_SLOT_ENTITLEMENTS, &blob, &length)) )
+    {
+        //decode
+        entitlements = entitlementsDecode(blob, length);
+    }
+
+bail:
+    
+    return entitlements;
+}
+
+//decode (XML or DER) entitlements blob
+// 'blob' includes its header, and is only borrowed
+NSDictionary* entitlementsDecode(const uint8_t* blob, size_t length)
+{
+    //entitlements
+    NSDictionary* entitlements = nil;
+    
+    //sanity check
+    if(length <= ENTITLEMENTS_HEADER_SIZE)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //decode
+    // based on magic, all fields are big-endian
+    switch(OSReadBigInt32(blob, 0))
+    {
+        //DER
+        case CODESIGN_MAGIC_DER_ENTITLEMENTS:
+            entitlements = decodeDER(blob + ENTITLEMENTS_HEADER_SIZE, length - ENTITLEMENTS_HEADER_SIZE);
+            break;
+        
+        //XML
+        case CODESIGN_MAGIC_ENTITLEMENTS:
+            entitlements = decodeXML(blob + ENTITLEMENTS_HEADER_SIZE, length - ENTITLEMENTS_HEADER_SIZE);
+            break;
+        
+        //unknown
+        default:
+            break;
+    }
+
+bail:
+    
+    return entitlements;
+}
+
+//render (some) entitlements
+// each is a 'key = value;' line, in the style of a dictionary's description
+NSString* entitlementsRender(NSDictionary* entitlements, NSArray* keys, NSRange range)
+{
+    //output
+    NSMutableString* output = nil;
+    
+    //init
+    output = [NSMutableString string];
+    
+    //render each
+    for(NSUInteger i = range.location; i < NSMaxRange(range) && i < keys.count; i++)
+    {
+        //value
+        id value = entitlements[keys[i]];
+        
+        //string?
+        // quote it
+        if(YES == [value isKindOfClass:[NSString class]])
+        {
+            [output appendFormat:@"    \"%@\" = \"%@\";\n", keys[i], value];
+        }
+        //array or dictionary?
+        // indent its contents
+        else if( (YES == [value isKindOfClass:[NSArray class]]) ||
+                 (YES == [value isKindOfClass:[NSDictionary class]]) )
+        {
+            [output appendFormat:@"    \"%@\" = %@;\n", keys[i], [value descriptionWithLocale:nil indent:1]];
+        }
+        //other
+        else
+        {
+            [output appendFormat:@"    \"%@\" = %@;\n", keys[i], value];
+        }
+    }
+    
+    return output;
+}
@@ -15,8 +15,9 @@
 //close button
 @property (weak) IBOutlet NSButton* closeButton;
 
-//signing info
-@property(nonatomic, retain)NSDictionary* signingInfo;
+//path
+// of item, whose entitlements to show
+@property(nonatomic, retain)NSString* path;
 
 //entitlements
 @property (unsafe_unretained) IBOutlet NSTextView* entitlements;
@@ -7,6 +7,7 @@
 //
 
 #import "Consts.h"
+#import "Entitlements.h"
 #import "EntitlementsWindowController.h"
 
 
@@ -25,7 +26,8 @@
     self.entitlements.textContainerInset = NSMakeSize(0, 10);
     
     //add entitlements
-    self.entitlements.string = [self.signingInfo[KEY_SIGNING_ENTITLEMENTS] description];
+    // decoded (and rendered) in the background
+    [self showEntitlements];
     
     //make first responder
     // calling this without a timeout sometimes fails :/
@@ -33,7 +35,93 @@
         
         //and make it first responder
         [self.window makeFirstResponder:self.closeButton];
+    
+    });
+    
+    return;
+}
+
+//decode and show entitlements
+// rendered in batches, w/ each appended as soon as its ready
+-(void)showEntitlements
+{
+    //weak self
+    // as window may be closed before all are rendered
+    __weak typeof(self) weakSelf = self;
+    
+    //path
+    NSString* path = self.path;
+    
+    //font
+    NSFont* font = self.entitlements.font;
+    
+    //clear
+    self.entitlements.string = @"";
+    
+    //decode in background
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        
+        //entitlements
+        NSDictionary* entitlements = entitlementsForPath(path);
         
+        //keys
+        // sorted, as a dictionary's description would be
+        NSArray* keys = [entitlements.allKeys sortedArrayUsingSelector:@selector(compare:)];
+        
+        //none?
+        if(0 == keys.count)
+        {
+            //show on main thread
+            dispatch_async(dispatch_get_main_queue(), ^{
+                
+                //set
+                weakSelf.entitlements.string = NSLocalizedString(@"None", @"None");
+            
+            });
+            
+            return;
+        }
+        
+        //render each batch
+        // main queue is serial, so batches are appended in order
+        for(NSUInteger i = 0; i <= keys.count; i += ENTITLEMENTS_RENDER_BATCH)
+        {
+            //rendered batch
+            NSMutableString* rendered = [NSMutableString string];
+            
+            //window closed?
+            if(nil == weakSelf)
+            {
+                //done
+                break;
+            }
+            
+            //first batch?
+            if(0 == i)
+            {
+                //open
+                [rendered appendString:@"{\n"];
+            }
+            
+            //render
+            [rendered appendString:entitlementsRender(entitlements, keys, NSMakeRange(i, ENTITLEMENTS_RENDER_BATCH))];
+            
+            //last batch?
+            if(i + ENTITLEMENTS_RENDER_BATCH > keys.count)
+            {
+                //close
+                [rendered appendString:@"}"];
+            }
+            
+            //append on main thread
+            dispatch_async(dispatch_get_main_queue(), ^{
+                
+                //append
+                [weakSelf.entitlements.textStorage appendAttributedString:[[NSAttributedString alloc] initWithString:rendered attributes:@{NSFontAttributeName:font}]];
+            
+            });
+        }
+    
     });
     
     return;
@@ -0,0 +1,52 @@
+//
+//  FileType.h
+//  WhatsYourSign
+//
+//  Created by Patrick Wardle on 10/17/26.
+//  Copyright (c) 2026 Objective-See. All rights reserved.
+//
+
+#ifndef FileType_h
+#define FileType_h
+
+@import Foundation;
+
+//max # of bytes read (from start of file)
+#define FILETYPE_HEADER_SIZE 4096
+
+//UDIF trailer size
+// this is at the end of the file
+#define FILETYPE_UDIF_TRAILER_SIZE 512
+
+//file type classifier
+// examines file's header (via a table of magic numbers)
+typedef NSString* (*FileTypeClassifier)(NSString* path, int fd, const uint8_t* header, size_t size);
+
+//magic number
+typedef struct
+{
+    //offset of magic
+    size_t offset;
+    
+    //magic (bytes)
+    const char* magic;
+    
+    //size of magic
+    size_t size;
+    
+    //classifier
+    // if NULL, 'description' is used as is
+    FileTypeClassifier classifier;
+    
+    //description
+    const char* description;
+
+} FileTypeMagic;
+
+/* FUNCTIONS */
+
+//classify a file
+// returns same (user-facing) type as 'file', or nil if file isn't one WYS recognizes
+NSString* classifyFile(NSString* path);
+
+#endif /* FileType_h */
@@ -0,0 +1,400 @@
+//
+//  FileType.m
+//  FinderSync
+//
+//  Created by Patrick Wardle on 10/17/26.
+//  Copyright (c) 2026 Objective-See. All rights reserved.
+//
+
+#import "Xar.h"
+#import "MachO.h"
+#import "FileType.h"
+
+#import <fcntl.h>
+#import <unistd.h>
+#import <sys/stat.h>
+#import <mach-o/fat.h>
+#import <mach-o/arch.h>
+#import <mach-o/loader.h>
+
+//describe a (thin) mach-o
+// e.g. 'Mach-O 64-bit executable arm64'
+static NSString* classifyMachO(NSString* path, int fd, const uint8_t* header, size_t size)
+{
+    //header
+    // big enough for 64-bit
+    struct mach_header_64 machHeader = {0};
+    
+    //swap?
+    BOOL swap = NO;
+    
+    //64-bit?
+    BOOL is64Bit = NO;
+    
+    //file type
+    const char* fileType = NULL;
+    
+    //arch info
+    const NXArchInfo* archInfo = NULL;
+    
+    //sanity check
+    if(size < sizeof(struct mach_header))
+    {
+        return nil;
+    }
+    
+    //copy out
+    memcpy(&machHeader, header, MIN(size, sizeof(machHeader)));
+    
+    //init flags
+    swap = ( (MH_CIGAM == machHeader.magic) || (MH_CIGAM_64 == machHeader.magic) );
+    is64Bit = ( (MH_MAGIC_64 == machHeader.magic) || (MH_CIGAM_64 == machHeader.magic) );
+    
+    //swap
+    if(YES == swap)
+    {
+        machHeader.cputype = (cpu_type_t)OSSwapInt32((uint32_t)machHeader.cputype);
+        machHeader.cpusubtype = (cpu_subtype_t)OSSwapInt32((uint32_t)machHeader.cpusubtype);
+        machHeader.filetype = OSSwapInt32(machHeader.filetype);
+    }
+    
+    //file type
+    // names match those of 'file'
+    switch(machHeader.filetype)
+    {
+        case MH_OBJECT:      fileType = "object"; break;
+        case MH_EXECUTE:     fileType = "executable"; break;
+        case MH_FVMLIB:      fileType = "fixed virtual memory shared library"; break;
+        case MH_CORE:        fileType = "core"; break;
+        case MH_PRELOAD:     fileType = "preload executable"; break;
+        case MH_DYLIB:       fileType = "dynamically linked shared library"; break;
+        case MH_DYLINKER:    fileType = "dynamic linker"; break;
+        case MH_BUNDLE:      fileType = "bundle"; break;
+        case MH_DYLIB_STUB:  fileType = "dynamically linked shared library stub"; break;
+        case MH_DSYM:        fileType = "dSYM companion file"; break;
+        case MH_KEXT_BUNDLE: fileType = "kext bundle"; break;
+        
+        //unknown
+        // let 'file' figure it out
+        default:
+            return nil;
+    }
+    
+    //get arch
+    // mask off capability bits (e.g. ptrauth ABI)
+    archInfo = NXGetArchInfoFromCpuType(machHeader.cputype, machHeader.cpusubtype & ~CPU_SUBTYPE_MASK);
+    if(NULL == archInfo)
+    {
+        //try w/o subtype
+        archInfo = NXGetArchInfoFromCpuType(machHeader.cputype, CPU_SUBTYPE_MULTIPLE);
+    }
+    
+    return [NSString stringWithFormat:@"Mach-O %s%s%s%s", (YES == is64Bit) ? "64-bit " : "", fileType, (NULL != archInfo) ? " " : "", (NULL != archInfo) ? archInfo->name : ""];
+}
+
+//describe a universal (fat) binary
+// e.g. 'Mach-O universal binary with 2 architectures'
+static NSString* classifyFat(NSString* path, int fd, const uint8_t* header, size_t size)
+{
+    //# of archs
+    uint32_t count = 0;
+    
+    //sanity check
+    if(size < sizeof(struct fat_header))
+    {
+        return nil;
+    }
+    
+    //get count
+    // fat header is always big-endian
+    count = OSReadBigInt32(header, offsetof(struct fat_header, nfat_arch));
+    
+    //too many?
+    // likely a java class file (same magic), so let 'file' handle it
+    if( (0 == count) ||
+        (count > MACHO_MAX_SLICES) )
+    {
+        return nil;
+    }
+    
+    return [NSString stringWithFormat:@"Mach-O universal binary with %u architecture%s", count, (1 == count) ? "" : "s"];
+}
+
+//describe a zip archive
+// e.g. 'Zip archive data, at least v2.0 to extract'
+static NSString* classifyZip(NSString* path, int fd, const uint8_t* header, size_t size)
+{
+    //version (needed to extract)
+    uint16_t version = 0;
+    
+    //sanity check
+    if(size < 6)
+    {
+        return nil;
+    }
+    
+    //get version
+    // little-endian, major * 10 + minor
+    version = OSReadLittleInt16(header, 4);
+    
+    return [NSString stringWithFormat:@"Zip archive data, at least v%u.%u to extract", version / 10, version % 10];
+}
+
+//describe text's encoding
+// only ASCII and UTF-8 are detected
+static NSString* textEncoding(const uint8_t* header, size_t size)
+{
+    //ascii?
+    for(size_t i = 0; i < size; i++)
+    {
+        //non-ascii?
+        if(header[i] & 0x80)
+        {
+            return @"Unicode text, UTF-8 text";
+        }
+    }
+    
+    return @"ASCII text";
+}
+
+//describe a script
+// e.g. 'Bourne-Again shell script text executable, ASCII text'
+static NSString* classifyScript(NSString* path, int fd, const uint8_t* header, size_t size)
+{
+    //interpreter names
+    // and how 'file' describes their scripts
+    static const struct { const char* name; const char* description; } interpreters[] =
+    {
+        {"sh", "POSIX shell script"},
+        {"bash", "Bourne-Again shell script"},
+        {"zsh", "Paul Falstad's zsh script"},
+        {"csh", "C shell script"},
+        {"tcsh", "Tenex C shell script"},
+        {"ksh", "Korn shell script"},
+        {"python", "Python script"},
+        {"python2", "Python script"},
+        {"python3", "Python script"},
+        {"perl", "Perl script"},
+        {"ruby", "Ruby script"},
+        {"php", "PHP script"},
+        {"node", "Node.js script"},
+        {"osascript", "a osascript script"},
+    };
+    
+    //shebang line
+    NSString* line = nil;
+    
+    //components
+    NSArray* components = nil;
+    
+    //interpreter
+    NSString* interpreter = nil;
+    
+    //description
+    NSString* description = nil;
+    
+    //end of (first) line
+    const uint8_t* end = NULL;
+    
+    //find end of line
+    end = memchr(header, '\n', size);
+    if(NULL == end)
+    {
+        //entire header
+        end = header + size;
+    }
+    
+    //grab line
+    // skipping '#!'
+    line = [[NSString alloc] initWithBytes:header + 2 length:(NSUInteger)(end - header - 2) encoding:NSUTF8StringEncoding];
+    
+    //split
+    components = [[line stringByTrimmingCharactersInSet:NSCharacterSet.whitespaceAndNewlineCharacterSet] componentsSeparatedByCharactersInSet:NSCharacterSet.whitespaceCharacterSet];
+    
+    //interpreter
+    interpreter = components.firstObject.lastPathComponent;
+    
+    //'/usr/bin/env <interpreter>'?
+    if( (YES == [interpreter isEqualToString:@"env"]) &&
+        (components.count > 1) )
+    {
+        //skip 'env'
+        interpreter = [components[1] lastPathComponent];
+    }
+    
+    //no interpreter?
+    if(0 == interpreter.length)
+    {
+        return nil;
+    }
+    
+    //lookup
+    for(size_t i = 0; i < sizeof(interpreters)/sizeof(interpreters[0]); i++)
+    {
+        //match?
+        if(YES == [interpreter isEqualToString:@(interpreters[i].name)])
+        {
+            //set
+            description = @(interpreters[i].description);
+            break;
+        }
+    }
+    
+    //unknown interpreter
+    // 'file' shows the shebang path
+    if(nil == description)
+    {
+        //set
+        description = [NSString stringWithFormat:@"a %@ script", [components componentsJoinedByString:@" "]];
+    }
+    
+    return [NSString stringWithFormat:@"%@ text executable, %@", description, textEncoding(header, size)];
+}
+
+//describe an XML document
+// e.g. 'XML 1.0 document text, ASCII text'
+static NSString* classifyXML(NSString* path, int fd, const uint8_t* header, size_t size)
+{
+    return [NSString stringWithFormat:@"XML 1.0 document text, %@", textEncoding(header, size)];
+}
+
+//describe a xar archive
+// e.g. 'xar archive compressed TOC'
+// note: 'file' follows this with ': <size>, <checksum>', which WYS doesn't show
+static NSString* classifyXar(NSString* path, int fd, const uint8_t* header, size_t size)
+{
+    //sanity check
+    if(size < XAR_HEADER_SIZE)
+    {
+        return nil;
+    }
+    
+    return @"xar archive compressed TOC";
+}
+
+//magic numbers
+// order matters, first match wins
+static const FileTypeMagic magicNumbers[] =
+{
+    //mach-o (thin)
+    {0, "\xfe\xed\xfa\xce", 4, classifyMachO, NULL},
+    {0, "\xce\xfa\xed\xfe", 4, classifyMachO, NULL},
+    {0, "\xfe\xed\xfa\xcf", 4, classifyMachO, NULL},
+    {0, "\xcf\xfa\xed\xfe", 4, classifyMachO, NULL},
+    
+    //mach-o (fat)
+    {0, "\xca\xfe\xba\xbe", 4, classifyFat, NULL},
+    {0, "\xca\xfe\xba\xbf", 4, classifyFat, NULL},
+    
+    //xar (.pkg/.xip)
+    {0, "xar!", 4, classifyXar, NULL},
+    
+    //zip
+    {0, "PK\x03\x04", 4, classifyZip, NULL},
+    {0, "PK\x05\x06", 4, NULL, "Zip archive data (empty)"},
+    
+    //plists
+    {0, "bplist00", 8, NULL, "Apple binary property list"},
+    {0, "<?xml", 5, classifyXML, NULL},
+    
+    //scripts
+    {0, "#!", 2, classifyScript, NULL},
+};
+
+//check for a UDIF (disk image)
+// has a 'koly' trailer at the end of the file
+static BOOL isUDIF(int fd)
+{
+    //file info
+    struct stat info = {0};
+    
+    //magic
+    uint8_t magic[4] = {0};
+    
+    //get size
+    if( (0 != fstat(fd, &info)) ||
+        (info.st_size < FILETYPE_UDIF_TRAILER_SIZE) )
+    {
+        return NO;
+    }
+    
+    //read trailer's magic
+    if(sizeof(magic) != pread(fd, magic, sizeof(magic), info.st_size - FILETYPE_UDIF_TRAILER_SIZE))
+    {
+        return NO;
+    }
+    
+    return (0 == memcmp(magic, "koly", sizeof(magic)));
+}
+
+//classify a file
+// returns same (user-facing) type as 'file', or nil if file isn't one WYS recognizes
+NSString* classifyFile(NSString* path)
+{
+    //type
+    NSString* type = nil;
+    
+    //file descriptor
+    int fd = -1;
+    
+    //header
+    uint8_t header[FILETYPE_HEADER_SIZE] = {0};
+    
+    //bytes read
+    ssize_t size = 0;
+    
+    //open
+    fd = open(path.fileSystemRepresentation, O_RDONLY | O_CLOEXEC);
+    if(-1 == fd)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //read header
+    size = pread(fd, header, sizeof(header), 0);
+    if(size <= 0)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //check each magic
+    for(size_t i = 0; i < sizeof(magicNumbers)/sizeof(magicNumbers[0]); i++)
+    {
+        //magic
+        const FileTypeMagic* magic = &magicNumbers[i];
+        
+        //no match?
+        if( ((size_t)size < magic->offset + magic->size) ||
+            (0 != memcmp(header + magic->offset, magic->magic, magic->size)) )
+        {
+            //next
+            continue;
+        }
+        
+        //classify
+        type = (NULL != magic->classifier) ? magic->classifier(path, fd, header, (size_t)size) : @(magic->description);
+        
+        //done
+        goto bail;
+    }
+    
+    //disk image?
+    if(YES == isUDIF(fd))
+    {
+        //set
+        type = @"Apple disk image (UDIF)";
+    }
+
+bail:
+    
+    //close
+    if(-1 != fd)
+    {
+        close(fd);
+        fd = -1;
+    }
+    
+    return type;
+}
@@ -12,6 +12,7 @@
 
 #import "Item.h"
 #import "InfoWindowController.h"
+#import "BatchWindowController.h"
 
 @interface FinderSync : FIFinderSync
 
@@ -23,7 +24,7 @@
 //directories to watch
 @property(nonatomic, retain)NSMutableSet* directories;
 
-//active info windows
+//active info (and batch) windows
 @property(nonatomic, retain)NSMutableArray* infoWindows;
 
 @end
@@ -183,25 +183,48 @@
 }
 
 //automatically invoked
-// add 'Signing Info' menu item
+// add 'Signing Info' menu item (and batch item, for multi-selections/folders)
 -(NSMenu*)menuForMenuKind:(FIMenuKind)whichMenu
 {
     //menu
     NSMenu *menu = nil;
     
-    //ignore multi-selections
-    if([[[FIFinderSyncController defaultController] selectedItemURLs] count] > 1)
-    {
-        //ignore
-        goto bail;
-    }
+    //selected items
+    NSArray* selectedItems = nil;
+    
+    //directory flag
+    BOOL isDirectory = NO;
+    
+    //get selected items
+    selectedItems = [[FIFinderSyncController defaultController] selectedItemURLs];
     
     //alloc/init menu
     menu = [[NSMenu alloc] initWithTitle:@""];
     
+    //multi-selection?
+    // add (only) batch item
+    if(selectedItems.count > 1)
+    {
+        //add 'Signing Info (n items)'
+        [menu addItemWithTitle:[NSString stringWithFormat:NSLocalizedString(@"Code Signing Info (%lu Items)", @"Code Signing Info (%lu Items)"), (unsigned long)selectedItems.count] action:@selector(showBatchSigningInfo:) keyEquivalent:@""];
+        
+        //done
+        goto bail;
+    }
+    
     //add 'Signing Info'
     [menu addItemWithTitle:NSLocalizedString(@"Code Signing Info", @"Code Signing Info") action:@selector(showSigningInfo:) keyEquivalent:@""];
     
+    //folder (not bundle)?
+    // also add batch item, for its contents
+    if( (YES == [NSFileManager.defaultManager fileExistsAtPath:[selectedItems.firstObject path] isDirectory:&isDirectory]) &&
+        (YES == isDirectory) &&
+        (YES != [NSWorkspace.sharedWorkspace isFilePackageAtPath:[selectedItems.firstObject path]]) )
+    {
+        //add 'Signing Info (all items)'
+        [menu addItemWithTitle:NSLocalizedString(@"Code Signing Info (All Items)", @"Code Signing Info (All Items)") action:@selector(showBatchSigningInfo:) keyEquivalent:@""];
+    }
+    
 bail:
 
     return menu;
@@ -283,4 +306,61 @@ bail:
     return;
 }
 
+//show signing info for multiple items
+// selection (or folder's contents) are verified, and shown in a single table
+-(void)showBatchSigningInfo:(id)sender
+{
+    //selected items
+    NSArray* selectedItems = nil;
+    
+    //get selected items
+    selectedItems = [[FIFinderSyncController defaultController] selectedItemURLs];
+    
+    //show window on main thread
+    dispatch_async(dispatch_get_main_queue(), ^{
+        
+        //batch window
+        BatchWindowController* batchWindowController = nil;
+        
+        //init batch window
+        batchWindowController = [[BatchWindowController alloc] initWithItems:selectedItems];
+        
+        //retain window controller
+        [self.infoWindows addObject:batchWindowController];
+        
+        //register for close
+        // so we can release window controller
+        __block id observer = [[NSNotificationCenter defaultCenter] addObserverForName:NSWindowWillCloseNotification object:batchWindowController.window queue:nil usingBlock:^(NSNotification *note) {
+            
+            //release window controller
+            [self.infoWindows removeObject:batchWindowController];
+            
+            //remove observer
+            [[NSNotificationCenter defaultCenter] removeObserver:observer];
+            
+        }];
+        
+        //center window
+        [batchWindowController.window center];
+        
+        //activate
+        if(@available(macOS 14.0, *)) {
+            [NSApp activate];
+        }
+        else
+        {
+            [NSApp activateIgnoringOtherApps:YES];
+        }
+        
+        //show it
+        [batchWindowController showWindow:self];
+        
+        //start
+        [batchWindowController start];
+        
+    });
+    
+    return;
+}
+
 @end
@@ -0,0 +1,92 @@
+//
+//  HashCache.h
+//  WhatsYourSign
+//
+//  Created by Patrick Wardle on 10/17/26.
+//  Copyright (c) 2026 Objective-See. All rights reserved.
+//
+
+#ifndef HashCache_h
+#define HashCache_h
+
+@import Foundation;
+
+#import <sys/stat.h>
+#import <CommonCrypto/CommonDigest.h>
+
+//cache file
+// lives in the app group container
+#define HASH_CACHE_FILE @"hashes.cache"
+
+//# of tries to open (and, if needed, recreate) cache
+// as another instance might be replacing it at the same time
+#define HASH_CACHE_OPEN_ATTEMPTS 4
+
+//cache magic ('WYSH')
+#define HASH_CACHE_MAGIC 0x57595348
+
+//cache version
+#define HASH_CACHE_VERSION 1
+
+//# of sets
+#define HASH_CACHE_SETS 1024
+
+//# of entries per set
+// eviction is LRU, within a set
+#define HASH_CACHE_WAYS 8
+
+//cache header
+typedef struct
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t sets;
+    uint32_t ways;
+
+    //LRU clock
+    uint64_t clock;
+
+} HashCacheHeader;
+
+//cache entry
+// keyed by the file's identity
+typedef struct
+{
+    //file identity
+    uint64_t device;
+    uint64_t inode;
+    uint64_t size;
+    int64_t modified;
+    int64_t modifiedNS;
+    int64_t changed;
+    int64_t changedNS;
+
+    //last used
+    // value of LRU clock, 0 if entry is unused
+    uint64_t lastUsed;
+
+    //digests
+    uint8_t md5[CC_MD5_DIGEST_LENGTH];
+    uint8_t sha1[CC_SHA1_DIGEST_LENGTH];
+    uint8_t sha256[CC_SHA256_DIGEST_LENGTH];
+    uint8_t sha512[CC_SHA512_DIGEST_LENGTH];
+
+} HashCacheEntry;
+
+/* FUNCTIONS */
+
+//lookup (cached) hashes for a file
+NSDictionary* hashCacheLookup(const struct stat* info);
+
+//save hashes for a file
+void hashCacheStore(const struct stat* info, NSDictionary* hashes);
+
+//clear cache
+// e.g. between benchmark iterations
+void hashCacheClear(void);
+
+//hash a file
+// but first check the cache
+NSDictionary* hashFileCached(NSString* itemPath);
+
+#endif /* HashCache_h */
@@ -0,0 +1,586 @@
+//
+//  HashCache.m
+//  FinderSync
+//
+//  Created by Patrick Wardle on 10/17/26.
+//  Copyright (c) 2026 Objective-See. All rights reserved.
+//
+//  note: cache is a fixed-size (set-associative) table, memory-mapped and shared
+//        by all extension instances; access is serialized via 'flock' on the file
+//        it's never resized in place: a new one is built in a temp file and renamed over it, and instances remap
+
+#import "consts.h"
+#import "HashCache.h"
+#import "utilities.h"
+
+#import <fcntl.h>
+#import <os/lock.h>
+#import <os/log.h>
+#import <sys/file.h>
+#import <sys/mman.h>
+
+//lock
+// protects (re)mapping of cache, and serializes this instance's threads (as 'flock' doesn't)
+static os_unfair_lock cacheLock = OS_UNFAIR_LOCK_INIT;
+
+//mapped cache
+static HashCacheHeader* cache = NULL;
+
+//cache's file descriptor
+// needed for locking
+static int cacheFD = -1;
+
+//size of (mapped) cache
+static size_t cacheSize(void)
+{
+    return sizeof(HashCacheHeader) + (HASH_CACHE_SETS * HASH_CACHE_WAYS * sizeof(HashCacheEntry));
+}
+
+//get path to cache
+static NSString* cachePath(void)
+{
+    //path
+    static NSString* path = nil;
+    
+    //once token
+    static dispatch_once_t onceToken = 0;
+    
+    //only once
+    dispatch_once(&onceToken, ^{
+        
+        //init
+        // normally, app group container
+        path = [cachesDirectory() URLByAppendingPathComponent:HASH_CACHE_FILE].path;
+    
+    });
+    
+    return path;
+}
+
+//is an (open) cache file valid?
+// right size, w/ a header that matches this version and geometry
+static BOOL cacheIsValid(int fd)
+{
+    //file info
+    struct stat info = {0};
+    
+    //header
+    HashCacheHeader header = {0};
+    
+    return (0 == fstat(fd, &info)) &&
+           ((size_t)info.st_size == cacheSize()) &&
+           (sizeof(header) == pread(fd, &header, sizeof(header), 0)) &&
+           (HASH_CACHE_MAGIC == header.magic) &&
+           (HASH_CACHE_VERSION == header.version) &&
+           (HASH_CACHE_SETS == header.sets) &&
+           (HASH_CACHE_WAYS == header.ways);
+}
+
+//is (open) cache file still the one at the cache's path?
+// i.e. not replaced by another instance
+static BOOL cacheIsCurrent(int fd)
+{
+    //file info (path)
+    struct stat pathInfo = {0};
+    
+    //file info (fd)
+    struct stat fdInfo = {0};
+    
+    return (0 == stat(cachePath().fileSystemRepresentation, &pathInfo)) &&
+           (0 == fstat(fd, &fdInfo)) &&
+           (pathInfo.st_dev == fdInfo.st_dev) &&
+           (pathInfo.st_ino == fdInfo.st_ino);
+}
+
+//build (empty) cache
+// in a temp file, then (atomically) renamed over any old one, as other instances might have it mapped
+static BOOL createCache(void)
+{
+    //contents
+    NSMutableData* contents = nil;
+    
+    //header
+    HashCacheHeader header = {HASH_CACHE_MAGIC, HASH_CACHE_VERSION, HASH_CACHE_SETS, HASH_CACHE_WAYS, 0};
+    
+    //temp path
+    NSString* tempPath = nil;
+    
+    //init
+    // header, then (zero'd) entries
+    contents = [NSMutableData dataWithBytes:&header length:sizeof(header)];
+    contents.length = cacheSize();
+    
+    //write to temp file
+    // then rename over cache
+    tempPath = [cachePath() stringByAppendingFormat:@".%d", getpid()];
+    if( (YES != [contents writeToFile:tempPath atomically:NO]) ||
+        (0 != rename(tempPath.fileSystemRepresentation, cachePath().fileSystemRepresentation)) )
+    {
+        //cleanup
+        unlink(tempPath.fileSystemRepresentation);
+        
+        return NO;
+    }
+    
+    //dbg msg
+    os_log_debug(OS_LOG_DEFAULT, "WYS: (re)created hash cache");
+    
+    return YES;
+}
+
+//unmap and close cache
+// note: call with lock held
+static void closeCache(void)
+{
+    //unmap
+    if(NULL != cache)
+    {
+        munmap(cache, cacheSize());
+        cache = NULL;
+    }
+    
+    //close
+    if(-1 != cacheFD)
+    {
+        close(cacheFD);
+        cacheFD = -1;
+    }
+    
+    return;
+}
+
+//open and map cache
+// (re)creating it, if it's new or invalid
+// note: call with lock held
+static BOOL openCache(void)
+{
+    //fd
+    int fd = -1;
+    
+    //mapping
+    void* mapping = MAP_FAILED;
+    
+    //no path?
+    if(nil == cachePath())
+    {
+        //bail
+        goto bail;
+    }
+    
+    //open, (re)creating as needed
+    // a few tries, as another instance might be replacing it too
+    for(int attempt = 0; attempt < HASH_CACHE_OPEN_ATTEMPTS; attempt++)
+    {
+        //open
+        fd = open(cachePath().fileSystemRepresentation, O_RDWR | O_CLOEXEC);
+        if(-1 == fd)
+        {
+            //(re)create
+            // then try again
+            createCache();
+            continue;
+        }
+        
+        //lock
+        // another instance might be replacing it
+        flock(fd, LOCK_EX);
+        
+        //valid, and (still) current?
+        if( (YES == cacheIsValid(fd)) &&
+            (YES == cacheIsCurrent(fd)) )
+        {
+            //unlock
+            flock(fd, LOCK_UN);
+            
+            break;
+        }
+        
+        //invalid?
+        // replace, while holding lock on old one
+        if(YES == cacheIsCurrent(fd))
+        {
+            createCache();
+        }
+        
+        //unlock
+        flock(fd, LOCK_UN);
+        
+        //close
+        close(fd);
+        fd = -1;
+    }
+    
+    //couldn't open?
+    if(-1 == fd)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //map
+    // file is never truncated (only replaced), so mapping stays valid
+    mapping = mmap(NULL, cacheSize(), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if(MAP_FAILED == mapping)
+    {
+        //close
+        close(fd);
+        
+        //bail
+        goto bail;
+    }
+    
+    //save
+    cache = mapping;
+    cacheFD = fd;
+
+bail:
+    
+    //dbg msg
+    os_log_debug(OS_LOG_DEFAULT, "WYS: hash cache mapped: %d", (NULL != cache));
+    
+    return (NULL != cache);
+}
+
+//acquire cache
+// (re)maps it if needed (e.g. it was replaced), then locks it
+static BOOL acquireCache(void)
+{
+    //lock
+    os_unfair_lock_lock(&cacheLock);
+    
+    //map
+    if( (NULL == cache) &&
+        (YES != openCache()) )
+    {
+        //unlock
+        os_unfair_lock_unlock(&cacheLock);
+        
+        return NO;
+    }
+    
+    //lock file
+    flock(cacheFD, LOCK_EX);
+    
+    //replaced (by another instance)?
+    // remap new one, as old one is orphaned
+    if(YES != cacheIsCurrent(cacheFD))
+    {
+        //unlock file
+        flock(cacheFD, LOCK_UN);
+        
+        //close
+        closeCache();
+        
+        //(re)map
+        if(YES != openCache())
+        {
+            //unlock
+            os_unfair_lock_unlock(&cacheLock);
+            
+            return NO;
+        }
+        
+        //lock file
+        flock(cacheFD, LOCK_EX);
+    }
+    
+    return YES;
+}
+
+//release cache
+static void releaseCache(void)
+{
+    //unlock file
+    flock(cacheFD, LOCK_UN);
+    
+    //unlock
+    os_unfair_lock_unlock(&cacheLock);
+    
+    return;
+}
+
+//get set (first entry) for a file
+static HashCacheEntry* setForFile(const struct stat* info)
+{
+    //hash (FNV-1a)
+    uint64_t hash = 0xcbf29ce484222325;
+    
+    //identity
+    uint64_t identity[3] = {(uint64_t)info->st_dev, (uint64_t)info->st_ino, (uint64_t)info->st_size};
+    
+    //hash identity
+    for(size_t i = 0; i < sizeof(identity); i++)
+    {
+        hash ^= ((uint8_t*)identity)[i];
+        hash *= 0x100000001b3;
+    }
+    
+    return (HashCacheEntry*)(cache + 1) + ((hash % HASH_CACHE_SETS) * HASH_CACHE_WAYS);
+}
+
+//does entry match file?
+static BOOL entryMatches(const HashCacheEntry* entry, const struct stat* info)
+{
+    return (0 != entry->lastUsed) &&
+           (entry->device == (uint64_t)info->st_dev) &&
+           (entry->inode == (uint64_t)info->st_ino) &&
+           (entry->size == (uint64_t)info->st_size) &&
+           (entry->modified == info->st_mtimespec.tv_sec) &&
+           (entry->modifiedNS == info->st_mtimespec.tv_nsec) &&
+           (entry->changed == info->st_ctimespec.tv_sec) &&
+           (entry->changedNS == info->st_ctimespec.tv_nsec);
+}
+
+//convert hex string to bytes
+static BOOL stringToBytes(NSString* string, uint8_t* bytes, size_t length)
+{
+    //chars
+    const char* chars = string.UTF8String;
+    
+    //sanity check
+    if( (NULL == chars) ||
+        (strlen(chars) != length*2) )
+    {
+        return NO;
+    }
+    
+    //convert
+    for(size_t i = 0; i < length; i++)
+    {
+        //byte
+        unsigned int byte = 0;
+        
+        //scan
+        if(1 != sscanf(chars + i*2, "%2x", &byte))
+        {
+            return NO;
+        }
+        
+        //save
+        bytes[i] = (uint8_t)byte;
+    }
+    
+    return YES;
+}
+
+//lookup (cached) hashes for a file
+NSDictionary* hashCacheLookup(const struct stat* info)
+{
+    //hashes
+    NSDictionary* hashes = nil;
+    
+    //set
+    HashCacheEntry* set = NULL;
+    
+    //acquire cache
+    if(YES != acquireCache())
+    {
+        //bail
+        goto bail;
+    }
+    
+    //get set
+    set = setForFile(info);
+    
+    //check each entry
+    for(NSUInteger i = 0; i < HASH_CACHE_WAYS; i++)
+    {
+        //no match?
+        if(YES != entryMatches(&set[i], info))
+        {
+            //skip
+            continue;
+        }
+        
+        //update LRU
+        set[i].lastUsed = ++cache->clock;
+        
+        //init hashes
+        hashes = @{KEY_HASH_MD5:bytesToHex(set[i].md5, sizeof(set[i].md5), YES),
+                   KEY_HASH_SHA1:bytesToHex(set[i].sha1, sizeof(set[i].sha1), YES),
+                   KEY_HASH_SHA256:bytesToHex(set[i].sha256, sizeof(set[i].sha256), YES),
+                   KEY_HASH_SHA512:bytesToHex(set[i].sha512, sizeof(set[i].sha512), YES)};
+        
+        //done
+        break;
+    }
+    
+    //release
+    releaseCache();
+
+bail:
+    
+    return hashes;
+}
+
+//clear cache
+// e.g. between benchmark iterations
+void hashCacheClear(void)
+{
+    //acquire cache
+    if(YES != acquireCache())
+    {
+        return;
+    }
+    
+    //reset entries
+    // and LRU clock
+    memset((uint8_t*)cache + sizeof(HashCacheHeader), 0, cacheSize() - sizeof(HashCacheHeader));
+    cache->clock = 0;
+    
+    //release
+    releaseCache();
+    
+    return;
+}
+
+//save hashes for a file
+// evicts least recently used entry in set (if full)
+void hashCacheStore(const struct stat* info, NSDictionary* hashes)
+{
+    //entry
+    HashCacheEntry entry = {0};
+    
+    //set
+    HashCacheEntry* set = NULL;
+    
+    //victim
+    HashCacheEntry* victim = NULL;
+    
+    //init identity
+    entry.device = (uint64_t)info->st_dev;
+    entry.inode = (uint64_t)info->st_ino;
+    entry.size = (uint64_t)info->st_size;
+    entry.modified = info->st_mtimespec.tv_sec;
+    entry.modifiedNS = info->st_mtimespec.tv_nsec;
+    entry.changed = info->st_ctimespec.tv_sec;
+    entry.changedNS = info->st_ctimespec.tv_nsec;
+    
+    //init digests
+    if( (YES != stringToBytes(hashes[KEY_HASH_MD5], entry.md5, sizeof(entry.md5))) ||
+        (YES != stringToBytes(hashes[KEY_HASH_SHA1], entry.sha1, sizeof(entry.sha1))) ||
+        (YES != stringToBytes(hashes[KEY_HASH_SHA256], entry.sha256, sizeof(entry.sha256))) ||
+        (YES != stringToBytes(hashes[KEY_HASH_SHA512], entry.sha512, sizeof(entry.sha512))) )
+    {
+        //bail
+        goto bail;
+    }
+    
+    //acquire cache
+    if(YES != acquireCache())
+    {
+        //bail
+        goto bail;
+    }
+    
+    //get set
+    set = setForFile(info);
+    
+    //find victim
+    // existing entry, unused entry, or least recently used
+    for(NSUInteger i = 0; i < HASH_CACHE_WAYS; i++)
+    {
+        //match or unused?
+        if( (YES == entryMatches(&set[i], info)) ||
+            (0 == set[i].lastUsed) )
+        {
+            //use
+            victim = &set[i];
+            break;
+        }
+        
+        //older?
+        if( (NULL == victim) ||
+            (set[i].lastUsed < victim->lastUsed) )
+        {
+            //save
+            victim = &set[i];
+        }
+    }
+    
+    //set LRU
+    entry.lastUsed = ++cache->clock;
+    
+    //save
+    *victim = entry;
+    
+    //release
+    releaseCache();
+
+bail:
+    
+    return;
+}
+
+//hash a file
+// but first check the cache
+NSDictionary* hashFileCached(NSString* itemPath)
+{
+    //hashes
+    NSDictionary* hashes = nil;
+    
+    //path
+    NSString* path = nil;
+    
+    //file info (before)
+    struct stat before = {0};
+    
+    //file info (after)
+    struct stat after = {0};
+    
+    //get path to hash
+    // for bundles, this is their main binary
+    path = hashablePath(itemPath);
+    if(nil == path)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //get file info
+    // can't cache w/o file's identity, so just hash
+    if(0 != stat(path.fileSystemRepresentation, &before))
+    {
+        //hash
+        hashes = hashFile(itemPath);
+        
+        //done
+        goto bail;
+    }
+    
+    //cache hit?
+    hashes = hashCacheLookup(&before);
+    if(nil != hashes)
+    {
+        //dbg msg
+        os_log_debug(OS_LOG_DEFAULT, "WYS: hash cache hit for %{public}@", path);
+        
+        //done
+        goto bail;
+    }
+    
+    //hash
+    hashes = hashFile(itemPath);
+    if(nil == hashes)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //only cache if file didn't change while hashing
+    if( (0 == stat(path.fileSystemRepresentation, &after)) &&
+        (before.st_ino == after.st_ino) &&
+        (before.st_size == after.st_size) &&
+        (before.st_mtimespec.tv_sec == after.st_mtimespec.tv_sec) &&
+        (before.st_mtimespec.tv_nsec == after.st_mtimespec.tv_nsec) &&
+        (before.st_ctimespec.tv_sec == after.st_ctimespec.tv_sec) &&
+        (before.st_ctimespec.tv_nsec == after.st_ctimespec.tv_nsec) )
+    {
+        //save
+        hashCacheStore(&before, hashes);
+    }
+
+bail:
+    
+    return hashes;
+}
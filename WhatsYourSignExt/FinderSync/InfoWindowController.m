@@ -62,7 +62,12 @@
     self.icon.image = [self.item getIcon];
     
     //set type
-    self.type.stringValue = self.item.type.capitalizedString;
+    // might still be 'determining...', as it's now set in background
+    if(nil != self.item.type)
+    {
+        //set
+        self.type.stringValue = self.item.type.capitalizedString;
+    }
     
     //show spinner
     [self.activityIndicator setHidden:NO];
@@ -99,6 +104,7 @@
 
 //process item's code signing info
 // sets code signing icon, summary, and formats signing auths
+// note: invoked as each stage completes, so only shows what's available so far
 -(void)processCodeSigningInfo
 {
     //signing icon
@@ -113,14 +119,37 @@
     //directory flag
     BOOL isDirectory = NO;
     
+    //set type
+    if(nil != self.item.type)
+    {
+        //set
+        self.type.stringValue = self.item.type.capitalizedString;
+    }
+    
+    //no signing info yet?
+    if(self.item.stage < ItemStageSignature)
+    {
+        //done
+        return;
+    }
+    
     //alloc string for summary
     csSummary = [NSMutableString string];
     
-    //stop/hide spinner
-    [self.activityIndicator stopAnimation:nil];
+    //reset summary details
+    // as it's only set once signer is known
+    self.summaryDetails.stringValue = @"";
     
-    //hide spinner
-    [self.activityIndicator setHidden:YES];
+    //all done?
+    // stop/hide spinner
+    if(self.item.stage >= ItemStageHashes)
+    {
+        //stop spinner
+        [self.activityIndicator stopAnimation:nil];
+        
+        //hide spinner
+        [self.activityIndicator setHidden:YES];
+    }
     
     //start summary with item name
     [csSummary appendString:[self.item.name stringByDeletingPathExtension]];
@@ -184,6 +213,17 @@
                 break;
             }
             
+            //signer not yet known?
+            // for now, set icon to default (signed)
+            if(self.item.stage < ItemStageSigner)
+            {
+                //set icon
+                csIcon = [NSImage imageNamed:@"signed"];
+                
+                //done
+                break;
+            }
+            
             //item signed by apple
             if(YES == [self.item.signingInfo[KEY_SIGNING_IS_APPLE] boolValue])
             {
@@ -321,6 +361,48 @@
             //set details
             csDetails = [NSMutableString stringWithFormat:NSLocalizedString(@"Unknown (status/error: %ld)", @"Unknown (status/error: %ld)"), (long)[self.item.signingInfo[KEY_SIGNATURE_STATUS] integerValue]];
             
+            //nested code failed?
+            // show which item
+            if(nil != self.item.signingInfo[KEY_SIGNING_NESTED_FAILURE])
+            {
+                //append to details
+                [csDetails appendFormat:NSLocalizedString(@"\n› nested code: %@", @"\n› nested code: %@"), self.item.signingInfo[KEY_SIGNING_NESTED_FAILURE]];
+            }
+            
+            //resources don't match seal?
+            // show (first few) that were modified, added, or removed
+            for(NSArray* kind in @[@[KEY_RESOURCES_MODIFIED, NSLocalizedString(@"modified", @"modified")],
+                                   @[KEY_RESOURCES_ADDED, NSLocalizedString(@"added", @"added")],
+                                   @[KEY_RESOURCES_REMOVED, NSLocalizedString(@"removed", @"removed")]])
+            {
+                //resources
+                NSArray* resources = self.item.signingInfo[KEY_SIGNING_RESOURCES][kind.firstObject];
+                
+                //none?
+                if(0 == resources.count)
+                {
+                    continue;
+                }
+                
+                //append to details
+                [csDetails appendFormat:@"\n› %@: %@", kind.lastObject, [[resources subarrayWithRange:NSMakeRange(0, MIN(resources.count, RESOURCES_MAX_SHOWN))] componentsJoinedByString:@", "]];
+                
+                //more?
+                if(resources.count > RESOURCES_MAX_SHOWN)
+                {
+                    //append to details
+                    [csDetails appendFormat:NSLocalizedString(@" (+%lu more)", @" (+%lu more)"), (unsigned long)(resources.count - RESOURCES_MAX_SHOWN)];
+                }
+            }
+            
+            //modified code?
+            // show first page that doesn't match its hash
+            if(nil != self.item.signingInfo[KEY_SIGNING_BAD_PAGE])
+            {
+                //append to details
+                [csDetails appendFormat:NSLocalizedString(@"\n› code modified: page %@ (offset: %#llx)", @"\n› code modified: page %@ (offset: %#llx)"), self.item.signingInfo[KEY_SIGNING_BAD_PAGE], [self.item.signingInfo[KEY_SIGNING_BAD_PAGE_OFFSET] unsignedLongLongValue]];
+            }
+            
             break;
     }
     
@@ -335,7 +417,9 @@
     }
     
     //no hashes?
-    if(nil == self.item.hashes)
+    // note: only once they've been generated
+    if( (self.item.stage >= ItemStageHashes) &&
+        (nil == self.item.hashes) )
     {
         //bundle?
         // give a more specific error msg
@@ -353,17 +437,22 @@
         }
     }
     //create clickable 'show hashes' label
-    else
+    else if(self.item.stage >= ItemStageHashes)
     {
         //create/set attributes string
         self.hashes.attributedStringValue = [[NSMutableAttributedString alloc] initWithString:NSLocalizedString(@"View Hashes", @"View Hashes") attributes:@{NSLinkAttributeName:[NSURL URLWithString:@"#"], NSForegroundColorAttributeName:[NSColor blueColor], NSUnderlineStyleAttributeName:[NSNumber numberWithInt:NSSingleUnderlineStyle]}];
         
         //add click event handler
-        [self.hashes addGestureRecognizer:[[NSClickGestureRecognizer alloc] initWithTarget:self action:@selector(showHashes:)]];
+        // only once, as this method is invoked per stage
+        if(0 == self.hashes.gestureRecognizers.count)
+        {
+            //add
+            [self.hashes addGestureRecognizer:[[NSClickGestureRecognizer alloc] initWithTarget:self action:@selector(showHashes:)]];
+        }
     }
     
     //no entitlements?
-    if(0 == [self.item.signingInfo[KEY_SIGNING_ENTITLEMENTS] count])
+    if(YES != [self.item.signingInfo[KEY_SIGNING_HAS_ENTITLEMENTS] boolValue])
     {
         //couldn't access?
         if(kPOSIXErrorEACCES == [self.item.signingInfo[KEY_SIGNATURE_STATUS] intValue])
@@ -384,7 +473,12 @@
         self.entitlements.attributedStringValue = [[NSMutableAttributedString alloc] initWithString:NSLocalizedString(@"View Entitlements", @"View Entitlements") attributes:@{NSLinkAttributeName:[NSURL URLWithString:@"#"], NSForegroundColorAttributeName:[NSColor blueColor], NSUnderlineStyleAttributeName:[NSNumber numberWithInt:NSSingleUnderlineStyle]}];
         
         //add click event handler
-        [self.entitlements addGestureRecognizer:[[NSClickGestureRecognizer alloc] initWithTarget:self action:@selector(showEntitlements:)]];
+        // only once, as this method is invoked per stage
+        if(0 == self.entitlements.gestureRecognizers.count)
+        {
+            //add
+            [self.entitlements addGestureRecognizer:[[NSClickGestureRecognizer alloc] initWithTarget:self action:@selector(showEntitlements:)]];
+        }
     }
     
     //have signing auths?
@@ -449,8 +543,9 @@
     //alloc sheet
     self.entitlementsWindowController = [[EntitlementsWindowController alloc] initWithWindowNibName:@"EntitlementsWindow"];
     
-    //save signing info into iVar
-    self.entitlementsWindowController.signingInfo = self.item.signingInfo;
+    //save path into iVar
+    // entitlements are decoded once window loads
+    self.entitlementsWindowController.path = self.item.path;
     
     //show entitlements
     [self.window beginSheet:self.entitlementsWindowController.window completionHandler:^(NSModalResponse returnCode) {
@@ -11,6 +11,30 @@
 
 #import "InfoWindowController.h"
 
+//verification stages
+// published (in order) to window, as each completes
+typedef NS_ENUM(NSInteger, ItemStage)
+{
+    ItemStageNone = 0,
+    
+    //type
+    ItemStageType,
+    
+    //signature status & authorities
+    ItemStageSignature,
+    
+    //signer (apple, dev id, app store)
+    ItemStageSigner,
+    
+    //notarization
+    // signing info is now complete
+    ItemStageNotarization,
+    
+    //hashes
+    // verification is now complete
+    ItemStageHashes
+};
+
 @interface Item : NSObject
 {
     
@@ -31,22 +55,34 @@
 @property(nonatomic, retain)NSImage* icon;
 
 //type
-@property(nonatomic, retain)NSString* type;
+// set in background, so atomic
+@property(atomic, retain)NSString* type;
 
 //bundle
 @property(nonatomic, retain)NSBundle* bundle;
 
 //hashes
-@property(nonatomic, retain)NSDictionary* hashes;
+// set in background, so atomic
+@property(atomic, retain)NSDictionary* hashes;
 
 //signing info
-@property(nonatomic, retain)NSMutableDictionary* signingInfo;
+// set in background (as each stage completes), so atomic
+@property(atomic, retain)NSMutableDictionary* signingInfo;
+
+//stage
+// last one published to window
+@property ItemStage stage;
 
 /* METHODS */
 
 //init method
+// kicks off (background) verification, publishing each stage to window as it completes
 -(id)init:(NSString*)itemPath;
 
+//init method
+// only kicks off (background) verification if 'verify' is set
+-(id)init:(NSString*)itemPath verify:(BOOL)verify;
+
 //get item's name
 // ->either from bundle or path's last component
 -(NSString*)getName;
@@ -54,6 +90,10 @@
 //get an icon for a item
 -(NSImage*)getIcon;
 
+//verify item
+// determines type, then generates signing info (and hashes), synchronously
+-(void)verify;
+
 //get signing info (which takes a while to generate)
 // ->this method should be called in the background
 -(void)generateSigningInfo;
@@ -8,15 +8,30 @@
 
 #import "Xips.h"
 #import "Item.h"
+#import "Udif.h"
 #import "consts.h"
 #import "Signing.h"
+#import "Trace.h"
+#import "FileType.h"
 #import "Packages.h"
+#import "NestedCode.h"
+#import "HashCache.h"
 #import "utilities.h"
-#import "FinderSync.h"
 
 #import <os/log.h>
 
 @implementation Item
+{
+    //publish stages to window?
+    BOOL publishes;
+    
+    //publish to window (first) result yet?
+    BOOL published;
+    
+    //time item was created
+    // used to measure time to first result
+    CFAbsoluteTime created;
+}
 
 @synthesize icon;
 @synthesize name;
@@ -28,7 +43,15 @@
 @synthesize windowController;
 
 //init method
+// kicks off (background) verification, publishing each stage to window as it completes
 -(id)init:(NSString*)itemPath
+{
+    return [self init:itemPath verify:YES];
+}
+
+//init method
+// only kicks off (background) verification if 'verify' is set
+-(id)init:(NSString*)itemPath verify:(BOOL)verify
 {
     //super
     self = [super init];
@@ -54,39 +77,25 @@
         // either from bundle or just use a system icon
         self.icon = [self getIcon];
         
-        //set type
-        [self determineType];
+        //caller will verify?
+        if(YES != verify)
+        {
+            //done
+            goto bail;
+        }
+        
+        //publish stages
+        publishes = YES;
         
-        //get code signing info
-        // do in background cuz it can be slow!
-        dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0),
+        //init
+        created = CFAbsoluteTimeGetCurrent();
+        
+        //get type, code signing info, etc
+        // do in background cuz it can be slow, with each stage published as it's ready
+        dispatch_async(dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0),
         ^{
-           //get code signing info
-           [self generateSigningInfo];
-        
-           //no errors?
-           // if item is an app, might have to verify its (fat) binary too
-           if(YES == [self shouldVerifyBinary])
-           {
-               //dbg msg
-               //logMsg(LOG_DEBUG, [NSString stringWithFormat:@"verifying %@'s main binary", self.name]);
-               
-               //verify
-               [self verifyBinary];
-           }
-           
-           //nap
-           // allows 'determining' msg / activity indicator to be shown
-           [NSThread sleepForTimeInterval:0.5];
-           
-           //on main thread
-           // tell window to now process signing info
-           dispatch_async(dispatch_get_main_queue(), ^{
-               
-               //process
-               [self.windowController processCodeSigningInfo];
-               
-           });
+           //verify
+           [self verify];
            
         });
     }
@@ -96,6 +105,135 @@ bail:
     return self;
 }
 
+//verify item
+// determines type, then generates signing info (and hashes), synchronously
+-(void)verify
+{
+    //group
+    dispatch_group_t group = NULL;
+    
+    //span
+    TraceSpan span = traceBegin("item");
+    
+    //set type
+    [self determineType];
+    
+    //publish type
+    [self publish:ItemStageType];
+    
+    //init group
+    group = dispatch_group_create();
+    
+    //hash in background
+    // as it's independent of signing checks (note: xips are only checked)
+    if(YES != [self.type isEqualToString:@"XIP Secure Archive"])
+    {
+        //hash
+        dispatch_group_async(group, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+            
+            //span
+            TraceSpan hashSpan = traceBegin("hashes");
+            
+            //add hashes
+            self.hashes = hashFileCached(self.path);
+            
+            //end span
+            traceEnd(&hashSpan, traceFileSize(hashablePath(self.path) ?: self.path));
+            
+        });
+    }
+    
+    //get code signing info
+    // publishes signature and signer stages, as they complete
+    [self generateSigningInfo];
+    
+    //no errors?
+    // if item is an app, might have to verify its (fat) binary too
+    if(YES == [self shouldVerifyBinary])
+    {
+        //dbg msg
+        //logMsg(LOG_DEBUG, [NSString stringWithFormat:@"verifying %@'s main binary", self.name]);
+        
+        //verify
+        [self verifyBinary];
+    }
+    
+    //publish notarization
+    // signing info is now complete
+    [self publish:ItemStageNotarization];
+    
+    //wait for hashes
+    dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+    
+    //publish hashes
+    [self publish:ItemStageHashes];
+    
+    //end span
+    traceEnd(&span, traceFileSize(self.path));
+    
+    return;
+}
+
+//publish a stage
+// window then (re)processes whatever results are available
+-(void)publish:(ItemStage)stage
+{
+    //no window?
+    if(YES != publishes)
+    {
+        //bail
+        return;
+    }
+    
+    //on main thread
+    dispatch_async(dispatch_get_main_queue(), ^{
+        
+        //set stage
+        self.stage = stage;
+        
+        //first (useful) result?
+        // log how long it took to get here
+        if( (stage >= ItemStageSignature) &&
+            (YES != self->published) )
+        {
+            //set flag
+            self->published = YES;
+            
+            //dbg msg
+            os_log_debug(OS_LOG_DEFAULT, "WYS: time to first result: %.3f seconds", CFAbsoluteTimeGetCurrent() - self->created);
+        }
+        
+        //process
+        [self.windowController processCodeSigningInfo];
+        
+    });
+    
+    return;
+}
+
+//get callback for signing stages
+// saves signing info (as it is so far), then publishes stage
+// note: only for items whose signing info is final once Security is done (i.e. not bundles or disk images)
+-(SigningProgress)signingProgress
+{
+    //no window?
+    // no need for callback
+    if(YES != publishes)
+    {
+        return nil;
+    }
+    
+    return ^(SigningStage stage, NSMutableDictionary* info) {
+        
+        //save
+        self.signingInfo = info;
+        
+        //publish
+        [self publish:(SigningStageSignature == stage) ? ItemStageSignature : ItemStageSigner];
+        
+    };
+}
+
 //item is an app (bundle), verify its binary if:
 // a) no codesigning issues
 // b) has main binary (path)
@@ -165,6 +303,12 @@ bail:
     //array of parsed results
     NSArray* parsedResults = nil;
     
+    //span
+    TraceSpan span = traceBegin("type");
+    
+    //span (for 'file')
+    TraceSpan taskSpan = {0};
+    
     //couldn't access?
     if(YES != [NSFileManager.defaultManager isReadableFileAtPath:self.path])
     {
@@ -204,11 +348,23 @@ bail:
         }
     }
     //not a directory
-    // use the 'file' command, as its more accurate
+    // classify (in-process) via file's magic, as its more accurate
     else
     {
-        //exec 'file' to get file type
-        results = execTask(FILE, @[self.path]);
+        //classify
+        // types match those of the 'file' command
+        localizedType = classifyFile(self.path);
+        if(nil != localizedType)
+        {
+            //done
+            goto bail;
+        }
+        
+        //unrecognized
+        // so fall back to exec'ing 'file' to get file type
+        taskSpan = traceBegin("task.file");
+        results = execTaskWithTimeout(FILE, @[self.path], TASK_TIMEOUT);
+        traceEnd(&taskSpan, [results[STDOUT] length]);
         if( (0 != [results[EXIT_CODE] intValue]) ||
             (0 == [results[STDOUT] length]) )
         {
@@ -245,6 +401,9 @@ bail:
     //set type
     self.type = localizedType;
     
+    //end span
+    traceEnd(&span, 0);
+    
     return;
 }
 
@@ -334,6 +493,9 @@ bail:
 // call in the background
 -(void)generateSigningInfo
 {
+    //span
+    TraceSpan span = traceBegin("signing");
+    
     //dbg msg
     os_log_debug(OS_LOG_DEFAULT, "WYS: generating signing information for %{public}@", self.path);
     
@@ -350,9 +512,23 @@ bail:
     {
         //check
         self.signingInfo = checkPackage(self.path);
-        
-        //add hashes
-        self.hashes = hashFile(self.path);
+    }
+    
+    //and .dmgs
+    // signing info via Sec* APIs, while (also) verifying the image's checksums
+    else if(NSOrderedSame == [self.path.pathExtension caseInsensitiveCompare:@"dmg"])
+    {
+        //verify
+        [self generateDiskImageSigningInfo];
+    }
+
+    //bundles
+    // verify their nested code concurrently, while (also) verifying the bundle itself
+    else if( (nil != self.bundle) &&
+             (YES == [self.bundle.bundlePath isEqualToString:self.path]) )
+    {
+        //verify
+        [self generateBundleSigningInfo];
     }
 
     //extract via Sec* APIs
@@ -360,12 +536,187 @@ bail:
     {
         //extract
         // pass 'YES' to also generate entitlements
-        self.signingInfo = extractSigningInfo(self.path, kSecCSCheckNestedCode | kSecCSEnforceRevocationChecks, YES);
+        self.signingInfo = extractSigningInfoWithProgress(self.path, kSecCSCheckNestedCode | kSecCSEnforceRevocationChecks, YES, [self signingProgress]);
+    }
+    
+    //end span
+    traceEnd(&span, 0);
+    
+    return;
+}
+
+//get signing info for a bundle
+// its nested code is verified (concurrently) in the background, instead of serially by Security
+-(void)generateBundleSigningInfo
+{
+    //nested code
+    NSArray* nestedCode = nil;
+    
+    //nested code results
+    __block NSDictionary* nestedResults = nil;
+    
+    //signing info
+    NSMutableDictionary* info = nil;
+    
+    //flags
+    // for checking bundle itself
+    SecCSFlags flags = kSecCSEnforceRevocationChecks;
+    
+    //group
+    dispatch_group_t group = NULL;
+    
+    //init group
+    group = dispatch_group_create();
+    
+    //find nested code
+    // from bundle's (and nested bundles') nested code seals
+    nestedCode = findNestedCode(self.path);
+    
+    //couldn't find it all?
+    // have Security (serially) check it instead
+    if(nil == nestedCode)
+    {
+        //dbg msg
+        os_log_debug(OS_LOG_DEFAULT, "WYS: couldn't enumerate nested code of %{public}@, so Security will check it", self.path);
+        
+        //add flag
+        flags |= kSecCSCheckNestedCode;
+    }
+    
+    //verify nested code
+    dispatch_group_async(group, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+        
+        //span
+        TraceSpan nestedSpan = traceBegin("nestedCode");
+        
+        //verify
+        nestedResults = verifyNestedCode(nestedCode, kSecCSCheckNestedCode | kSecCSEnforceRevocationChecks);
+        
+        //end span
+        traceEnd(&nestedSpan, 0);
+        
+    });
+    
+    //extract (bundle's own) signing info
+    // pass 'YES' to also generate entitlements
+    // note: stages aren't published, as (only) the bundle's own (successful) status, would briefly show a trusted verdict
+    //       instead, once nested code (and main binary) is checked, they're published together w/ notarization
+    info = extractSigningInfo(self.path, flags, YES);
+    
+    //wait for nested code
+    dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+    
+    //bundle itself is fine, but nested code isn't?
+    // use nested code's status, and note which item failed
+    if( (nil != nestedResults) &&
+        (errSecSuccess == [info[KEY_SIGNATURE_STATUS] intValue]) )
+    {
+        //update status
+        info[KEY_SIGNATURE_STATUS] = nestedResults[KEY_SIGNATURE_STATUS];
         
-        //add hashes
-        self.hashes = hashFile(self.path);
+        //add failed item
+        // relative to bundle, as that's what user cares about
+        info[KEY_SIGNING_NESTED_FAILURE] = [nestedResults[KEY_SIGNING_NESTED_FAILURE] substringFromIndex:MIN(self.path.length + 1, [nestedResults[KEY_SIGNING_NESTED_FAILURE] length])];
     }
     
+    //save
+    // only now, as window might be reading (partial) signing info
+    self.signingInfo = info;
+    
+    return;
+}
+
+//get signing info for a disk image
+// its (UDIF) checksums are verified (concurrently) in the background, while Security checks its signature
+-(void)generateDiskImageSigningInfo
+{
+    //image results
+    __block NSDictionary* imageResults = nil;
+    
+    //signing info
+    NSMutableDictionary* info = nil;
+    
+    //partitions that failed checksums
+    NSMutableArray* failed = nil;
+    
+    //group
+    dispatch_group_t group = NULL;
+    
+    //init group
+    group = dispatch_group_create();
+    
+    //verify image
+    dispatch_group_async(group, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+        
+        //span
+        TraceSpan imageSpan = traceBegin("diskImage");
+        
+        //verify
+        imageResults = [[[UdifImage alloc] init:self.path] verify];
+        
+        //end span
+        traceEnd(&imageSpan, traceFileSize(self.path));
+        
+    });
+    
+    //extract (image's) signing info
+    // note: like bundles, stages aren't published until checksums are merged in
+    info = extractSigningInfo(self.path, kSecCSCheckNestedCode | kSecCSEnforceRevocationChecks, YES);
+    
+    //wait for image
+    dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+    
+    //save image results
+    if(nil != imageResults)
+    {
+        //save
+        info[KEY_DISKIMAGE] = imageResults;
+        
+        //init
+        failed = [NSMutableArray array];
+        
+        //data fork failed?
+        if(errSecCSSignatureFailed == [imageResults[KEY_DISKIMAGE_DATA_FORK] intValue])
+        {
+            //add
+            [failed addObject:NSLocalizedString(@"data fork", @"data fork")];
+        }
+        
+        //find any partitions that failed
+        // note: unsupported chunks/checksums are just skipped
+        for(NSDictionary* partition in imageResults[KEY_DISKIMAGE_PARTITIONS])
+        {
+            //failed?
+            if(errSecCSSignatureFailed == [partition[KEY_COMPONENT_EXTRACTED] intValue])
+            {
+                //add
+                [failed addObject:partition[KEY_COMPONENT_NAME]];
+            }
+        }
+        
+        //any failed?
+        // image is corrupt (or was modified), so report (like a bundle's modified resources)
+        if(0 != failed.count)
+        {
+            //dbg msg
+            os_log_debug(OS_LOG_DEFAULT, "WYS: disk image failed checksums: %{public}@", failed);
+            
+            //signature was ok?
+            // doesn't matter now
+            if(errSecSuccess == [info[KEY_SIGNATURE_STATUS] intValue])
+            {
+                info[KEY_SIGNATURE_STATUS] = [NSNumber numberWithInteger:errSecCSSignatureFailed];
+            }
+            
+            //save
+            info[KEY_SIGNING_RESOURCES] = @{KEY_RESOURCES_MODIFIED:failed};
+        }
+    }
+    
+    //save
+    // only now, as window might be reading (partial) signing info
+    self.signingInfo = info;
+    
     return;
 }
 
@@ -379,6 +730,9 @@ bail:
     //signing info
     NSMutableDictionary* binarySigningInfo = nil;
     
+    //span
+    TraceSpan span = traceBegin("binary");
+    
     //get app binary
     binaryPath = self.bundle.executablePath;
     if(nil == binaryPath)
@@ -420,6 +774,9 @@ bail:
     
 bail:
     
+    //end span
+    traceEnd(&span, traceFileSize(binaryPath));
+    
     return;
 }
 
@@ -0,0 +1,92 @@
+//
+//  MachO.h
+//  WhatsYourSign
+//
+//  Created by Patrick Wardle on 10/17/26.
+//  Copyright (c) 2026 Objective-See. All rights reserved.
+//
+
+#ifndef MachO_h
+#define MachO_h
+
+@import Foundation;
+
+#import <mach/machine.h>
+
+//max # of slices
+// anything more is (likely) not a universal binary (e.g. java class file)
+#define MACHO_MAX_SLICES 16
+
+//max size of load commands
+#define MACHO_MAX_LOAD_COMMANDS_SIZE (16*1024*1024)
+
+//kind of binary
+typedef NS_ENUM(NSInteger, MachOKind)
+{
+    MachOKindNone = 0,
+    MachOKindThin,
+    MachOKindFat,
+    MachOKindFat64
+};
+
+//slice (architecture)
+typedef struct
+{
+    //cpu type
+    cpu_type_t cpuType;
+    
+    //cpu subtype
+    cpu_subtype_t cpuSubType;
+    
+    //offset in file
+    uint64_t offset;
+    
+    //size
+    uint64_t size;
+    
+    //alignment (power of 2)
+    uint32_t align;
+    
+    //64-bit?
+    BOOL is64Bit;
+    
+    //code signature ('LC_CODE_SIGNATURE')
+    // offset is in file (not slice), both are 0 if unsigned
+    uint64_t signatureOffset;
+    uint32_t signatureSize;
+    
+    //invalid?
+    // e.g. out of bounds, or not a mach-o, so it's skipped when picking best slice
+    BOOL invalid;
+
+} MachOSlice;
+
+//index of a (thin or universal) binary
+typedef struct
+{
+    //kind
+    MachOKind kind;
+    
+    //# of slices
+    uint32_t count;
+    
+    //slices
+    MachOSlice slices[MACHO_MAX_SLICES];
+
+} MachOIndex;
+
+/* FUNCTIONS */
+
+//build index of a binary
+// only reads its headers and load commands
+// note: (fat) slices that can't be parsed are flagged as invalid, as long as one is valid
+BOOL machoIndexFile(int fd, MachOIndex* index);
+
+//build index of a binary, via its path
+BOOL machoIndexPath(NSString* path, MachOIndex* index);
+
+//find slice the loader would pick
+// for thin binaries, this is just the (only) slice; invalid slices are skipped
+const MachOSlice* machoBestSlice(const MachOIndex* index);
+
+#endif /* MachO_h */
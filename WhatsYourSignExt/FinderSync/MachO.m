@@ -0,0 +1,481 @@
+//
+//  MachO.m
+//  FinderSync
+//
+//  Created by Patrick Wardle on 10/17/26.
+//  Copyright (c) 2026 Objective-See. All rights reserved.
+//
+
+#import "MachO.h"
+#import "utilities.h"
+
+#import <fcntl.h>
+#import <unistd.h>
+#import <os/log.h>
+#import <sys/stat.h>
+#import <mach-o/fat.h>
+#import <mach-o/arch.h>
+#import <mach-o/loader.h>
+
+//parse a (thin) mach-o at 'offset'
+// grabs its cpu type, and finds its code signature
+static BOOL parseSlice(int fd, uint64_t offset, MachOSlice* slice)
+{
+    //flag
+    BOOL parsed = NO;
+    
+    //header
+    // big enough for 64-bit
+    struct mach_header_64 header = {0};
+    
+    //swap?
+    BOOL swap = NO;
+    
+    //header size
+    size_t headerSize = 0;
+    
+    //# of load commands
+    uint32_t commandCount = 0;
+    
+    //size of load commands
+    uint32_t commandsSize = 0;
+    
+    //load commands
+    uint8_t* commands = NULL;
+    
+    //current offset (in load commands)
+    uint32_t current = 0;
+    
+    //read header
+    if(YES != readAt(fd, &header, sizeof(header), offset))
+    {
+        //bail
+        goto bail;
+    }
+    
+    //check magic
+    switch(header.magic)
+    {
+        case MH_MAGIC:
+            headerSize = sizeof(struct mach_header);
+            break;
+        
+        case MH_CIGAM:
+            headerSize = sizeof(struct mach_header);
+            swap = YES;
+            break;
+        
+        case MH_MAGIC_64:
+            headerSize = sizeof(struct mach_header_64);
+            slice->is64Bit = YES;
+            break;
+        
+        case MH_CIGAM_64:
+            headerSize = sizeof(struct mach_header_64);
+            slice->is64Bit = YES;
+            swap = YES;
+            break;
+        
+        //not a mach-o
+        default:
+            goto bail;
+    }
+    
+    //init cpu type/subtype
+    // unless already set (from fat header)
+    if(0 == slice->cpuType)
+    {
+        slice->cpuType = (cpu_type_t)(swap ? OSSwapInt32((uint32_t)header.cputype) : (uint32_t)header.cputype);
+        slice->cpuSubType = (cpu_subtype_t)(swap ? OSSwapInt32((uint32_t)header.cpusubtype) : (uint32_t)header.cpusubtype);
+    }
+    
+    //init load command info
+    commandCount = swap ? OSSwapInt32(header.ncmds) : header.ncmds;
+    commandsSize = swap ? OSSwapInt32(header.sizeofcmds) : header.sizeofcmds;
+    
+    //sanity check
+    if(commandsSize > MACHO_MAX_LOAD_COMMANDS_SIZE)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //alloc
+    commands = malloc(commandsSize);
+    if(NULL == commands)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //read load commands
+    if(YES != readAt(fd, commands, commandsSize, offset + headerSize))
+    {
+        //bail
+        goto bail;
+    }
+    
+    //find 'LC_CODE_SIGNATURE'
+    for(uint32_t i = 0; i < commandCount; i++)
+    {
+        //load command
+        struct load_command command = {0};
+        
+        //signature command
+        struct linkedit_data_command signature = {0};
+        
+        //sanity check
+        if(current + sizeof(command) > commandsSize)
+        {
+            break;
+        }
+        
+        //copy out
+        // load commands aren't always aligned
+        memcpy(&command, commands + current, sizeof(command));
+        
+        //swap
+        if(YES == swap)
+        {
+            command.cmd = OSSwapInt32(command.cmd);
+            command.cmdsize = OSSwapInt32(command.cmdsize);
+        }
+        
+        //sanity check
+        if( (command.cmdsize < sizeof(command)) ||
+            (current + command.cmdsize > commandsSize) )
+        {
+            break;
+        }
+        
+        //code signature?
+        if( (LC_CODE_SIGNATURE == command.cmd) &&
+            (command.cmdsize >= sizeof(signature)) )
+        {
+            //copy out
+            memcpy(&signature, commands + current, sizeof(signature));
+            
+            //save
+            // offset is relative to slice
+            slice->signatureOffset = offset + (swap ? OSSwapInt32(signature.dataoff) : signature.dataoff);
+            slice->signatureSize = swap ? OSSwapInt32(signature.datasize) : signature.datasize;
+            
+            break;
+        }
+        
+        //next
+        current += command.cmdsize;
+    }
+    
+    //happy
+    parsed = YES;
+
+bail:
+    
+    //free
+    if(NULL != commands)
+    {
+        free(commands);
+        commands = NULL;
+    }
+    
+    return parsed;
+}
+
+//build index of a binary
+// only reads its headers and load commands
+BOOL machoIndexFile(int fd, MachOIndex* index)
+{
+    //flag
+    BOOL indexed = NO;
+    
+    //header
+    struct fat_header header = {0};
+    
+    //file info
+    struct stat info = {0};
+    
+    //arch entry size
+    size_t archSize = 0;
+    
+    //arch entries
+    uint8_t* archs = NULL;
+    
+    //# of valid slices
+    uint32_t validCount = 0;
+    
+    //reset
+    memset(index, 0, sizeof(MachOIndex));
+    
+    //get file info
+    if(0 != fstat(fd, &info))
+    {
+        //bail
+        goto bail;
+    }
+    
+    //read (fat) header
+    if(YES != readAt(fd, &header, sizeof(header), 0))
+    {
+        //bail
+        goto bail;
+    }
+    
+    //fat header is always big-endian
+    switch(OSSwapBigToHostInt32(header.magic))
+    {
+        case FAT_MAGIC:
+            index->kind = MachOKindFat;
+            archSize = sizeof(struct fat_arch);
+            break;
+        
+        case FAT_MAGIC_64:
+            index->kind = MachOKindFat64;
+            archSize = sizeof(struct fat_arch_64);
+            break;
+        
+        //maybe thin?
+        default:
+        {
+            //parse
+            if(YES != parseSlice(fd, 0, &index->slices[0]))
+            {
+                //bail
+                goto bail;
+            }
+            
+            //init
+            index->kind = MachOKindThin;
+            index->count = 1;
+            index->slices[0].size = (uint64_t)info.st_size;
+            
+            //happy
+            indexed = YES;
+            
+            //done
+            goto bail;
+        }
+    }
+    
+    //init count
+    index->count = OSSwapBigToHostInt32(header.nfat_arch);
+    
+    //sanity check
+    if( (0 == index->count) ||
+        (index->count > MACHO_MAX_SLICES) )
+    {
+        //bail
+        goto bail;
+    }
+    
+    //alloc
+    archs = calloc(index->count, archSize);
+    if(NULL == archs)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //read arch entries
+    // these directly follow the fat header
+    if(YES != readAt(fd, archs, index->count * archSize, sizeof(header)))
+    {
+        //bail
+        goto bail;
+    }
+    
+    //parse each slice
+    for(uint32_t i = 0; i < index->count; i++)
+    {
+        //slice
+        MachOSlice* slice = &index->slices[i];
+        
+        //fat arch
+        if(MachOKindFat == index->kind)
+        {
+            //arch
+            struct fat_arch* arch = (struct fat_arch*)(archs + i * archSize);
+            
+            //init
+            slice->cpuType = (cpu_type_t)OSSwapBigToHostInt32((uint32_t)arch->cputype);
+            slice->cpuSubType = (cpu_subtype_t)OSSwapBigToHostInt32((uint32_t)arch->cpusubtype);
+            slice->offset = OSSwapBigToHostInt32(arch->offset);
+            slice->size = OSSwapBigToHostInt32(arch->size);
+            slice->align = OSSwapBigToHostInt32(arch->align);
+        }
+        //fat arch (64)
+        else
+        {
+            //arch
+            struct fat_arch_64* arch = (struct fat_arch_64*)(archs + i * archSize);
+            
+            //init
+            slice->cpuType = (cpu_type_t)OSSwapBigToHostInt32((uint32_t)arch->cputype);
+            slice->cpuSubType = (cpu_subtype_t)OSSwapBigToHostInt32((uint32_t)arch->cpusubtype);
+            slice->offset = OSSwapBigToHostInt64(arch->offset);
+            slice->size = OSSwapBigToHostInt64(arch->size);
+            slice->align = OSSwapBigToHostInt32(arch->align);
+        }
+        
+        //sanity check
+        // then parse slice (note: cpu type/subtype from fat header take precedence)
+        if( (slice->offset > (uint64_t)info.st_size) ||
+            (slice->size > (uint64_t)info.st_size - slice->offset) ||
+            (YES != parseSlice(fd, slice->offset, slice)) )
+        {
+            //dbg msg
+            os_log_debug(OS_LOG_DEFAULT, "WYS: slice %u (cpu type: %d) is invalid, skipping", i, slice->cpuType);
+            
+            //flag
+            // and reset anything parsed
+            slice->invalid = YES;
+            slice->is64Bit = NO;
+            slice->signatureOffset = 0;
+            slice->signatureSize = 0;
+            
+            //next
+            continue;
+        }
+        
+        //valid
+        validCount++;
+    }
+    
+    //happy
+    // if any slice is valid
+    indexed = (0 != validCount);
+
+bail:
+    
+    //free
+    if(NULL != archs)
+    {
+        free(archs);
+        archs = NULL;
+    }
+    
+    //reset on failure
+    if(YES != indexed)
+    {
+        memset(index, 0, sizeof(MachOIndex));
+    }
+    
+    return indexed;
+}
+
+//build index of a binary, via its path
+BOOL machoIndexPath(NSString* path, MachOIndex* index)
+{
+    //flag
+    BOOL indexed = NO;
+    
+    //file descriptor
+    int fd = -1;
+    
+    //open
+    fd = open(path.fileSystemRepresentation, O_RDONLY | O_CLOEXEC);
+    if(-1 == fd)
+    {
+        //reset
+        memset(index, 0, sizeof(MachOIndex));
+        
+        //bail
+        goto bail;
+    }
+    
+    //index
+    indexed = machoIndexFile(fd, index);
+
+bail:
+    
+    //close
+    if(-1 != fd)
+    {
+        close(fd);
+        fd = -1;
+    }
+    
+    return indexed;
+}
+
+//find slice the loader would pick
+// for thin binaries, this is just the (only) slice
+const MachOSlice* machoBestSlice(const MachOIndex* index)
+{
+    //best slice
+    const MachOSlice* bestSlice = NULL;
+    
+    //local architecture
+    const NXArchInfo* localArchitecture = NULL;
+    
+    //archs
+    // host byte order, as expected by 'NXFindBestFatArch'
+    struct fat_arch archs[MACHO_MAX_SLICES] = {0};
+    
+    //best arch
+    struct fat_arch* bestArch = NULL;
+    
+    //slice of each arch
+    // as invalid slices are skipped
+    uint32_t sliceIndices[MACHO_MAX_SLICES] = {0};
+    
+    //# of archs
+    uint32_t archCount = 0;
+    
+    //thin?
+    if(MachOKindThin == index->kind)
+    {
+        //only slice
+        bestSlice = &index->slices[0];
+        
+        //done
+        goto bail;
+    }
+    
+    //not fat?
+    if(0 == index->count)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //get local architecture
+    localArchitecture = NXGetLocalArchInfo();
+    if(NULL == localArchitecture)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //init archs
+    // only cpu type/subtype matter here
+    for(uint32_t i = 0; i < index->count; i++)
+    {
+        //skip invalid
+        if(YES == index->slices[i].invalid)
+        {
+            continue;
+        }
+        
+        //add
+        archs[archCount].cputype = index->slices[i].cpuType;
+        archs[archCount].cpusubtype = index->slices[i].cpuSubType;
+        archs[archCount].align = index->slices[i].align;
+        sliceIndices[archCount++] = i;
+    }
+    
+    //find best
+    bestArch = NXFindBestFatArch(localArchitecture->cputype, localArchitecture->cpusubtype, archs, archCount);
+    if(NULL == bestArch)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //map back to slice
+    bestSlice = &index->slices[sliceIndices[bestArch - archs]];
+
+bail:
+    
+    return bestSlice;
+}
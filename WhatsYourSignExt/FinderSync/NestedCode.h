@@ -0,0 +1,43 @@
+//
+//  NestedCode.h
+//  WhatsYourSign
+//
+//  Created by Patrick Wardle on 10/17/26.
+//  Copyright (c) 2026 Objective-See. All rights reserved.
+//
+
+#ifndef NestedCode_h
+#define NestedCode_h
+
+@import Foundation;
+@import Security;
+
+//max depth of nested bundles
+#define NESTED_CODE_MAX_DEPTH 8
+
+//keys for nested code
+// its path, and its seal (in parent's resource manifest)
+#define KEY_NESTED_PATH @"path"
+#define KEY_NESTED_SEAL @"seal"
+
+/* FUNCTIONS */
+
+//get root of a bundle's (nested) code/resources
+// 'Contents' for apps, current version for frameworks
+NSString* bundleContents(NSString* bundlePath);
+
+//find (all) code nested in a bundle
+// any sealed nested code, wherever it is (e.g. frameworks, helpers, launch services, system extensions, nested apps)
+// returns its path and seal (see 'KEY_NESTED_*'), or nil if it couldn't all be found, in which case Security should check it
+NSArray* findNestedCode(NSString* bundlePath);
+
+//check nested code against its seal
+// it must (still) be the code its parent sealed: satisfying the seal's requirement, and matching its cdhash
+// 'flags' are for validating the nested code itself (e.g. 'kSecCSBasicValidateOnly' to not hash its pages/resources)
+OSStatus checkNestedSeal(NSString* itemPath, NSDictionary* seal, SecCSFlags flags);
+
+//verify (all) code nested in a bundle, concurrently
+// each item against its seal (see 'checkNestedSeal'); stops on first failure, returning its status and path (or nil if all are valid)
+NSDictionary* verifyNestedCode(NSArray* nestedCode, SecCSFlags flags);
+
+#endif /* NestedCode_h */
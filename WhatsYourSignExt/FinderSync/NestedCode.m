@@ -0,0 +1,390 @@
+//
+//  NestedCode.m
+//  FinderSync
+//
+//  Created by Patrick Wardle on 10/17/26.
+//  Copyright (c) 2026 Objective-See. All rights reserved.
+//
+
+#import "consts.h"
+#import "NestedCode.h"
+#import "CodeResources.h"
+
+#import <os/log.h>
+#import <stdatomic.h>
+
+//get root of a bundle's (nested) code/resources
+// 'Contents' for apps, current version for frameworks
+NSString* bundleContents(NSString* bundlePath)
+{
+    //directory flag
+    BOOL isDirectory = NO;
+    
+    //apps, plugins, etc
+    if( (YES == [NSFileManager.defaultManager fileExistsAtPath:[bundlePath stringByAppendingPathComponent:@"Contents"] isDirectory:&isDirectory]) &&
+        (YES == isDirectory) )
+    {
+        return [bundlePath stringByAppendingPathComponent:@"Contents"];
+    }
+    
+    //frameworks
+    if( (YES == [NSFileManager.defaultManager fileExistsAtPath:[bundlePath stringByAppendingPathComponent:@"Versions/Current"] isDirectory:&isDirectory]) &&
+        (YES == isDirectory) )
+    {
+        return [[bundlePath stringByAppendingPathComponent:@"Versions/Current"] stringByResolvingSymlinksInPath];
+    }
+    
+    //flat bundle
+    return bundlePath;
+}
+
+//find nested code
+// from nested code seals (those w/ a cdhash/requirement) in bundle's resource manifest, recursing into nested bundles
+// returns NO if any (nested) bundle's seals couldn't be enumerated, e.g. it has no (v2) manifest, or is too deep
+static BOOL findNested(NSString* bundlePath, NSUInteger depth, NSMutableArray* nestedCode)
+{
+    //flag
+    BOOL complete = NO;
+    
+    //contents
+    NSString* contents = nil;
+    
+    //seals
+    NSDictionary* seals = nil;
+    
+    //too deep?
+    if(depth > NESTED_CODE_MAX_DEPTH)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //get contents
+    contents = [bundleContents(bundlePath) stringByResolvingSymlinksInPath];
+    
+    //get (v2) seals
+    // only these seal nested code by cdhash
+    seals = codeResourcesManifest(bundlePath)[@"files2"];
+    if(YES != [seals isKindOfClass:[NSDictionary class]])
+    {
+        //bail
+        goto bail;
+    }
+    
+    //assume complete
+    complete = YES;
+    
+    //check each seal
+    // sorted, so (first) failure is deterministic
+    for(NSString* name in [seals.allKeys sortedArrayUsingSelector:@selector(compare:)])
+    {
+        //seal
+        NSDictionary* seal = seals[name];
+        
+        //item path
+        NSString* itemPath = [contents stringByAppendingPathComponent:name];
+        
+        //directory flag
+        BOOL isDirectory = NO;
+        
+        //not nested code?
+        if( (YES != [seal isKindOfClass:[NSDictionary class]]) ||
+            ( (nil == seal[@"cdhash"]) && (nil == seal[@"requirement"]) ) )
+        {
+            continue;
+        }
+        
+        //add
+        // w/ its seal, and even if it's gone, so that's caught too
+        [nestedCode addObject:@{KEY_NESTED_PATH:itemPath, KEY_NESTED_SEAL:seal}];
+        
+        //nested bundle?
+        // check it for its own nested code
+        if( (YES == [NSFileManager.defaultManager fileExistsAtPath:itemPath isDirectory:&isDirectory]) &&
+            (YES == isDirectory) &&
+            (YES != findNested(itemPath, depth + 1, nestedCode)) )
+        {
+            //not complete
+            complete = NO;
+        }
+    }
+
+bail:
+    
+    return complete;
+}
+
+//find (all) code nested in a bundle
+// any sealed nested code, wherever it is (e.g. frameworks, helpers, launch services, system extensions, nested apps)
+// returns nil if it couldn't all be found, in which case Security should check it
+NSArray* findNestedCode(NSString* bundlePath)
+{
+    //nested code
+    NSMutableArray* nestedCode = nil;
+    
+    //init
+    nestedCode = [NSMutableArray array];
+    
+    //find
+    if(YES != findNested(bundlePath, 0, nestedCode))
+    {
+        //unset
+        nestedCode = nil;
+    }
+    
+    return nestedCode;
+}
+
+//check nested code against its seal
+// it must (still) be the code its parent sealed: satisfying the seal's requirement, and matching its cdhash
+// 'flags' are for validating the nested code itself (e.g. 'kSecCSBasicValidateOnly' to not hash its pages/resources)
+OSStatus checkNestedSeal(NSString* itemPath, NSDictionary* seal, SecCSFlags flags)
+{
+    //status
+    OSStatus status = errSecCSResourcesInvalid;
+    
+    //static code
+    SecStaticCodeRef staticCode = NULL;
+    
+    //(sealed) requirement
+    SecRequirementRef requirement = NULL;
+    
+    //(sealed) cd hash
+    NSData* sealedHash = nil;
+    
+    //signing details
+    CFDictionaryRef signingDetails = NULL;
+    
+    //(nested code's) cd hashes
+    NSMutableArray* cdHashes = nil;
+    
+    //create requirement
+    // text in (v2) manifests, though it can also be compiled
+    if(YES == [seal[@"requirement"] isKindOfClass:[NSString class]])
+    {
+        status = SecRequirementCreateWithString((__bridge CFStringRef)seal[@"requirement"], kSecCSDefaultFlags, &requirement);
+    }
+    else if(YES == [seal[@"requirement"] isKindOfClass:[NSData class]])
+    {
+        status = SecRequirementCreateWithData((__bridge CFDataRef)seal[@"requirement"], kSecCSDefaultFlags, &requirement);
+    }
+    
+    //get cd hash
+    if(YES == [seal[@"cdhash"] isKindOfClass:[NSData class]])
+    {
+        sealedHash = seal[@"cdhash"];
+    }
+    
+    //bad requirement, or nothing to check against?
+    // manifest is authenticated, so it's malformed
+    if( ( (nil != seal[@"requirement"]) && (errSecSuccess != status) ) ||
+        ( (NULL == requirement) && (0 == sealedHash.length) ) )
+    {
+        //set error
+        status = errSecCSResourcesInvalid;
+        
+        //bail
+        goto bail;
+    }
+    
+    //create static code
+    status = SecStaticCodeCreateWithPath((__bridge CFURLRef)[NSURL fileURLWithPath:itemPath], kSecCSDefaultFlags, &staticCode);
+    if(errSecSuccess != status)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //validate
+    // and evaluate (sealed) requirement, so only the code parent sealed passes
+    status = SecStaticCodeCheckValidity(staticCode, flags, requirement);
+    if(errSecSuccess != status)
+    {
+        //other (valid) code?
+        // report as Security does, i.e. nested code was modified
+        if(errSecCSReqFailed == status)
+        {
+            status = errSecCSBadNestedCode;
+        }
+        
+        //bail
+        goto bail;
+    }
+    
+    //no cd hash?
+    // requirement was enough
+    if(0 == sealedHash.length)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //get signing details
+    // for (all of) nested code's cd hashes
+    status = SecCodeCopySigningInformation(staticCode, kSecCSDefaultFlags, &signingDetails);
+    if(errSecSuccess != status)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //init cd hashes
+    // each code directory's, and (truncated) primary one
+    cdHashes = [NSMutableArray arrayWithArray:[((__bridge NSDictionary*)signingDetails)[@"cdhashes-full"] allValues]];
+    if(nil != ((__bridge NSDictionary*)signingDetails)[(__bridge NSString*)kSecCodeInfoUnique])
+    {
+        [cdHashes addObject:((__bridge NSDictionary*)signingDetails)[(__bridge NSString*)kSecCodeInfoUnique]];
+    }
+    
+    //assume mismatch
+    status = errSecCSBadNestedCode;
+    
+    //check each
+    // sealed hash is truncated (to 20 bytes)
+    for(NSData* cdHash in cdHashes)
+    {
+        //match?
+        if( (YES == [cdHash isKindOfClass:[NSData class]]) &&
+            (cdHash.length >= sealedHash.length) &&
+            (0 == memcmp(cdHash.bytes, sealedHash.bytes, sealedHash.length)) )
+        {
+            //happy
+            status = errSecSuccess;
+            break;
+        }
+    }
+    
+bail:
+    
+    //release details
+    if(NULL != signingDetails)
+    {
+        CFRelease(signingDetails);
+        signingDetails = NULL;
+    }
+    
+    //release requirement
+    if(NULL != requirement)
+    {
+        CFRelease(requirement);
+        requirement = NULL;
+    }
+    
+    //release code
+    if(NULL != staticCode)
+    {
+        CFRelease(staticCode);
+        staticCode = NULL;
+    }
+    
+    return status;
+}
+
+//verify items, concurrently
+// each against its seal, returning index of first failure (or NSIntegerMax if all are valid)
+static NSInteger verifyConcurrently(NSArray* items, SecCSFlags flags, OSStatus* statuses)
+{
+    //(index of) first failure
+    _Atomic NSInteger firstFailure = NSIntegerMax;
+    
+    //pointer to first failure
+    // as blocks can't capture atomics by reference
+    _Atomic NSInteger* firstFailurePtr = &firstFailure;
+    
+    //verify each
+    // GCD balances these across all cores
+    dispatch_apply(items.count, DISPATCH_APPLY_AUTO, ^(size_t i)
+    {
+        //status
+        OSStatus status = errSecSuccess;
+        
+        //current (first) failure
+        NSInteger current = 0;
+        
+        //earlier item already failed?
+        // no need to check this one, then
+        if((NSInteger)i > atomic_load(firstFailurePtr))
+        {
+            return;
+        }
+        
+        //check
+        // validates item, and that it's the code its parent sealed
+        status = checkNestedSeal(items[i][KEY_NESTED_PATH], items[i][KEY_NESTED_SEAL], flags);
+        
+        //valid?
+        if(errSecSuccess == status)
+        {
+            return;
+        }
+        
+        //save
+        statuses[i] = status;
+        
+        //save, if earliest
+        current = atomic_load(firstFailurePtr);
+        while( ((NSInteger)i < current) &&
+               (true != atomic_compare_exchange_weak(firstFailurePtr, &current, (NSInteger)i)) ) {}
+    });
+    
+    return atomic_load(&firstFailure);
+}
+
+//verify (all) code nested in a bundle, concurrently
+// stops on first failure, returning its status and path (or nil if all are valid)
+NSDictionary* verifyNestedCode(NSArray* nestedCode, SecCSFlags flags)
+{
+    //result
+    NSDictionary* result = nil;
+    
+    //(index of) first failure
+    NSInteger firstFailure = NSIntegerMax;
+    
+    //statuses
+    // only written by the item's own worker
+    OSStatus* statuses = NULL;
+    
+    //none?
+    if(0 == nestedCode.count)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //dbg msg
+    os_log_debug(OS_LOG_DEFAULT, "WYS: verifying %lu nested item(s)", (unsigned long)nestedCode.count);
+    
+    //alloc statuses
+    statuses = calloc(nestedCode.count, sizeof(OSStatus));
+    if(NULL == statuses)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //verify
+    // nested code is checked directly, so don't have Security (serially) re-check it
+    firstFailure = verifyConcurrently(nestedCode, flags & ~kSecCSCheckNestedCode, statuses);
+    if(NSIntegerMax == firstFailure)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //dbg msg
+    os_log_debug(OS_LOG_DEFAULT, "WYS: nested item %{public}@ failed validation (%d)", nestedCode[firstFailure][KEY_NESTED_PATH], statuses[firstFailure]);
+    
+    //init result
+    result = @{KEY_SIGNATURE_STATUS:[NSNumber numberWithInteger:statuses[firstFailure]], KEY_SIGNING_NESTED_FAILURE:nestedCode[firstFailure][KEY_NESTED_PATH]};
+    
+bail:
+    
+    //free
+    if(NULL != statuses)
+    {
+        free(statuses);
+        statuses = NULL;
+    }
+    
+    return result;
+}
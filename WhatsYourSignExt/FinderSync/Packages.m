@@ -6,9 +6,13 @@
 //  Copyright (c) 2020 Objective-See. All rights reserved.
 //
 
+#import "Xar.h"
 #import "consts.h"
 #import "Signing.h"
+#import "Tickets.h"
 #import "Packages.h"
+#import "Trace.h"
+#import "X509.h"
 #import "utilities.h"
 
 #import <os/log.h>
@@ -48,7 +52,22 @@ NSMutableDictionary* checkPackage(NSString* package)
     PKTrust* pkTrust = nil;
     
     //certificate name
-    CFStringRef certificateName = NULL;
+    NSString* certificateName = nil;
+    
+    //archive (parsed natively)
+    XarArchive* xar = nil;
+    
+    //components
+    NSArray* components = nil;
+    
+    //components that failed checksums
+    NSMutableArray* failed = nil;
+    
+    //span
+    TraceSpan span = traceBegin("checkPackage");
+    
+    //span (for heap)
+    TraceSpan heapSpan = {0};
     
     //dbg msg
     os_log_debug(OS_LOG_DEFAULT, "WYS: checking package (.pkg)...");
@@ -89,18 +108,41 @@ NSMutableDictionary* checkPackage(NSString* package)
         goto bail;
     }
     
-    //sanity check
-    // method: 'verifyReturningError:'
-    if(YES != [archive respondsToSelector:@selector(verifyReturningError:)])
+    //open archive (natively)
+    // for checking its TOC checksum, and all files in its heap
+    xar = [[XarArchive alloc] init:package];
+    if(nil == xar)
     {
-        //bail
-        goto bail;
+        //dbg msg
+        // e.g. TOC uses an encoding/layout the native parser doesn't handle
+        os_log_debug(OS_LOG_DEFAULT, "WYS: failed to (natively) open %{public}@, falling back to PackageKit", package);
+        
+        //sanity check
+        // method: 'verifyReturningError:'
+        if(YES != [archive respondsToSelector:@selector(verifyReturningError:)])
+        {
+            //bail
+            goto bail;
+        }
+        
+        //basic validation
+        // this checks checksum, etc
+        if(YES != [archive verifyReturningError:&error])
+        {
+            //bail
+            goto bail;
+        }
     }
-    
     //basic validation
-    // this checks checksum, etc
-    if(YES != [archive verifyReturningError:&error])
+    // TOC checksum (which is what's signed)
+    else if(YES != [xar verifyChecksum])
     {
+        //dbg msg
+        os_log_debug(OS_LOG_DEFAULT, "WYS: package's TOC checksum doesn't match");
+        
+        //failed
+        info[KEY_SIGNATURE_STATUS] = [NSNumber numberWithInteger:errSecCSSignatureFailed];
+        
         //bail
         goto bail;
     }
@@ -226,6 +268,74 @@ NSMutableDictionary* checkPackage(NSString* package)
     //happily signed
     info[KEY_SIGNATURE_STATUS] = [NSNumber numberWithInteger:errSecSuccess];
     
+    //no native parser?
+    // PackageKit checked the TOC, but components can't be (individually) checked
+    if(nil == xar)
+    {
+        //dbg msg
+        os_log_debug(OS_LOG_DEFAULT, "WYS: skipping component checks of %{public}@", package);
+    }
+    //check each component
+    // i.e. archived & extracted checksums of all files in heap
+    else
+    {
+        //verify
+        heapSpan = traceBegin("package.heap");
+        components = [xar verifyHeap];
+        traceEnd(&heapSpan, traceFileSize(package));
+    }
+    
+    //check components
+    if(nil != components)
+    {
+        //save
+        info[KEY_PACKAGE_COMPONENTS] = components;
+        
+        //init
+        failed = [NSMutableArray array];
+        
+        //find any that failed
+        // note: unsupported encodings/algorithms are just skipped
+        for(NSDictionary* component in components)
+        {
+            //failed?
+            if( (errSecCSSignatureFailed == [component[KEY_COMPONENT_ARCHIVED] intValue]) ||
+                (errSecCSSignatureFailed == [component[KEY_COMPONENT_EXTRACTED] intValue]) )
+            {
+                //add
+                [failed addObject:component[KEY_COMPONENT_NAME]];
+            }
+        }
+        
+        //any failed?
+        // package was modified, so report (like a bundle's modified resources)
+        if(0 != failed.count)
+        {
+            //dbg msg
+            os_log_debug(OS_LOG_DEFAULT, "WYS: package components failed checksums: %{public}@", failed);
+            
+            //failed
+            info[KEY_SIGNATURE_STATUS] = [NSNumber numberWithInteger:errSecCSSignatureFailed];
+            
+            //save
+            info[KEY_SIGNING_RESOURCES] = @{KEY_RESOURCES_MODIFIED:failed};
+        }
+    }
+    //couldn't read heap
+    // components weren't checked, so don't report as (happily) signed
+    else if(nil != xar)
+    {
+        //dbg msg
+        os_log_debug(OS_LOG_DEFAULT, "WYS: failed to read heap of %{public}@", package);
+        
+        //failed
+        info[KEY_SIGNATURE_STATUS] = [NSNumber numberWithInteger:errSecIO];
+    }
+    
+    //register stapled ticket (if any)
+    // allows notarization to be checked, even when offline
+    registerStapledTicket(package);
+    
     //notarized too?
     info[KEY_SIGNING_IS_NOTARIZED] = [NSNumber numberWithInteger:isNotarized(signature)];
     
@@ -236,15 +346,19 @@ NSMutableDictionary* checkPackage(NSString* package)
     for(id certificate in signature.certificateRefs)
     {
         //extract name
-        if(errSecSuccess == SecCertificateCopyCommonName((__bridge SecCertificateRef)certificate, &certificateName))
+        certificateName = x509CommonName((__bridge SecCertificateRef)certificate);
+        if(nil != certificateName)
         {
             //add
-            [info[KEY_SIGNING_AUTHORITIES] addObject:CFBridgingRelease(certificateName)];
+            [info[KEY_SIGNING_AUTHORITIES] addObject:certificateName];
         }
     }
     
 bail:
     
+    //end span
+    traceEnd(&span, traceFileSize(package));
+    
     return info;
 }
 
@@ -254,19 +368,9 @@ OSStatus isNotarized(PKArchiveSignature* signature)
     //flag
     OSStatus isItemNotarized = errSecCSUnsigned;
 
-    //error
-    CFErrorRef error = NULL;
-
     //hash
     NSData* hash = nil;
     
-    //truncated hash
-    // this is what Apple uses
-    NSData* truncatedHash = nil;
-    
-    //algo type
-    SecCSDigestAlgorithm hashType = 0;
-    
     //get hash
     hash = [signature signedDataReturningAlgorithm:0x0];
     if(0 == hash.length)
@@ -274,60 +378,12 @@ OSStatus isNotarized(PKArchiveSignature* signature)
         //bail
         goto bail;
     }
-        
-    //SHA1 hash
-    if(CC_SHA1_DIGEST_LENGTH == hash.length)
-    {
-        //SHA1
-        hashType = kSecCodeSignatureHashSHA1;
-        
-        //use as is
-        truncatedHash = hash;
-    }
-    //SHA256 hash
-    else if(CC_SHA256_DIGEST_LENGTH == hash.length)
-    {
-        //SHA256
-        hashType = kSecCodeSignatureHashSHA256;
-        
-        //truncate, first 20 bytes
-        // this is what the notarization checks requires
-        truncatedHash = [hash subdataWithRange:NSMakeRange(0, CC_SHA1_DIGEST_LENGTH)];
-    }
-    
-    //sanity check
-    if(0 == hashType)
-    {
-        //bail
-        goto bail;
-    }
     
     //notarization check
-    // do online, as we want to also detect revocations
-    if(YES == SecAssessmentTicketLookup((__bridge CFDataRef)(truncatedHash), hashType, kSecAssessmentTicketFlagForceOnlineCheck, NULL, &error))
-    {
-        //set
-        isItemNotarized = errSecSuccess;
-        
-    }
-    //error
-    // but maybe cuz revoked?
-    else
-    {
-        if(error &&
-           (EACCES == CFErrorGetCode(error)) )
-        {
-            //set
-            isItemNotarized = errSecCSRevokedNotarization;
-        }
-    }
+    // online, as we want to also detect revocations (but w/ a deadline, and cached)
+    isItemNotarized = lookupTickets(@[hash], TICKET_LOOKUP_DEADLINE);
     
 bail:
     
-    if(error)
-    {
-        CFRelease(error);
-    }
-
     return isItemNotarized;
 }
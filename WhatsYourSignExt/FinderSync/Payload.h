@@ -0,0 +1,75 @@
+//
+//  Payload.h
+//  WhatsYourSign
+//
+//  Created by Patrick Wardle on 10/17/26.
+//  Copyright (c) 2026 Objective-See. All rights reserved.
+//
+//  note: a pkg's payload is a cpio archive (odc or newc), compressed w/ gzip or pbzx (chunks of xz)
+//        it's decoded in a single, streaming pass, w/ any mach-o's hashed and signature-checked as they go by
+//        (nothing is extracted to disk, and memory use doesn't depend on payload's size)
+
+#ifndef Payload_h
+#define Payload_h
+
+@import Foundation;
+
+//pbzx magic ('pbzx')
+#define PBZX_MAGIC 0x70627a78
+
+//size of buffer for decompression
+#define PAYLOAD_BUFFER_SIZE (256*1024)
+
+//max size of a gzip header
+// fixed fields, plus (optional) extra, name, and comment
+#define PAYLOAD_MAX_GZIP_HEADER 4096
+
+//max length of a (cpio) member's name
+// longer names are truncated
+#define PAYLOAD_MAX_NAME 4096
+
+//size of (member) prefix
+// used to identify mach-o's (and find slices of universal ones)
+#define PAYLOAD_PREFIX_SIZE 1024
+
+//max size of a slice's mach header and load commands
+#define PAYLOAD_MAX_HEAD (64*1024)
+
+//max size of a slice's code signature
+#define PAYLOAD_MAX_SIGNATURE (16*1024*1024)
+
+//(code) page size
+// what codesign uses for macOS
+#define PAYLOAD_PAGE_SIZE 4096
+
+//max # of pages (per slice) that are hashed
+#define PAYLOAD_MAX_PAGES (1024*1024)
+
+//max # of binaries reported (per payload)
+#define PAYLOAD_MAX_BINARIES 4096
+
+//class interface
+@interface PayloadInspector : NSObject
+{
+
+}
+
+/* METHODS */
+
+//process (next) bytes of payload
+// decompresses, walks cpio archive, and checks any mach-o's
+-(void)update:(const uint8_t*)bytes length:(size_t)length;
+
+//finish
+// returns (per-binary) summaries
+-(NSArray*)finish;
+
+/* PROPERTIES */
+
+//binaries
+// summary of each mach-o
+@property(nonatomic, retain)NSMutableArray* binaries;
+
+@end
+
+#endif /* Payload_h */
@@ -0,0 +1,1976 @@
+//
+//  Payload.m
+//  FinderSync
+//
+//  Created by Patrick Wardle on 10/17/26.
+//  Copyright (c) 2026 Objective-See. All rights reserved.
+//
+
+#import "consts.h"
+#import "Payload.h"
+#import "utilities.h"
+#import "CodeSignature.h"
+#import "X509.h"
+
+#import <os/log.h>
+#import <sys/stat.h>
+#import <mach-o/fat.h>
+#import <mach-o/loader.h>
+#import <compression.h>
+#import <Security/CMSDecoder.h>
+#import <CommonCrypto/CommonDigest.h>
+
+//size of a page's hashes
+// sha1 and sha256, as code directory could use either
+#define PAGE_HASHES_SIZE (CC_SHA1_DIGEST_LENGTH + CC_SHA256_DIGEST_LENGTH)
+
+//size of (odc) cpio header
+#define CPIO_ODC_HEADER_SIZE 76
+
+//size of (newc) cpio header
+#define CPIO_NEWC_HEADER_SIZE 110
+
+//payload formats
+typedef NS_ENUM(NSInteger, PayloadFormat)
+{
+    PayloadFormatUnknown = 0,
+    PayloadFormatPBZX,
+    PayloadFormatGzip,
+    PayloadFormatCpio,
+    PayloadFormatUnsupported
+};
+
+//cpio states
+typedef NS_ENUM(NSInteger, CpioState)
+{
+    CpioStateHeader = 0,
+    CpioStateName,
+    CpioStateData,
+    CpioStatePad,
+    CpioStateDone
+};
+
+//slice of a binary
+// state of capturing its header/signature, and hashing its pages
+typedef struct
+{
+    //offset (in file)
+    uint64_t offset;
+    
+    //size
+    uint64_t size;
+    
+    //head
+    // mach header and load commands
+    uint8_t* head;
+    size_t headLength;
+    size_t headSize;
+    
+    //head parsed?
+    BOOL parsed;
+    
+    //head couldn't be parsed?
+    BOOL unparsable;
+    
+    //code signature
+    // offset is in slice (and is where code ends)
+    uint64_t signatureOffset;
+    uint32_t signatureSize;
+    uint8_t* signature;
+    size_t signatureLength;
+    
+    //page hashes
+    uint8_t* pages;
+    uint64_t pageCapacity;
+    uint64_t pageCount;
+    size_t pageFill;
+    CC_SHA1_CTX pageSHA1;
+    CC_SHA256_CTX pageSHA256;
+    
+    //pages can't be verified?
+    BOOL pagesDisabled;
+
+} PayloadSlice;
+
+//parse a (cpio) number
+// fixed-width, octal (odc) or hex (newc)
+static BOOL cpioNumber(const uint8_t* field, size_t width, int base, uint64_t* value)
+{
+    //init
+    *value = 0;
+    
+    //parse
+    for(size_t i = 0; i < width; i++)
+    {
+        //digit
+        int digit = -1;
+        
+        //convert
+        if( (field[i] >= '0') && (field[i] <= '9') )
+        {
+            digit = field[i] - '0';
+        }
+        else if( (16 == base) && (field[i] >= 'a') && (field[i] <= 'f') )
+        {
+            digit = field[i] - 'a' + 10;
+        }
+        else if( (16 == base) && (field[i] >= 'A') && (field[i] <= 'F') )
+        {
+            digit = field[i] - 'A' + 10;
+        }
+        
+        //invalid?
+        if( (digit < 0) ||
+            (digit >= base) )
+        {
+            return NO;
+        }
+        
+        //add
+        *value = (*value * (uint64_t)base) + (uint64_t)digit;
+    }
+    
+    return YES;
+}
+
+//get size of a gzip header
+// returns 0 if more bytes are needed, SIZE_MAX if it's invalid
+static size_t gzipHeaderSize(const uint8_t* header, size_t length)
+{
+    //flags
+    uint8_t flags = 0;
+    
+    //position
+    size_t position = 10;
+    
+    //need fixed fields
+    if(length < 10)
+    {
+        return 0;
+    }
+    
+    //check magic, method (deflate)
+    if( (0x1f != header[0]) ||
+        (0x8b != header[1]) ||
+        (8 != header[2]) )
+    {
+        return SIZE_MAX;
+    }
+    
+    //init flags
+    flags = header[3];
+    
+    //extra?
+    if(0 != (flags & 0x04))
+    {
+        //need length
+        if(position + 2 > length)
+        {
+            return 0;
+        }
+        
+        //skip
+        position += 2 + (header[position] | (header[position + 1] << 8));
+    }
+    
+    //name, comment?
+    // both are NULL-terminated
+    for(uint8_t flag = 0x08; flag <= 0x10; flag <<= 1)
+    {
+        //terminator
+        const uint8_t* terminator = NULL;
+        
+        //not present?
+        if(0 == (flags & flag))
+        {
+            continue;
+        }
+        
+        //need more?
+        if(position >= length)
+        {
+            return 0;
+        }
+        
+        //find end
+        terminator = memchr(header + position, 0, length - position);
+        if(NULL == terminator)
+        {
+            return 0;
+        }
+        
+        //skip
+        position = (size_t)(terminator - header) + 1;
+    }
+    
+    //header crc?
+    if(0 != (flags & 0x02))
+    {
+        position += 2;
+    }
+    
+    //need more?
+    if(position > length)
+    {
+        return 0;
+    }
+    
+    return position;
+}
+
+//finish a page
+// saves its (sha1/sha256) hashes
+static void finishPage(PayloadSlice* slice)
+{
+    //hashes
+    uint8_t* hashes = NULL;
+    
+    //too many?
+    if(slice->pageCount >= slice->pageCapacity)
+    {
+        //can't verify
+        slice->pagesDisabled = YES;
+        return;
+    }
+    
+    //init
+    hashes = slice->pages + slice->pageCount * PAGE_HASHES_SIZE;
+    
+    //save
+    CC_SHA1_Final(hashes, &slice->pageSHA1);
+    CC_SHA256_Final(hashes + CC_SHA1_DIGEST_LENGTH, &slice->pageSHA256);
+    
+    //next
+    slice->pageCount++;
+    slice->pageFill = 0;
+    
+    return;
+}
+
+//hash (code) pages of a slice
+static void hashPages(PayloadSlice* slice, const uint8_t* bytes, size_t length)
+{
+    //process
+    while( (0 != length) &&
+           (YES != slice->pagesDisabled) )
+    {
+        //bytes to hash
+        size_t take = 0;
+        
+        //new page?
+        if(0 == slice->pageFill)
+        {
+            CC_SHA1_Init(&slice->pageSHA1);
+            CC_SHA256_Init(&slice->pageSHA256);
+        }
+        
+        //hash
+        take = MIN(length, PAYLOAD_PAGE_SIZE - slice->pageFill);
+        CC_SHA1_Update(&slice->pageSHA1, bytes, (CC_LONG)take);
+        CC_SHA256_Update(&slice->pageSHA256, bytes, (CC_LONG)take);
+        
+        //update
+        slice->pageFill += take;
+        bytes += take;
+        length -= take;
+        
+        //page done?
+        if(PAYLOAD_PAGE_SIZE == slice->pageFill)
+        {
+            finishPage(slice);
+        }
+    }
+    
+    return;
+}
+
+//parse head of a slice
+// finds code signature (via 'LC_CODE_SIGNATURE'), once header and load commands are in
+static void parseHead(PayloadSlice* slice)
+{
+    //header
+    const struct mach_header* header = NULL;
+    
+    //header size
+    size_t headerSize = 0;
+    
+    //swap?
+    BOOL swap = NO;
+    
+    //# of load commands
+    uint32_t commandCount = 0;
+    
+    //size of load commands
+    uint32_t commandsSize = 0;
+    
+    //current offset (in load commands)
+    size_t current = 0;
+    
+    //need (at least) a header
+    if(slice->headLength < sizeof(struct mach_header_64))
+    {
+        //all there is?
+        if(slice->headLength == slice->headSize)
+        {
+            slice->unparsable = YES;
+        }
+        
+        return;
+    }
+    
+    //init
+    header = (const struct mach_header*)slice->head;
+    
+    //check magic
+    switch(header->magic)
+    {
+        case MH_MAGIC:
+            headerSize = sizeof(struct mach_header);
+            break;
+        
+        case MH_CIGAM:
+            headerSize = sizeof(struct mach_header);
+            swap = YES;
+            break;
+        
+        case MH_MAGIC_64:
+            headerSize = sizeof(struct mach_header_64);
+            break;
+        
+        case MH_CIGAM_64:
+            headerSize = sizeof(struct mach_header_64);
+            swap = YES;
+            break;
+        
+        //not a mach-o
+        default:
+            slice->unparsable = YES;
+            return;
+    }
+    
+    //init load command info
+    commandCount = swap ? OSSwapInt32(header->ncmds) : header->ncmds;
+    commandsSize = swap ? OSSwapInt32(header->sizeofcmds) : header->sizeofcmds;
+    
+    //too big?
+    if(headerSize + commandsSize > PAYLOAD_MAX_HEAD)
+    {
+        slice->unparsable = YES;
+        return;
+    }
+    
+    //need more?
+    if(slice->headLength < headerSize + commandsSize)
+    {
+        //all there is?
+        if(slice->headLength == slice->headSize)
+        {
+            slice->unparsable = YES;
+        }
+        
+        return;
+    }
+    
+    //find 'LC_CODE_SIGNATURE'
+    for(uint32_t i = 0; i < commandCount; i++)
+    {
+        //load command
+        struct load_command command = {0};
+        
+        //signature command
+        struct linkedit_data_command signature = {0};
+        
+        //sanity check
+        if(current + sizeof(command) > commandsSize)
+        {
+            break;
+        }
+        
+        //copy out
+        // load commands aren't always aligned
+        memcpy(&command, slice->head + headerSize + current, sizeof(command));
+        
+        //swap
+        if(YES == swap)
+        {
+            command.cmd = OSSwapInt32(command.cmd);
+            command.cmdsize = OSSwapInt32(command.cmdsize);
+        }
+        
+        //sanity check
+        if( (command.cmdsize < sizeof(command)) ||
+            (current + command.cmdsize > commandsSize) )
+        {
+            break;
+        }
+        
+        //code signature?
+        if( (LC_CODE_SIGNATURE == command.cmd) &&
+            (command.cmdsize >= sizeof(signature)) )
+        {
+            //copy out
+            memcpy(&signature, slice->head + headerSize + current, sizeof(signature));
+            
+            //save
+            slice->signatureOffset = swap ? OSSwapInt32(signature.dataoff) : signature.dataoff;
+            slice->signatureSize = swap ? OSSwapInt32(signature.datasize) : signature.datasize;
+            
+            break;
+        }
+        
+        //next
+        current += command.cmdsize;
+    }
+    
+    //parsed
+    slice->parsed = YES;
+    
+    //unsigned?
+    // or signature is outside slice
+    if( (0 == slice->signatureSize) ||
+        (slice->signatureOffset > slice->size) ||
+        (slice->signatureSize > slice->size - slice->signatureOffset) )
+    {
+        //unset
+        slice->signatureSize = 0;
+        slice->signatureOffset = slice->size;
+        
+        //no need for pages
+        slice->pagesDisabled = YES;
+        
+        return;
+    }
+    
+    //alloc signature
+    // unless too big
+    if(slice->signatureSize <= PAYLOAD_MAX_SIGNATURE)
+    {
+        slice->signature = malloc(slice->signatureSize);
+    }
+    
+    return;
+}
+
+//process (part of) a slice
+// captures its head and signature, and hashes its pages
+static void processSlice(PayloadSlice* slice, const uint8_t* bytes, size_t length, uint64_t position)
+{
+    //start of overlap
+    uint64_t start = MAX(position, slice->offset);
+    
+    //end of overlap
+    uint64_t end = MIN(position + length, slice->offset + slice->size);
+    
+    //offset (in slice)
+    uint64_t offset = 0;
+    
+    //bytes to hash
+    uint64_t hashLength = 0;
+    
+    //no overlap?
+    if(end <= start)
+    {
+        return;
+    }
+    
+    //init
+    offset = start - slice->offset;
+    bytes += start - position;
+    length = (size_t)(end - start);
+    
+    //capture head
+    if( (offset <= slice->headLength) &&
+        (slice->headLength < slice->headSize) &&
+        (NULL != slice->head) )
+    {
+        //bytes to capture
+        size_t take = (size_t)MIN((uint64_t)(slice->headSize - slice->headLength), offset + length - slice->headLength);
+        
+        //copy
+        memcpy(slice->head + slice->headLength, bytes + (slice->headLength - offset), take);
+        slice->headLength += take;
+    }
+    
+    //parse head
+    if( (YES != slice->parsed) &&
+        (YES != slice->unparsable) )
+    {
+        parseHead(slice);
+    }
+    
+    //couldn't parse?
+    if(YES == slice->unparsable)
+    {
+        //can't verify
+        slice->pagesDisabled = YES;
+    }
+    
+    //hash pages
+    // up to signature, which is where code ends (note: before parsing, bytes are all in head)
+    if( (YES != slice->pagesDisabled) &&
+        (offset < ((YES == slice->parsed) ? slice->signatureOffset : slice->size)) )
+    {
+        //init length
+        hashLength = MIN(offset + length, (YES == slice->parsed) ? slice->signatureOffset : slice->size) - offset;
+        
+        //alloc
+        if(NULL == slice->pages)
+        {
+            //init capacity
+            slice->pageCapacity = MIN((slice->size + PAYLOAD_PAGE_SIZE - 1) / PAYLOAD_PAGE_SIZE, (uint64_t)PAYLOAD_MAX_PAGES);
+            
+            //alloc
+            slice->pages = malloc((size_t)slice->pageCapacity * PAGE_HASHES_SIZE);
+            if(NULL == slice->pages)
+            {
+                slice->pagesDisabled = YES;
+            }
+        }
+        
+        //hash
+        if(NULL != slice->pages)
+        {
+            hashPages(slice, bytes, (size_t)hashLength);
+        }
+    }
+    
+    //capture signature
+    if( (NULL != slice->signature) &&
+        (offset + length > slice->signatureOffset) &&
+        (offset < slice->signatureOffset + slice->signatureSize) )
+    {
+        //start (in signature)
+        uint64_t from = MAX(offset, slice->signatureOffset);
+        
+        //end (in signature)
+        uint64_t to = MIN(offset + length, slice->signatureOffset + slice->signatureSize);
+        
+        //copy
+        memcpy(slice->signature + (from - slice->signatureOffset), bytes + (from - offset), (size_t)(to - from));
+        slice->signatureLength += (size_t)(to - from);
+    }
+    
+    return;
+}
+
+//free a slice's buffers
+static void freeSlice(PayloadSlice* slice)
+{
+    //head
+    if(NULL != slice->head)
+    {
+        free(slice->head);
+        slice->head = NULL;
+    }
+    
+    //signature
+    if(NULL != slice->signature)
+    {
+        free(slice->signature);
+        slice->signature = NULL;
+    }
+    
+    //pages
+    if(NULL != slice->pages)
+    {
+        free(slice->pages);
+        slice->pages = NULL;
+    }
+    
+    return;
+}
+
+//verify CMS signature over a code directory
+// on success, adds signing authorities (leaf first)
+static OSStatus verifyCMS(NSData* cms, NSData* codeDirectory, NSMutableArray* authorities)
+{
+    //status
+    OSStatus status = errSecCSSignatureFailed;
+    
+    //decoder
+    CMSDecoderRef decoder = NULL;
+    
+    //policy
+    SecPolicyRef policy = NULL;
+    
+    //trust
+    SecTrustRef trust = NULL;
+    
+    //signer status
+    CMSSignerStatus signerStatus = kCMSSignerUnsigned;
+    
+    //cert verify
+    OSStatus certVerifyResult = 0;
+    
+    //signing time
+    CFAbsoluteTime signingTime = 0;
+    
+    //trust result
+    SecTrustResultType result = kSecTrustResultInvalid;
+    
+    //flag
+    BOOL trusted = NO;
+    
+    //create decoder
+    if(noErr != CMSDecoderCreate(&decoder))
+    {
+        //bail
+        goto bail;
+    }
+    
+    //add message
+    // and its (detached) content, the code directory
+    if( (noErr != CMSDecoderUpdateMessage(decoder, cms.bytes, cms.length)) ||
+        (noErr != CMSDecoderFinalizeMessage(decoder)) ||
+        (noErr != CMSDecoderSetDetachedContent(decoder, (__bridge CFDataRef)codeDirectory)) )
+    {
+        //bail
+        goto bail;
+    }
+    
+    //create policy
+    // code signing, not just basic X.509
+    policy = SecPolicyCreateWithProperties(kSecPolicyAppleCodeSigning, NULL);
+    if(NULL == policy)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //check signer's signature
+    // trust is evaluated below, as of when it was signed
+    if( (noErr != CMSDecoderCopySignerStatus(decoder, 0, policy, FALSE, &signerStatus, &trust, &certVerifyResult)) ||
+        (kCMSSignerValid != signerStatus) ||
+        (NULL == trust) )
+    {
+        //bail
+        goto bail;
+    }
+    
+    //get signing time
+    // (secure) timestamp, else signing time, as (since) expired certs are fine if they were valid then
+    if( (noErr == CMSDecoderCopySignerTimestamp(decoder, 0, &signingTime)) ||
+        (noErr == CMSDecoderCopySignerSigningTime(decoder, 0, &signingTime)) )
+    {
+        //set
+        SecTrustSetVerifyDate(trust, (__bridge CFDateRef)[NSDate dateWithTimeIntervalSinceReferenceDate:signingTime]);
+    }
+    
+    //evaluate
+    if(@available(macOS 10.14, *))
+    {
+        trusted = SecTrustEvaluateWithError(trust, NULL);
+    }
+    else
+    {
+        trusted = ( (errSecSuccess == SecTrustEvaluate(trust, &result)) &&
+                    ((kSecTrustResultProceed == result) || (kSecTrustResultUnspecified == result)) );
+    }
+    
+    //not trusted?
+    if(YES != trusted)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //extract names
+    for(CFIndex i = 0; i < SecTrustGetCertificateCount(trust); i++)
+    {
+        //name
+        NSString* name = x509CommonName(SecTrustGetCertificateAtIndex(trust, i));
+        
+        //add
+        if(nil != name)
+        {
+            [authorities addObject:name];
+        }
+    }
+    
+    //happy
+    status = errSecSuccess;
+
+bail:
+    
+    //release trust
+    if(NULL != trust)
+    {
+        CFRelease(trust);
+        trust = NULL;
+    }
+    
+    //release policy
+    if(NULL != policy)
+    {
+        CFRelease(policy);
+        policy = NULL;
+    }
+    
+    //release decoder
+    if(NULL != decoder)
+    {
+        CFRelease(decoder);
+        decoder = NULL;
+    }
+    
+    return status;
+}
+
+//check a slice
+// its code directory, page hashes, and CMS signature
+static OSStatus checkSlice(PayloadSlice* slice, NSMutableDictionary* binary)
+{
+    //status
+    OSStatus status = errSecCSUnimplemented;
+    
+    //signature
+    NSData* signature = nil;
+    
+    //code directory
+    NSData* codeDirectory = nil;
+    
+    //its header
+    const CodeDirectory* header = NULL;
+    
+    //CMS blob
+    NSData* cms = nil;
+    
+    //authorities
+    NSMutableArray* authorities = nil;
+    
+    //offsets
+    uint32_t identOffset = 0;
+    uint32_t teamOffset = 0;
+    uint32_t hashOffset = 0;
+    
+    //# of code pages
+    uint32_t pageCount = 0;
+    
+    //code limit
+    uint64_t codeLimit = 0;
+    
+    //cd hash
+    uint8_t cdHash[CC_SHA256_DIGEST_LENGTH] = {0};
+    
+    //couldn't parse?
+    if(YES != slice->parsed)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //unsigned?
+    if(0 == slice->signatureSize)
+    {
+        //unsigned
+        status = errSecCSUnsigned;
+        
+        //bail
+        goto bail;
+    }
+    
+    //not (fully) captured?
+    // e.g. too big
+    if( (NULL == slice->signature) ||
+        (slice->signatureLength != slice->signatureSize) )
+    {
+        //bail
+        goto bail;
+    }
+    
+    //init
+    // only valid while slice is
+    signature = [NSData dataWithBytesNoCopy:slice->signature length:slice->signatureSize freeWhenDone:NO];
+    
+    //from here on, bad means failed
+    status = errSecCSSignatureFailed;
+    
+    //check magic
+    if( (signature.length < 12) ||
+        (CODESIGN_MAGIC_EMBEDDED_SIGNATURE != OSReadBigInt32(signature.bytes, 0)) )
+    {
+        //bail
+        goto bail;
+    }
+    
+    //get (primary) code directory
+    // as it's what the CMS signature covers
+    codeDirectory = codeSignatureBlob(signature, CODESIGN_SLOT_CODEDIRECTORY);
+    if(codeDirectory.length < offsetof(CodeDirectory, scatterOffset))
+    {
+        //bail
+        goto bail;
+    }
+    
+    //init
+    header = codeDirectory.bytes;
+    identOffset = OSSwapBigToHostInt32(header->identOffset);
+    hashOffset = OSSwapBigToHostInt32(header->hashOffset);
+    pageCount = OSSwapBigToHostInt32(header->nCodeSlots);
+    codeLimit = OSSwapBigToHostInt32(header->codeLimit);
+    
+    //check magic
+    if(CODESIGN_MAGIC_CODEDIRECTORY != OSSwapBigToHostInt32(header->magic))
+    {
+        //bail
+        goto bail;
+    }
+    
+    //64-bit code limit?
+    if( (OSSwapBigToHostInt32(header->version) >= CODESIGN_SUPPORTS_CODELIMIT64) &&
+        (codeDirectory.length >= sizeof(CodeDirectory)) &&
+        (0 != header->codeLimit64) )
+    {
+        //use
+        codeLimit = OSSwapBigToHostInt64(header->codeLimit64);
+    }
+    
+    //save identifier
+    // first slice wins
+    if( (nil == binary[KEY_BINARY_IDENTIFIER]) &&
+        (identOffset < codeDirectory.length) )
+    {
+        binary[KEY_BINARY_IDENTIFIER] = [[NSString alloc] initWithBytes:(const char*)codeDirectory.bytes + identOffset length:strnlen((const char*)codeDirectory.bytes + identOffset, codeDirectory.length - identOffset) encoding:NSUTF8StringEncoding];
+    }
+    
+    //save team id
+    if( (nil == binary[KEY_BINARY_TEAM_ID]) &&
+        (OSSwapBigToHostInt32(header->version) >= CODESIGN_SUPPORTS_TEAMID) &&
+        (codeDirectory.length >= offsetof(CodeDirectory, spare3)) )
+    {
+        //init
+        teamOffset = OSSwapBigToHostInt32(header->teamOffset);
+        
+        //save
+        if( (0 != teamOffset) &&
+            (teamOffset < codeDirectory.length) )
+        {
+            binary[KEY_BINARY_TEAM_ID] = [[NSString alloc] initWithBytes:(const char*)codeDirectory.bytes + teamOffset length:strnlen((const char*)codeDirectory.bytes + teamOffset, codeDirectory.length - teamOffset) encoding:NSUTF8StringEncoding];
+        }
+    }
+    
+    //save cd hash
+    // code directory's hash, truncated to 20 bytes
+    if(nil == binary[KEY_BINARY_CDHASH])
+    {
+        //sha1
+        if(CODESIGN_HASHTYPE_SHA1 == header->hashType)
+        {
+            CC_SHA1(codeDirectory.bytes, (CC_LONG)codeDirectory.length, cdHash);
+        }
+        //sha256
+        else
+        {
+            CC_SHA256(codeDirectory.bytes, (CC_LONG)codeDirectory.length, cdHash);
+        }
+        
+        //save
+        binary[KEY_BINARY_CDHASH] = bytesToHex(cdHash, CC_SHA1_DIGEST_LENGTH, YES);
+    }
+    
+    //can verify pages?
+    // have hashes of all, w/ same page size/code limit, in a supported hash type
+    if( (YES != slice->pagesDisabled) &&
+        (12 == header->pageSize) &&
+        (codeLimit == slice->signatureOffset) &&
+        (pageCount == slice->pageCount) &&
+        ( ((CODESIGN_HASHTYPE_SHA1 == header->hashType) && (CC_SHA1_DIGEST_LENGTH == header->hashSize)) ||
+          ((CODESIGN_HASHTYPE_SHA256 == header->hashType) && (CC_SHA256_DIGEST_LENGTH == header->hashSize)) ) &&
+        ((uint64_t)hashOffset + (uint64_t)pageCount * header->hashSize <= codeDirectory.length) )
+    {
+        //check each
+        for(uint32_t i = 0; i < pageCount; i++)
+        {
+            //(computed) hash
+            const uint8_t* hash = slice->pages + (uint64_t)i * PAGE_HASHES_SIZE + ((CODESIGN_HASHTYPE_SHA1 == header->hashType) ? 0 : CC_SHA1_DIGEST_LENGTH);
+            
+            //mismatch?
+            if(0 != memcmp(hash, (const uint8_t*)codeDirectory.bytes + hashOffset + (uint64_t)i * header->hashSize, header->hashSize))
+            {
+                //dbg msg
+                os_log_debug(OS_LOG_DEFAULT, "WYS: payload binary %{public}@, page %u was modified", binary[KEY_BINARY_PATH], i);
+                
+                //bail
+                goto bail;
+            }
+        }
+        
+        //(all) pages verified
+        // note: unless another slice couldn't be
+        if(nil == binary[KEY_BINARY_PAGES_VERIFIED])
+        {
+            binary[KEY_BINARY_PAGES_VERIFIED] = @YES;
+        }
+    }
+    //couldn't verify
+    else
+    {
+        binary[KEY_BINARY_PAGES_VERIFIED] = @NO;
+    }
+    
+    //get CMS blob
+    // wrapper's header is magic and length
+    cms = codeSignatureBlob(signature, CODESIGN_SLOT_SIGNATURE);
+    
+    //none, or empty?
+    // ad-hoc signed, so (like unsigned) there's no signer to trust
+    if( (cms.length <= 8) ||
+        (CODESIGN_MAGIC_BLOBWRAPPER != OSReadBigInt32(cms.bytes, 0)) )
+    {
+        //flag
+        binary[KEY_BINARY_ADHOC] = @YES;
+        
+        //ad-hoc
+        status = errSecCSUnsigned;
+        
+        //done
+        goto bail;
+    }
+    
+    //init
+    authorities = [NSMutableArray array];
+    
+    //verify
+    status = verifyCMS([cms subdataWithRange:NSMakeRange(8, cms.length - 8)], codeDirectory, authorities);
+    if(errSecSuccess != status)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //save authorities
+    // first slice wins
+    if(nil == binary[KEY_SIGNING_AUTHORITIES])
+    {
+        binary[KEY_SIGNING_AUTHORITIES] = authorities;
+    }
+
+bail:
+    
+    return status;
+}
+
+//class implementation
+@implementation PayloadInspector
+{
+    //format
+    PayloadFormat format;
+    
+    //leading bytes
+    // used to detect format
+    uint8_t magic[4];
+    size_t magicLength;
+    
+    //failed?
+    // (rest of) payload is ignored
+    BOOL failed;
+    
+    //gzip header
+    uint8_t* gzipHeader;
+    size_t gzipHeaderLength;
+    BOOL gzipHeaderDone;
+    
+    //pbzx header
+    // file header, then each chunk's (flags, length)
+    uint8_t pbzxHeader[16];
+    size_t pbzxHeaderLength;
+    BOOL pbzxStarted;
+    
+    //pbzx chunk
+    uint64_t chunkRemaining;
+    BOOL chunkPlain;
+    
+    //decompression
+    compression_stream stream;
+    BOOL streaming;
+    BOOL streamEnded;
+    uint8_t* output;
+    
+    //cpio state
+    CpioState state;
+    
+    //cpio header
+    uint8_t header[CPIO_NEWC_HEADER_SIZE];
+    size_t headerLength;
+    size_t headerSize;
+    BOOL newc;
+    
+    //cpio (member) name
+    char name[PAYLOAD_MAX_NAME];
+    size_t nameLength;
+    uint64_t nameRemaining;
+    
+    //cpio (member) data
+    uint64_t dataRemaining;
+    size_t padRemaining;
+    uint64_t mode;
+    
+    //member
+    uint64_t memberSize;
+    uint64_t memberPosition;
+    
+    //member prefix
+    uint8_t prefix[PAYLOAD_PREFIX_SIZE];
+    size_t prefixLength;
+    size_t prefixSize;
+    
+    //member identified?
+    BOOL identified;
+    
+    //member is a binary?
+    BOOL isBinary;
+    
+    //binary's (file) hash
+    CC_SHA256_CTX sha256;
+    
+    //binary's slices
+    PayloadSlice slices[MACHO_MAX_SLICES];
+    uint32_t sliceCount;
+    
+    //# of binaries found
+    NSUInteger binaryCount;
+}
+
+@synthesize binaries;
+
+//init
+-(instancetype)init
+{
+    //init
+    if(self = [super init])
+    {
+        //init
+        self.binaries = [NSMutableArray array];
+        
+        //alloc buffer
+        output = malloc(PAYLOAD_BUFFER_SIZE);
+        if(NULL == output)
+        {
+            //bail
+            return nil;
+        }
+    }
+    
+    return self;
+}
+
+//process (next) bytes of payload
+// decompresses, walks cpio archive, and checks any mach-o's
+-(void)update:(const uint8_t*)bytes length:(size_t)length
+{
+    //bytes to take
+    size_t take = 0;
+    
+    //failed?
+    if(YES == failed)
+    {
+        return;
+    }
+    
+    //format unknown?
+    // grab (enough) leading bytes
+    if(PayloadFormatUnknown == format)
+    {
+        //take
+        take = MIN(length, sizeof(magic) - magicLength);
+        memcpy(magic + magicLength, bytes, take);
+        magicLength += take;
+        bytes += take;
+        length -= take;
+        
+        //need more?
+        if(magicLength < sizeof(magic))
+        {
+            return;
+        }
+        
+        //pbzx
+        if(PBZX_MAGIC == OSReadBigInt32(magic, 0))
+        {
+            format = PayloadFormatPBZX;
+        }
+        //gzip
+        else if( (0x1f == magic[0]) && (0x8b == magic[1]) )
+        {
+            format = PayloadFormatGzip;
+        }
+        //(uncompressed) cpio
+        else if(0 == memcmp(magic, "0707", 4))
+        {
+            format = PayloadFormatCpio;
+        }
+        //unsupported
+        else
+        {
+            //dbg msg
+            os_log_debug(OS_LOG_DEFAULT, "WYS: unsupported payload format");
+            
+            //failed
+            failed = YES;
+            return;
+        }
+        
+        //process leading bytes
+        [self decode:magic length:sizeof(magic)];
+    }
+    
+    //process
+    [self decode:bytes length:length];
+    
+    return;
+}
+
+//decode payload
+// based on its format
+-(void)decode:(const uint8_t*)bytes length:(size_t)length
+{
+    //process
+    switch(format)
+    {
+        case PayloadFormatPBZX:
+            [self pbzx:bytes length:length];
+            break;
+        
+        case PayloadFormatGzip:
+            [self gzip:bytes length:length];
+            break;
+        
+        case PayloadFormatCpio:
+            [self cpio:bytes length:length];
+            break;
+        
+        default:
+            break;
+    }
+    
+    return;
+}
+
+//decompress bytes
+// output is passed on to cpio
+-(void)inflate:(const uint8_t*)bytes length:(size_t)length algorithm:(compression_algorithm)algorithm finalize:(BOOL)finalize
+{
+    //status
+    compression_status status = COMPRESSION_STATUS_OK;
+    
+    //done, failed, or nothing to do?
+    if( (YES == streamEnded) ||
+        (YES == failed) ||
+        ( (0 == length) && (YES != finalize) ) )
+    {
+        return;
+    }
+    
+    //init stream
+    if(YES != streaming)
+    {
+        //init
+        if(COMPRESSION_STATUS_OK != compression_stream_init(&stream, COMPRESSION_STREAM_DECODE, algorithm))
+        {
+            //failed
+            failed = YES;
+            return;
+        }
+        
+        //set flag
+        streaming = YES;
+    }
+    
+    //init input
+    stream.src_ptr = bytes;
+    stream.src_size = length;
+    
+    //decompress
+    // until input is consumed, and output buffer isn't full
+    do
+    {
+        //init output
+        stream.dst_ptr = output;
+        stream.dst_size = PAYLOAD_BUFFER_SIZE;
+        
+        //decompress
+        status = compression_stream_process(&stream, (YES == finalize) ? COMPRESSION_STREAM_FINALIZE : 0);
+        if(COMPRESSION_STATUS_ERROR == status)
+        {
+            //dbg msg
+            os_log_debug(OS_LOG_DEFAULT, "WYS: failed to decompress payload");
+            
+            //failed
+            failed = YES;
+            break;
+        }
+        
+        //process
+        [self cpio:output length:PAYLOAD_BUFFER_SIZE - stream.dst_size];
+        
+        //end of stream?
+        if(COMPRESSION_STATUS_END == status)
+        {
+            //set flag
+            streamEnded = YES;
+            break;
+        }
+    
+    } while( (0 != stream.src_size) ||
+             (0 == stream.dst_size) );
+    
+    return;
+}
+
+//end (current) decompression stream
+-(void)endStream
+{
+    //destroy
+    if(YES == streaming)
+    {
+        compression_stream_destroy(&stream);
+        streaming = NO;
+    }
+    
+    //reset
+    streamEnded = NO;
+    
+    return;
+}
+
+//process gzip'd payload
+// skip (variable-length) header, then inflate
+-(void)gzip:(const uint8_t*)bytes length:(size_t)length
+{
+    //bytes to take
+    size_t take = 0;
+    
+    //header size
+    size_t size = 0;
+    
+    //header done?
+    if(YES == gzipHeaderDone)
+    {
+        //inflate
+        [self inflate:bytes length:length algorithm:COMPRESSION_ZLIB finalize:NO];
+        
+        return;
+    }
+    
+    //alloc header
+    if(NULL == gzipHeader)
+    {
+        //alloc
+        gzipHeader = malloc(PAYLOAD_MAX_GZIP_HEADER);
+        if(NULL == gzipHeader)
+        {
+            //failed
+            failed = YES;
+            return;
+        }
+    }
+    
+    //take
+    take = MIN(length, PAYLOAD_MAX_GZIP_HEADER - gzipHeaderLength);
+    memcpy(gzipHeader + gzipHeaderLength, bytes, take);
+    gzipHeaderLength += take;
+    bytes += take;
+    length -= take;
+    
+    //get header size
+    size = gzipHeaderSize(gzipHeader, gzipHeaderLength);
+    
+    //invalid, or too big?
+    if( (SIZE_MAX == size) ||
+        ( (0 == size) && (PAYLOAD_MAX_GZIP_HEADER == gzipHeaderLength) ) )
+    {
+        //failed
+        failed = YES;
+        return;
+    }
+    
+    //need more?
+    if(0 == size)
+    {
+        return;
+    }
+    
+    //done w/ header
+    gzipHeaderDone = YES;
+    
+    //inflate what's after header
+    // then (rest of) input
+    [self inflate:gzipHeader + size length:gzipHeaderLength - size algorithm:COMPRESSION_ZLIB finalize:NO];
+    [self inflate:bytes length:length algorithm:COMPRESSION_ZLIB finalize:NO];
+    
+    //free header
+    free(gzipHeader);
+    gzipHeader = NULL;
+    
+    return;
+}
+
+//process pbzx payload
+// header ('pbzx', flags), then chunks (flags, length, data), each xz compressed or plain
+-(void)pbzx:(const uint8_t*)bytes length:(size_t)length
+{
+    //process
+    while( (0 != length) &&
+           (YES != failed) )
+    {
+        //bytes to take
+        size_t take = 0;
+        
+        //in a chunk?
+        if(0 != chunkRemaining)
+        {
+            //take
+            take = (size_t)MIN((uint64_t)length, chunkRemaining);
+            
+            //plain?
+            if(YES == chunkPlain)
+            {
+                [self cpio:bytes length:take];
+            }
+            //xz
+            else
+            {
+                [self inflate:bytes length:take algorithm:COMPRESSION_LZMA finalize:NO];
+            }
+            
+            //update
+            chunkRemaining -= take;
+            bytes += take;
+            length -= take;
+            
+            //end of (xz) chunk?
+            // each is its own stream
+            if( (0 == chunkRemaining) &&
+                (YES != chunkPlain) )
+            {
+                //flush
+                [self inflate:NULL length:0 algorithm:COMPRESSION_LZMA finalize:YES];
+                
+                //end
+                [self endStream];
+            }
+            
+            continue;
+        }
+        
+        //grab (next) header
+        // file header is 'pbzx' and flags, chunk header is flags and length
+        take = MIN(length, ((YES == pbzxStarted) ? 16 : 12) - pbzxHeaderLength);
+        memcpy(pbzxHeader + pbzxHeaderLength, bytes, take);
+        pbzxHeaderLength += take;
+        bytes += take;
+        length -= take;
+        
+        //need more?
+        if(pbzxHeaderLength < ((YES == pbzxStarted) ? 16 : 12))
+        {
+            continue;
+        }
+        
+        //file header?
+        if(YES != pbzxStarted)
+        {
+            //set flag
+            pbzxStarted = YES;
+        }
+        //chunk header
+        else
+        {
+            //init chunk
+            // plain (stored) if its length is its uncompressed size (flags)
+            chunkRemaining = OSReadBigInt64(pbzxHeader, 8);
+            chunkPlain = (OSReadBigInt64(pbzxHeader, 0) == chunkRemaining);
+        }
+        
+        //reset
+        pbzxHeaderLength = 0;
+    }
+    
+    return;
+}
+
+//process cpio archive
+// walks members (header, name, data), handing data of regular files off
+-(void)cpio:(const uint8_t*)bytes length:(size_t)length
+{
+    //process
+    while( (0 != length) &&
+           (YES != failed) &&
+           (CpioStateDone != state) )
+    {
+        //bytes to take
+        size_t take = 0;
+        
+        switch(state)
+        {
+            //header
+            case CpioStateHeader:
+            {
+                //need magic first
+                // to know format (and so header size)
+                if(0 == headerSize)
+                {
+                    //take
+                    take = MIN(length, 6 - headerLength);
+                    memcpy(header + headerLength, bytes, take);
+                    headerLength += take;
+                    bytes += take;
+                    length -= take;
+                    
+                    //need more?
+                    if(headerLength < 6)
+                    {
+                        break;
+                    }
+                    
+                    //odc
+                    if(0 == memcmp(header, "070707", 6))
+                    {
+                        headerSize = CPIO_ODC_HEADER_SIZE;
+                        newc = NO;
+                    }
+                    //newc
+                    else if( (0 == memcmp(header, "070701", 6)) ||
+                             (0 == memcmp(header, "070702", 6)) )
+                    {
+                        headerSize = CPIO_NEWC_HEADER_SIZE;
+                        newc = YES;
+                    }
+                    //invalid
+                    else
+                    {
+                        //dbg msg
+                        os_log_debug(OS_LOG_DEFAULT, "WYS: invalid cpio header in payload");
+                        
+                        //failed
+                        failed = YES;
+                        break;
+                    }
+                }
+                
+                //take
+                take = MIN(length, headerSize - headerLength);
+                memcpy(header + headerLength, bytes, take);
+                headerLength += take;
+                bytes += take;
+                length -= take;
+                
+                //need more?
+                if(headerLength < headerSize)
+                {
+                    break;
+                }
+                
+                //parse
+                [self parseHeader];
+                
+                break;
+            }
+            
+            //name
+            case CpioStateName:
+            {
+                //take
+                take = (size_t)MIN((uint64_t)length, nameRemaining);
+                
+                //save
+                // (truncated) if too long
+                if(nameLength < sizeof(name))
+                {
+                    memcpy(name + nameLength, bytes, MIN(take, sizeof(name) - nameLength));
+                    nameLength += MIN(take, sizeof(name) - nameLength);
+                }
+                
+                //update
+                nameRemaining -= take;
+                bytes += take;
+                length -= take;
+                
+                //need more?
+                if(0 != nameRemaining)
+                {
+                    break;
+                }
+                
+                //start member
+                [self startMember];
+                
+                break;
+            }
+            
+            //data
+            case CpioStateData:
+            {
+                //take
+                take = (size_t)MIN((uint64_t)length, dataRemaining);
+                
+                //process
+                [self memberData:bytes length:take];
+                
+                //update
+                dataRemaining -= take;
+                bytes += take;
+                length -= take;
+                
+                //done?
+                if(0 == dataRemaining)
+                {
+                    //end member
+                    [self endMember];
+                    
+                    //padding (newc)
+                    padRemaining = (YES == newc) ? (size_t)((4 - (memberSize % 4)) % 4) : 0;
+                    state = (0 != padRemaining) ? CpioStatePad : CpioStateHeader;
+                }
+                
+                break;
+            }
+            
+            //padding
+            case CpioStatePad:
+            {
+                //skip
+                take = MIN(length, padRemaining);
+                padRemaining -= take;
+                bytes += take;
+                length -= take;
+                
+                //done?
+                if(0 == padRemaining)
+                {
+                    state = CpioStateHeader;
+                }
+                
+                break;
+            }
+            
+            default:
+                break;
+        }
+    }
+    
+    return;
+}
+
+//parse (complete) cpio header
+// grab mode, name size and file size
+-(void)parseHeader
+{
+    //name size
+    uint64_t nameSize = 0;
+    
+    //odc
+    // octal: magic(6) dev(6) ino(6) mode(6) uid(6) gid(6) nlink(6) rdev(6) mtime(11) namesize(6) filesize(11)
+    if(YES != newc)
+    {
+        if( (YES != cpioNumber(header + 18, 6, 8, &mode)) ||
+            (YES != cpioNumber(header + 59, 6, 8, &nameSize)) ||
+            (YES != cpioNumber(header + 65, 11, 8, &memberSize)) )
+        {
+            //failed
+            failed = YES;
+            return;
+        }
+    }
+    //newc
+    // hex: magic(6) ino mode uid gid nlink mtime filesize devmajor devminor rdevmajor rdevminor namesize check (8 each)
+    else
+    {
+        if( (YES != cpioNumber(header + 14, 8, 16, &mode)) ||
+            (YES != cpioNumber(header + 54, 8, 16, &memberSize)) ||
+            (YES != cpioNumber(header + 94, 8, 16, &nameSize)) )
+        {
+            //failed
+            failed = YES;
+            return;
+        }
+    }
+    
+    //init name
+    // newc pads (header and) name to 4 bytes
+    nameLength = 0;
+    nameRemaining = nameSize + ((YES == newc) ? ((4 - ((CPIO_NEWC_HEADER_SIZE + nameSize) % 4)) % 4) : 0);
+    
+    //reset header
+    headerLength = 0;
+    headerSize = 0;
+    
+    //next
+    state = CpioStateName;
+    
+    //no name?
+    if(0 == nameRemaining)
+    {
+        [self startMember];
+    }
+    
+    return;
+}
+
+//start a member
+// once its name is in
+-(void)startMember
+{
+    //end of archive?
+    if(0 == strncmp(name, "TRAILER!!!", MIN(nameLength, sizeof(name))))
+    {
+        //done
+        state = CpioStateDone;
+        return;
+    }
+    
+    //init
+    memberPosition = 0;
+    prefixLength = 0;
+    identified = NO;
+    isBinary = NO;
+    
+    //only need prefix of regular files
+    prefixSize = (S_IFREG == (mode & S_IFMT)) ? (size_t)MIN(memberSize, (uint64_t)PAYLOAD_PREFIX_SIZE) : 0;
+    
+    //init data
+    dataRemaining = memberSize;
+    
+    //empty?
+    if(0 == dataRemaining)
+    {
+        //end member
+        [self endMember];
+        
+        //next
+        state = CpioStateHeader;
+        return;
+    }
+    
+    //next
+    state = CpioStateData;
+    
+    return;
+}
+
+//process member's data
+// once prefix is in, decide if member is a binary
+-(void)memberData:(const uint8_t*)bytes length:(size_t)length
+{
+    //bytes to take
+    size_t take = 0;
+    
+    //not identified yet?
+    if(YES != identified)
+    {
+        //take
+        take = MIN(length, prefixSize - prefixLength);
+        memcpy(prefix + prefixLength, bytes, take);
+        prefixLength += take;
+        bytes += take;
+        length -= take;
+        
+        //need more?
+        if(prefixLength < prefixSize)
+        {
+            return;
+        }
+        
+        //identify
+        identified = YES;
+        isBinary = [self startBinary];
+        
+        //binary?
+        // process prefix (as it's skipped past)
+        if(YES == isBinary)
+        {
+            [self binaryData:prefix length:prefixLength];
+        }
+    }
+    
+    //binary?
+    if( (YES == isBinary) &&
+        (0 != length) )
+    {
+        [self binaryData:bytes length:length];
+    }
+    
+    return;
+}
+
+//start a binary
+// checks prefix for mach-o (or universal) magic, and inits its slices
+-(BOOL)startBinary
+{
+    //magic
+    uint32_t magicValue = 0;
+    
+    //arch entry size
+    size_t archSize = 0;
+    
+    //too small?
+    if(prefixLength < sizeof(struct mach_header_64))
+    {
+        return NO;
+    }
+    
+    //too many?
+    if(binaryCount >= PAYLOAD_MAX_BINARIES)
+    {
+        return NO;
+    }
+    
+    //init
+    memcpy(&magicValue, prefix, sizeof(magicValue));
+    sliceCount = 0;
+    memset(slices, 0, sizeof(slices));
+    
+    //thin?
+    if( (MH_MAGIC == magicValue) ||
+        (MH_CIGAM == magicValue) ||
+        (MH_MAGIC_64 == magicValue) ||
+        (MH_CIGAM_64 == magicValue) )
+    {
+        //single slice
+        sliceCount = 1;
+        slices[0].offset = 0;
+        slices[0].size = memberSize;
+    }
+    //universal?
+    // fat header is always big-endian
+    else if( (FAT_MAGIC == OSSwapBigToHostInt32(magicValue)) ||
+             (FAT_MAGIC_64 == OSSwapBigToHostInt32(magicValue)) )
+    {
+        //init
+        archSize = (FAT_MAGIC == OSSwapBigToHostInt32(magicValue)) ? sizeof(struct fat_arch) : sizeof(struct fat_arch_64);
+        sliceCount = OSReadBigInt32(prefix, 4);
+        
+        //sanity check
+        // also, java class files share magic
+        if( (0 == sliceCount) ||
+            (sliceCount > MACHO_MAX_SLICES) ||
+            (sizeof(struct fat_header) + sliceCount * archSize > prefixLength) )
+        {
+            return NO;
+        }
+        
+        //init each slice
+        for(uint32_t i = 0; i < sliceCount; i++)
+        {
+            //arch
+            const uint8_t* arch = prefix + sizeof(struct fat_header) + i * archSize;
+            
+            //fat arch
+            if(sizeof(struct fat_arch) == archSize)
+            {
+                slices[i].offset = OSReadBigInt32(arch, offsetof(struct fat_arch, offset));
+                slices[i].size = OSReadBigInt32(arch, offsetof(struct fat_arch, size));
+            }
+            //fat arch (64)
+            else
+            {
+                slices[i].offset = OSReadBigInt64(arch, offsetof(struct fat_arch_64, offset));
+                slices[i].size = OSReadBigInt64(arch, offsetof(struct fat_arch_64, size));
+            }
+            
+            //sanity check
+            if( (slices[i].offset > memberSize) ||
+                (slices[i].size > memberSize - slices[i].offset) )
+            {
+                return NO;
+            }
+        }
+    }
+    //not a binary
+    else
+    {
+        return NO;
+    }
+    
+    //alloc heads
+    for(uint32_t i = 0; i < sliceCount; i++)
+    {
+        //init
+        slices[i].headSize = (size_t)MIN(slices[i].size, (uint64_t)PAYLOAD_MAX_HEAD);
+        slices[i].head = malloc(MAX(slices[i].headSize, 1));
+        
+        //failed?
+        if(NULL == slices[i].head)
+        {
+            slices[i].unparsable = YES;
+        }
+    }
+    
+    //init hash
+    CC_SHA256_Init(&sha256);
+    
+    //inc
+    binaryCount++;
+    
+    return YES;
+}
+
+//process binary's data
+// hash it, and hand off to each slice
+-(void)binaryData:(const uint8_t*)bytes length:(size_t)length
+{
+    //hash
+    CC_SHA256_Update(&sha256, bytes, (CC_LONG)length);
+    
+    //each slice
+    for(uint32_t i = 0; i < sliceCount; i++)
+    {
+        processSlice(&slices[i], bytes, length, memberPosition);
+    }
+    
+    //update
+    memberPosition += length;
+    
+    return;
+}
+
+//end a member
+// for binaries, check each slice, and save summary
+-(void)endMember
+{
+    //summary
+    NSMutableDictionary* binary = nil;
+    
+    //status
+    OSStatus status = errSecSuccess;
+    
+    //hash
+    uint8_t digest[CC_SHA256_DIGEST_LENGTH] = {0};
+    
+    //small (regular) file?
+    // prefix is all there is, so identify now
+    if( (YES != identified) &&
+        (0 != prefixSize) &&
+        (prefixLength == prefixSize) )
+    {
+        //identify
+        identified = YES;
+        isBinary = [self startBinary];
+        
+        //binary?
+        if(YES == isBinary)
+        {
+            [self binaryData:prefix length:prefixLength];
+        }
+    }
+    
+    //not a binary?
+    if(YES != isBinary)
+    {
+        return;
+    }
+    
+    //init
+    binary = [NSMutableDictionary dictionary];
+    
+    //add path
+    // minus leading './'
+    binary[KEY_BINARY_PATH] = [[NSString alloc] initWithBytes:name length:strnlen(name, MIN(nameLength, sizeof(name))) encoding:NSUTF8StringEncoding] ?: @"?";
+    if(YES == [binary[KEY_BINARY_PATH] hasPrefix:@"./"])
+    {
+        binary[KEY_BINARY_PATH] = [binary[KEY_BINARY_PATH] substringFromIndex:2];
+    }
+    
+    //add hash
+    CC_SHA256_Final(digest, &sha256);
+    binary[KEY_BINARY_SHA256] = bytesToHex(digest, sizeof(digest), YES);
+    
+    //check each slice
+    // overall status is worst of them: failed, then unsigned, then unverified
+    for(uint32_t i = 0; i < sliceCount; i++)
+    {
+        //slice status
+        OSStatus sliceStatus = errSecSuccess;
+        
+        //finish last (partial) page
+        if( (YES != slices[i].pagesDisabled) &&
+            (NULL != slices[i].pages) &&
+            (0 != slices[i].pageFill) )
+        {
+            finishPage(&slices[i]);
+        }
+        
+        //check
+        sliceStatus = checkSlice(&slices[i], binary);
+        
+        //worse?
+        if( (errSecCSSignatureFailed == sliceStatus) ||
+            ( (errSecCSUnsigned == sliceStatus) && (errSecCSSignatureFailed != status) ) ||
+            ( (errSecSuccess == status) && (errSecSuccess != sliceStatus) ) )
+        {
+            status = sliceStatus;
+        }
+        
+        //free
+        freeSlice(&slices[i]);
+    }
+    
+    //add status
+    binary[KEY_BINARY_STATUS] = [NSNumber numberWithInt:status];
+    
+    //save
+    [self.binaries addObject:binary];
+    
+    //reset
+    sliceCount = 0;
+    isBinary = NO;
+    
+    return;
+}
+
+//finish
+// returns (per-binary) summaries
+-(NSArray*)finish
+{
+    //flush gzip'd payload
+    // pbzx (chunks) are flushed as they end
+    if( (PayloadFormatGzip == format) &&
+        (YES == gzipHeaderDone) )
+    {
+        [self inflate:NULL length:0 algorithm:COMPRESSION_ZLIB finalize:YES];
+    }
+    
+    //truncated?
+    if( (YES != failed) &&
+        (CpioStateDone != state) )
+    {
+        //dbg msg
+        os_log_debug(OS_LOG_DEFAULT, "WYS: payload ended before cpio trailer");
+    }
+    
+    //dbg msg
+    os_log_debug(OS_LOG_DEFAULT, "WYS: payload contains %lu binaries", (unsigned long)self.binaries.count);
+    
+    return self.binaries;
+}
+
+//dealloc
+// free buffers
+-(void)dealloc
+{
+    //end stream
+    [self endStream];
+    
+    //free output
+    if(NULL != output)
+    {
+        free(output);
+        output = NULL;
+    }
+    
+    //free gzip header
+    if(NULL != gzipHeader)
+    {
+        free(gzipHeader);
+        gzipHeader = NULL;
+    }
+    
+    //free any slices
+    // e.g. payload was truncated
+    for(uint32_t i = 0; i < MACHO_MAX_SLICES; i++)
+    {
+        freeSlice(&slices[i]);
+    }
+}
+
+@end
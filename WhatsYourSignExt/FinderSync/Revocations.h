@@ -0,0 +1,87 @@
+//
+//  Revocations.h
+//  WhatsYourSign
+//
+//  Created by Patrick Wardle on 10/17/26.
+//  Copyright (c) 2026 Objective-See. All rights reserved.
+//
+//  note: revocation store is a (memory-mapped) file of sorted, fixed-size entries:
+//        header: magic ('WYSR'), version, # of entries (all big-endian uint32)
+//        entry:  type (big-endian uint32), value (32 bytes, zero-padded)
+//        it's (re)loaded whenever the file changes, so can be refreshed at any time
+//        updates are written to a temp file, then renamed over the store, so a mapped store is never truncated
+//        changes are detected via (vnode) dispatch sources, so lookups don't stat the file
+
+#ifndef Revocations_h
+#define Revocations_h
+
+@import Foundation;
+@import Security;
+
+//revocation store file
+// lives in the (shared) caches directory
+#define REVOCATIONS_FILE @"revocations.db"
+
+//revocation store magic ('WYSR')
+#define REVOCATIONS_MAGIC 0x57595352
+
+//revocation store version
+#define REVOCATIONS_VERSION 2
+
+//size of entry value
+#define REVOCATION_VALUE_SIZE 32
+
+//entry type: certificate (SHA-256 fingerprint)
+#define REVOKED_CERTIFICATE 1
+
+//entry type: certificate serial number
+// SHA-256 of issuer's hash and serial, as serials are only unique per issuer
+#define REVOKED_SERIAL 2
+
+//entry type: cd hash (first 20 bytes, as used by Apple)
+#define REVOKED_CDHASH 3
+
+//revocation store header
+typedef struct
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t count;
+
+} RevocationsHeader;
+
+//revocation store entry
+typedef struct
+{
+    uint32_t type;
+    uint8_t value[REVOCATION_VALUE_SIZE];
+
+} RevocationEntry;
+
+/* FUNCTIONS */
+
+//is the (local) revocation store available?
+BOOL revocationStoreAvailable(void);
+
+//is an entry revoked?
+BOOL isEntryRevoked(uint32_t type, NSData* value);
+
+//is a certificate revoked?
+// checks its fingerprint and serial number
+BOOL isCertificateRevoked(SecCertificateRef certificate);
+
+//is any certificate in a chain revoked?
+BOOL isCertificateChainRevoked(NSArray* certificates);
+
+//is a cd hash revoked?
+BOOL isCDHashRevoked(NSData* cdHash);
+
+//build value of a (revoked) serial entry
+// from issuer's hash (see 'KEY_CERT_ISSUER_HASH') and (raw) serial
+NSData* revokedSerialValue(NSData* issuerHash, NSData* serial);
+
+//(re)write revocation store
+// entries (w/ host-order types) are sorted, written to a temp file, then renamed over store
+BOOL writeRevocationStore(const RevocationEntry* entries, uint32_t count);
+
+#endif /* Revocations_h */
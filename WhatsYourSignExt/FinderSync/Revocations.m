@@ -0,0 +1,568 @@
+//
+//  Revocations.m
+//  FinderSync
+//
+//  Created by Patrick Wardle on 10/17/26.
+//  Copyright (c) 2026 Objective-See. All rights reserved.
+//
+
+#import "consts.h"
+#import "Revocations.h"
+#import "X509.h"
+#import "utilities.h"
+
+#import <fcntl.h>
+#import <unistd.h>
+#import <os/lock.h>
+#import <os/log.h>
+#import <stdatomic.h>
+#import <sys/mman.h>
+#import <sys/stat.h>
+#import <CommonCrypto/CommonDigest.h>
+
+//lock
+// protects (re)mapping of store
+static os_unfair_lock storeLock = OS_UNFAIR_LOCK_INIT;
+
+//mapped store
+static void* store = NULL;
+
+//size of mapped store
+static size_t storeSize = 0;
+
+//identity of mapped store
+// used to detect when file is refreshed
+static struct stat storeInfo = {0};
+
+//store (might have) changed?
+// set by vnode sources, so file isn't stat'd on each lookup
+static _Atomic bool storeStale = true;
+
+//vnode source for store's directory
+// catches store being (atomically) replaced, created, or deleted
+static dispatch_source_t directorySource = NULL;
+
+//vnode source for store itself
+// catches in-place writes, (re)created on each refresh
+static dispatch_source_t fileSource = NULL;
+
+//get path to store
+static NSString* storePath(void)
+{
+    //path
+    static NSString* path = nil;
+    
+    //once token
+    static dispatch_once_t onceToken = 0;
+    
+    //only once
+    dispatch_once(&onceToken, ^{
+        
+        //init
+        // (shared) caches directory, so tests (and benchmarks) can point it elsewhere
+        path = [cachesDirectory() URLByAppendingPathComponent:REVOCATIONS_FILE].path;
+    
+    });
+    
+    return path;
+}
+
+//watch a path for changes
+// any event marks store as stale
+static dispatch_source_t watchPath(NSString* path, unsigned long events)
+{
+    //source
+    dispatch_source_t source = NULL;
+    
+    //file descriptor
+    int fd = -1;
+    
+    //sanity check
+    if(nil == path)
+    {
+        return NULL;
+    }
+    
+    //open
+    // just for events
+    fd = open(path.fileSystemRepresentation, O_EVTONLY | O_CLOEXEC);
+    if(-1 == fd)
+    {
+        return NULL;
+    }
+    
+    //create source
+    source = dispatch_source_create(DISPATCH_SOURCE_TYPE_VNODE, (uintptr_t)fd, events, dispatch_get_global_queue(QOS_CLASS_UTILITY, 0));
+    if(NULL == source)
+    {
+        //close
+        close(fd);
+        
+        return NULL;
+    }
+    
+    //on change
+    // mark stale, so next lookup refreshes
+    dispatch_source_set_event_handler(source, ^{
+        atomic_store(&storeStale, true);
+    });
+    
+    //on cancel
+    // close file descriptor
+    dispatch_source_set_cancel_handler(source, ^{
+        close(fd);
+    });
+    
+    //start
+    dispatch_resume(source);
+    
+    return source;
+}
+
+//(re)map store if file changed
+// changes are signaled by vnode sources, so this is normally just an atomic load
+// note: call with lock held
+static void refreshStore(void)
+{
+    //file info
+    struct stat info = {0};
+    
+    //file descriptor
+    int fd = -1;
+    
+    //mapping
+    void* mapping = MAP_FAILED;
+    
+    //header
+    const RevocationsHeader* header = NULL;
+    
+    //watch store's directory
+    if(NULL == directorySource)
+    {
+        //watch
+        directorySource = watchPath(storePath().stringByDeletingLastPathComponent, DISPATCH_VNODE_WRITE);
+    }
+    
+    //no changes since last refresh?
+    if(true != atomic_exchange(&storeStale, false))
+    {
+        //done
+        goto bail;
+    }
+    
+    //can't watch directory?
+    // stay stale, so store is (still) checked on each lookup
+    if(NULL == directorySource)
+    {
+        atomic_store(&storeStale, true);
+    }
+    
+    //(re)watch store
+    // before stat'ing it, so no changes are missed
+    if(NULL != fileSource)
+    {
+        //cancel
+        dispatch_source_cancel(fileSource);
+        fileSource = NULL;
+    }
+    fileSource = watchPath(storePath(), DISPATCH_VNODE_WRITE | DISPATCH_VNODE_EXTEND | DISPATCH_VNODE_DELETE | DISPATCH_VNODE_RENAME | DISPATCH_VNODE_REVOKE);
+    
+    //get file info
+    // no file? unmap any old store
+    if( (nil == storePath()) ||
+        (0 != stat(storePath().fileSystemRepresentation, &info)) )
+    {
+        //reset
+        memset(&info, 0, sizeof(info));
+    }
+    
+    //unchanged?
+    if( (info.st_dev == storeInfo.st_dev) &&
+        (info.st_ino == storeInfo.st_ino) &&
+        (info.st_size == storeInfo.st_size) &&
+        (info.st_mtimespec.tv_sec == storeInfo.st_mtimespec.tv_sec) &&
+        (info.st_mtimespec.tv_nsec == storeInfo.st_mtimespec.tv_nsec) )
+    {
+        //done
+        goto bail;
+    }
+    
+    //unmap old store
+    if(NULL != store)
+    {
+        munmap(store, storeSize);
+        store = NULL;
+        storeSize = 0;
+    }
+    
+    //save identity
+    storeInfo = info;
+    
+    //no (or too small) file?
+    if((size_t)info.st_size < sizeof(RevocationsHeader))
+    {
+        //bail
+        goto bail;
+    }
+    
+    //open
+    fd = open(storePath().fileSystemRepresentation, O_RDONLY | O_CLOEXEC);
+    if(-1 == fd)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //map
+    // store is only ever replaced (renamed over), never truncated, so mapping stays valid
+    mapping = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if(MAP_FAILED == mapping)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //validate header
+    header = mapping;
+    if( (REVOCATIONS_MAGIC != OSSwapBigToHostInt32(header->magic)) ||
+        (REVOCATIONS_VERSION != OSSwapBigToHostInt32(header->version)) ||
+        ((size_t)OSSwapBigToHostInt32(header->count) > ((size_t)info.st_size - sizeof(RevocationsHeader)) / sizeof(RevocationEntry)) )
+    {
+        //dbg msg
+        os_log_debug(OS_LOG_DEFAULT, "WYS: revocation store is invalid");
+        
+        //unmap
+        munmap(mapping, (size_t)info.st_size);
+        
+        //bail
+        goto bail;
+    }
+    
+    //save
+    store = mapping;
+    storeSize = (size_t)info.st_size;
+    
+    //dbg msg
+    os_log_debug(OS_LOG_DEFAULT, "WYS: loaded revocation store (%u entries)", OSSwapBigToHostInt32(header->count));
+
+bail:
+    
+    //close
+    // mapping stays valid
+    if(-1 != fd)
+    {
+        close(fd);
+        fd = -1;
+    }
+    
+    return;
+}
+
+//is the (local) revocation store available?
+BOOL revocationStoreAvailable(void)
+{
+    //flag
+    BOOL available = NO;
+    
+    //lock
+    os_unfair_lock_lock(&storeLock);
+    
+    //refresh
+    refreshStore();
+    
+    //set
+    available = (NULL != store);
+    
+    //unlock
+    os_unfair_lock_unlock(&storeLock);
+    
+    return available;
+}
+
+//is an entry revoked?
+// binary search, as entries are sorted (by type, then value)
+BOOL isEntryRevoked(uint32_t type, NSData* value)
+{
+    //flag
+    BOOL revoked = NO;
+    
+    //key
+    RevocationEntry key = {0};
+    
+    //entries
+    const RevocationEntry* entries = NULL;
+    
+    //bounds
+    size_t low = 0;
+    size_t high = 0;
+    
+    //sanity check
+    if( (0 == value.length) ||
+        (value.length > REVOCATION_VALUE_SIZE) )
+    {
+        //bail
+        return NO;
+    }
+    
+    //init key
+    // big-endian type, so it sorts w/ memcmp
+    key.type = OSSwapHostToBigInt32(type);
+    memcpy(key.value, value.bytes, value.length);
+    
+    //lock
+    os_unfair_lock_lock(&storeLock);
+    
+    //refresh
+    refreshStore();
+    
+    //no store?
+    if(NULL == store)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //init
+    entries = (const RevocationEntry*)((const uint8_t*)store + sizeof(RevocationsHeader));
+    high = OSSwapBigToHostInt32(((const RevocationsHeader*)store)->count);
+    
+    //search
+    while(low < high)
+    {
+        //middle
+        size_t middle = low + (high - low) / 2;
+        
+        //compare
+        int result = memcmp(&entries[middle], &key, sizeof(key));
+        
+        //match?
+        if(0 == result)
+        {
+            //revoked
+            revoked = YES;
+            break;
+        }
+        
+        //adjust bounds
+        if(result < 0)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+bail:
+    
+    //unlock
+    os_unfair_lock_unlock(&storeLock);
+    
+    return revoked;
+}
+
+//build value of a (revoked) serial entry
+// from issuer's hash (see 'KEY_CERT_ISSUER_HASH') and (raw) serial
+NSData* revokedSerialValue(NSData* issuerHash, NSData* serial)
+{
+    //context
+    CC_SHA256_CTX context = {0};
+    
+    //digest
+    uint8_t digest[CC_SHA256_DIGEST_LENGTH] = {0};
+    
+    //sanity check
+    if( (CC_SHA256_DIGEST_LENGTH != issuerHash.length) ||
+        (0 == serial.length) )
+    {
+        return nil;
+    }
+    
+    //hash issuer's hash, then serial
+    CC_SHA256_Init(&context);
+    CC_SHA256_Update(&context, issuerHash.bytes, (CC_LONG)issuerHash.length);
+    CC_SHA256_Update(&context, serial.bytes, (CC_LONG)serial.length);
+    CC_SHA256_Final(digest, &context);
+    
+    return [NSData dataWithBytes:digest length:sizeof(digest)];
+}
+
+//is a certificate revoked?
+// checks its fingerprint and (issuer's) serial number
+BOOL isCertificateRevoked(SecCertificateRef certificate)
+{
+    //flag
+    BOOL revoked = NO;
+    
+    //(parsed) cert info
+    // cached, so fingerprint isn't recomputed for each check
+    NSDictionary* info = nil;
+    
+    //fingerprint
+    NSData* fingerprint = nil;
+    
+    //serial
+    // keyed by issuer
+    NSData* serial = nil;
+    
+    //cert data
+    NSData* data = nil;
+    
+    //digest
+    uint8_t digest[CC_SHA256_DIGEST_LENGTH] = {0};
+    
+    //get cert info
+    info = x509Info(certificate);
+    
+    //grab fingerprint and serial
+    fingerprint = info[KEY_CERT_SHA256];
+    serial = revokedSerialValue(info[KEY_CERT_ISSUER_HASH], info[KEY_CERT_SERIAL]);
+    
+    //couldn't parse cert?
+    // fall back to Security framework, so (at least) its fingerprint is still checked
+    if(nil == info)
+    {
+        //get cert data
+        data = CFBridgingRelease(SecCertificateCopyData(certificate));
+        if(0 == data.length)
+        {
+            //bail
+            goto bail;
+        }
+        
+        //compute fingerprint
+        CC_SHA256(data.bytes, (CC_LONG)data.length, digest);
+        fingerprint = [NSData dataWithBytes:digest length:sizeof(digest)];
+    }
+    
+    //check fingerprint
+    if(YES == isEntryRevoked(REVOKED_CERTIFICATE, fingerprint))
+    {
+        //revoked
+        revoked = YES;
+        
+        //done
+        goto bail;
+    }
+    
+    //check serial
+    // note: nil if no issuer, which won't match
+    revoked = isEntryRevoked(REVOKED_SERIAL, serial);
+
+bail:
+    
+    return revoked;
+}
+
+//is any certificate in a chain revoked?
+BOOL isCertificateChainRevoked(NSArray* certificates)
+{
+    //check each
+    for(id certificate in certificates)
+    {
+        //revoked?
+        if(YES == isCertificateRevoked((__bridge SecCertificateRef)certificate))
+        {
+            return YES;
+        }
+    }
+    
+    return NO;
+}
+
+//is a cd hash revoked?
+// store has first 20 bytes, as these are what Apple uses
+BOOL isCDHashRevoked(NSData* cdHash)
+{
+    //sanity check
+    if(cdHash.length < CC_SHA1_DIGEST_LENGTH)
+    {
+        return NO;
+    }
+    
+    return isEntryRevoked(REVOKED_CDHASH, [cdHash subdataWithRange:NSMakeRange(0, CC_SHA1_DIGEST_LENGTH)]);
+}
+
+//compare entries
+// for sorting, as 'isEntryRevoked' binary searches w/ memcmp
+static int compareEntries(const void* first, const void* second)
+{
+    return memcmp(first, second, sizeof(RevocationEntry));
+}
+
+//(re)write revocation store
+// entries (w/ host-order types) are sorted, written to a temp file, then renamed over store
+BOOL writeRevocationStore(const RevocationEntry* entries, uint32_t count)
+{
+    //flag
+    BOOL written = NO;
+    
+    //store
+    NSMutableData* contents = nil;
+    
+    //header
+    RevocationsHeader header = {0};
+    
+    //(output) entries
+    RevocationEntry* sorted = NULL;
+    
+    //temp path
+    NSString* tempPath = nil;
+    
+    //sanity check
+    if( (nil == storePath()) ||
+        ((0 != count) && (NULL == entries)) )
+    {
+        //bail
+        goto bail;
+    }
+    
+    //init header
+    header.magic = OSSwapHostToBigInt32(REVOCATIONS_MAGIC);
+    header.version = OSSwapHostToBigInt32(REVOCATIONS_VERSION);
+    header.count = OSSwapHostToBigInt32(count);
+    
+    //init
+    contents = [NSMutableData dataWithBytes:&header length:sizeof(header)];
+    contents.length = sizeof(header) + (size_t)count * sizeof(RevocationEntry);
+    
+    //copy entries
+    // w/ big-endian types, so they sort (and match) w/ memcmp
+    sorted = (RevocationEntry*)((uint8_t*)contents.mutableBytes + sizeof(header));
+    for(uint32_t i = 0; i < count; i++)
+    {
+        sorted[i] = entries[i];
+        sorted[i].type = OSSwapHostToBigInt32(entries[i].type);
+    }
+    
+    //sort
+    qsort(sorted, count, sizeof(RevocationEntry), compareEntries);
+    
+    //write to temp file
+    // then (atomically) rename over store, as readers might have it mapped
+    tempPath = [storePath() stringByAppendingFormat:@".%d", getpid()];
+    if( (YES != [contents writeToFile:tempPath atomically:NO]) ||
+        (0 != rename(tempPath.fileSystemRepresentation, storePath().fileSystemRepresentation)) )
+    {
+        //cleanup
+        unlink(tempPath.fileSystemRepresentation);
+        
+        //bail
+        goto bail;
+    }
+    
+    //mark stale
+    // so next lookup (re)maps, even if vnode event hasn't arrived yet
+    atomic_store(&storeStale, true);
+    
+    //happy
+    written = YES;
+    
+    //dbg msg
+    os_log_debug(OS_LOG_DEFAULT, "WYS: wrote revocation store (%u entries)", count);
+
+bail:
+    
+    return written;
+}
@@ -24,14 +24,40 @@ enum {
 //function def for 'SecAssessmentTicketLookup'
 Boolean SecAssessmentTicketLookup(CFDataRef hash, SecCSDigestAlgorithm hashType, SecAssessmentTicketFlags flags, double *date, CFErrorRef *errors);
 
+//function def for 'SecAssessmentTicketRegister'
+Boolean SecAssessmentTicketRegister(CFDataRef ticketData, CFErrorRef *errors);
+
+//signing info stages
+// reported (in order) as each is determined
+typedef NS_ENUM(NSInteger, SigningStage)
+{
+    //status, authorities (and entitlements)
+    SigningStageSignature = 1,
+    
+    //signer (apple, dev id, app store)
+    SigningStageSigner
+};
+
+//callback for signing info stages
+// passed a copy of signing info, as it is so far
+typedef void (^SigningProgress)(SigningStage stage, NSMutableDictionary* signingInfo);
+
 /* FUNCTIONS */
 
 //check if file is (likely) fat binary
 BOOL isBinaryFat(NSString* path);
 
+//determine the offset (if any)
+// of the 'best' architecture in a (fat) binary
+uint64_t bestArchOffset(NSString* path);
+
 //get the signing info of a file
 NSMutableDictionary* extractSigningInfo(NSString* path, SecCSFlags flags, BOOL entitlements);
 
+//get the signing info of a file
+// reports each stage, as soon as its determined
+NSMutableDictionary* extractSigningInfoWithProgress(NSString* path, SecCSFlags flags, BOOL entitlements, SigningProgress progress);
+
 //determine if a file is signed by Apple proper
 BOOL isApple(NSString* path, SecCSFlags flags);
 
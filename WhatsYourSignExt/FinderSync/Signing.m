@@ -7,14 +7,20 @@
 //  License:    Creative Commons Attribution-NonCommercial 4.0 International License
 //
 
+#import "MachO.h"
+#import "CodeSignature.h"
+#import "NestedCode.h"
+#import "CodeResources.h"
 #import "Consts.h"
 #import "Signing.h"
 #import "Utilities.h"
+#import "Revocations.h"
+#import "Tickets.h"
+#import "Trace.h"
 #import "AppReceipt.h"
-
-#import <mach-o/fat.h>
-#import <mach-o/arch.h>
-#import <mach-o/swap.h>
+#import "Entitlements.h"
+#import "VerdictCache.h"
+#import "X509.h"
 
 #import <sys/sysctl.h>
 
@@ -23,125 +29,307 @@
 @import CommonCrypto;
 @import SystemConfiguration;
 
+//'anchor apple' requirement
+static SecRequirementRef appleRequirement = NULL;
+
+//'anchor apple generic' requirement
+static SecRequirementRef devIDRequirement = NULL;
+
+//'notarized' requirement
+static SecRequirementRef notarizedRequirement = NULL;
+
 //determine the offset (if any)
 // of the 'best' architecture in a (fat) binary
-uint32_t bestArchOffset(NSString* path)
+// note: only the binary's headers are read (see 'MachO.m')
+uint64_t bestArchOffset(NSString* path)
 {
     //offset of best architecture
-    uint32_t offset = 0;
-    
-    //pool
-    @autoreleasepool
-    {
-    
-    //binary
-    NSMutableData* binary = nil;
-    
-    //le bytez
-    const void* binaryBytes = NULL;
-    
-    //fat header
-    struct fat_header* fatHeader = NULL;
+    uint64_t offset = 0;
     
-    //number of fat architectures
-    uint32_t fatArchitectureCount = 0;
+    //index
+    MachOIndex index = {0};
     
-    //fat architectures
-    void *fatArchitectures = NULL;
+    //best slice
+    const MachOSlice* bestSlice = NULL;
     
-    //local architecture
-    const NXArchInfo *localArchitecture = NULL;
+    //index binary
+    // fails for non mach-o's, which is fine
+    if(YES != machoIndexPath(path, &index))
+    {
+        //bail
+        goto bail;
+    }
     
-    //best matching architecture
-    struct fat_arch *bestArchitecture = NULL;
-        
     //not fat?
     // can just return offset:0
-    if(YES != isBinaryFat(path))
+    if( (MachOKindFat != index.kind) &&
+        (MachOKindFat64 != index.kind) )
     {
         //bail
         goto bail;
     }
     
-    //load binary into memory
-    binary = [NSMutableData dataWithContentsOfFile:path];
-    if(binary.length < sizeof(struct fat_header))
+    //find best slice
+    bestSlice = machoBestSlice(&index);
+    if(NULL == bestSlice)
     {
         //bail
         goto bail;
     }
     
-    //grab bytes
-    binaryBytes = binary.bytes;
+    //init offset
+    offset = bestSlice->offset;
+    
+bail:
+    
+    return offset;
+}
+
+//compile requirements
+// only done once, as these are then (re)used for every item
+static void initRequirements(void)
+{
+    //token
+    static dispatch_once_t onceToken = 0;
     
-    //not universal (fat)
-    if( (FAT_MAGIC != *(const uint32_t *)binaryBytes) &&
-        (FAT_CIGAM != *(const uint32_t *)binaryBytes) )
+    //only once
+    dispatch_once(&onceToken, ^{
+        
+        //'anchor apple'
+        SecRequirementCreateWithString(CFSTR("anchor apple"), kSecCSDefaultFlags, &appleRequirement);
+        
+        //'anchor apple generic'
+        SecRequirementCreateWithString(CFSTR("anchor apple generic"), kSecCSDefaultFlags, &devIDRequirement);
+        
+        //'notarized'
+        SecRequirementCreateWithString(CFSTR("notarized"), kSecCSDefaultFlags, &notarizedRequirement);
+    
+    });
+    
+    return;
+}
+
+//check if (already validated) code satisfies a requirement
+// 'kSecCSBasicValidateOnly' as executable/resources were validated (and the results cached) by the full check
+static BOOL satisfiesRequirement(SecStaticCodeRef staticCode, SecRequirementRef requirement, SecCSFlags flags)
+{
+    //sanity check
+    if(NULL == requirement)
     {
-        //bail
-        goto bail;
+        return NO;
     }
     
-    //binary is fat
-    // init pointer to fat header
-    fatHeader = (struct fat_header*)binaryBytes;
+    return (errSecSuccess == SecStaticCodeCheckValidity(staticCode, flags | kSecCSBasicValidateOnly, requirement));
+}
 
-    //swap size?
-    if(fatHeader->magic == OSSwapHostToBigInt32(FAT_MAGIC))
+//validate code, w/ its (sealed) resources verified by 'verifyCodeResources'
+// these are hashed concurrently, so Security's own (serial) resource pass is skipped
+// note: as in that pass, nested code must satisfy its seal's requirement (see 'CodeResources.m')
+// returns NO if this couldn't be done (e.g. not a bundle, or validation failed), so caller should do a full validation
+static BOOL validateWithResources(SecStaticCodeRef staticCode, NSString* path, SecCSFlags flags, OSStatus* status, NSDictionary** resources)
+{
+    //internal information
+    CFDictionaryRef internalDetails = NULL;
+    
+    //(authenticated) resource manifest
+    NSDictionary* manifest = nil;
+    
+    //nested code, or strict validation?
+    // these are done as part of Security's resource pass, so it can't be skipped
+    if(0 != (flags & (kSecCSCheckNestedCode | kSecCSStrictValidate)))
+    {
+        return NO;
+    }
+    
+    //no resource manifest?
+    // e.g. a (standalone) binary
+    if(YES != [NSFileManager.defaultManager fileExistsAtPath:[bundleContents(path) stringByAppendingPathComponent:CODE_RESOURCES_PATH]])
+    {
+        return NO;
+    }
+    
+    //validate all but resources
+    // on failure, full validation will (quickly) fail the same way
+    if(errSecSuccess != SecStaticCodeCheckValidity(staticCode, flags | kSecCSDoNotValidateResources, NULL))
+    {
+        return NO;
+    }
+    
+    //get resource manifest
+    // Security checks it against (now validated) code directory, so it can be trusted
+    if(errSecSuccess != SecCodeCopySigningInformation(staticCode, kSecCSInternalInformation, &internalDetails))
+    {
+        return NO;
+    }
+    
+    //extract
+    // and hand ownership to ARC
+    manifest = ((__bridge_transfer NSDictionary*)internalDetails)[(__bridge NSString*)kSecCodeInfoResourceDirectory];
+    if(YES != [manifest isKindOfClass:[NSDictionary class]])
+    {
+        return NO;
+    }
+    
+    //verify resources
+    *resources = verifyCodeResources(path, manifest);
+    if(nil == *resources)
     {
-        //swap
-        fatArchitectureCount = OSSwapBigToHostInt32(fatHeader->nfat_arch);
+        return NO;
     }
     
+    //any added, removed, or modified?
+    *status = ( (0 != [(*resources)[KEY_RESOURCES_ADDED] count]) ||
+                (0 != [(*resources)[KEY_RESOURCES_REMOVED] count]) ||
+                (0 != [(*resources)[KEY_RESOURCES_MODIFIED] count]) ) ? errSecCSBadResource : errSecSuccess;
+    
+    return YES;
+}
+
+//check if (already validated) code satisfies a requirement, within a deadline
+// for checks that go online (e.g. notarization), so they can't block (the UI) indefinitely
+// returns NO if deadline passed, setting 'timedOut'
+static BOOL satisfiesRequirementWithin(SecStaticCodeRef staticCode, SecRequirementRef requirement, SecCSFlags flags, NSTimeInterval deadline, BOOL* timedOut)
+{
+    //result
+    // note: set by check, even if it finishes after deadline
+    __block BOOL satisfied = NO;
+    
+    //flag
+    BOOL completed = NO;
+    
+    //semaphore
+    dispatch_semaphore_t semaphore = NULL;
+    
+    //init
+    semaphore = dispatch_semaphore_create(0);
+    
+    //retain code
+    // as check might outlive caller's reference
+    CFRetain(staticCode);
+    
+    //check
+    // in background, as it goes online
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+        
+        //check
+        satisfied = satisfiesRequirement(staticCode, requirement, flags);
+        
+        //release code
+        CFRelease(staticCode);
+        
+        //signal
+        dispatch_semaphore_signal(semaphore);
+    
+    });
+    
+    //wait
+    // but only until deadline
+    completed = (0 == dispatch_semaphore_wait(semaphore, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(deadline * NSEC_PER_SEC))));
+    
+    //save
+    *timedOut = (YES != completed);
+    
+    return (YES == completed) && (YES == satisfied);
+}
+
+//check if a file satisfies a requirement
+// validates (best arch of) file, against the requirement
+static BOOL checkRequirement(NSString* path, SecCSFlags flags, SecRequirementRef requirement)
+{
+    //flag
+    BOOL satisfied = NO;
+    
+    //code
+    SecStaticCodeRef staticCode = NULL;
+    
     //sanity check
-    if(binary.length <= sizeof(struct fat_header) + fatArchitectureCount * sizeof(struct fat_arch))
+    if(NULL == requirement)
     {
         //bail
         goto bail;
     }
     
-    //init pointer to fat architectures
-    fatArchitectures = (char*)binaryBytes + sizeof(struct fat_header);
-        
-    //get local architecture
-    localArchitecture = NXGetLocalArchInfo();
+    //create static code
+    if(errSecSuccess != SecStaticCodeCreateWithPathAndAttributes((__bridge CFURLRef)([NSURL fileURLWithPath:path]), kSecCSDefaultFlags, (__bridge CFDictionaryRef)@{(__bridge NSString *)kSecCodeAttributeUniversalFileOffset : [NSNumber numberWithUnsignedLongLong:bestArchOffset(path)]}, &staticCode))
+    {
+        //bail
+        goto bail;
+    }
+    
+    //check
+    // this validates and evaluates requirement in one go
+    satisfied = (errSecSuccess == SecStaticCodeCheckValidity(staticCode, flags, requirement));
+
+bail:
     
-    //swap fat architectures?
-    if(fatHeader->magic == OSSwapHostToBigInt32(FAT_MAGIC))
+    //free static code
+    if(NULL != staticCode)
     {
-        //swap
-        swap_fat_arch(fatArchitectures, fatArchitectureCount, localArchitecture->byteorder);
+        //free
+        CFRelease(staticCode);
+        staticCode = NULL;
     }
-        
-    //find best architecture
-    bestArchitecture = NXFindBestFatArch(localArchitecture->cputype, localArchitecture->cpusubtype, fatArchitectures, fatArchitectureCount);
-    if(NULL == bestArchitecture)
+    
+    return satisfied;
+}
+
+//find first (code) page that doesn't match its hash
+// for bundles, checks their executable
+static void findBadPage(NSString* path, NSMutableDictionary* signingInfo)
+{
+    //binary
+    NSString* binaryPath = nil;
+    
+    //bad page
+    int64_t badPage = CODESIGN_PAGES_UNVERIFIED;
+    
+    //its offset
+    uint64_t badOffset = 0;
+    
+    //get binary
+    binaryPath = hashablePath(path);
+    if(nil == binaryPath)
     {
         //bail
         goto bail;
     }
     
-    //init offset
-    offset = bestArchitecture->offset;
+    //verify pages
+    badPage = codeSignatureFirstBadPage(binaryPath, &badOffset);
+    if(badPage < 0)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //dbg msg
+    os_log_debug(OS_LOG_DEFAULT, "WYS: %{public}@: page %lld (offset: %#llx) doesn't match its hash", binaryPath, badPage, badOffset);
+    
+    //save
+    signingInfo[KEY_SIGNING_BAD_PAGE] = [NSNumber numberWithLongLong:badPage];
+    signingInfo[KEY_SIGNING_BAD_PAGE_OFFSET] = [NSNumber numberWithUnsignedLongLong:badOffset];
     
 bail:
-        
-    ;
-        
-    }//autorelease
     
-    return offset;
+    return;
 }
 
 //get the signing info of a item
 NSMutableDictionary* extractSigningInfo(NSString* path, SecCSFlags flags, BOOL entitlements)
+{
+    return extractSigningInfoWithProgress(path, flags, entitlements, nil);
+}
+
+//get the signing info of a item
+// reports each stage, as soon as its determined
+NSMutableDictionary* extractSigningInfoWithProgress(NSString* path, SecCSFlags flags, BOOL entitlements, SigningProgress progress)
 {
     //info dictionary
     NSMutableDictionary* signingInfo = nil;
     
     //offset of best architecture
     // for universal/fat binary, need to check correct arch
-    uint32_t offset = 0;
+    uint64_t offset = 0;
     
     //code
     SecStaticCodeRef staticCode = NULL;
@@ -162,25 +350,44 @@ NSMutableDictionary* extractSigningInfo(NSString* path, SecCSFlags flags, BOOL e
     SecCertificateRef certificate = NULL;
     
     //common name on chert
-    CFStringRef commonName = NULL;
+    NSString* commonName = nil;
     
-    //token
-    static dispatch_once_t onceToken = 0;
+    //cache key
+    VerdictKey key = {0};
+    
+    //cache key (after validation)
+    VerdictKey keyAfter = {0};
+    
+    //can be cached?
+    BOOL cacheable = NO;
+    
+    //cached signing info
+    NSMutableDictionary* cachedInfo = nil;
+    
+    //(sealed) resources
+    // added, removed, and modified
+    NSDictionary* resources = nil;
+    
+    //notarized (offline)?
+    BOOL notarizedOffline = NO;
+    
+    //online notarization check timed out?
+    BOOL notarizationTimedOut = NO;
     
-    //is notarized requirement
-    static SecRequirementRef isNotarized = nil;
+    //start of notarization checks
+    CFAbsoluteTime notarizationStart = 0;
+    
+    //span
+    TraceSpan span = traceBegin("signing.info");
+    
+    //span (for each stage)
+    TraceSpan stageSpan = {0};
     
     //dbg msg
     os_log_debug(OS_LOG_DEFAULT, "WYS: extracting code signing information for: %{public}@", path);
     
-    //only once
-    // init notarization requirements
-    dispatch_once(&onceToken, ^{
-        
-        //init
-        SecRequirementCreateWithString(CFSTR("notarized"), kSecCSDefaultFlags, &isNotarized);
-
-    });
+    //init requirements
+    initRequirements();
     
     //init signing status
     signingInfo = [NSMutableDictionary dictionary];
@@ -199,8 +406,25 @@ NSMutableDictionary* extractSigningInfo(NSString* path, SecCSFlags flags, BOOL e
     // this is what loader will run, and thus, what we should validate!
     offset = bestArchOffset(path);
     
+    //cached verdict?
+    // keyed by identity and cd hash of executable, and (for bundles) identity of their whole tree, so changes invalidate it
+    cacheable = verdictCacheKey(path, offset, flags, entitlements, &key);
+    if(YES == cacheable)
+    {
+        //lookup
+        cachedInfo = verdictCacheLookup(&key);
+        if(nil != cachedInfo)
+        {
+            //use
+            signingInfo = cachedInfo;
+            
+            //done
+            goto bail;
+        }
+    }
+    
     //create static code
-    status = SecStaticCodeCreateWithPathAndAttributes((__bridge CFURLRef)([NSURL fileURLWithPath:path]), kSecCSDefaultFlags, (__bridge CFDictionaryRef)@{(__bridge NSString *)kSecCodeAttributeUniversalFileOffset : [NSNumber numberWithUnsignedInt:offset]}, &staticCode);
+    status = SecStaticCodeCreateWithPathAndAttributes((__bridge CFURLRef)([NSURL fileURLWithPath:path]), kSecCSDefaultFlags, (__bridge CFDictionaryRef)@{(__bridge NSString *)kSecCodeAttributeUniversalFileOffset : [NSNumber numberWithUnsignedLongLong:offset]}, &staticCode);
     
     //save signature status
     signingInfo[KEY_SIGNATURE_STATUS] = [NSNumber numberWithInteger:status];
@@ -211,10 +435,48 @@ NSMutableDictionary* extractSigningInfo(NSString* path, SecCSFlags flags, BOOL e
     }
     
     //check signature
-    status = SecStaticCodeCheckValidity(staticCode, flags, NULL);
+    // note: this is the only full validation, all requirement checks below reuse its results
+    //       for bundles, resources are verified (concurrently) by 'verifyCodeResources', not Security's own (serial) pass
+    stageSpan = traceBegin("signing.validity");
+    if(YES != validateWithResources(staticCode, path, flags, &status, &resources))
+    {
+        //full validation
+        status = SecStaticCodeCheckValidity(staticCode, flags, NULL);
+    }
+    traceEnd(&stageSpan, 0);
     
     //(re)save signature status
     signingInfo[KEY_SIGNATURE_STATUS] = [NSNumber numberWithInteger:status];
+    
+    //signature failed?
+    // find first (code) page that was modified
+    if(errSecCSSignatureFailed == status)
+    {
+        //find
+        stageSpan = traceBegin("signing.badPage");
+        findBadPage(path, signingInfo);
+        traceEnd(&stageSpan, 0);
+    }
+    
+    //resources don't match seal?
+    // if Security (not 'verifyCodeResources') checked them, find which were added, removed, or modified
+    if( (nil == resources) &&
+        ( (errSecCSBadResource == status) ||
+          (errSecCSResourcesInvalid == status) ||
+          (errSecCSResourceDirectoryFailed == status) ) )
+    {
+        //verify
+        stageSpan = traceBegin("signing.resources");
+        resources = verifyCodeResources(path, nil);
+        traceEnd(&stageSpan, 0);
+    }
+    
+    //save resources
+    // (only) if any don't match seal
+    if(errSecSuccess != status)
+    {
+        signingInfo[KEY_SIGNING_RESOURCES] = resources;
+    }
 
     //if file is validly signed (or was signed, but revoked)
     // grab entitlements, signing authorities, notarization status, etc.
@@ -264,31 +526,12 @@ NSMutableDictionary* extractSigningInfo(NSString* path, SecCSFlags flags, BOOL e
             }
         }
         
-        //add entitlements?
-        if( (YES == entitlements) &&
-            (nil != [(__bridge NSDictionary*)signingDetails objectForKey:(__bridge NSString*)kSecCodeInfoEntitlementsDict]) )
+        //note if there are entitlements?
+        // they're only decoded (see 'Entitlements.m') once the user asks to view them
+        if(YES == entitlements)
         {
-                //extract/save
-                signingInfo[KEY_SIGNING_ENTITLEMENTS] = [(__bridge NSDictionary*)signingDetails objectForKey:(__bridge NSString*)kSecCodeInfoEntitlementsDict];
-        }
-        
-        //determine if binary is signed by Apple
-        signingInfo[KEY_SIGNING_IS_APPLE] = [NSNumber numberWithBool:isApple(path, flags)];
-        
-        //not apple proper
-        // is signed with Apple Dev ID?
-        if(YES != [signingInfo[KEY_SIGNING_IS_APPLE] boolValue])
-        {
-            //determine if binary is Apple Dev ID
-            signingInfo[KEY_SIGNING_IS_APPLE_DEV_ID] = [NSNumber numberWithBool:isSignedDevID(path, flags)];
-            
-            //if dev id
-            // from app store?
-            if(YES == [signingInfo[KEY_SIGNING_IS_APPLE_DEV_ID] boolValue])
-            {
-                //from app store?
-                signingInfo[KEY_SIGNING_IS_APP_STORE] = [NSNumber numberWithBool:fromAppStore(path)];
-            }
+            //save
+            signingInfo[KEY_SIGNING_HAS_ENTITLEMENTS] = [NSNumber numberWithBool:entitlementsExist(path)];
         }
     }
     //error
@@ -313,183 +556,134 @@ NSMutableDictionary* extractSigningInfo(NSString* path, SecCSFlags flags, BOOL e
         certificate = (__bridge SecCertificateRef)([certificateChain objectAtIndex:index]);
         
         //get common name
-        status = SecCertificateCopyCommonName(certificate, &commonName);
+        // parsed (and interned) once per certificate, as chains are mostly shared
+        commonName = x509CommonName(certificate);
         
         //add (valid ones)
-        if( (errSecSuccess == status) &&
-            (NULL != commonName) )
+        if(nil != commonName)
         {
             //save
-            [signingInfo[KEY_SIGNING_AUTHORITIES] addObject:(__bridge NSString*)commonName];
-        }
-        
-        //cleanup
-        if(NULL != commonName)
-        {
-            //release name
-            CFRelease(commonName);
-            
-            //unset
-            commonName = NULL;
+            [signingInfo[KEY_SIGNING_AUTHORITIES] addObject:commonName];
         }
     }
     
-    //check notarization status
-    // note: force online checks (revocation)
-    if(errSecSuccess == SecStaticCodeCheckValidity(staticCode, kSecCSEnforceRevocationChecks, isNotarized))
+    //check (local) revocation store
+    // catches revoked certs/cd hashes, even when offline
+    if( (errSecSuccess == [signingInfo[KEY_SIGNATURE_STATUS] intValue]) &&
+        ( (YES == isCDHashRevoked(signingInfo[KEY_SIGNING_CDHASH_SHA256])) ||
+          (YES == isCDHashRevoked(signingInfo[KEY_SIGNING_CDHASH_SHA1])) ||
+          (YES == isCertificateChainRevoked(certificateChain)) ) )
     {
-        //notarized
-        signingInfo[KEY_SIGNING_IS_NOTARIZED] = [NSNumber numberWithInteger:errSecSuccess];
+        //dbg msg
+        os_log_debug(OS_LOG_DEFAULT, "WYS: %{public}@ is revoked (per local revocation store)", path);
+        
+        //update status
+        signingInfo[KEY_SIGNATURE_STATUS] = [NSNumber numberWithInteger:CSSMERR_TP_CERT_REVOKED];
     }
-    //failed
-    // but maybe cuz it's revoked?
-    else
+    
+    //report status & authorities
+    if(nil != progress)
     {
-        //check hashes
-        for(NSData* hash in [((__bridge NSDictionary*)signingDetails)[@"cdhashes-full"] allObjects])
-        {
-            //error
-            CFErrorRef error = NULL;
-            
-            //truncated hash
-            // this is what Apple uses
-            NSData* truncatedHash = nil;
-            
-            //hash type
-            SecCSDigestAlgorithm hashType = 0;
-            
-            //sanity check
-            if(YES != [hash isKindOfClass:[NSData class]])
-            {
-                //skip
-                continue;
-            }
-            
-            //SHA1?
-            if(CC_SHA1_DIGEST_LENGTH == hash.length)
-            {
-                //SHA1
-                hashType = kSecCodeSignatureHashSHA1;
-                
-                //use as is
-                truncatedHash = hash;
-            }
-            //SHA256 hash
-            else if(CC_SHA256_DIGEST_LENGTH == hash.length)
-            {
-                //SHA256
-                hashType = kSecCodeSignatureHashSHA256;
-                
-                //truncate, first 20 bytes
-                // this is what the notarization checks requires
-                truncatedHash = [hash subdataWithRange:NSMakeRange(0, CC_SHA1_DIGEST_LENGTH)];
-            }
-            //unknown
-            // just ignore for now
-            else
-            {
-                //skip
-                continue;
-            }
-            
-            //notarization check
-            // do online ('kSecAssessmentTicketFlagForceOnlineCheck') to detect revocations
-            if(YES != SecAssessmentTicketLookup((__bridge CFDataRef)(truncatedHash), hashType, kSecAssessmentTicketFlagForceOnlineCheck, NULL, &error))
-            {
-                //EACCES: means revoked
-                if(error)
-                {
-                    if(EACCES == CFErrorGetCode(error))
-                    {
-                        signingInfo[KEY_SIGNING_IS_NOTARIZED] = [NSNumber numberWithInteger:errSecCSRevokedNotarization];
-                    }
-                    CFRelease(error);
-                }
-            }
-        }
+        progress(SigningStageSignature, [signingInfo mutableCopy]);
     }
     
-bail:
+    //determine if binary is signed by Apple
+    stageSpan = traceBegin("signing.signer");
+    signingInfo[KEY_SIGNING_IS_APPLE] = [NSNumber numberWithBool:satisfiesRequirement(staticCode, appleRequirement, kSecCSDefaultFlags)];
     
-    //free signing info
-    if(NULL != signingDetails)
+    //not apple proper
+    // is signed with Apple Dev ID?
+    if(YES != [signingInfo[KEY_SIGNING_IS_APPLE] boolValue])
     {
-        //free
-        CFRelease(signingDetails);
+        //determine if binary is Apple Dev ID
+        signingInfo[KEY_SIGNING_IS_APPLE_DEV_ID] = [NSNumber numberWithBool:satisfiesRequirement(staticCode, devIDRequirement, kSecCSDefaultFlags)];
         
-        //unset
-        signingDetails = NULL;
+        //if dev id
+        // from app store?
+        if(YES == [signingInfo[KEY_SIGNING_IS_APPLE_DEV_ID] boolValue])
+        {
+            //from app store?
+            signingInfo[KEY_SIGNING_IS_APP_STORE] = [NSNumber numberWithBool:fromAppStore(path)];
+        }
     }
     
-    //free static code
-    if(NULL != staticCode)
+    //end span
+    traceEnd(&stageSpan, 0);
+    
+    //report signer
+    if(nil != progress)
     {
-        //free
-        CFRelease(staticCode);
-        
-        //unset
-        staticCode = NULL;
+        progress(SigningStageSigner, [signingInfo mutableCopy]);
     }
     
-    return signingInfo;
-}
-
-//determine if a file is signed by Apple proper
-BOOL isApple(NSString* path, SecCSFlags flags)
-{
-    //flag
-    BOOL isApple = NO;
+    //span
+    stageSpan = traceBegin("signing.notarization");
     
-    //code
-    SecStaticCodeRef staticCode = NULL;
+    //register stapled ticket (if any)
+    // allows notarization to be checked, even when offline
+    registerStapledTicket(path);
     
-    //signing reqs
-    SecRequirementRef requirementRef = NULL;
+    //start
+    // online checks share a single deadline
+    notarizationStart = CFAbsoluteTimeGetCurrent();
     
-    //status
-    OSStatus status = -1;
+    //check notarization status offline first
+    // i.e. stapled/registered (or previously downloaded) tickets
+    notarizedOffline = satisfiesRequirement(staticCode, notarizedRequirement, kSecCSNoNetworkAccess);
     
-    //create static code
-    status = SecStaticCodeCreateWithPath((__bridge CFURLRef)([NSURL fileURLWithPath:path]), kSecCSDefaultFlags, &staticCode);
-    if(errSecSuccess != status)
+    //then online
+    // note: forces online checks (revocation), but w/ a deadline
+    if(YES == satisfiesRequirementWithin(staticCode, notarizedRequirement, kSecCSEnforceRevocationChecks, TICKET_LOOKUP_DEADLINE, &notarizationTimedOut))
     {
-        //bail
-        goto bail;
+        //notarized
+        signingInfo[KEY_SIGNING_IS_NOTARIZED] = [NSNumber numberWithInteger:errSecSuccess];
     }
-    
-    //create req string w/ 'anchor apple'
-    // (3rd party: 'anchor apple generic')
-    status = SecRequirementCreateWithString(CFSTR("anchor apple"), kSecCSDefaultFlags, &requirementRef);
-    if( (errSecSuccess != status) ||
-        (requirementRef == NULL) )
+    //timed out
+    // go w/ offline result (as revocation couldn't be checked)
+    else if(YES == notarizationTimedOut)
     {
-        //bail
-        goto bail;
+        //dbg msg
+        os_log_debug(OS_LOG_DEFAULT, "WYS: online notarization check of %{public}@ didn't complete within %.1f seconds", path, TICKET_LOOKUP_DEADLINE);
+        
+        //notarized (offline)?
+        if(YES == notarizedOffline)
+        {
+            signingInfo[KEY_SIGNING_IS_NOTARIZED] = [NSNumber numberWithInteger:errSecSuccess];
+        }
     }
-    
-    //check if file is signed by apple by checking if it conforms to req string
-    status = SecStaticCodeCheckValidity(staticCode, flags, requirementRef);
-    if(errSecSuccess != status)
+    //failed
+    // but maybe cuz it's revoked? check hashes (concurrently, w/ what's left of deadline)
+    else if(errSecCSRevokedNotarization == lookupTickets([((__bridge NSDictionary*)signingDetails)[@"cdhashes-full"] allObjects], MAX(TICKET_LOOKUP_DEADLINE - (CFAbsoluteTimeGetCurrent() - notarizationStart), 0)))
     {
-        //bail
-        // just means isn't signed by apple
-        goto bail;
+        //revoked
+        signingInfo[KEY_SIGNING_IS_NOTARIZED] = [NSNumber numberWithInteger:errSecCSRevokedNotarization];
     }
     
-    //ok, happy (SecStaticCodeCheckValidity() didn't fail)
-    // file is signed by Apple
-    isApple = YES;
+    //end span
+    traceEnd(&stageSpan, 0);
     
 bail:
     
-    //free req reference
-    if(NULL != requirementRef)
+    //save verdict
+    // but only if item didn't change while it was being validated, and its notarization was (fully) checked
+    if( (YES == cacheable) &&
+        (nil == cachedInfo) &&
+        (YES != notarizationTimedOut) &&
+        (YES == verdictCacheKey(path, offset, flags, entitlements, &keyAfter)) &&
+        (0 == memcmp(&key, &keyAfter, sizeof(VerdictKey))) )
+    {
+        //save
+        verdictCacheStore(&key, signingInfo);
+    }
+    
+    //free signing info
+    if(NULL != signingDetails)
     {
         //free
-        CFRelease(requirementRef);
+        CFRelease(signingDetails);
         
         //unset
-        requirementRef = NULL;
+        signingDetails = NULL;
     }
     
     //free static code
@@ -502,7 +696,22 @@ bail:
         staticCode = NULL;
     }
     
-    return isApple;
+    //end span
+    traceEnd(&span, 0);
+    
+    return signingInfo;
+}
+
+//determine if a file is signed by Apple proper
+// note: 'extractSigningInfo' doesn't call this, as it checks its (already validated) static code
+BOOL isApple(NSString* path, SecCSFlags flags)
+{
+    //init requirements
+    initRequirements();
+    
+    //check 'anchor apple'
+    // (3rd party: 'anchor apple generic')
+    return checkRequirement(path, flags, appleRequirement);
 }
 
 //verify the receipt
@@ -564,7 +773,9 @@ BOOL verifyReceipt(NSBundle* appBundle, AppReceipt* receipt)
     CC_SHA1(digestData.bytes, (CC_LONG)digestData.length, digestBuffer);
     
     //check for hash match
-    if(0 != memcmp(digestBuffer, receipt.receiptHash.bytes, CC_SHA1_DIGEST_LENGTH))
+    // note: receipt's hash has to be (at least) as long as digest
+    if( (receipt.receiptHash.length < CC_SHA1_DIGEST_LENGTH) ||
+        (0 != memcmp(digestBuffer, receipt.receiptHash.bytes, CC_SHA1_DIGEST_LENGTH)) )
     {
         //hash check failed
         goto bail;
@@ -685,69 +896,14 @@ bail:
 }
 
 //determine if file is signed with Apple Dev ID/cert
+// note: 'extractSigningInfo' doesn't call this, as it checks its (already validated) static code
 BOOL isSignedDevID(NSString* path, SecCSFlags flags)
 {
-    //flag
-    BOOL signedOK = NO;
-    
-    //code
-    SecStaticCodeRef staticCode = NULL;
-    
-    //signing reqs
-    SecRequirementRef requirementRef = NULL;
-    
-    //status
-    OSStatus status = -1;
-    
-    //create static code
-    status = SecStaticCodeCreateWithPath((__bridge CFURLRef)([NSURL fileURLWithPath:path]), kSecCSDefaultFlags, &staticCode);
-    if(errSecSuccess != status)
-    {
-        //bail
-        goto bail;
-    }
-    
-    //create req string w/ 'anchor apple generic'
-    status = SecRequirementCreateWithString(CFSTR("anchor apple generic"), kSecCSDefaultFlags, &requirementRef);
-    if( (errSecSuccess != status) ||
-        (requirementRef == NULL) )
-    {
-        //bail
-        goto bail;
-    }
-    
-    //check if file is signed w/ apple dev id by checking if it conforms to req string
-    status = SecStaticCodeCheckValidity(staticCode, flags, requirementRef);
-    if(errSecSuccess != status)
-    {
-        //bail
-        // just means app isn't signed by apple dev id
-        goto bail;
-    }
-    
-    //ok, happy
-    // file is signed by Apple Dev ID
-    signedOK = YES;
-    
-bail:
-    
-    //free req reference
-    if(NULL != requirementRef)
-    {
-        //free
-        CFRelease(requirementRef);
-        requirementRef = NULL;
-    }
-    
-    //free static code
-    if(NULL != staticCode)
-    {
-        //free
-        CFRelease(staticCode);
-        staticCode = NULL;
-    }
+    //init requirements
+    initRequirements();
     
-    return signedOK;
+    //check 'anchor apple generic'
+    return checkRequirement(path, flags, devIDRequirement);
 }
 
 //determine if a file is from the app store
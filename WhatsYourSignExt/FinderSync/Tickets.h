@@ -0,0 +1,76 @@
+//
+//  Tickets.h
+//  WhatsYourSign
+//
+//  Created by Patrick Wardle on 10/17/26.
+//  Copyright (c) 2026 Objective-See. All rights reserved.
+//
+//  note: notarization tickets can be stapled to:
+//        bundles: as 'Contents/CodeResources'
+//        pkgs:    appended, followed by a trailer (magic 't8lr', version, type, length)
+//        dmgs:    in the code signature (which the UDIF trailer points to), in the ticket slot
+//        once registered w/ the system, tickets are found without going online
+
+#ifndef Tickets_h
+#define Tickets_h
+
+@import Foundation;
+@import Security;
+
+#import "Udif.h"
+
+//ticket magic ('s8ch')
+#define TICKET_MAGIC 0x73386368
+
+//pkg trailer magic ('t8lr')
+#define TICKET_TRAILER_MAGIC 0x74386c72
+
+//pkg trailer version
+#define TICKET_TRAILER_VERSION 1
+
+//pkg trailer type: ticket
+#define TICKET_TRAILER_TYPE_TICKET 2
+
+//max size of a ticket
+#define TICKET_MAX_SIZE (1024*1024)
+
+//code signature slot of (stapled) ticket
+#define CODESIGN_SLOT_TICKET 0x10002
+
+//time (seconds) to wait for (online) lookups
+// for all of an item's hashes
+#define TICKET_LOOKUP_DEADLINE 3.0
+
+//time (seconds) lookup results are cached
+#define TICKET_CACHE_TTL (60*60)
+
+//time (seconds) 'not found' results are cached
+#define TICKET_CACHE_NEGATIVE_TTL (5*60)
+
+//pkg trailer
+typedef struct
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t type;
+    uint32_t length;
+    uint32_t reserved;
+
+} __attribute__((packed)) TicketTrailer;
+
+/* FUNCTIONS */
+
+//get an item's stapled ticket
+// returns nil if item (bundle, pkg, dmg) doesn't have one
+NSData* stapledTicket(NSString* path);
+
+//register an item's stapled ticket w/ the system
+// only done once per item, returns NO if there's no ticket
+BOOL registerStapledTicket(NSString* path);
+
+//lookup (notarization) tickets for cd hashes
+// lookups are concurrent, bounded by a deadline, and cached
+// returns errSecSuccess, errSecCSRevokedNotarization, or errSecCSUnsigned (not found/timed out)
+OSStatus lookupTickets(NSArray* hashes, NSTimeInterval deadline);
+
+#endif /* Tickets_h */
@@ -0,0 +1,506 @@
+//
+//  Tickets.m
+//  FinderSync
+//
+//  Created by Patrick Wardle on 10/17/26.
+//  Copyright (c) 2026 Objective-See. All rights reserved.
+//
+
+#import "MachO.h"
+#import "Signing.h"
+#import "Tickets.h"
+#import "utilities.h"
+#import "NestedCode.h"
+#import "CodeSignature.h"
+
+#import <fcntl.h>
+#import <unistd.h>
+#import <os/lock.h>
+#import <os/log.h>
+#import <sys/stat.h>
+#import <CommonCrypto/CommonDigest.h>
+
+//lock
+// for cache, registered items, and lookup results
+static os_unfair_lock ticketsLock = OS_UNFAIR_LOCK_INIT;
+
+//cached lookups
+// truncated hash -> @[status, time]
+static NSMutableDictionary* lookups = nil;
+
+//items whose tickets were registered
+static NSMutableSet* registered = nil;
+
+//is data a ticket?
+static BOOL isTicket(NSData* data)
+{
+    return (data.length >= 4) &&
+           (data.length <= TICKET_MAX_SIZE) &&
+           (TICKET_MAGIC == OSReadBigInt32(data.bytes, 0));
+}
+
+//get ticket stapled to a pkg
+// it's appended, and followed by a trailer
+static NSData* pkgTicket(int fd, off_t size)
+{
+    //ticket
+    NSMutableData* ticket = nil;
+    
+    //trailer
+    TicketTrailer trailer = {0};
+    
+    //sanity check
+    if(size < (off_t)sizeof(trailer))
+    {
+        //bail
+        goto bail;
+    }
+    
+    //read trailer
+    if(YES != readAt(fd, &trailer, sizeof(trailer), (uint64_t)size - sizeof(trailer)))
+    {
+        //bail
+        goto bail;
+    }
+    
+    //check trailer
+    // note: fields are little-endian
+    if( (TICKET_TRAILER_MAGIC != OSSwapLittleToHostInt32(trailer.magic)) ||
+        (TICKET_TRAILER_VERSION != OSSwapLittleToHostInt16(trailer.version)) ||
+        (TICKET_TRAILER_TYPE_TICKET != OSSwapLittleToHostInt16(trailer.type)) ||
+        (OSSwapLittleToHostInt32(trailer.length) > TICKET_MAX_SIZE) ||
+        ((off_t)OSSwapLittleToHostInt32(trailer.length) > size - (off_t)sizeof(trailer)) )
+    {
+        //bail
+        goto bail;
+    }
+    
+    //alloc
+    ticket = [NSMutableData dataWithLength:OSSwapLittleToHostInt32(trailer.length)];
+    
+    //read ticket
+    // directly precedes trailer
+    if(YES != readAt(fd, ticket.mutableBytes, ticket.length, (uint64_t)size - sizeof(trailer) - ticket.length))
+    {
+        //unset
+        ticket = nil;
+    }
+
+bail:
+    
+    return ticket;
+}
+
+//get ticket stapled to a dmg
+// it's in the (image's) code signature, which the UDIF trailer points to
+static NSData* dmgTicket(int fd, off_t size)
+{
+    //ticket
+    NSData* ticket = nil;
+    
+    //trailer
+    uint8_t trailer[UDIF_TRAILER_SIZE] = {0};
+    
+    //code signature location
+    // as a 'slice', so it can be read like a mach-o's
+    MachOSlice slice = {0};
+    
+    //sanity check
+    if(size < UDIF_TRAILER_SIZE)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //read trailer
+    // it's the last 512 bytes
+    if( (YES != readAt(fd, trailer, sizeof(trailer), (uint64_t)size - UDIF_TRAILER_SIZE)) ||
+        (UDIF_MAGIC != OSReadBigInt32(trailer, 0)) )
+    {
+        //bail
+        goto bail;
+    }
+    
+    //init location
+    slice.signatureOffset = OSReadBigInt64(trailer, UDIF_CODESIGNATURE_OFFSET);
+    slice.signatureSize = (uint32_t)MIN(OSReadBigInt64(trailer, UDIF_CODESIGNATURE_LENGTH), (uint64_t)UINT32_MAX);
+    
+    //sanity check
+    if( (slice.signatureOffset > (uint64_t)size) ||
+        (slice.signatureSize > (uint64_t)size - slice.signatureOffset) )
+    {
+        //bail
+        goto bail;
+    }
+    
+    //get ticket
+    ticket = codeSignatureBlob(codeSignatureRead(fd, &slice), CODESIGN_SLOT_TICKET);
+
+bail:
+    
+    return ticket;
+}
+
+//get an item's stapled ticket
+// returns nil if item (bundle, pkg, dmg) doesn't have one
+NSData* stapledTicket(NSString* path)
+{
+    //ticket
+    NSData* ticket = nil;
+    
+    //directory flag
+    BOOL isDirectory = NO;
+    
+    //file descriptor
+    int fd = -1;
+    
+    //file info
+    struct stat info = {0};
+    
+    //bundle?
+    // ticket is a file in its contents
+    if( (YES == [NSFileManager.defaultManager fileExistsAtPath:path isDirectory:&isDirectory]) &&
+        (YES == isDirectory) )
+    {
+        //read
+        ticket = [NSData dataWithContentsOfFile:[bundleContents(path) stringByAppendingPathComponent:@"CodeResources"] options:NSDataReadingMappedIfSafe error:NULL];
+        
+        //done
+        goto bail;
+    }
+    
+    //open
+    fd = open(path.fileSystemRepresentation, O_RDONLY | O_CLOEXEC);
+    if( (-1 == fd) ||
+        (0 != fstat(fd, &info)) )
+    {
+        //bail
+        goto bail;
+    }
+    
+    //pkg?
+    if(NSOrderedSame == [path.pathExtension caseInsensitiveCompare:@"pkg"])
+    {
+        //get ticket
+        ticket = pkgTicket(fd, info.st_size);
+    }
+    //dmg?
+    else if(NSOrderedSame == [path.pathExtension caseInsensitiveCompare:@"dmg"])
+    {
+        //get ticket
+        ticket = dmgTicket(fd, info.st_size);
+    }
+
+bail:
+    
+    //close
+    if(-1 != fd)
+    {
+        close(fd);
+        fd = -1;
+    }
+    
+    //not a ticket?
+    if(YES != isTicket(ticket))
+    {
+        //unset
+        ticket = nil;
+    }
+    
+    return ticket;
+}
+
+//register an item's stapled ticket w/ the system
+// only done once per item, returns NO if there's no ticket
+BOOL registerStapledTicket(NSString* path)
+{
+    //flag
+    BOOL isRegistered = NO;
+    
+    //ticket
+    NSData* ticket = nil;
+    
+    //error
+    CFErrorRef error = NULL;
+    
+    //lock
+    os_unfair_lock_lock(&ticketsLock);
+    
+    //init
+    if(nil == registered)
+    {
+        registered = [NSMutableSet set];
+    }
+    
+    //already registered?
+    isRegistered = [registered containsObject:path];
+    
+    //unlock
+    os_unfair_lock_unlock(&ticketsLock);
+    
+    //done?
+    if(YES == isRegistered)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //get ticket
+    ticket = stapledTicket(path);
+    if(nil == ticket)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //register
+    if(YES != SecAssessmentTicketRegister((__bridge CFDataRef)ticket, &error))
+    {
+        //dbg msg
+        os_log_debug(OS_LOG_DEFAULT, "WYS: failed to register ticket of %{public}@: %{public}@", path, (__bridge NSError*)error);
+        
+        //bail
+        goto bail;
+    }
+    
+    //dbg msg
+    os_log_debug(OS_LOG_DEFAULT, "WYS: registered stapled ticket of %{public}@", path);
+    
+    //happy
+    isRegistered = YES;
+    
+    //save
+    os_unfair_lock_lock(&ticketsLock);
+    [registered addObject:path];
+    os_unfair_lock_unlock(&ticketsLock);
+
+bail:
+    
+    //free error
+    if(NULL != error)
+    {
+        CFRelease(error);
+        error = NULL;
+    }
+    
+    return isRegistered;
+}
+
+//truncate a (cd) hash
+// this is what Apple uses, and also sets its type
+static NSData* truncateHash(NSData* hash, SecCSDigestAlgorithm* hashType)
+{
+    //SHA1?
+    // use as is
+    if(CC_SHA1_DIGEST_LENGTH == hash.length)
+    {
+        *hashType = kSecCodeSignatureHashSHA1;
+        return hash;
+    }
+    
+    //SHA256?
+    // truncate, first 20 bytes
+    if(CC_SHA256_DIGEST_LENGTH == hash.length)
+    {
+        *hashType = kSecCodeSignatureHashSHA256;
+        return [hash subdataWithRange:NSMakeRange(0, CC_SHA1_DIGEST_LENGTH)];
+    }
+    
+    return nil;
+}
+
+//lookup a ticket
+// online ('kSecAssessmentTicketFlagForceOnlineCheck') to detect revocations
+// 'definitive' is NO for errors (e.g. network), as these shouldn't be cached
+static OSStatus lookupTicket(NSData* truncatedHash, SecCSDigestAlgorithm hashType, BOOL* definitive)
+{
+    //status
+    OSStatus status = errSecCSUnsigned;
+    
+    //error
+    CFErrorRef error = NULL;
+    
+    //init
+    *definitive = YES;
+    
+    //lookup
+    if(YES == SecAssessmentTicketLookup((__bridge CFDataRef)truncatedHash, hashType, kSecAssessmentTicketFlagForceOnlineCheck, NULL, &error))
+    {
+        //notarized
+        status = errSecSuccess;
+    }
+    //EACCES: means revoked
+    else if( (NULL != error) &&
+             (EACCES == CFErrorGetCode(error)) )
+    {
+        //revoked
+        status = errSecCSRevokedNotarization;
+    }
+    //anything but ENOENT (not found)?
+    // e.g. offline, so result isn't definitive
+    else if( (NULL == error) ||
+             (ENOENT != CFErrorGetCode(error)) )
+    {
+        //dbg msg
+        os_log_debug(OS_LOG_DEFAULT, "WYS: ticket lookup failed: %{public}@", (__bridge NSError*)error);
+        
+        //not definitive
+        *definitive = NO;
+    }
+    
+    //free error
+    if(NULL != error)
+    {
+        CFRelease(error);
+        error = NULL;
+    }
+    
+    return status;
+}
+
+//get cached lookup
+// note: call with lock held
+static NSNumber* cachedLookup(NSData* truncatedHash)
+{
+    //cached
+    NSArray* cached = lookups[truncatedHash];
+    
+    //not found?
+    if(nil == cached)
+    {
+        return nil;
+    }
+    
+    //expired?
+    // 'not found' results expire sooner, as item might've just been notarized
+    if(-[cached[1] timeIntervalSinceNow] > ((errSecCSUnsigned == [cached[0] intValue]) ? TICKET_CACHE_NEGATIVE_TTL : TICKET_CACHE_TTL))
+    {
+        //remove
+        [lookups removeObjectForKey:truncatedHash];
+        
+        return nil;
+    }
+    
+    return cached[0];
+}
+
+//combine lookup results
+// revoked trumps notarized, which trumps not found
+static OSStatus combine(OSStatus current, OSStatus status)
+{
+    if( (errSecCSRevokedNotarization == current) ||
+        (errSecCSRevokedNotarization == status) )
+    {
+        return errSecCSRevokedNotarization;
+    }
+    
+    if( (errSecSuccess == current) ||
+        (errSecSuccess == status) )
+    {
+        return errSecSuccess;
+    }
+    
+    return errSecCSUnsigned;
+}
+
+//lookup (notarization) tickets for cd hashes
+// lookups are concurrent, bounded by a deadline, and cached
+// returns errSecSuccess, errSecCSRevokedNotarization, or errSecCSUnsigned (not found/timed out)
+OSStatus lookupTickets(NSArray* hashes, NSTimeInterval deadline)
+{
+    //result
+    // note: lookups still running after deadline may (harmlessly) update it
+    __block OSStatus result = errSecCSUnsigned;
+    
+    //status
+    OSStatus status = errSecCSUnsigned;
+    
+    //group
+    dispatch_group_t group = NULL;
+    
+    //init group
+    group = dispatch_group_create();
+    
+    //lookup each
+    for(NSData* hash in hashes)
+    {
+        //hash type
+        SecCSDigestAlgorithm hashType = 0;
+        
+        //truncated hash
+        NSData* truncatedHash = nil;
+        
+        //cached result
+        NSNumber* cached = nil;
+        
+        //sanity check
+        if(YES != [hash isKindOfClass:[NSData class]])
+        {
+            continue;
+        }
+        
+        //truncate
+        // unknown types are just ignored
+        truncatedHash = truncateHash(hash, &hashType);
+        if(nil == truncatedHash)
+        {
+            continue;
+        }
+        
+        //check cache
+        os_unfair_lock_lock(&ticketsLock);
+        if(nil == lookups)
+        {
+            lookups = [NSMutableDictionary dictionary];
+        }
+        cached = cachedLookup(truncatedHash);
+        if(nil != cached)
+        {
+            result = combine(result, cached.intValue);
+        }
+        os_unfair_lock_unlock(&ticketsLock);
+        
+        //cached?
+        if(nil != cached)
+        {
+            continue;
+        }
+        
+        //lookup
+        // in background, as it goes online
+        dispatch_group_async(group, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+            
+            //definitive?
+            BOOL definitive = NO;
+            
+            //lookup
+            OSStatus lookupStatus = lookupTicket(truncatedHash, hashType, &definitive);
+            
+            //save
+            // even if past deadline, so it's ready next time (but not errors, e.g. when offline)
+            os_unfair_lock_lock(&ticketsLock);
+            if(YES == definitive)
+            {
+                lookups[truncatedHash] = @[[NSNumber numberWithInt:lookupStatus], [NSDate date]];
+            }
+            result = combine(result, lookupStatus);
+            os_unfair_lock_unlock(&ticketsLock);
+        
+        });
+    }
+    
+    //wait
+    // but only until deadline
+    if(0 != dispatch_group_wait(group, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(deadline * NSEC_PER_SEC))))
+    {
+        //dbg msg
+        os_log_debug(OS_LOG_DEFAULT, "WYS: ticket lookup(s) didn't complete within %.1f seconds", deadline);
+    }
+    
+    //grab result
+    os_unfair_lock_lock(&ticketsLock);
+    status = result;
+    os_unfair_lock_unlock(&ticketsLock);
+    
+    return status;
+}
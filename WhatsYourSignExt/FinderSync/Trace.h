@@ -0,0 +1,80 @@
+//
+//  Trace.h
+//  WhatsYourSign
+//
+//  Created by Patrick Wardle on 10/17/26.
+//  Copyright (c) 2026 Objective-See. All rights reserved.
+//
+//  note: spans (around each stage of verification) are recorded only when tracing is enabled
+//        via 'WYS_TRACE=<path>' (environment), or the 'traceFile' (shared) default, and exported as Chrome trace JSON
+//        they're (also) emitted as signposts, whenever Instruments is recording
+
+#ifndef Trace_h
+#define Trace_h
+
+@import Foundation;
+
+#import <os/signpost.h>
+
+//environment variable
+// path to write trace to
+#define TRACE_ENV "WYS_TRACE"
+
+//max # of (recorded) events
+// beyond this, events are dropped (but still counted)
+#define TRACE_MAX_EVENTS (64*1024)
+
+//max # of (distinct) stages
+#define TRACE_MAX_STAGES 128
+
+//delay before (re)writing trace
+// so a burst of spans results in a single write
+#define TRACE_FLUSH_DELAY 2.0
+
+//span
+// name (static string), start time, and signpost id
+// note: start is 0 when tracing is disabled
+typedef struct
+{
+    //name
+    const char* name;
+    
+    //start (nanoseconds)
+    uint64_t start;
+    
+    //signpost id
+    os_signpost_id_t signpost;
+
+} TraceSpan;
+
+/* FUNCTIONS */
+
+//begin a span
+// name must be a static string
+TraceSpan traceBegin(const char* name);
+
+//end a span
+// records its duration, (optional) byte count, and thread
+void traceEnd(TraceSpan* span, uint64_t bytes);
+
+//check if tracing is enabled
+// i.e. to a file, or Instruments is recording
+BOOL traceIsEnabled(void);
+
+//get size of a file
+// only when tracing is enabled, as it's just for spans' byte counts
+uint64_t traceFileSize(NSString* path);
+
+//get (per-stage) counters
+// aggregated across all spans: count, total and max duration, and bytes
+NSDictionary* traceCounters(void);
+
+//export trace
+// Chrome trace JSON, w/ (per-stage) counters
+BOOL traceExport(NSString* path);
+
+//write trace now
+// (if enabled) e.g. before exiting, as writes are otherwise delayed
+void traceFlush(void);
+
+#endif /* Trace_h */
@@ -0,0 +1,457 @@
+//
+//  Trace.m
+//  FinderSync
+//
+//  Created by Patrick Wardle on 10/17/26.
+//  Copyright (c) 2026 Objective-See. All rights reserved.
+//
+
+#import "consts.h"
+#import "Trace.h"
+
+#import <os/lock.h>
+#import <pthread.h>
+#import <sys/stat.h>
+#import <stdatomic.h>
+
+//event
+// a (completed) span
+typedef struct
+{
+    //name
+    const char* name;
+    
+    //start (nanoseconds)
+    uint64_t start;
+    
+    //duration (nanoseconds)
+    uint64_t duration;
+    
+    //bytes
+    uint64_t bytes;
+    
+    //thread
+    uint64_t thread;
+
+} TraceEvent;
+
+//stage
+// counters, aggregated across all of its spans
+typedef struct
+{
+    //name
+    const char* name;
+    
+    //# of spans
+    uint64_t count;
+    
+    //total duration (nanoseconds)
+    uint64_t total;
+    
+    //max duration (nanoseconds)
+    uint64_t max;
+    
+    //bytes
+    uint64_t bytes;
+
+} TraceStage;
+
+//path to write trace to
+// nil, if (file) tracing is disabled
+static NSString* tracePath = nil;
+
+//log for signposts
+static os_log_t traceLog = NULL;
+
+//events
+static TraceEvent* events = NULL;
+
+//# of events
+static NSUInteger eventCount = 0;
+
+//# of dropped events
+static uint64_t droppedCount = 0;
+
+//stages
+static TraceStage stages[TRACE_MAX_STAGES];
+
+//# of stages
+static NSUInteger stageCount = 0;
+
+//lock for events and stages
+static os_unfair_lock traceLock = OS_UNFAIR_LOCK_INIT;
+
+//write pending?
+static atomic_bool flushPending = false;
+
+//init tracing
+// only once, from environment or (shared) defaults
+static void traceInit(void)
+{
+    //once token
+    static dispatch_once_t onceToken = 0;
+    
+    //only once
+    dispatch_once(&onceToken, ^{
+        
+        //path (from environment)
+        const char* path = getenv(TRACE_ENV);
+        
+        //init log
+        traceLog = os_log_create("com.objective-see.wys", "stages");
+        
+        //init path
+        // environment takes precedence
+        if( (NULL != path) &&
+            (0 != path[0]) )
+        {
+            tracePath = [NSString stringWithUTF8String:path];
+        }
+        else
+        {
+            tracePath = [[[NSUserDefaults alloc] initWithSuiteName:APP_GROUP] stringForKey:PREF_TRACE_FILE];
+        }
+        
+        //enabled?
+        // alloc events
+        if(nil != tracePath)
+        {
+            //alloc
+            events = calloc(TRACE_MAX_EVENTS, sizeof(TraceEvent));
+            if(NULL == events)
+            {
+                //disable
+                tracePath = nil;
+            }
+        }
+    
+    });
+    
+    return;
+}
+
+//find stage
+// or add it, if there's room (caller must hold lock)
+static TraceStage* findStage(const char* name)
+{
+    //find
+    // names are usually the same (static) string, so compare pointers first
+    for(NSUInteger i = 0; i < stageCount; i++)
+    {
+        if( (name == stages[i].name) ||
+            (0 == strcmp(name, stages[i].name)) )
+        {
+            return &stages[i];
+        }
+    }
+    
+    //full?
+    if(stageCount >= TRACE_MAX_STAGES)
+    {
+        return NULL;
+    }
+    
+    //add
+    stages[stageCount].name = name;
+    
+    return &stages[stageCount++];
+}
+
+//write trace
+// after a delay, so a burst of spans results in a single write
+static void scheduleFlush(void)
+{
+    //already pending?
+    if(true == atomic_exchange(&flushPending, true))
+    {
+        return;
+    }
+    
+    //write (later)
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(TRACE_FLUSH_DELAY * NSEC_PER_SEC)), dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+        
+        //unset
+        // before write, so later spans (re)schedule
+        atomic_store(&flushPending, false);
+        
+        //write
+        traceExport(tracePath);
+    
+    });
+    
+    return;
+}
+
+//begin a span
+// name must be a static string
+TraceSpan traceBegin(const char* name)
+{
+    //span
+    TraceSpan span = {name, 0, OS_SIGNPOST_ID_NULL};
+    
+    //init
+    traceInit();
+    
+    //Instruments recording?
+    // begin signpost interval
+    if(os_signpost_enabled(traceLog))
+    {
+        //init id
+        span.signpost = os_signpost_id_generate(traceLog);
+        
+        //begin
+        os_signpost_interval_begin(traceLog, span.signpost, "stage", "%{public}s", name);
+    }
+    
+    //enabled?
+    // start clock
+    if( (nil != tracePath) ||
+        (OS_SIGNPOST_ID_NULL != span.signpost) )
+    {
+        span.start = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+    }
+    
+    return span;
+}
+
+//end a span
+// records its duration, (optional) byte count, and thread
+void traceEnd(TraceSpan* span, uint64_t bytes)
+{
+    //event
+    TraceEvent event = {0};
+    
+    //stage
+    TraceStage* stage = NULL;
+    
+    //disabled?
+    if(0 == span->start)
+    {
+        return;
+    }
+    
+    //init event
+    event.name = span->name;
+    event.start = span->start;
+    event.duration = clock_gettime_nsec_np(CLOCK_UPTIME_RAW) - span->start;
+    event.bytes = bytes;
+    pthread_threadid_np(NULL, &event.thread);
+    
+    //end signpost interval
+    if(OS_SIGNPOST_ID_NULL != span->signpost)
+    {
+        os_signpost_interval_end(traceLog, span->signpost, "stage", "%{public}s bytes:%llu", span->name, bytes);
+    }
+    
+    //unset
+    // so span can't be ended twice
+    span->start = 0;
+    
+    //only signposts?
+    if(nil == tracePath)
+    {
+        return;
+    }
+    
+    //lock
+    os_unfair_lock_lock(&traceLock);
+    
+    //save event
+    // or drop it, if full
+    if(eventCount < TRACE_MAX_EVENTS)
+    {
+        events[eventCount++] = event;
+    }
+    else
+    {
+        droppedCount++;
+    }
+    
+    //update stage's counters
+    stage = findStage(event.name);
+    if(NULL != stage)
+    {
+        stage->count++;
+        stage->total += event.duration;
+        stage->max = MAX(stage->max, event.duration);
+        stage->bytes += event.bytes;
+    }
+    
+    //unlock
+    os_unfair_lock_unlock(&traceLock);
+    
+    //write (later)
+    scheduleFlush();
+    
+    return;
+}
+
+//check if tracing is enabled
+// i.e. to a file, or Instruments is recording
+BOOL traceIsEnabled(void)
+{
+    //init
+    traceInit();
+    
+    return (nil != tracePath) || (os_signpost_enabled(traceLog));
+}
+
+//get size of a file
+// only when tracing is enabled, as it's just for spans' byte counts
+uint64_t traceFileSize(NSString* path)
+{
+    //file info
+    struct stat info = {0};
+    
+    //disabled?
+    if(YES != traceIsEnabled())
+    {
+        return 0;
+    }
+    
+    return (0 == stat(path.fileSystemRepresentation, &info)) ? (uint64_t)info.st_size : 0;
+}
+
+//get (per-stage) counters
+// aggregated across all spans: count, total and max duration, and bytes
+NSDictionary* traceCounters(void)
+{
+    //counters
+    NSMutableDictionary* counters = nil;
+    
+    //init
+    counters = [NSMutableDictionary dictionary];
+    
+    //lock
+    os_unfair_lock_lock(&traceLock);
+    
+    //add each stage
+    for(NSUInteger i = 0; i < stageCount; i++)
+    {
+        counters[[NSString stringWithUTF8String:stages[i].name]] = @{@"count":[NSNumber numberWithUnsignedLongLong:stages[i].count],
+                                                                     @"totalMs":[NSNumber numberWithDouble:stages[i].total / (double)NSEC_PER_MSEC],
+                                                                     @"maxMs":[NSNumber numberWithDouble:stages[i].max / (double)NSEC_PER_MSEC],
+                                                                     @"bytes":[NSNumber numberWithUnsignedLongLong:stages[i].bytes]};
+    }
+    
+    //unlock
+    os_unfair_lock_unlock(&traceLock);
+    
+    return counters;
+}
+
+//export trace
+// Chrome trace JSON, w/ (per-stage) counters
+BOOL traceExport(NSString* path)
+{
+    //flag
+    BOOL exported = NO;
+    
+    //(copy of) events
+    TraceEvent* snapshot = NULL;
+    
+    //# of events
+    NSUInteger count = 0;
+    
+    //# of dropped events
+    uint64_t dropped = 0;
+    
+    //trace events
+    NSMutableArray* traceEvents = nil;
+    
+    //JSON
+    NSData* json = nil;
+    
+    //pid
+    pid_t pid = getpid();
+    
+    //sanity check
+    if( (nil == path) ||
+        (NULL == events) )
+    {
+        //bail
+        goto bail;
+    }
+    
+    //lock
+    os_unfair_lock_lock(&traceLock);
+    
+    //copy events
+    // so lock isn't held while serializing
+    count = eventCount;
+    dropped = droppedCount;
+    snapshot = malloc(MAX(count, 1) * sizeof(TraceEvent));
+    if(NULL != snapshot)
+    {
+        memcpy(snapshot, events, count * sizeof(TraceEvent));
+    }
+    
+    //unlock
+    os_unfair_lock_unlock(&traceLock);
+    
+    //sanity check
+    if(NULL == snapshot)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //init
+    traceEvents = [NSMutableArray arrayWithCapacity:count];
+    
+    //convert events
+    // complete ('X') events, w/ times in microseconds
+    for(NSUInteger i = 0; i < count; i++)
+    {
+        [traceEvents addObject:@{@"name":[NSString stringWithUTF8String:snapshot[i].name],
+                                 @"cat":@"wys",
+                                 @"ph":@"X",
+                                 @"ts":[NSNumber numberWithDouble:snapshot[i].start / (double)NSEC_PER_USEC],
+                                 @"dur":[NSNumber numberWithDouble:snapshot[i].duration / (double)NSEC_PER_USEC],
+                                 @"pid":[NSNumber numberWithInt:pid],
+                                 @"tid":[NSNumber numberWithUnsignedLongLong:snapshot[i].thread],
+                                 @"args":@{@"bytes":[NSNumber numberWithUnsignedLongLong:snapshot[i].bytes]}}];
+    }
+    
+    //serialize
+    // counters are saved as (Chrome trace) 'otherData'
+    json = [NSJSONSerialization dataWithJSONObject:@{@"traceEvents":traceEvents,
+                                                     @"displayTimeUnit":@"ms",
+                                                     @"otherData":@{@"stages":traceCounters(), @"dropped":[NSNumber numberWithUnsignedLongLong:dropped]}} options:0 error:NULL];
+    if(nil == json)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //write
+    exported = [json writeToFile:path atomically:YES];
+
+bail:
+    
+    //free
+    if(NULL != snapshot)
+    {
+        free(snapshot);
+        snapshot = NULL;
+    }
+    
+    return exported;
+}
+
+//write trace now
+// (if enabled) e.g. before exiting, as writes are otherwise delayed
+void traceFlush(void)
+{
+    //init
+    traceInit();
+    
+    //enabled?
+    if(nil != tracePath)
+    {
+        //write
+        traceExport(tracePath);
+    }
+    
+    return;
+}
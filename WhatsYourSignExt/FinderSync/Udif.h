@@ -0,0 +1,103 @@
+//
+//  Udif.h
+//  WhatsYourSign
+//
+//  Created by Patrick Wardle on 10/17/26.
+//  Copyright (c) 2026 Objective-See. All rights reserved.
+//
+//  note: UDIF (dmg) format: data fork, then (XML) plist of partitions ('blkx'), then a 512-byte trailer ('koly')
+//        each partition's 'mish' table maps its sectors to (compressed) chunks in the data fork
+//        chunks are independent, so are read and decompressed in parallel, w/ their CRCs combined in order
+
+#ifndef Udif_h
+#define Udif_h
+
+@import Foundation;
+
+//UDIF (dmg) trailer magic ('koly')
+#define UDIF_MAGIC 0x6b6f6c79
+
+//UDIF (dmg) trailer size
+#define UDIF_TRAILER_SIZE 512
+
+//UDIF (dmg) trailer: offsets of fields
+#define UDIF_DATA_FORK_OFFSET 0x18
+#define UDIF_DATA_FORK_LENGTH 0x20
+#define UDIF_DATA_CHECKSUM 0x50
+#define UDIF_XML_OFFSET 0xD8
+#define UDIF_XML_LENGTH 0xE0
+#define UDIF_CODESIGNATURE_OFFSET 0xE8
+#define UDIF_CODESIGNATURE_LENGTH 0xF0
+#define UDIF_MASTER_CHECKSUM 0x160
+
+//partition table ('mish') magic
+#define UDIF_MISH_MAGIC 0x6d697368
+
+//partition table: size of header, and of each chunk
+#define UDIF_MISH_HEADER_SIZE 0xCC
+#define UDIF_MISH_CHUNK_SIZE 0x28
+
+//partition table: offset of checksum
+#define UDIF_MISH_CHECKSUM 0x40
+
+//checksum type: CRC32
+// checksums are type, size (in bits), then value
+#define UDIF_CHECKSUM_CRC32 2
+
+//sector size
+#define UDIF_SECTOR_SIZE 512
+
+//chunk types
+#define UDIF_CHUNK_ZERO 0x00000000
+#define UDIF_CHUNK_RAW 0x00000001
+#define UDIF_CHUNK_IGNORE 0x00000002
+#define UDIF_CHUNK_ADC 0x80000004
+#define UDIF_CHUNK_ZLIB 0x80000005
+#define UDIF_CHUNK_BZIP2 0x80000006
+#define UDIF_CHUNK_LZFSE 0x80000007
+#define UDIF_CHUNK_LZMA 0x80000008
+#define UDIF_CHUNK_COMMENT 0x7ffffffe
+#define UDIF_CHUNK_TERMINATOR 0xffffffff
+
+//max size of (XML) plist
+#define UDIF_MAX_XML_SIZE (64*1024*1024)
+
+//max size of a chunk
+// compressed, or decompressed (hdiutil uses 1MB)
+#define UDIF_MAX_CHUNK_SIZE (64*1024*1024)
+
+//size of stripes of the data fork
+// gaps between chunks are read (and checksummed) in these
+#define UDIF_STRIPE_SIZE (4*1024*1024)
+
+//class interface
+@interface UdifImage : NSObject
+{
+
+}
+
+/* METHODS */
+
+//init with path
+// reads trailer and (only) parses partition tables
+-(instancetype)init:(NSString*)path;
+
+//verify image
+// data fork and partitions are checked in one (parallel) pass, plus master checksum and code signature's details
+-(NSDictionary*)verify;
+
+/* PROPERTIES */
+
+//path
+@property(nonatomic, retain)NSString* path;
+
+//trailer
+@property(nonatomic, retain)NSData* trailer;
+
+//partitions
+// each is a name, and (raw) 'mish' table
+@property(nonatomic, retain)NSArray* partitions;
+
+@end
+
+#endif /* Udif_h */
@@ -0,0 +1,1271 @@
+//
+//  Udif.m
+//  FinderSync
+//
+//  Created by Patrick Wardle on 10/17/26.
+//  Copyright (c) 2026 Objective-See. All rights reserved.
+//
+
+#import "Udif.h"
+#import "MachO.h"
+#import "consts.h"
+#import "utilities.h"
+#import "CodeSignature.h"
+
+#import <fcntl.h>
+#import <unistd.h>
+#import <os/log.h>
+#import <sys/stat.h>
+#import <compression.h>
+#import <CommonCrypto/CommonDigest.h>
+
+@import Security;
+
+//chunk
+// where it is (in data fork), and results of decompressing it
+typedef struct
+{
+    //type
+    uint32_t type;
+    
+    //offset (in data fork)
+    uint64_t offset;
+    
+    //length (compressed)
+    uint64_t length;
+    
+    //size (decompressed)
+    uint64_t size;
+    
+    //CRC (decompressed)
+    uint32_t crc;
+    
+    //status
+    OSStatus status;
+
+} UdifChunk;
+
+//unit of work
+// a chunk, or a gap between chunks, read (and checksummed) by one worker
+typedef struct
+{
+    //offset (in data fork)
+    uint64_t offset;
+    
+    //length
+    uint64_t length;
+    
+    //chunk
+    // -1 for gaps
+    NSInteger chunk;
+    
+    //CRC (raw)
+    uint32_t crc;
+    
+    //couldn't be read?
+    BOOL readFailed;
+
+} UdifUnit;
+
+//CRC32 tables
+// slicing-by-8, so each (core) can keep up w/ disk
+static uint32_t crcTable[8][256];
+
+//init CRC32 tables
+static void crcInit(void)
+{
+    //once
+    static dispatch_once_t once = 0;
+    
+    //init
+    dispatch_once(&once, ^{
+        
+        //standard table
+        for(uint32_t i = 0; i < 256; i++)
+        {
+            //value
+            uint32_t value = i;
+            
+            //compute
+            for(int bit = 0; bit < 8; bit++)
+            {
+                value = (0 != (value & 1)) ? (0xEDB88320 ^ (value >> 1)) : (value >> 1);
+            }
+            
+            //save
+            crcTable[0][i] = value;
+        }
+        
+        //tables for (next) 7 bytes
+        for(uint32_t i = 0; i < 256; i++)
+        {
+            for(int table = 1; table < 8; table++)
+            {
+                crcTable[table][i] = (crcTable[table-1][i] >> 8) ^ crcTable[0][crcTable[table-1][i] & 0xFF];
+            }
+        }
+    });
+    
+    return;
+}
+
+//update a CRC32
+// same as zlib's 'crc32()'
+static uint32_t crc32Update(uint32_t crc, const uint8_t* bytes, size_t length)
+{
+    //invert
+    crc = ~crc;
+    
+    //align
+    while( (0 != length) &&
+           (0 != ((uintptr_t)bytes & 7)) )
+    {
+        crc = crcTable[0][(crc ^ *bytes++) & 0xFF] ^ (crc >> 8);
+        length--;
+    }
+    
+    //8 bytes at a time
+    // note: assumes little-endian
+    while(length >= 8)
+    {
+        //words
+        uint32_t one = 0;
+        uint32_t two = 0;
+        
+        //init
+        memcpy(&one, bytes, sizeof(one));
+        memcpy(&two, bytes + 4, sizeof(two));
+        one ^= crc;
+        
+        //update
+        crc = crcTable[7][one & 0xFF] ^ crcTable[6][(one >> 8) & 0xFF] ^ crcTable[5][(one >> 16) & 0xFF] ^ crcTable[4][one >> 24] ^
+              crcTable[3][two & 0xFF] ^ crcTable[2][(two >> 8) & 0xFF] ^ crcTable[1][(two >> 16) & 0xFF] ^ crcTable[0][two >> 24];
+        
+        //next
+        bytes += 8;
+        length -= 8;
+    }
+    
+    //rest
+    while(0 != length--)
+    {
+        crc = crcTable[0][(crc ^ *bytes++) & 0xFF] ^ (crc >> 8);
+    }
+    
+    return ~crc;
+}
+
+//multiply vector by (gf2) matrix
+static uint32_t gf2Times(const uint32_t* matrix, uint32_t vector)
+{
+    //sum
+    uint32_t sum = 0;
+    
+    //multiply
+    while(0 != vector)
+    {
+        //add
+        if(0 != (vector & 1))
+        {
+            sum ^= *matrix;
+        }
+        
+        //next
+        vector >>= 1;
+        matrix++;
+    }
+    
+    return sum;
+}
+
+//square a (gf2) matrix
+static void gf2Square(uint32_t* square, const uint32_t* matrix)
+{
+    //square
+    for(int i = 0; i < 32; i++)
+    {
+        square[i] = gf2Times(matrix, matrix[i]);
+    }
+    
+    return;
+}
+
+//combine CRC32s of two (adjacent) blocks
+// i.e. CRC32 of first block, then second (of 'length' bytes), same as zlib's 'crc32_combine()'
+static uint32_t crc32Combine(uint32_t first, uint32_t second, uint64_t length)
+{
+    //operator for even powers of two zeros
+    uint32_t even[32] = {0};
+    
+    //operator for odd powers of two zeros
+    uint32_t odd[32] = {0};
+    
+    //row
+    uint32_t row = 1;
+    
+    //nothing to add?
+    if(0 == length)
+    {
+        return first ^ second;
+    }
+    
+    //init operator for one zero bit
+    odd[0] = 0xEDB88320;
+    for(int i = 1; i < 32; i++)
+    {
+        odd[i] = row;
+        row <<= 1;
+    }
+    
+    //two, then four zero bits
+    gf2Square(even, odd);
+    gf2Square(odd, even);
+    
+    //apply 'length' zero bytes to first CRC
+    do
+    {
+        //next power
+        gf2Square(even, odd);
+        if(0 != (length & 1))
+        {
+            first = gf2Times(even, first);
+        }
+        
+        //next
+        length >>= 1;
+        if(0 == length)
+        {
+            break;
+        }
+        
+        //next power
+        gf2Square(odd, even);
+        if(0 != (length & 1))
+        {
+            first = gf2Times(odd, first);
+        }
+        
+        //next
+        length >>= 1;
+    
+    } while(0 != length);
+    
+    return first ^ second;
+}
+
+//update a CRC32 w/ 'length' zeros
+// e.g. for zero-filled chunks, without having to hash (GBs of) zeros
+static uint32_t crc32Zeros(uint32_t crc, uint64_t length)
+{
+    return ~crc32Combine(~crc, 0, length);
+}
+
+//decompress (Apple Data Compression) chunk
+// returns # of bytes decompressed, or SIZE_MAX if it's malformed
+static size_t adcDecode(const uint8_t* input, size_t inputLength, uint8_t* output, size_t outputLength)
+{
+    //position in input
+    size_t in = 0;
+    
+    //position in output
+    size_t out = 0;
+    
+    //decompress
+    while(in < inputLength)
+    {
+        //control byte
+        uint8_t control = input[in++];
+        
+        //length
+        size_t length = 0;
+        
+        //distance
+        size_t distance = 0;
+        
+        //literal
+        // (control & 0x7F) + 1 bytes follow
+        if(0 != (control & 0x80))
+        {
+            //init
+            length = (control & 0x7F) + 1;
+            
+            //sanity check
+            if( (length > inputLength - in) ||
+                (length > outputLength - out) )
+            {
+                return SIZE_MAX;
+            }
+            
+            //copy
+            memcpy(output + out, input + in, length);
+            in += length;
+            out += length;
+            
+            continue;
+        }
+        
+        //three-byte match
+        // 16-bit distance
+        if(0 != (control & 0x40))
+        {
+            //sanity check
+            if(2 > inputLength - in)
+            {
+                return SIZE_MAX;
+            }
+            
+            //init
+            length = (control & 0x3F) + 4;
+            distance = ((size_t)input[in] << 8) | input[in + 1];
+            in += 2;
+        }
+        //two-byte match
+        // 10-bit distance
+        else
+        {
+            //sanity check
+            if(1 > inputLength - in)
+            {
+                return SIZE_MAX;
+            }
+            
+            //init
+            length = ((control & 0x3C) >> 2) + 3;
+            distance = ((size_t)(control & 0x03) << 8) | input[in];
+            in += 1;
+        }
+        
+        //sanity check
+        if( (distance + 1 > out) ||
+            (length > outputLength - out) )
+        {
+            return SIZE_MAX;
+        }
+        
+        //copy
+        // byte by byte, as match can overlap itself
+        for(size_t i = 0; i < length; i++, out++)
+        {
+            output[out] = output[out - distance - 1];
+        }
+    }
+    
+    return out;
+}
+
+//decompress a chunk
+// returns errSecSuccess, errSecCSSignatureFailed (malformed), or errSecCSUnimplemented
+static OSStatus decompressChunk(const UdifChunk* chunk, const uint8_t* input, uint8_t* output)
+{
+    //status
+    OSStatus status = errSecCSSignatureFailed;
+    
+    //size (decompressed)
+    size_t size = 0;
+    
+    //xz magic
+    static const uint8_t xzMagic[] = {0xFD, '7', 'z', 'X', 'Z', 0x00};
+    
+    switch(chunk->type)
+    {
+        //raw
+        case UDIF_CHUNK_RAW:
+        {
+            //length must match
+            if(chunk->length == chunk->size)
+            {
+                memcpy(output, input, (size_t)chunk->size);
+                size = (size_t)chunk->size;
+            }
+            
+            break;
+        }
+        
+        //adc
+        case UDIF_CHUNK_ADC:
+        {
+            size = adcDecode(input, (size_t)chunk->length, output, (size_t)chunk->size);
+            break;
+        }
+        
+        //zlib
+        // skip zlib header, as 'COMPRESSION_ZLIB' is raw deflate
+        case UDIF_CHUNK_ZLIB:
+        {
+            if(chunk->length > 2)
+            {
+                size = compression_decode_buffer(output, (size_t)chunk->size, input + 2, (size_t)chunk->length - 2, NULL, COMPRESSION_ZLIB);
+            }
+            
+            break;
+        }
+        
+        //lzfse
+        case UDIF_CHUNK_LZFSE:
+        {
+            size = compression_decode_buffer(output, (size_t)chunk->size, input, (size_t)chunk->length, NULL, COMPRESSION_LZFSE);
+            break;
+        }
+        
+        //lzma
+        // 'COMPRESSION_LZMA' only decodes xz streams
+        case UDIF_CHUNK_LZMA:
+        {
+            //not xz?
+            if( (chunk->length < sizeof(xzMagic)) ||
+                (0 != memcmp(input, xzMagic, sizeof(xzMagic))) )
+            {
+                //unsupported
+                return errSecCSUnimplemented;
+            }
+            
+            //decompress
+            size = compression_decode_buffer(output, (size_t)chunk->size, input, (size_t)chunk->length, NULL, COMPRESSION_LZMA);
+            
+            break;
+        }
+        
+        //unsupported
+        // e.g. bzip2 (which compression framework doesn't support)
+        default:
+            return errSecCSUnimplemented;
+    }
+    
+    //all of it?
+    if(size == chunk->size)
+    {
+        //happy
+        status = errSecSuccess;
+    }
+    
+    return status;
+}
+
+//process a unit
+// read it, checksum it, and (if it's a chunk) decompress and checksum that too
+static void processUnit(int fd, uint64_t dataForkOffset, UdifUnit* unit, UdifChunk* chunks)
+{
+    //input
+    uint8_t* input = NULL;
+    
+    //output
+    uint8_t* output = NULL;
+    
+    //chunk
+    UdifChunk* chunk = NULL;
+    
+    //alloc
+    input = malloc((size_t)MAX(unit->length, 1));
+    if(NULL == input)
+    {
+        //failed
+        unit->readFailed = YES;
+        
+        //bail
+        goto bail;
+    }
+    
+    //read
+    if(YES != readAt(fd, input, (size_t)unit->length, dataForkOffset + unit->offset))
+    {
+        //failed
+        unit->readFailed = YES;
+        
+        //bail
+        goto bail;
+    }
+    
+    //checksum (raw)
+    unit->crc = crc32Update(0, input, (size_t)unit->length);
+    
+    //gap?
+    if(-1 == unit->chunk)
+    {
+        //done
+        goto bail;
+    }
+    
+    //init chunk
+    chunk = &chunks[unit->chunk];
+    
+    //raw?
+    // decompressed is raw, so reuse CRC
+    if(UDIF_CHUNK_RAW == chunk->type)
+    {
+        //save
+        chunk->crc = unit->crc;
+        chunk->status = (chunk->length == chunk->size) ? errSecSuccess : errSecCSSignatureFailed;
+        
+        //done
+        goto bail;
+    }
+    
+    //alloc
+    output = malloc((size_t)MAX(chunk->size, 1));
+    if(NULL == output)
+    {
+        //failed
+        chunk->status = errSecCSInternalError;
+        
+        //bail
+        goto bail;
+    }
+    
+    //decompress
+    chunk->status = decompressChunk(chunk, input, output);
+    if(errSecSuccess != chunk->status)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //checksum (decompressed)
+    chunk->crc = crc32Update(0, output, (size_t)chunk->size);
+
+bail:
+    
+    //free input
+    if(NULL != input)
+    {
+        free(input);
+        input = NULL;
+    }
+    
+    //free output
+    if(NULL != output)
+    {
+        free(output);
+        output = NULL;
+    }
+    
+    return;
+}
+
+//compare chunks by offset
+// for qsort_r, w/ indices into chunks
+static int compareChunks(void* chunks, const void* first, const void* second)
+{
+    //offsets
+    uint64_t firstOffset = ((const UdifChunk*)chunks)[*(const NSInteger*)first].offset;
+    uint64_t secondOffset = ((const UdifChunk*)chunks)[*(const NSInteger*)second].offset;
+    
+    return (firstOffset < secondOffset) ? -1 : ((firstOffset > secondOffset) ? 1 : 0);
+}
+
+//compare a (stored) checksum to a CRC32
+// returns errSecSuccess, errSecCSSignatureFailed, or errSecCSUnimplemented (not CRC32)
+static OSStatus checkCRC(const uint8_t* checksum, uint32_t crc)
+{
+    //not CRC32?
+    if( (UDIF_CHECKSUM_CRC32 != OSReadBigInt32(checksum, 0)) ||
+        (32 != OSReadBigInt32(checksum, 4)) )
+    {
+        return errSecCSUnimplemented;
+    }
+    
+    return (crc == OSReadBigInt32(checksum, 8)) ? errSecSuccess : errSecCSSignatureFailed;
+}
+
+//class implementation
+@implementation UdifImage
+{
+    //file descriptor
+    int fd;
+    
+    //offset of data fork
+    uint64_t dataForkOffset;
+    
+    //length of data fork
+    uint64_t dataForkLength;
+}
+
+@synthesize path;
+@synthesize trailer;
+@synthesize partitions;
+
+//init with path
+// reads trailer and (only) parses partition tables
+-(instancetype)init:(NSString*)imagePath
+{
+    //file info
+    struct stat info = {0};
+    
+    //trailer
+    uint8_t header[UDIF_TRAILER_SIZE] = {0};
+    
+    //offset of xml
+    uint64_t xmlOffset = 0;
+    
+    //length of xml
+    uint64_t xmlLength = 0;
+    
+    //xml
+    NSMutableData* xml = nil;
+    
+    //plist
+    NSDictionary* plist = nil;
+    
+    //partitions
+    NSMutableArray* tables = nil;
+    
+    //init
+    if(self = [super init])
+    {
+        //init fd
+        fd = -1;
+        
+        //save path
+        self.path = imagePath;
+        
+        //open
+        fd = open(imagePath.fileSystemRepresentation, O_RDONLY | O_CLOEXEC);
+        if( (-1 == fd) ||
+            (0 != fstat(fd, &info)) ||
+            (info.st_size < UDIF_TRAILER_SIZE) )
+        {
+            //bail
+            return nil;
+        }
+        
+        //read trailer
+        // it's the last 512 bytes
+        if( (YES != readAt(fd, header, sizeof(header), (uint64_t)info.st_size - UDIF_TRAILER_SIZE)) ||
+            (UDIF_MAGIC != OSReadBigInt32(header, 0)) )
+        {
+            //bail
+            return nil;
+        }
+        
+        //save
+        self.trailer = [NSData dataWithBytes:header length:sizeof(header)];
+        
+        //extract offsets/lengths
+        // all fields are big-endian
+        dataForkOffset = OSReadBigInt64(header, UDIF_DATA_FORK_OFFSET);
+        dataForkLength = OSReadBigInt64(header, UDIF_DATA_FORK_LENGTH);
+        xmlOffset = OSReadBigInt64(header, UDIF_XML_OFFSET);
+        xmlLength = OSReadBigInt64(header, UDIF_XML_LENGTH);
+        
+        //sanity check
+        if( (dataForkOffset > (uint64_t)info.st_size) ||
+            (dataForkLength > (uint64_t)info.st_size - dataForkOffset) ||
+            (0 == xmlLength) ||
+            (xmlLength > UDIF_MAX_XML_SIZE) ||
+            (xmlOffset > (uint64_t)info.st_size) ||
+            (xmlLength > (uint64_t)info.st_size - xmlOffset) )
+        {
+            //bail
+            return nil;
+        }
+        
+        //alloc
+        xml = [NSMutableData dataWithLength:(NSUInteger)xmlLength];
+        
+        //read xml
+        if(YES != readAt(fd, xml.mutableBytes, xml.length, xmlOffset))
+        {
+            //bail
+            return nil;
+        }
+        
+        //parse
+        plist = [NSPropertyListSerialization propertyListWithData:xml options:NSPropertyListImmutable format:NULL error:NULL];
+        if(YES != [plist isKindOfClass:[NSDictionary class]])
+        {
+            //bail
+            return nil;
+        }
+        
+        //init
+        tables = [NSMutableArray array];
+        
+        //extract partitions
+        // 'resource-fork' -> 'blkx', each w/ a name and (raw) partition table
+        for(NSDictionary* partition in plist[@"resource-fork"][@"blkx"])
+        {
+            //table
+            NSData* table = nil;
+            
+            //sanity check
+            if(YES != [partition isKindOfClass:[NSDictionary class]])
+            {
+                continue;
+            }
+            
+            //table
+            table = partition[@"Data"];
+            if(YES != [table isKindOfClass:[NSData class]])
+            {
+                continue;
+            }
+            
+            //add
+            [tables addObject:@{KEY_COMPONENT_NAME:([partition[@"Name"] isKindOfClass:[NSString class]] ? partition[@"Name"] : @"?"), @"table":table}];
+        }
+        
+        //save
+        self.partitions = tables;
+    }
+    
+    return self;
+}
+
+//parse partition tables into chunks
+// returns # of chunks, w/ each partition's (first chunk, # of chunks) in 'ranges'
+-(NSUInteger)parseChunks:(UdifChunk**)chunks ranges:(NSRange*)ranges
+{
+    //# of chunks
+    NSUInteger count = 0;
+    
+    //current
+    NSUInteger current = 0;
+    
+    //count all chunks
+    for(NSDictionary* partition in self.partitions)
+    {
+        //table
+        NSData* table = partition[@"table"];
+        
+        //add
+        if( (table.length >= UDIF_MISH_HEADER_SIZE) &&
+            (UDIF_MISH_MAGIC == OSReadBigInt32(table.bytes, 0)) )
+        {
+            count += MIN(OSReadBigInt32(table.bytes, UDIF_MISH_HEADER_SIZE - 4), (table.length - UDIF_MISH_HEADER_SIZE) / UDIF_MISH_CHUNK_SIZE);
+        }
+    }
+    
+    //alloc
+    *chunks = calloc(MAX(count, 1), sizeof(UdifChunk));
+    if(NULL == *chunks)
+    {
+        //bail
+        return 0;
+    }
+    
+    //parse each table
+    for(NSUInteger i = 0; i < self.partitions.count; i++)
+    {
+        //table
+        NSData* table = self.partitions[i][@"table"];
+        
+        //offset of partition's data
+        uint64_t base = 0;
+        
+        //# of chunks
+        NSUInteger tableCount = 0;
+        
+        //init range
+        ranges[i] = NSMakeRange(current, 0);
+        
+        //invalid?
+        if( (table.length < UDIF_MISH_HEADER_SIZE) ||
+            (UDIF_MISH_MAGIC != OSReadBigInt32(table.bytes, 0)) )
+        {
+            continue;
+        }
+        
+        //init
+        base = OSReadBigInt64(table.bytes, 0x18);
+        tableCount = MIN(OSReadBigInt32(table.bytes, UDIF_MISH_HEADER_SIZE - 4), (table.length - UDIF_MISH_HEADER_SIZE) / UDIF_MISH_CHUNK_SIZE);
+        
+        //each chunk
+        for(NSUInteger j = 0; j < tableCount; j++)
+        {
+            //entry
+            const uint8_t* entry = (const uint8_t*)table.bytes + UDIF_MISH_HEADER_SIZE + j * UDIF_MISH_CHUNK_SIZE;
+            
+            //chunk
+            UdifChunk* chunk = &(*chunks)[current];
+            
+            //type
+            chunk->type = OSReadBigInt32(entry, 0);
+            
+            //skip comments, terminator
+            if( (UDIF_CHUNK_COMMENT == chunk->type) ||
+                (UDIF_CHUNK_TERMINATOR == chunk->type) )
+            {
+                continue;
+            }
+            
+            //init
+            chunk->size = OSReadBigInt64(entry, 0x10) * UDIF_SECTOR_SIZE;
+            chunk->offset = base + OSReadBigInt64(entry, 0x18);
+            chunk->length = OSReadBigInt64(entry, 0x20);
+            
+            //zeros?
+            // nothing to read
+            if( (UDIF_CHUNK_ZERO == chunk->type) ||
+                (UDIF_CHUNK_IGNORE == chunk->type) )
+            {
+                chunk->length = 0;
+            }
+            //unknown type?
+            else if( (UDIF_CHUNK_RAW != chunk->type) &&
+                     (0 == (chunk->type & 0x80000000)) )
+            {
+                //unsupported
+                chunk->status = errSecCSUnimplemented;
+                chunk->length = 0;
+            }
+            //sanity check
+            // has to fit (in data fork, and in memory)
+            else if( (OSReadBigInt64(entry, 0x10) > UDIF_MAX_CHUNK_SIZE / UDIF_SECTOR_SIZE) ||
+                     (chunk->length > UDIF_MAX_CHUNK_SIZE) ||
+                     (chunk->offset < base) ||
+                     (chunk->offset > dataForkLength) ||
+                     (chunk->length > dataForkLength - chunk->offset) ||
+                     ( (0 == chunk->length) && (0 != chunk->size) ) )
+            {
+                //malformed
+                chunk->status = errSecCSSignatureFailed;
+                chunk->length = 0;
+            }
+            
+            //next
+            current++;
+        }
+        
+        //save range
+        ranges[i].length = current - ranges[i].location;
+    }
+    
+    return current;
+}
+
+//add unit(s) for a gap
+// split into stripes, so they're read in parallel too
+static NSUInteger addGap(UdifUnit* units, NSUInteger count, uint64_t start, uint64_t end)
+{
+    //add
+    while(start < end)
+    {
+        //init
+        units[count].offset = start;
+        units[count].length = MIN(end - start, (uint64_t)UDIF_STRIPE_SIZE);
+        units[count].chunk = -1;
+        
+        //next
+        start += units[count].length;
+        count++;
+    }
+    
+    return count;
+}
+
+//build units of work
+// chunks (sorted by offset), and gaps between them, to cover data fork
+// returns # of units, w/ 'contiguous' set to NO if chunks overlap (so data fork is covered by gaps only)
+-(NSUInteger)buildUnits:(UdifUnit**)units chunks:(UdifChunk*)chunks count:(NSUInteger)count contiguous:(BOOL*)contiguous
+{
+    //chunks (w/ data)
+    NSInteger* order = NULL;
+    
+    //# of chunks w/ data
+    NSUInteger withData = 0;
+    
+    //# of units
+    NSUInteger unitCount = 0;
+    
+    //current offset
+    uint64_t current = 0;
+    
+    //init
+    *contiguous = YES;
+    
+    //alloc
+    order = calloc(MAX(count, 1), sizeof(NSInteger));
+    if(NULL == order)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //find chunks w/ data
+    for(NSUInteger i = 0; i < count; i++)
+    {
+        if(0 != chunks[i].length)
+        {
+            order[withData++] = (NSInteger)i;
+        }
+    }
+    
+    //sort by offset
+    qsort_r(order, withData, sizeof(NSInteger), chunks, compareChunks);
+    
+    //check for overlap
+    for(NSUInteger i = 0; i < withData; i++)
+    {
+        //overlaps?
+        if(chunks[order[i]].offset < current)
+        {
+            //not contiguous
+            *contiguous = NO;
+            break;
+        }
+        
+        //next
+        current = chunks[order[i]].offset + chunks[order[i]].length;
+    }
+    
+    //alloc units
+    // at most: each chunk, a gap before each (and at end), and stripes of data fork
+    *units = calloc(2 * withData + 1 + (NSUInteger)(dataForkLength / UDIF_STRIPE_SIZE) + 1, sizeof(UdifUnit));
+    if(NULL == *units)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //reset
+    current = 0;
+    
+    //add each chunk
+    // and gaps before it (if contiguous)
+    for(NSUInteger i = 0; i < withData; i++)
+    {
+        //gap?
+        if(YES == *contiguous)
+        {
+            unitCount = addGap(*units, unitCount, current, chunks[order[i]].offset);
+        }
+        
+        //add
+        (*units)[unitCount].offset = chunks[order[i]].offset;
+        (*units)[unitCount].length = chunks[order[i]].length;
+        (*units)[unitCount].chunk = order[i];
+        unitCount++;
+        
+        //next
+        current = chunks[order[i]].offset + chunks[order[i]].length;
+    }
+    
+    //add (trailing) gap
+    // or, if not contiguous, all of data fork
+    unitCount = addGap(*units, unitCount, (YES == *contiguous) ? current : 0, dataForkLength);
+
+bail:
+    
+    //free
+    if(NULL != order)
+    {
+        free(order);
+        order = NULL;
+    }
+    
+    return unitCount;
+}
+
+//process units in parallel
+-(void)processUnits:(UdifUnit*)units count:(NSUInteger)count chunks:(UdifChunk*)chunks
+{
+    //file descriptor
+    int file = fd;
+    
+    //offset of data fork
+    uint64_t offset = dataForkOffset;
+    
+    //process
+    dispatch_apply(count, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t i) {
+        
+        //process
+        processUnit(file, offset, &units[i], chunks);
+    
+    });
+    
+    return;
+}
+
+//get details of code signature
+// identifier, and cd hash (truncated, as hex)
+-(NSDictionary*)signingDetails
+{
+    //details
+    NSMutableDictionary* details = nil;
+    
+    //signature location
+    // as a 'slice', so it can be read like a mach-o's
+    MachOSlice slice = {0};
+    
+    //code directory
+    NSData* codeDirectory = nil;
+    
+    //its header
+    const CodeDirectory* header = NULL;
+    
+    //identifier offset
+    uint32_t identOffset = 0;
+    
+    //cd hash
+    uint8_t cdHash[CC_SHA256_DIGEST_LENGTH] = {0};
+    
+    //init location
+    slice.signatureOffset = OSReadBigInt64(self.trailer.bytes, UDIF_CODESIGNATURE_OFFSET);
+    slice.signatureSize = (uint32_t)MIN(OSReadBigInt64(self.trailer.bytes, UDIF_CODESIGNATURE_LENGTH), (uint64_t)UINT32_MAX);
+    
+    //get code directory
+    codeDirectory = codeSignatureBlob(codeSignatureRead(fd, &slice), CODESIGN_SLOT_CODEDIRECTORY);
+    if(codeDirectory.length < offsetof(CodeDirectory, scatterOffset))
+    {
+        //bail
+        goto bail;
+    }
+    
+    //init
+    header = codeDirectory.bytes;
+    identOffset = OSSwapBigToHostInt32(header->identOffset);
+    details = [NSMutableDictionary dictionary];
+    
+    //add identifier
+    if(identOffset < codeDirectory.length)
+    {
+        details[KEY_DISKIMAGE_IDENTIFIER] = [[NSString alloc] initWithBytes:(const char*)codeDirectory.bytes + identOffset length:strnlen((const char*)codeDirectory.bytes + identOffset, codeDirectory.length - identOffset) encoding:NSUTF8StringEncoding];
+    }
+    
+    //compute cd hash
+    if(CODESIGN_HASHTYPE_SHA1 == header->hashType)
+    {
+        CC_SHA1(codeDirectory.bytes, (CC_LONG)codeDirectory.length, cdHash);
+    }
+    else
+    {
+        CC_SHA256(codeDirectory.bytes, (CC_LONG)codeDirectory.length, cdHash);
+    }
+    
+    //convert/add
+    // truncated to 20 bytes
+    details[KEY_DISKIMAGE_CDHASH] = bytesToHex(cdHash, CC_SHA1_DIGEST_LENGTH, YES);
+
+bail:
+    
+    return details;
+}
+
+//verify image
+// data fork and partitions are checked in one (parallel) pass, plus master checksum and code signature's details
+-(NSDictionary*)verify
+{
+    //results
+    NSMutableDictionary* results = nil;
+    
+    //partition results
+    NSMutableArray* partitionResults = nil;
+    
+    //chunks
+    UdifChunk* chunks = NULL;
+    
+    //# of chunks
+    NSUInteger chunkCount = 0;
+    
+    //each partition's chunks
+    NSRange* ranges = NULL;
+    
+    //units
+    UdifUnit* units = NULL;
+    
+    //# of units
+    NSUInteger unitCount = 0;
+    
+    //chunks are contiguous?
+    BOOL contiguous = NO;
+    
+    //data fork CRC
+    uint32_t dataForkCRC = 0;
+    
+    //master CRC
+    uint32_t masterCRC = 0;
+    
+    //master checksum can be computed?
+    BOOL masterComputable = YES;
+    
+    //data fork status
+    OSStatus dataForkStatus = errSecSuccess;
+    
+    //start time
+    CFAbsoluteTime start = 0;
+    
+    //init
+    crcInit();
+    start = CFAbsoluteTimeGetCurrent();
+    
+    //alloc ranges
+    ranges = calloc(MAX(self.partitions.count, 1), sizeof(NSRange));
+    if(NULL == ranges)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //parse chunks
+    chunkCount = [self parseChunks:&chunks ranges:ranges];
+    if(NULL == chunks)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //build units
+    unitCount = [self buildUnits:&units chunks:chunks count:chunkCount contiguous:&contiguous];
+    if(NULL == units)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //data fork is read (mostly) sequentially
+    // so ask for aggressive read ahead
+    fcntl(fd, F_RDAHEAD, 1);
+    
+    //process
+    [self processUnits:units count:unitCount chunks:chunks];
+    
+    //combine CRCs of data fork
+    // in order, and (if chunks overlap) just from gaps, which then cover it
+    for(NSUInteger i = 0; i < unitCount; i++)
+    {
+        //read failed?
+        if(YES == units[i].readFailed)
+        {
+            //dbg msg
+            os_log_debug(OS_LOG_DEFAULT, "WYS: failed to read disk image at %llu", dataForkOffset + units[i].offset);
+            
+            //bail
+            goto bail;
+        }
+        
+        //skip chunks
+        // if they overlap, as they're not part of (in order) gaps
+        if( (YES != contiguous) &&
+            (-1 != units[i].chunk) )
+        {
+            continue;
+        }
+        
+        //combine
+        dataForkCRC = crc32Combine(dataForkCRC, units[i].crc, units[i].length);
+    }
+    
+    //init results
+    results = [NSMutableDictionary dictionary];
+    partitionResults = [NSMutableArray array];
+    
+    //check data fork
+    dataForkStatus = checkCRC((const uint8_t*)self.trailer.bytes + UDIF_DATA_CHECKSUM, dataForkCRC);
+    results[KEY_DISKIMAGE_DATA_FORK] = [NSNumber numberWithInt:dataForkStatus];
+    
+    //check each partition
+    for(NSUInteger i = 0; i < self.partitions.count; i++)
+    {
+        //table
+        NSData* table = self.partitions[i][@"table"];
+        
+        //status
+        OSStatus status = errSecSuccess;
+        
+        //CRC (decompressed)
+        uint32_t crc = 0;
+        
+        //invalid table?
+        if( (table.length < UDIF_MISH_HEADER_SIZE) ||
+            (UDIF_MISH_MAGIC != OSReadBigInt32(table.bytes, 0)) )
+        {
+            //failed
+            status = errSecCSSignatureFailed;
+            masterComputable = NO;
+        }
+        
+        //combine CRCs of chunks
+        // stops at first failure, or unsupported chunk
+        for(NSUInteger j = ranges[i].location; (errSecSuccess == status) && (j < NSMaxRange(ranges[i])); j++)
+        {
+            //zeros
+            if( (UDIF_CHUNK_ZERO == chunks[j].type) ||
+                (UDIF_CHUNK_IGNORE == chunks[j].type) )
+            {
+                crc = crc32Zeros(crc, chunks[j].size);
+            }
+            //failed, or unsupported
+            else if(errSecSuccess != chunks[j].status)
+            {
+                status = chunks[j].status;
+            }
+            //combine
+            else
+            {
+                crc = crc32Combine(crc, chunks[j].crc, chunks[j].size);
+            }
+        }
+        
+        //check
+        if(errSecSuccess == status)
+        {
+            status = checkCRC((const uint8_t*)table.bytes + UDIF_MISH_CHECKSUM, crc);
+        }
+        
+        //master checksum
+        // CRC32 of each partition's (stored) CRC32
+        if( (YES == masterComputable) &&
+            (UDIF_CHECKSUM_CRC32 == OSReadBigInt32(table.bytes, UDIF_MISH_CHECKSUM)) )
+        {
+            masterCRC = crc32Update(masterCRC, (const uint8_t*)table.bytes + UDIF_MISH_CHECKSUM + 8, sizeof(uint32_t));
+        }
+        else
+        {
+            masterComputable = NO;
+        }
+        
+        //add
+        [partitionResults addObject:@{KEY_COMPONENT_NAME:self.partitions[i][KEY_COMPONENT_NAME],
+                                      KEY_COMPONENT_EXTRACTED:[NSNumber numberWithInt:status]}];
+    }
+    
+    //save partitions
+    results[KEY_DISKIMAGE_PARTITIONS] = partitionResults;
+    
+    //check master
+    results[KEY_DISKIMAGE_MASTER] = [NSNumber numberWithInt:(YES == masterComputable) ? checkCRC((const uint8_t*)self.trailer.bytes + UDIF_MASTER_CHECKSUM, masterCRC) : errSecCSUnimplemented];
+    
+    //add signing details
+    [results addEntriesFromDictionary:[self signingDetails]];
+    
+    //dbg msg
+    os_log_debug(OS_LOG_DEFAULT, "WYS: verified disk image (%lu partitions, %lu chunks, %llu bytes) in %.3f seconds", (unsigned long)self.partitions.count, (unsigned long)chunkCount, dataForkLength, CFAbsoluteTimeGetCurrent() - start);
+
+bail:
+    
+    //free units
+    if(NULL != units)
+    {
+        free(units);
+        units = NULL;
+    }
+    
+    //free chunks
+    if(NULL != chunks)
+    {
+        free(chunks);
+        chunks = NULL;
+    }
+    
+    //free ranges
+    if(NULL != ranges)
+    {
+        free(ranges);
+        ranges = NULL;
+    }
+    
+    return results;
+}
+
+//dealloc
+// close file
+-(void)dealloc
+{
+    //close
+    if(-1 != fd)
+    {
+        close(fd);
+        fd = -1;
+    }
+}
+
+@end
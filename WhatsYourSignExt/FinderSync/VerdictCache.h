@@ -0,0 +1,142 @@
+//
+//  VerdictCache.h
+//  WhatsYourSign
+//
+//  Created by Patrick Wardle on 10/17/26.
+//  Copyright (c) 2026 Objective-See. All rights reserved.
+//
+//  note: cache is an append-only log of signing verdicts, shared by the app and all extension instances:
+//        header: magic ('WYSV'), version
+//        record: magic ('VREC'), payload length, checksum, time, key, then payload (binary plist), padded to 8 bytes
+//        records are appended via a single 'write', so readers (which just map the file) never block
+//        once the log is too big, live records are copied into a new file, which is renamed over it
+
+#ifndef VerdictCache_h
+#define VerdictCache_h
+
+@import Foundation;
+@import Security;
+
+#import <CommonCrypto/CommonDigest.h>
+
+//cache file
+// lives in the app group container
+#define VERDICT_CACHE_FILE @"verdicts.log"
+
+//cache magic ('WYSV')
+#define VERDICT_CACHE_MAGIC 0x57595356
+
+//record magic ('VREC')
+#define VERDICT_RECORD_MAGIC 0x56524543
+
+//cache version
+#define VERDICT_CACHE_VERSION 4
+
+//max size of log
+// beyond this, it's compacted
+#define VERDICT_CACHE_MAX_SIZE (8*1024*1024)
+
+//max size of a record's payload
+#define VERDICT_MAX_PAYLOAD (1024*1024)
+
+//default time (seconds) revocation/notarization results are trusted
+#define VERDICT_CACHE_DEFAULT_TTL (24*60*60)
+
+//max time (seconds) failed verdicts are trusted
+// failures might be transient (e.g. network or revocation errors)
+#define VERDICT_CACHE_FAILURE_TTL (5*60)
+
+//cache header
+typedef struct
+{
+    uint32_t magic;
+    uint32_t version;
+
+} VerdictCacheHeader;
+
+//identity of a file
+typedef struct
+{
+    uint64_t device;
+    uint64_t inode;
+    uint64_t size;
+    int64_t modified;
+    int64_t modifiedNS;
+    int64_t changed;
+    int64_t changedNS;
+
+} FileIdentity;
+
+//key of a verdict
+// built from file info, and the (executable's) code directory, so lookups are cheap (nothing is hashed, bar the code directory)
+// note: zero'd first, so it can be compared via 'memcmp'
+typedef struct
+{
+    //validation flags
+    uint32_t flags;
+    
+    //entitlements extracted?
+    uint32_t entitlements;
+    
+    //unused
+    uint32_t reserved;
+    
+    //offset of (validated) architecture
+    uint64_t offset;
+    
+    //hash of path
+    uint64_t path;
+    
+    //main executable
+    FileIdentity executable;
+    
+    //cd hash of main executable
+    // (SHA-256) of (validated architecture's) best code directory, zero'd if it has none
+    uint8_t cdHash[CC_SHA256_DIGEST_LENGTH];
+    
+    //bundle's tree
+    // hash of every entry's (relative) path and identity, so any change under bundle (e.g. an edited resource, or replaced nested code) changes it
+    // zero'd if not a bundle
+    uint64_t tree;
+
+} VerdictKey;
+
+//record
+// followed by payload
+typedef struct
+{
+    uint32_t magic;
+    
+    //size of payload
+    uint32_t length;
+    
+    //checksum (FNV-1a)
+    // of time, key, and payload
+    uint64_t checksum;
+    
+    //time verdict was made
+    int64_t created;
+    
+    //key
+    VerdictKey key;
+
+} VerdictRecord;
+
+/* FUNCTIONS */
+
+//build key for an item
+// returns NO if item can't be cached
+BOOL verdictCacheKey(NSString* path, uint64_t offset, SecCSFlags flags, BOOL entitlements, VerdictKey* key);
+
+//lookup (cached) signing info
+// returns nil if not found, or if it has expired (failures expire sooner)
+NSMutableDictionary* verdictCacheLookup(const VerdictKey* key);
+
+//save signing info
+void verdictCacheStore(const VerdictKey* key, NSDictionary* signingInfo);
+
+//clear cache
+// removes log, so all lookups miss (e.g. between benchmark iterations)
+void verdictCacheClear(void);
+
+#endif /* VerdictCache_h */
@@ -0,0 +1,940 @@
+//
+//  VerdictCache.m
+//  FinderSync
+//
+//  Created by Patrick Wardle on 10/17/26.
+//  Copyright (c) 2026 Objective-See. All rights reserved.
+//
+
+#import "MachO.h"
+#import "consts.h"
+#import "utilities.h"
+#import "VerdictCache.h"
+#import "CodeSignature.h"
+
+#import <fts.h>
+#import <fcntl.h>
+#import <unistd.h>
+#import <os/lock.h>
+#import <os/log.h>
+#import <sys/file.h>
+#import <sys/mman.h>
+#import <sys/stat.h>
+
+//lock
+// only serializes threads in this process
+static os_unfair_lock cacheLock = OS_UNFAIR_LOCK_INIT;
+
+//mapped log
+static const uint8_t* cache = NULL;
+
+//size of mapped log
+static size_t cacheSize = 0;
+
+//identity of mapped log
+// used to detect when file is compacted
+static struct stat cacheInfo = {0};
+
+//offset of next record to index
+static size_t indexed = 0;
+
+//log is invalid?
+// e.g. old version, or a bad record
+static BOOL invalid = NO;
+
+//index
+// key (data) -> offset of its latest record
+static NSMutableDictionary* verdicts = nil;
+
+//file descriptor for appends
+static int appendFD = -1;
+
+//get path to cache
+static NSString* cachePath(void)
+{
+    //path
+    static NSString* path = nil;
+    
+    //once token
+    static dispatch_once_t onceToken = 0;
+    
+    //only once
+    dispatch_once(&onceToken, ^{
+        
+        //init
+        path = [cachesDirectory() URLByAppendingPathComponent:VERDICT_CACHE_FILE].path;
+    
+    });
+    
+    return path;
+}
+
+//get time (seconds) revocation/notarization results are trusted
+// 0 disables the cache
+static NSTimeInterval verdictTTL(void)
+{
+    //shared defaults
+    static NSUserDefaults* sharedDefaults = nil;
+    
+    //once token
+    static dispatch_once_t onceToken = 0;
+    
+    //only once
+    dispatch_once(&onceToken, ^{
+        
+        //init
+        sharedDefaults = [[NSUserDefaults alloc] initWithSuiteName:APP_GROUP];
+    
+    });
+    
+    //not set?
+    if(nil == [sharedDefaults objectForKey:PREF_VERDICT_TTL])
+    {
+        //default
+        return VERDICT_CACHE_DEFAULT_TTL;
+    }
+    
+    return MAX([sharedDefaults doubleForKey:PREF_VERDICT_TTL], 0);
+}
+
+//hash bytes (FNV-1a)
+static uint64_t fnv(uint64_t hash, const void* bytes, size_t length)
+{
+    //hash
+    for(size_t i = 0; i < length; i++)
+    {
+        hash ^= ((const uint8_t*)bytes)[i];
+        hash *= 0x100000001b3;
+    }
+    
+    return hash;
+}
+
+//checksum of a record
+// covers time, key, and payload
+static uint64_t checksum(const VerdictRecord* record, const void* payload)
+{
+    //hash
+    uint64_t hash = 0xcbf29ce484222325;
+    
+    //time, key
+    hash = fnv(hash, &record->created, sizeof(record->created));
+    hash = fnv(hash, &record->key, sizeof(record->key));
+    
+    //payload
+    return fnv(hash, payload, record->length);
+}
+
+//size of record (incl. payload)
+// records are padded to 8 bytes
+static size_t recordSize(uint32_t length)
+{
+    return sizeof(VerdictRecord) + (((size_t)length + 7) & ~(size_t)7);
+}
+
+//get identity of a file
+static BOOL identify(NSString* path, FileIdentity* identity)
+{
+    //file info
+    struct stat info = {0};
+    
+    //stat
+    if( (nil == path) ||
+        (0 != stat(path.fileSystemRepresentation, &info)) )
+    {
+        return NO;
+    }
+    
+    //init
+    identity->device = (uint64_t)info.st_dev;
+    identity->inode = (uint64_t)info.st_ino;
+    identity->size = (uint64_t)info.st_size;
+    identity->modified = info.st_mtimespec.tv_sec;
+    identity->modifiedNS = info.st_mtimespec.tv_nsec;
+    identity->changed = info.st_ctimespec.tv_sec;
+    identity->changedNS = info.st_ctimespec.tv_nsec;
+    
+    return YES;
+}
+
+//get cd hash of a binary
+// SHA-256 of best code directory of slice at 'offset' (only its headers and signature are read)
+static BOOL identifyCode(NSString* path, uint64_t offset, uint8_t* cdHash)
+{
+    //flag
+    BOOL identified = NO;
+    
+    //file descriptor
+    int fd = -1;
+    
+    //index
+    MachOIndex index = {0};
+    
+    //slice
+    const MachOSlice* slice = NULL;
+    
+    //code directory
+    NSData* codeDirectory = nil;
+    
+    //open
+    fd = open(path.fileSystemRepresentation, O_RDONLY | O_CLOEXEC);
+    if(-1 == fd)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //index
+    // not a mach-o? nothing to identify
+    if(YES != machoIndexFile(fd, &index))
+    {
+        //bail
+        goto bail;
+    }
+    
+    //find (validated) slice
+    for(uint32_t i = 0; i < index.count; i++)
+    {
+        //match?
+        if( (YES != index.slices[i].invalid) &&
+            ( (MachOKindThin == index.kind) || (offset == index.slices[i].offset) ) )
+        {
+            //save
+            slice = &index.slices[i];
+            break;
+        }
+    }
+    
+    //get code directory
+    // unsigned? nothing to identify
+    if(NULL != slice)
+    {
+        codeDirectory = codeSignatureBestCodeDirectory(codeSignatureRead(fd, slice));
+    }
+    if(0 == codeDirectory.length)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //hash
+    CC_SHA256(codeDirectory.bytes, (CC_LONG)codeDirectory.length, cdHash);
+    
+    //happy
+    identified = YES;
+    
+bail:
+    
+    //close
+    if(-1 != fd)
+    {
+        close(fd);
+        fd = -1;
+    }
+    
+    return identified;
+}
+
+//compare (fts) entries by name
+// so a tree is always walked in the same order
+static int compareEntries(const FTSENT** first, const FTSENT** second)
+{
+    return strcmp((*first)->fts_name, (*second)->fts_name);
+}
+
+//get identity of a (bundle's) tree
+// hash of every entry's (relative) path and identity (incl. 'ctime', which any write updates); entries are just 'lstat'd
+static BOOL identifyTree(NSString* root, uint64_t* tree)
+{
+    //flag
+    BOOL identified = NO;
+    
+    //paths
+    char* const paths[] = {(char*)root.fileSystemRepresentation, NULL};
+    
+    //fts handle
+    FTS* fts = NULL;
+    
+    //entry
+    FTSENT* entry = NULL;
+    
+    //hash
+    uint64_t hash = 0xcbf29ce484222325;
+    
+    //open
+    // don't follow symlinks (as Security doesn't), and don't 'chdir'
+    fts = fts_open(paths, FTS_PHYSICAL | FTS_NOCHDIR, compareEntries);
+    if(NULL == fts)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //walk
+    while(NULL != (entry = fts_read(fts)))
+    {
+        //error?
+        // e.g. unreadable directory, so tree can't be identified
+        if( (FTS_ERR == entry->fts_info) ||
+            (FTS_DNR == entry->fts_info) ||
+            (FTS_NS == entry->fts_info) )
+        {
+            //bail
+            goto bail;
+        }
+        
+        //skip directories' post-order visit
+        if(FTS_DP == entry->fts_info)
+        {
+            continue;
+        }
+        
+        //add path
+        // and identity
+        hash = fnv(hash, entry->fts_path, entry->fts_pathlen);
+        hash = fnv(hash, &entry->fts_statp->st_ino, sizeof(entry->fts_statp->st_ino));
+        hash = fnv(hash, &entry->fts_statp->st_size, sizeof(entry->fts_statp->st_size));
+        hash = fnv(hash, &entry->fts_statp->st_mtimespec, sizeof(entry->fts_statp->st_mtimespec));
+        hash = fnv(hash, &entry->fts_statp->st_ctimespec, sizeof(entry->fts_statp->st_ctimespec));
+    }
+    
+    //walk failed?
+    if(0 != errno)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //save
+    *tree = hash;
+    
+    //happy
+    identified = YES;
+    
+bail:
+    
+    //close
+    if(NULL != fts)
+    {
+        fts_close(fts);
+        fts = NULL;
+    }
+    
+    return identified;
+}
+
+//get root of code
+// Security validates a bundle's main executable as the bundle, so use that
+static NSString* codeRoot(NSString* path)
+{
+    //parent
+    NSString* parent = nil;
+    
+    //bundle path
+    NSString* bundlePath = nil;
+    
+    //init parent
+    parent = path.stringByDeletingLastPathComponent;
+    
+    //not in a bundle's 'Contents/MacOS'?
+    if( (YES != [parent.lastPathComponent isEqualToString:@"MacOS"]) ||
+        (YES != [parent.stringByDeletingLastPathComponent.lastPathComponent isEqualToString:@"Contents"]) )
+    {
+        return path;
+    }
+    
+    //init bundle path
+    bundlePath = parent.stringByDeletingLastPathComponent.stringByDeletingLastPathComponent;
+    
+    //bundle's main executable?
+    if(YES == [[NSBundle bundleWithPath:bundlePath].executablePath.stringByResolvingSymlinksInPath isEqualToString:path.stringByResolvingSymlinksInPath])
+    {
+        return bundlePath;
+    }
+    
+    return path;
+}
+
+//build key for an item
+// returns NO if item can't be cached
+BOOL verdictCacheKey(NSString* path, uint64_t offset, SecCSFlags flags, BOOL entitlements, VerdictKey* key)
+{
+    //flag
+    BOOL built = NO;
+    
+    //root of code
+    NSString* root = nil;
+    
+    //directory flag
+    BOOL isDirectory = NO;
+    
+    //reset
+    memset(key, 0, sizeof(VerdictKey));
+    
+    //init
+    key->flags = flags;
+    key->entitlements = entitlements;
+    key->offset = offset;
+    key->path = fnv(0xcbf29ce484222325, path.fileSystemRepresentation, strlen(path.fileSystemRepresentation));
+    
+    //get root
+    // for a bundle's executable, this is the bundle
+    root = codeRoot(path);
+    
+    //get identity of executable
+    // for bundles, this is their main binary
+    // note: any change to it (incl. re-signing) updates its 'ctime'
+    if(YES != identify(hashablePath(root), &key->executable))
+    {
+        //bail
+        goto bail;
+    }
+    
+    //get its cd hash
+    // unsigned, or not a mach-o? stays zero'd
+    identifyCode(hashablePath(root), offset, key->cdHash);
+    
+    //bundle?
+    // also get identity of its tree, so any change under it (not just to its executable) invalidates verdict
+    if( (YES == [NSFileManager.defaultManager fileExistsAtPath:root isDirectory:&isDirectory]) &&
+        (YES == isDirectory) &&
+        (YES != identifyTree(root, &key->tree)) )
+    {
+        //bail
+        goto bail;
+    }
+    
+    //happy
+    built = YES;
+
+bail:
+    
+    return built;
+}
+
+//(re)map log if it changed, then index any new records
+// note: call with lock held
+static void refreshCache(void)
+{
+    //file info
+    struct stat info = {0};
+    
+    //file descriptor
+    int fd = -1;
+    
+    //mapping
+    void* mapping = MAP_FAILED;
+    
+    //get file info
+    // no file? reset below
+    if( (nil == cachePath()) ||
+        (0 != stat(cachePath().fileSystemRepresentation, &info)) )
+    {
+        //reset
+        memset(&info, 0, sizeof(info));
+    }
+    
+    //different file?
+    // (re)set mapping and index
+    if( (info.st_dev != cacheInfo.st_dev) ||
+        (info.st_ino != cacheInfo.st_ino) )
+    {
+        //unmap
+        if(NULL != cache)
+        {
+            munmap((void*)cache, cacheSize);
+            cache = NULL;
+            cacheSize = 0;
+        }
+        
+        //reset
+        indexed = 0;
+        invalid = NO;
+        verdicts = [NSMutableDictionary dictionary];
+    }
+    
+    //save identity
+    cacheInfo = info;
+    
+    //unchanged?
+    // note: log only ever grows (until its compacted into a new file)
+    if((size_t)info.st_size <= cacheSize)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //open
+    fd = open(cachePath().fileSystemRepresentation, O_RDONLY | O_CLOEXEC);
+    if(-1 == fd)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //map
+    // whole file, as it is now
+    mapping = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if(MAP_FAILED == mapping)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //unmap old
+    if(NULL != cache)
+    {
+        munmap((void*)cache, cacheSize);
+    }
+    
+    //save
+    cache = mapping;
+    cacheSize = (size_t)info.st_size;
+    
+    //validate header
+    if(0 == indexed)
+    {
+        //check
+        if( (cacheSize < sizeof(VerdictCacheHeader)) ||
+            (VERDICT_CACHE_MAGIC != ((const VerdictCacheHeader*)cache)->magic) ||
+            (VERDICT_CACHE_VERSION != ((const VerdictCacheHeader*)cache)->version) )
+        {
+            //invalid
+            invalid = YES;
+            
+            //bail
+            goto bail;
+        }
+        
+        //skip header
+        indexed = sizeof(VerdictCacheHeader);
+    }
+    
+    //index new records
+    // stops at an incomplete record, as it might still be being written
+    while( (YES != invalid) &&
+           (indexed + sizeof(VerdictRecord) <= cacheSize) )
+    {
+        //record
+        VerdictRecord record = {0};
+        
+        //copy out
+        memcpy(&record, cache + indexed, sizeof(record));
+        
+        //bad record?
+        // can't find next one, so rest of log is unusable
+        if( (VERDICT_RECORD_MAGIC != record.magic) ||
+            (record.length > VERDICT_MAX_PAYLOAD) )
+        {
+            //invalid
+            invalid = YES;
+            
+            //dbg msg
+            os_log_debug(OS_LOG_DEFAULT, "WYS: verdict cache has a bad record at %zu", indexed);
+            
+            break;
+        }
+        
+        //incomplete?
+        if(indexed + recordSize(record.length) > cacheSize)
+        {
+            break;
+        }
+        
+        //add to index
+        // unless it's torn (checksum mismatch)
+        if(record.checksum == checksum(&record, cache + indexed + sizeof(record)))
+        {
+            //add
+            // later records (for same key) win
+            verdicts[[NSData dataWithBytes:&record.key length:sizeof(record.key)]] = [NSNumber numberWithUnsignedLongLong:indexed];
+        }
+        
+        //next
+        indexed += recordSize(record.length);
+    }
+
+bail:
+    
+    //close
+    // mapping stays valid
+    if(-1 != fd)
+    {
+        close(fd);
+        fd = -1;
+    }
+    
+    return;
+}
+
+//has a verdict expired?
+// failures might be transient (e.g. network or revocation errors), so expire sooner
+static BOOL isExpired(NSDictionary* signingInfo, int64_t created, NSTimeInterval ttl)
+{
+    //failed?
+    if(errSecSuccess != [signingInfo[KEY_SIGNATURE_STATUS] intValue])
+    {
+        //use shorter ttl
+        ttl = MIN(ttl, VERDICT_CACHE_FAILURE_TTL);
+    }
+    
+    return (NSTimeInterval)(time(NULL) - created) > ttl;
+}
+
+//lookup (cached) signing info
+// returns nil if not found, or if its revocation/notarization results have expired
+NSMutableDictionary* verdictCacheLookup(const VerdictKey* key)
+{
+    //signing info
+    NSMutableDictionary* signingInfo = nil;
+    
+    //ttl
+    NSTimeInterval ttl = 0;
+    
+    //offset
+    NSNumber* offset = nil;
+    
+    //record
+    VerdictRecord record = {0};
+    
+    //payload
+    NSData* payload = nil;
+    
+    //get ttl
+    // 0 means cache is disabled
+    ttl = verdictTTL();
+    if(0 == ttl)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //lock
+    os_unfair_lock_lock(&cacheLock);
+    
+    //refresh
+    refreshCache();
+    
+    //find
+    offset = verdicts[[NSData dataWithBytes:key length:sizeof(VerdictKey)]];
+    if(nil != offset)
+    {
+        //copy out record
+        memcpy(&record, cache + offset.unsignedLongLongValue, sizeof(record));
+        
+        //copy out payload
+        // as mapping might change, once unlocked
+        payload = [NSData dataWithBytes:cache + offset.unsignedLongLongValue + sizeof(record) length:record.length];
+    }
+    
+    //unlock
+    os_unfair_lock_unlock(&cacheLock);
+    
+    //not found?
+    if(nil == payload)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //deserialize
+    signingInfo = [NSPropertyListSerialization propertyListWithData:payload options:NSPropertyListMutableContainers format:NULL error:NULL];
+    if(YES != [signingInfo isKindOfClass:[NSMutableDictionary class]])
+    {
+        //unset
+        signingInfo = nil;
+        
+        //bail
+        goto bail;
+    }
+    
+    //expired?
+    if(YES == isExpired(signingInfo, record.created, ttl))
+    {
+        //dbg msg
+        os_log_debug(OS_LOG_DEFAULT, "WYS: cached verdict expired");
+        
+        //unset
+        signingInfo = nil;
+        
+        //bail
+        goto bail;
+    }
+    
+    //dbg msg
+    os_log_debug(OS_LOG_DEFAULT, "WYS: verdict cache hit");
+
+bail:
+    
+    return signingInfo;
+}
+
+//(re)open log for appends
+// creates it (w/ its header) if needed
+// note: call with lock held
+static BOOL openLog(void)
+{
+    //file info (path)
+    struct stat pathInfo = {0};
+    
+    //file info (fd)
+    struct stat fdInfo = {0};
+    
+    //header
+    VerdictCacheHeader header = {VERDICT_CACHE_MAGIC, VERDICT_CACHE_VERSION};
+    
+    //already open?
+    // make sure log wasn't compacted (into a new file)
+    if( (-1 != appendFD) &&
+        (0 == stat(cachePath().fileSystemRepresentation, &pathInfo)) &&
+        (0 == fstat(appendFD, &fdInfo)) &&
+        (pathInfo.st_dev == fdInfo.st_dev) &&
+        (pathInfo.st_ino == fdInfo.st_ino) )
+    {
+        return YES;
+    }
+    
+    //close
+    if(-1 != appendFD)
+    {
+        close(appendFD);
+        appendFD = -1;
+    }
+    
+    //open/create
+    appendFD = open(cachePath().fileSystemRepresentation, O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+    if(-1 == appendFD)
+    {
+        return NO;
+    }
+    
+    //new?
+    // write header (lock, as another instance might be creating it too)
+    flock(appendFD, LOCK_EX);
+    if( (0 == fstat(appendFD, &fdInfo)) &&
+        (0 == fdInfo.st_size) &&
+        ((ssize_t)sizeof(header) != write(appendFD, &header, sizeof(header))) )
+    {
+        //dbg msg
+        os_log_debug(OS_LOG_DEFAULT, "WYS: failed to create verdict cache: %{darwin.errno}d", errno);
+        
+        //unlock
+        flock(appendFD, LOCK_UN);
+        
+        //close
+        close(appendFD);
+        appendFD = -1;
+        
+        return NO;
+    }
+    flock(appendFD, LOCK_UN);
+    
+    return YES;
+}
+
+//compact log
+// copies (latest, unexpired) records into a new file, then renames it over the log
+// note: call with lock held
+static void compactLog(NSTimeInterval ttl)
+{
+    //compacted log
+    NSMutableData* compacted = nil;
+    
+    //header
+    VerdictCacheHeader header = {VERDICT_CACHE_MAGIC, VERDICT_CACHE_VERSION};
+    
+    //file info (path)
+    struct stat pathInfo = {0};
+    
+    //file info (fd)
+    struct stat fdInfo = {0};
+    
+    //temp path
+    NSString* tempPath = nil;
+    
+    //lock
+    // only one instance compacts at a time
+    flock(appendFD, LOCK_EX);
+    
+    //already compacted?
+    // i.e. by another instance, while waiting on lock
+    if( (0 != stat(cachePath().fileSystemRepresentation, &pathInfo)) ||
+        (0 != fstat(appendFD, &fdInfo)) ||
+        (pathInfo.st_ino != fdInfo.st_ino) )
+    {
+        //bail
+        goto bail;
+    }
+    
+    //index (all) records
+    refreshCache();
+    
+    //init
+    compacted = [NSMutableData dataWithBytes:&header length:sizeof(header)];
+    
+    //copy live records
+    for(NSNumber* offset in verdicts.allValues)
+    {
+        //record
+        VerdictRecord record = {0};
+        
+        //copy out
+        memcpy(&record, cache + offset.unsignedLongLongValue, sizeof(record));
+        
+        //expired?
+        // skip, as it'd just be ignored anyway
+        if((NSTimeInterval)(time(NULL) - record.created) > ttl)
+        {
+            continue;
+        }
+        
+        //add
+        [compacted appendBytes:cache + offset.unsignedLongLongValue length:recordSize(record.length)];
+    }
+    
+    //still too big?
+    // just start over
+    if(compacted.length > VERDICT_CACHE_MAX_SIZE/2)
+    {
+        //reset
+        compacted.length = sizeof(header);
+    }
+    
+    //write to temp file
+    // then (atomically) rename over log, as readers might have it mapped
+    tempPath = [cachePath() stringByAppendingFormat:@".%d", getpid()];
+    if( (YES != [compacted writeToFile:tempPath atomically:NO]) ||
+        (0 != rename(tempPath.fileSystemRepresentation, cachePath().fileSystemRepresentation)) )
+    {
+        //cleanup
+        unlink(tempPath.fileSystemRepresentation);
+        
+        //bail
+        goto bail;
+    }
+    
+    //dbg msg
+    os_log_debug(OS_LOG_DEFAULT, "WYS: compacted verdict cache (%lu bytes)", (unsigned long)compacted.length);
+
+bail:
+    
+    //unlock
+    flock(appendFD, LOCK_UN);
+    
+    //(re)open
+    // picks up new log
+    openLog();
+    
+    return;
+}
+
+//clear cache
+// removes log, so all lookups miss (e.g. between benchmark iterations)
+void verdictCacheClear(void)
+{
+    //lock
+    os_unfair_lock_lock(&cacheLock);
+    
+    //close log
+    if(-1 != appendFD)
+    {
+        close(appendFD);
+        appendFD = -1;
+    }
+    
+    //remove log
+    if(nil != cachePath())
+    {
+        unlink(cachePath().fileSystemRepresentation);
+    }
+    
+    //refresh
+    // file is gone, so mapping and index are reset
+    refreshCache();
+    
+    //unlock
+    os_unfair_lock_unlock(&cacheLock);
+    
+    return;
+}
+
+//save signing info
+void verdictCacheStore(const VerdictKey* key, NSDictionary* signingInfo)
+{
+    //ttl
+    NSTimeInterval ttl = 0;
+    
+    //payload
+    NSData* payload = nil;
+    
+    //record
+    VerdictRecord record = {0};
+    
+    //record (incl. payload)
+    NSMutableData* data = nil;
+    
+    //get ttl
+    // 0 means cache is disabled
+    ttl = verdictTTL();
+    if(0 == ttl)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //serialize
+    payload = [NSPropertyListSerialization dataWithPropertyList:signingInfo format:NSPropertyListBinaryFormat_v1_0 options:0 error:NULL];
+    if( (0 == payload.length) ||
+        (payload.length > VERDICT_MAX_PAYLOAD) )
+    {
+        //bail
+        goto bail;
+    }
+    
+    //init record
+    record.magic = VERDICT_RECORD_MAGIC;
+    record.length = (uint32_t)payload.length;
+    record.created = time(NULL);
+    record.key = *key;
+    record.checksum = checksum(&record, payload.bytes);
+    
+    //init data
+    // record, payload, then padding
+    data = [NSMutableData dataWithBytes:&record length:sizeof(record)];
+    [data appendData:payload];
+    data.length = recordSize(record.length);
+    
+    //lock
+    os_unfair_lock_lock(&cacheLock);
+    
+    //open log
+    if(YES == openLog())
+    {
+        //refresh
+        refreshCache();
+        
+        //too big (or invalid)?
+        if( (YES == invalid) ||
+            (cacheSize > VERDICT_CACHE_MAX_SIZE) )
+        {
+            //compact
+            compactLog(ttl);
+        }
+        
+        //append
+        // single write, so won't interleave w/ other instances' records
+        if( (-1 == appendFD) ||
+            ((ssize_t)data.length != write(appendFD, data.bytes, data.length)) )
+        {
+            //dbg msg
+            os_log_debug(OS_LOG_DEFAULT, "WYS: failed to save verdict: %{darwin.errno}d", errno);
+        }
+    }
+    
+    //unlock
+    os_unfair_lock_unlock(&cacheLock);
+
+bail:
+    
+    return;
+}
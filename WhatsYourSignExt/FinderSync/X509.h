@@ -0,0 +1,52 @@
+//
+//  X509.h
+//  WhatsYourSign
+//
+//  Created by Patrick Wardle on 10/17/26.
+//  Copyright (c) 2026 Objective-See. All rights reserved.
+//
+//  note: certificates are parsed directly from their (DER) encoding, so only Foundation and CommonCrypto are needed
+//        parsed certificates are cached by (SHA-256) fingerprint, and their names interned,
+//        so the same chain (e.g. 'Developer ID Certification Authority' -> 'Apple Root CA') is only parsed once
+
+#ifndef X509_h
+#define X509_h
+
+@import Foundation;
+
+#import <Security/Security.h>
+
+//keys for (parsed) certificate
+#define KEY_CERT_COMMON_NAME @"commonName"
+#define KEY_CERT_ORGANIZATIONAL_UNIT @"organizationalUnit"
+#define KEY_CERT_ORGANIZATION @"organization"
+#define KEY_CERT_ISSUER_COMMON_NAME @"issuerCommonName"
+#define KEY_CERT_ISSUER_HASH @"issuerHash"
+#define KEY_CERT_SERIAL @"serial"
+#define KEY_CERT_NOT_BEFORE @"notBefore"
+#define KEY_CERT_NOT_AFTER @"notAfter"
+#define KEY_CERT_SHA1 @"sha1"
+#define KEY_CERT_SHA256 @"sha256"
+
+//max # of cached certificates
+// chains are short, and mostly shared, so this is plenty
+#define X509_CACHE_MAX 512
+
+//max # of interned names
+#define X509_INTERNED_MAX 2048
+
+/* FUNCTIONS */
+
+//parse a (DER) certificate
+// returns subject's names (CN, OU, O), issuer's CN and hash, serial, validity, and fingerprints; nil if malformed
+NSDictionary* x509Parse(const uint8_t* bytes, size_t length);
+
+//get (parsed) info of a certificate
+// cached by fingerprint, w/ names interned
+NSDictionary* x509Info(SecCertificateRef certificate);
+
+//get common name of a certificate
+// falls back to Security framework, if certificate couldn't be parsed
+NSString* x509CommonName(SecCertificateRef certificate);
+
+#endif /* X509_h */
@@ -0,0 +1,561 @@
+//
+//  X509.m
+//  FinderSync
+//
+//  Created by Patrick Wardle on 10/17/26.
+//  Copyright (c) 2026 Objective-See. All rights reserved.
+//
+
+#import "Der.h"
+#import "X509.h"
+
+#import <time.h>
+#import <os/lock.h>
+#import <CommonCrypto/CommonDigest.h>
+
+//OID: commonName (2.5.4.3)
+static const uint8_t oidCommonName[] = {0x55, 0x04, 0x03};
+
+//OID: organizationName (2.5.4.10)
+static const uint8_t oidOrganization[] = {0x55, 0x04, 0x0A};
+
+//OID: organizationalUnitName (2.5.4.11)
+// for Apple-issued certificates, this is the team id
+static const uint8_t oidOrganizationalUnit[] = {0x55, 0x04, 0x0B};
+
+//lock
+// for certificate cache, and interned names
+static os_unfair_lock certificatesLock = OS_UNFAIR_LOCK_INIT;
+
+//cached certificates
+// fingerprint -> info (or null if malformed)
+static NSMutableDictionary* certificates = nil;
+
+//interned names
+static NSMutableSet* names = nil;
+
+//decode (DER) string
+// the string types that show up in (distinguished) names
+static NSString* decodeString(const DERItem* item)
+{
+    //encoding
+    NSStringEncoding encoding = 0;
+    
+    //set encoding
+    switch(item->tag)
+    {
+        //utf8
+        // printable and IA5 strings are (subsets of) ASCII
+        case DER_TAG_UTF8_STRING:
+        case DER_TAG_PRINTABLE_STRING:
+        case DER_TAG_IA5_STRING:
+            encoding = NSUTF8StringEncoding;
+            break;
+        
+        //teletex
+        // treated as latin-1, like most implementations
+        case DER_TAG_T61_STRING:
+            encoding = NSISOLatin1StringEncoding;
+            break;
+        
+        //ucs-2
+        case DER_TAG_BMP_STRING:
+            encoding = NSUTF16BigEndianStringEncoding;
+            break;
+        
+        //ucs-4
+        case DER_TAG_UNIVERSAL_STRING:
+            encoding = NSUTF32BigEndianStringEncoding;
+            break;
+        
+        //unsupported
+        default:
+            return nil;
+    }
+    
+    return [[NSString alloc] initWithBytes:item->data length:item->length encoding:encoding];
+}
+
+//decode (DER) time
+// UTCTime ('YYMMDDHHMMSSZ') or GeneralizedTime ('YYYYMMDDHHMMSSZ')
+static NSDate* decodeTime(const DERItem* item)
+{
+    //digits
+    int digits[14] = {0};
+    
+    //# of digits
+    size_t count = 0;
+    
+    //index
+    size_t index = 0;
+    
+    //time
+    struct tm time = {0};
+    
+    //# of digits
+    // DER requires seconds, and 'Z'
+    if(DER_TAG_UTC_TIME == item->tag)
+    {
+        count = 12;
+    }
+    else if(DER_TAG_GENERALIZED_TIME == item->tag)
+    {
+        count = 14;
+    }
+    
+    //sanity check
+    if( (0 == count) ||
+        (item->length != count + 1) ||
+        ('Z' != item->data[count]) )
+    {
+        //bail
+        return nil;
+    }
+    
+    //decode digits
+    for(index = 0; index < count; index++)
+    {
+        //sanity check
+        if( (item->data[index] < '0') ||
+            (item->data[index] > '9') )
+        {
+            //bail
+            return nil;
+        }
+        
+        //save
+        digits[index] = item->data[index] - '0';
+    }
+    
+    //UTCTime
+    // two digit years: 50-99 are 19xx, 00-49 are 20xx (RFC 5280)
+    if(12 == count)
+    {
+        //year
+        time.tm_year = digits[0]*10 + digits[1];
+        if(time.tm_year < 50)
+        {
+            time.tm_year += 100;
+        }
+        
+        //skip year
+        index = 2;
+    }
+    //GeneralizedTime
+    else
+    {
+        //year
+        time.tm_year = digits[0]*1000 + digits[1]*100 + digits[2]*10 + digits[3] - 1900;
+        
+        //skip year
+        index = 4;
+    }
+    
+    //month, day, hour, minute, second
+    time.tm_mon = digits[index]*10 + digits[index+1] - 1;
+    time.tm_mday = digits[index+2]*10 + digits[index+3];
+    time.tm_hour = digits[index+4]*10 + digits[index+5];
+    time.tm_min = digits[index+6]*10 + digits[index+7];
+    time.tm_sec = digits[index+8]*10 + digits[index+9];
+    
+    return [NSDate dateWithTimeIntervalSince1970:timegm(&time)];
+}
+
+//find attribute in (DER) name
+// walks the RDNs (SET OF (OID, value)), returning first match
+static NSString* nameAttribute(const DERItem* name, const uint8_t* oid, size_t length)
+{
+    //cursor over RDNs
+    DERCursor rdns = {0};
+    
+    //cursor over (RDN's) attributes
+    DERCursor attributes = {0};
+    
+    //cursor over attribute
+    DERCursor attribute = {0};
+    
+    //rdn
+    DERItem rdn = {0};
+    
+    //attribute
+    DERItem item = {0};
+    
+    //type
+    DERItem type = {0};
+    
+    //value
+    DERItem value = {0};
+    
+    //walk RDNs
+    derEnter(&rdns, name);
+    while(YES == derNextExpect(&rdns, DER_TAG_SET, &rdn))
+    {
+        //walk attributes
+        derEnter(&attributes, &rdn);
+        while(YES == derNextExpect(&attributes, DER_TAG_SEQUENCE, &item))
+        {
+            //decode type and value
+            derEnter(&attribute, &item);
+            if( (YES != derNextExpect(&attribute, DER_TAG_OID, &type)) ||
+                (YES != derNext(&attribute, &value)) )
+            {
+                //skip
+                continue;
+            }
+            
+            //match?
+            if(YES == derOIDEqual(&type, oid, length))
+            {
+                return decodeString(&value);
+            }
+        }
+    }
+    
+    return nil;
+}
+
+//intern a name
+// names repeat across chains (e.g. issuers), so share a single copy
+// note: caller must hold lock
+static NSString* internName(NSString* name)
+{
+    //interned
+    NSString* interned = nil;
+    
+    //sanity check
+    if(nil == name)
+    {
+        return nil;
+    }
+    
+    //init
+    if(nil == names)
+    {
+        names = [NSMutableSet set];
+    }
+    
+    //already interned?
+    interned = [names member:name];
+    if(nil != interned)
+    {
+        return interned;
+    }
+    
+    //full?
+    // don't intern, just use as is
+    if(names.count >= X509_INTERNED_MAX)
+    {
+        return name;
+    }
+    
+    //intern
+    [names addObject:name];
+    
+    return name;
+}
+
+//parse a (DER) certificate
+// returns subject's names (CN, OU, O), issuer's CN and hash, serial, validity, and fingerprints; nil if malformed
+NSDictionary* x509Parse(const uint8_t* bytes, size_t length)
+{
+    //info
+    NSMutableDictionary* info = nil;
+    
+    //cursor over certificate
+    DERCursor cursor = {0};
+    
+    //cursor over tbs certificate
+    DERCursor tbsCursor = {0};
+    
+    //cursor over validity
+    DERCursor validityCursor = {0};
+    
+    //certificate
+    DERItem certificate = {0};
+    
+    //tbs certificate
+    DERItem tbs = {0};
+    
+    //item
+    DERItem item = {0};
+    
+    //signature algorithm
+    DERItem algorithm = {0};
+    
+    //issuer
+    DERItem issuer = {0};
+    
+    //validity
+    DERItem validity = {0};
+    
+    //subject
+    DERItem subject = {0};
+    
+    //not before/after
+    DERItem notBefore = {0};
+    DERItem notAfter = {0};
+    
+    //fingerprints
+    uint8_t sha1[CC_SHA1_DIGEST_LENGTH] = {0};
+    uint8_t sha256[CC_SHA256_DIGEST_LENGTH] = {0};
+    
+    //issuer's hash
+    uint8_t issuerHash[CC_SHA256_DIGEST_LENGTH] = {0};
+    
+    //name
+    NSString* name = nil;
+    
+    //date
+    NSDate* date = nil;
+    
+    //decode certificate
+    // SEQUENCE { tbsCertificate, signatureAlgorithm, signature }
+    if(YES != derDecode(bytes, length, DER_TAG_SEQUENCE, &certificate))
+    {
+        //bail
+        goto bail;
+    }
+    
+    //decode tbs certificate
+    derEnter(&cursor, &certificate);
+    if(YES != derNextExpect(&cursor, DER_TAG_SEQUENCE, &tbs))
+    {
+        //bail
+        goto bail;
+    }
+    
+    //first item
+    // either (optional) version, or serial
+    derEnter(&tbsCursor, &tbs);
+    if(YES != derNext(&tbsCursor, &item))
+    {
+        //bail
+        goto bail;
+    }
+    
+    //skip version
+    if( (DER_TAG_CONTEXT(0) == item.tag) &&
+        (YES != derNext(&tbsCursor, &item)) )
+    {
+        //bail
+        goto bail;
+    }
+    
+    //serial
+    // then signature algorithm, issuer, validity, and subject
+    if( (DER_TAG_INTEGER != item.tag) ||
+        (0 == item.length) ||
+        (YES != derNextExpect(&tbsCursor, DER_TAG_SEQUENCE, &algorithm)) ||
+        (YES != derNextExpect(&tbsCursor, DER_TAG_SEQUENCE, &issuer)) ||
+        (YES != derNextExpect(&tbsCursor, DER_TAG_SEQUENCE, &validity)) ||
+        (YES != derNextExpect(&tbsCursor, DER_TAG_SEQUENCE, &subject)) )
+    {
+        //bail
+        goto bail;
+    }
+    
+    //init
+    info = [NSMutableDictionary dictionary];
+    
+    //save serial
+    // raw (big endian) bytes, same as 'SecCertificateCopySerialNumberData'
+    info[KEY_CERT_SERIAL] = [NSData dataWithBytes:item.data length:item.length];
+    
+    //decode validity
+    derEnter(&validityCursor, &validity);
+    if( (YES != derNext(&validityCursor, &notBefore)) ||
+        (YES != derNext(&validityCursor, &notAfter)) )
+    {
+        //bail
+        info = nil;
+        goto bail;
+    }
+    
+    //save not before
+    date = decodeTime(&notBefore);
+    if(nil != date)
+    {
+        info[KEY_CERT_NOT_BEFORE] = date;
+    }
+    
+    //save not after
+    date = decodeTime(&notAfter);
+    if(nil != date)
+    {
+        info[KEY_CERT_NOT_AFTER] = date;
+    }
+    
+    //save subject's common name
+    name = nameAttribute(&subject, oidCommonName, sizeof(oidCommonName));
+    if(nil != name)
+    {
+        info[KEY_CERT_COMMON_NAME] = name;
+    }
+    
+    //save subject's organizational unit
+    name = nameAttribute(&subject, oidOrganizationalUnit, sizeof(oidOrganizationalUnit));
+    if(nil != name)
+    {
+        info[KEY_CERT_ORGANIZATIONAL_UNIT] = name;
+    }
+    
+    //save subject's organization
+    name = nameAttribute(&subject, oidOrganization, sizeof(oidOrganization));
+    if(nil != name)
+    {
+        info[KEY_CERT_ORGANIZATION] = name;
+    }
+    
+    //save issuer's common name
+    name = nameAttribute(&issuer, oidCommonName, sizeof(oidCommonName));
+    if(nil != name)
+    {
+        info[KEY_CERT_ISSUER_COMMON_NAME] = name;
+    }
+    
+    //save issuer's hash
+    // over (contents of) its name, so serials can be keyed by issuer
+    CC_SHA256(issuer.data, (CC_LONG)issuer.length, issuerHash);
+    info[KEY_CERT_ISSUER_HASH] = [NSData dataWithBytes:issuerHash length:sizeof(issuerHash)];
+    
+    //compute fingerprints
+    // over entire (DER) certificate
+    CC_SHA1(bytes, (CC_LONG)length, sha1);
+    CC_SHA256(bytes, (CC_LONG)length, sha256);
+    
+    //save fingerprints
+    info[KEY_CERT_SHA1] = [NSData dataWithBytes:sha1 length:sizeof(sha1)];
+    info[KEY_CERT_SHA256] = [NSData dataWithBytes:sha256 length:sizeof(sha256)];
+
+bail:
+    
+    return info;
+}
+
+//get (parsed) info of a certificate
+// cached by fingerprint, w/ names interned
+NSDictionary* x509Info(SecCertificateRef certificate)
+{
+    //info
+    id info = nil;
+    
+    //parsed info
+    NSMutableDictionary* parsed = nil;
+    
+    //cert data
+    NSData* data = nil;
+    
+    //fingerprint
+    uint8_t sha256[CC_SHA256_DIGEST_LENGTH] = {0};
+    
+    //fingerprint (as key)
+    NSData* fingerprint = nil;
+    
+    //get cert data
+    data = CFBridgingRelease(SecCertificateCopyData(certificate));
+    if(0 == data.length)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //compute fingerprint
+    CC_SHA256(data.bytes, (CC_LONG)data.length, sha256);
+    fingerprint = [NSData dataWithBytes:sha256 length:sizeof(sha256)];
+    
+    //lock
+    os_unfair_lock_lock(&certificatesLock);
+    
+    //cached?
+    info = certificates[fingerprint];
+    
+    //unlock
+    os_unfair_lock_unlock(&certificatesLock);
+    
+    //hit
+    if(nil != info)
+    {
+        //done
+        goto bail;
+    }
+    
+    //parse
+    // outside of lock, as it hashes the whole certificate
+    parsed = [x509Parse(data.bytes, data.length) mutableCopy];
+    
+    //lock
+    os_unfair_lock_lock(&certificatesLock);
+    
+    //init
+    if(nil == certificates)
+    {
+        certificates = [NSMutableDictionary dictionary];
+    }
+    
+    //intern names
+    for(NSString* key in @[KEY_CERT_COMMON_NAME, KEY_CERT_ORGANIZATIONAL_UNIT, KEY_CERT_ORGANIZATION, KEY_CERT_ISSUER_COMMON_NAME])
+    {
+        //intern
+        if(nil != parsed[key])
+        {
+            parsed[key] = internName(parsed[key]);
+        }
+    }
+    
+    //full?
+    // just start over
+    if(certificates.count >= X509_CACHE_MAX)
+    {
+        [certificates removeAllObjects];
+    }
+    
+    //save
+    // null if certificate was malformed, so it's not parsed again
+    info = (nil != parsed) ? [parsed copy] : [NSNull null];
+    certificates[fingerprint] = info;
+    
+    //unlock
+    os_unfair_lock_unlock(&certificatesLock);
+
+bail:
+    
+    //malformed?
+    if(YES == [info isKindOfClass:[NSNull class]])
+    {
+        //unset
+        info = nil;
+    }
+    
+    return info;
+}
+
+//get common name of a certificate
+// falls back to Security framework, if certificate couldn't be parsed
+NSString* x509CommonName(SecCertificateRef certificate)
+{
+    //common name
+    NSString* commonName = nil;
+    
+    //common name (from Security framework)
+    CFStringRef name = NULL;
+    
+    //parse
+    commonName = x509Info(certificate)[KEY_CERT_COMMON_NAME];
+    if(nil != commonName)
+    {
+        //done
+        goto bail;
+    }
+    
+    //fall back
+    if( (errSecSuccess == SecCertificateCopyCommonName(certificate, &name)) &&
+        (NULL != name) )
+    {
+        //save
+        commonName = CFBridgingRelease(name);
+    }
+
+bail:
+    
+    return commonName;
+}
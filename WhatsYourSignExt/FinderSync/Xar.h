@@ -0,0 +1,95 @@
+//
+//  Xar.h
+//  WhatsYourSign
+//
+//  Created by Patrick Wardle on 10/17/26.
+//  Copyright (c) 2026 Objective-See. All rights reserved.
+//
+//  note: XAR format, see: https://github.com/apple-oss-distributions/xar
+
+#ifndef Xar_h
+#define Xar_h
+
+@import Foundation;
+
+//xar magic ('xar!')
+#define XAR_MAGIC 0x78617221
+
+//xar header size (w/o checksum name)
+#define XAR_HEADER_SIZE 28
+
+//max size of (uncompressed) TOC
+#define XAR_MAX_TOC_SIZE (256*1024*1024)
+
+//checksum algorithms (header)
+#define XAR_CKSUM_NONE 0
+#define XAR_CKSUM_SHA1 1
+#define XAR_CKSUM_MD5 2
+#define XAR_CKSUM_OTHER 3
+
+//heap file encodings
+#define XAR_ENCODING_NONE @"application/octet-stream"
+#define XAR_ENCODING_GZIP @"application/x-gzip"
+#define XAR_ENCODING_XZ @"application/x-xz"
+#define XAR_ENCODING_BZIP2 @"application/x-bzip2"
+
+//size of buffer for (streaming) decompression of heap files
+#define XAR_INFLATE_BUFFER_SIZE (256*1024)
+
+//class interface
+@interface XarArchive : NSObject
+{
+
+}
+
+/* METHODS */
+
+//init with path
+// reads header and (only) inflates the TOC
+-(instancetype)init:(NSString*)path;
+
+//read bytes from the heap
+-(NSData*)readHeap:(uint64_t)offset length:(uint64_t)length;
+
+//verify the TOC checksum
+// (re)hash of compressed TOC should match checksum stored in heap
+-(BOOL)verifyChecksum;
+
+//verify the (RSA) signature over the TOC checksum
+// uses public key of leaf certificate
+-(OSStatus)verifySignature;
+
+//verify (all) files in the heap
+// heap is read once, sequentially, with files checked in parallel
+// returns each file's name, and results of checking its archived & extracted checksums
+-(NSArray*)verifyHeap;
+
+/* PROPERTIES */
+
+//path
+@property(nonatomic, retain)NSString* path;
+
+//table of contents
+@property(nonatomic, retain)NSXMLDocument* toc;
+
+//offset of heap (in file)
+@property uint64_t heapOffset;
+
+//checksum algorithm (name)
+@property(nonatomic, retain)NSString* checksumStyle;
+
+//checksum of (compressed) TOC
+// computed when archive is loaded
+@property(nonatomic, retain)NSData* tocChecksum;
+
+//signature certificates (SecCertificateRef)
+// leaf first, as listed in the TOC
+@property(nonatomic, retain)NSArray* certificates;
+
+//signing time
+// from TOC (so covered by its signed checksum), nil if there isn't one
+@property(nonatomic, retain)NSDate* signingTime;
+
+@end
+
+#endif /* Xar_h */
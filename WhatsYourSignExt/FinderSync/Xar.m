@@ -0,0 +1,1554 @@
+//
+//  Xar.m
+//  FinderSync
+//
+//  Created by Patrick Wardle on 10/17/26.
+//  Copyright (c) 2026 Objective-See. All rights reserved.
+//
+
+#import "Xar.h"
+#import "consts.h"
+#import "Payload.h"
+#import "utilities.h"
+
+#import <fcntl.h>
+#import <unistd.h>
+#import <os/log.h>
+#import <sys/stat.h>
+#import <bzlib.h>
+#import <os/lock.h>
+#import <stdatomic.h>
+#import <compression.h>
+#import <CommonCrypto/CommonDigest.h>
+
+@import Security;
+
+//digest algorithms
+typedef NS_ENUM(NSInteger, XarDigestAlgorithm)
+{
+    XarDigestNone = 0,
+    XarDigestMD5,
+    XarDigestSHA1,
+    XarDigestSHA256,
+    XarDigestSHA512
+};
+
+//digest (streaming)
+typedef struct
+{
+    //algorithm
+    XarDigestAlgorithm algorithm;
+    
+    //context
+    union
+    {
+        CC_MD5_CTX md5;
+        CC_SHA1_CTX sha1;
+        CC_SHA256_CTX sha256;
+        CC_SHA512_CTX sha512;
+        
+    } context;
+    
+} XarDigest;
+
+//heap file encodings
+typedef NS_ENUM(NSInteger, XarEncoding)
+{
+    XarEncodingNone = 0,
+    XarEncodingGzip,
+    XarEncodingXZ,
+    XarEncodingBzip2,
+    XarEncodingUnsupported
+};
+
+//heap file
+// state (and results) of checking it
+typedef struct
+{
+    //offset (in heap)
+    uint64_t offset;
+    
+    //length (in heap)
+    uint64_t length;
+    
+    //size (extracted)
+    uint64_t size;
+    
+    //encoding
+    XarEncoding encoding;
+    
+    //digests
+    XarDigest archived;
+    XarDigest extracted;
+    
+    //expected checksums
+    uint8_t archivedChecksum[CC_SHA512_DIGEST_LENGTH];
+    size_t archivedChecksumLength;
+    uint8_t extractedChecksum[CC_SHA512_DIGEST_LENGTH];
+    size_t extractedChecksumLength;
+    
+    //decompression stream
+    compression_stream stream;
+    
+    //decompression stream (bzip2)
+    // not supported by compression framework, so uses libbz2
+    bz_stream bzStream;
+    
+    //stream state
+    BOOL streaming;
+    BOOL streamEnded;
+    BOOL streamFailed;
+    
+    //zlib header bytes to skip
+    // 'COMPRESSION_ZLIB' is raw deflate
+    size_t headerSkip;
+    
+    //decompression buffer
+    uint8_t* output;
+    
+    //bytes processed
+    uint64_t processed;
+    
+    //bytes extracted
+    uint64_t extractedSize;
+    
+    //extracted checksum is (just) archived checksum?
+    // i.e. not encoded, and same algorithm
+    BOOL sameDigest;
+    
+    //payload inspector (PayloadInspector*)
+    // only set for payloads, and retained elsewhere
+    void* inspector;
+    
+    //done?
+    BOOL done;
+    
+    //results
+    OSStatus archivedStatus;
+    OSStatus extractedStatus;
+    
+} XarHeapFile;
+
+//heap ring slot
+// a chunk of the heap, shared by all files it overlaps
+typedef struct
+{
+    //bytes
+    uint8_t* bytes;
+    
+    //length
+    size_t length;
+    
+    //# of files that still have to process it
+    atomic_int pending;
+    
+} XarHeapSlot;
+
+//heap ring
+// slots are freed out of order (each once all files it overlaps are done w/ it),
+// so free slots are kept on a stack, rather than reused round robin
+typedef struct
+{
+    //slots
+    XarHeapSlot slots[HASH_RING_SLOTS];
+    
+    //free slots
+    XarHeapSlot* available[HASH_RING_SLOTS];
+    
+    //# of free slots
+    NSUInteger freeCount;
+    
+    //lock
+    // for free slots
+    os_unfair_lock lock;
+    
+} XarHeapRing;
+
+//grab a free slot
+// caller must have waited on ring's semaphore, so one is guaranteed to be free
+static XarHeapSlot* ringAcquire(XarHeapRing* ring)
+{
+    //slot
+    XarHeapSlot* slot = NULL;
+    
+    //pop
+    os_unfair_lock_lock(&ring->lock);
+    slot = ring->available[--ring->freeCount];
+    os_unfair_lock_unlock(&ring->lock);
+    
+    return slot;
+}
+
+//return a slot
+// caller must then signal ring's semaphore
+static void ringRelease(XarHeapRing* ring, XarHeapSlot* slot)
+{
+    //push
+    os_unfair_lock_lock(&ring->lock);
+    ring->available[ring->freeCount++] = slot;
+    os_unfair_lock_unlock(&ring->lock);
+    
+    return;
+}
+
+//init digest w/ (xar) checksum style
+// returns NO for unsupported algorithms
+static BOOL digestInit(XarDigest* digest, NSString* style)
+{
+    //reset
+    memset(digest, 0, sizeof(XarDigest));
+    
+    //sha1
+    if(NSOrderedSame == [style caseInsensitiveCompare:@"sha1"])
+    {
+        digest->algorithm = XarDigestSHA1;
+        CC_SHA1_Init(&digest->context.sha1);
+    }
+    //sha256
+    else if(NSOrderedSame == [style caseInsensitiveCompare:@"sha256"])
+    {
+        digest->algorithm = XarDigestSHA256;
+        CC_SHA256_Init(&digest->context.sha256);
+    }
+    //sha512
+    else if(NSOrderedSame == [style caseInsensitiveCompare:@"sha512"])
+    {
+        digest->algorithm = XarDigestSHA512;
+        CC_SHA512_Init(&digest->context.sha512);
+    }
+    //md5
+    else if(NSOrderedSame == [style caseInsensitiveCompare:@"md5"])
+    {
+        digest->algorithm = XarDigestMD5;
+        CC_MD5_Init(&digest->context.md5);
+    }
+    
+    return (XarDigestNone != digest->algorithm);
+}
+
+//add bytes to digest
+static void digestUpdate(XarDigest* digest, const void* bytes, size_t length)
+{
+    //add
+    switch(digest->algorithm)
+    {
+        case XarDigestMD5:
+            CC_MD5_Update(&digest->context.md5, bytes, (CC_LONG)length);
+            break;
+            
+        case XarDigestSHA1:
+            CC_SHA1_Update(&digest->context.sha1, bytes, (CC_LONG)length);
+            break;
+            
+        case XarDigestSHA256:
+            CC_SHA256_Update(&digest->context.sha256, bytes, (CC_LONG)length);
+            break;
+            
+        case XarDigestSHA512:
+            CC_SHA512_Update(&digest->context.sha512, bytes, (CC_LONG)length);
+            break;
+            
+        default:
+            break;
+    }
+    
+    return;
+}
+
+//finalize digest
+// 'output' must be (at least) CC_SHA512_DIGEST_LENGTH, returns digest's length
+static size_t digestFinal(XarDigest* digest, uint8_t* output)
+{
+    //finalize
+    switch(digest->algorithm)
+    {
+        case XarDigestMD5:
+            CC_MD5_Final(output, &digest->context.md5);
+            return CC_MD5_DIGEST_LENGTH;
+            
+        case XarDigestSHA1:
+            CC_SHA1_Final(output, &digest->context.sha1);
+            return CC_SHA1_DIGEST_LENGTH;
+            
+        case XarDigestSHA256:
+            CC_SHA256_Final(output, &digest->context.sha256);
+            return CC_SHA256_DIGEST_LENGTH;
+            
+        case XarDigestSHA512:
+            CC_SHA512_Final(output, &digest->context.sha512);
+            return CC_SHA512_DIGEST_LENGTH;
+            
+        default:
+            return 0;
+    }
+}
+
+//hash data w/ (xar) checksum style
+// returns nil for unsupported algorithms
+static NSData* digest(NSString* style, const void* bytes, size_t length)
+{
+    //digest
+    XarDigest digest = {0};
+    
+    //output
+    uint8_t output[CC_SHA512_DIGEST_LENGTH] = {0};
+    
+    //init
+    if(YES != digestInit(&digest, style))
+    {
+        //unsupported
+        return nil;
+    }
+    
+    //hash
+    digestUpdate(&digest, bytes, length);
+    
+    return [NSData dataWithBytes:output length:digestFinal(&digest, output)];
+}
+
+//check a (finalized) digest against expected checksum
+static OSStatus digestCheck(XarDigest* digest, const uint8_t* expected, size_t expectedLength)
+{
+    //output
+    uint8_t output[CC_SHA512_DIGEST_LENGTH] = {0};
+    
+    //unsupported?
+    if(XarDigestNone == digest->algorithm)
+    {
+        return errSecCSUnimplemented;
+    }
+    
+    //check
+    if( (expectedLength != digestFinal(digest, output)) ||
+        (0 != memcmp(output, expected, expectedLength)) )
+    {
+        return errSecCSSignatureFailed;
+    }
+    
+    return errSecSuccess;
+}
+
+//convert (TOC) hex string to bytes
+// returns # of bytes, 0 on error (or if too long)
+static size_t hexToBytes(NSString* hex, uint8_t* bytes, size_t maxLength)
+{
+    //string
+    const char* string = hex.UTF8String;
+    
+    //length
+    size_t length = 0;
+    
+    //sanity check
+    if( (NULL == string) ||
+        (0 != (strlen(string) % 2)) ||
+        (strlen(string) / 2 > maxLength) )
+    {
+        return 0;
+    }
+    
+    //convert
+    for(length = 0; length < strlen(string) / 2; length++)
+    {
+        //pair of hex digits
+        char pair[3] = {string[length * 2], string[length * 2 + 1], 0};
+        
+        //sanity check
+        if( (0 == isxdigit(pair[0])) ||
+            (0 == isxdigit(pair[1])) )
+        {
+            return 0;
+        }
+        
+        //save
+        bytes[length] = (uint8_t)strtoul(pair, NULL, 16);
+    }
+    
+    return length;
+}
+
+//handle (next) extracted bytes of a heap file
+// hashes them, and (for payloads) inspects them
+static void extractedBytes(XarHeapFile* file, const uint8_t* bytes, size_t length)
+{
+    //hash (extracted) bytes
+    digestUpdate(&file->extracted, bytes, length);
+    file->extractedSize += length;
+    
+    //payload?
+    // inspect (extracted) bytes too
+    if(NULL != file->inspector)
+    {
+        [(__bridge PayloadInspector*)file->inspector update:bytes length:length];
+    }
+    
+    return;
+}
+
+//end decompression stream of a heap file
+static void endStream(XarHeapFile* file)
+{
+    //cleanup
+    if(YES == file->streaming)
+    {
+        //bzip2
+        if(XarEncodingBzip2 == file->encoding)
+        {
+            BZ2_bzDecompressEnd(&file->bzStream);
+        }
+        //gzip/xz
+        else
+        {
+            compression_stream_destroy(&file->stream);
+        }
+        
+        //unset
+        file->streaming = NO;
+    }
+    
+    //free buffer
+    if(NULL != file->output)
+    {
+        free(file->output);
+        file->output = NULL;
+    }
+    
+    return;
+}
+
+//decompress (part of) a bzip2'd heap file
+// compression framework doesn't do bzip2, so uses libbz2 (which ships w/ macOS)
+static void bunzipChunk(XarHeapFile* file, const uint8_t* bytes, size_t length)
+{
+    //status
+    int status = BZ_OK;
+    
+    //first chunk?
+    // init stream and its buffer
+    if(YES != file->streaming)
+    {
+        //alloc buffer
+        file->output = malloc(XAR_INFLATE_BUFFER_SIZE);
+        
+        //init stream
+        if( (NULL == file->output) ||
+            (BZ_OK != BZ2_bzDecompressInit(&file->bzStream, 0, 0)) )
+        {
+            //failed
+            file->streamFailed = YES;
+            return;
+        }
+        
+        //set flag
+        file->streaming = YES;
+    }
+    
+    //init input
+    file->bzStream.next_in = (char*)bytes;
+    file->bzStream.avail_in = (unsigned int)length;
+    
+    //decompress
+    // until input is consumed, and output buffer isn't full
+    do
+    {
+        //init output
+        file->bzStream.next_out = (char*)file->output;
+        file->bzStream.avail_out = XAR_INFLATE_BUFFER_SIZE;
+        
+        //decompress
+        status = BZ2_bzDecompress(&file->bzStream);
+        if( (BZ_OK != status) &&
+            (BZ_STREAM_END != status) )
+        {
+            //failed
+            file->streamFailed = YES;
+            break;
+        }
+        
+        //handle (extracted) bytes
+        extractedBytes(file, file->output, XAR_INFLATE_BUFFER_SIZE - file->bzStream.avail_out);
+        
+        //end of stream?
+        if(BZ_STREAM_END == status)
+        {
+            //set flag
+            file->streamEnded = YES;
+            break;
+        }
+        
+    } while( (0 != file->bzStream.avail_in) ||
+             (0 == file->bzStream.avail_out) );
+    
+    return;
+}
+
+//decompress (part of) a heap file
+// extracted bytes are hashed as they come out
+static void inflateChunk(XarHeapFile* file, const uint8_t* bytes, size_t length, BOOL finalize)
+{
+    //skip
+    size_t skip = 0;
+    
+    //status
+    compression_status status = COMPRESSION_STATUS_OK;
+    
+    //skip (zlib) header
+    skip = MIN(file->headerSkip, length);
+    file->headerSkip -= skip;
+    bytes += skip;
+    length -= skip;
+    
+    //done, failed, or nothing to do?
+    if( (YES == file->streamEnded) ||
+        (YES == file->streamFailed) ||
+        ( (0 == length) && (YES != finalize) ) )
+    {
+        return;
+    }
+    
+    //bzip2?
+    // has its own end of stream marker, so nothing to flush
+    if(XarEncodingBzip2 == file->encoding)
+    {
+        //decompress
+        if(0 != length)
+        {
+            bunzipChunk(file, bytes, length);
+        }
+        
+        return;
+    }
+    
+    //first chunk?
+    // init stream and its buffer
+    if(YES != file->streaming)
+    {
+        //alloc buffer
+        file->output = malloc(XAR_INFLATE_BUFFER_SIZE);
+        
+        //init stream
+        if( (NULL == file->output) ||
+            (COMPRESSION_STATUS_OK != compression_stream_init(&file->stream, COMPRESSION_STREAM_DECODE, (XarEncodingXZ == file->encoding) ? COMPRESSION_LZMA : COMPRESSION_ZLIB)) )
+        {
+            //failed
+            file->streamFailed = YES;
+            return;
+        }
+        
+        //set flag
+        file->streaming = YES;
+    }
+    
+    //init input
+    file->stream.src_ptr = bytes;
+    file->stream.src_size = length;
+    
+    //decompress
+    // until input is consumed, and output buffer isn't full
+    do
+    {
+        //init output
+        file->stream.dst_ptr = file->output;
+        file->stream.dst_size = XAR_INFLATE_BUFFER_SIZE;
+        
+        //decompress
+        status = compression_stream_process(&file->stream, (YES == finalize) ? COMPRESSION_STREAM_FINALIZE : 0);
+        if(COMPRESSION_STATUS_ERROR == status)
+        {
+            //failed
+            file->streamFailed = YES;
+            break;
+        }
+        
+        //handle (extracted) bytes
+        extractedBytes(file, file->output, XAR_INFLATE_BUFFER_SIZE - file->stream.dst_size);
+        
+        //end of stream?
+        // note: for gzip, (adler) trailer follows, but isn't needed
+        if(COMPRESSION_STATUS_END == status)
+        {
+            //set flag
+            file->streamEnded = YES;
+            break;
+        }
+        
+    } while( (0 != file->stream.src_size) ||
+             (0 == file->stream.dst_size) );
+    
+    return;
+}
+
+//finish (checking) a heap file
+// finalizes digests, and compares them against expected checksums
+static void finishFile(XarHeapFile* file)
+{
+    //compressed?
+    if( (XarEncodingGzip == file->encoding) ||
+        (XarEncodingXZ == file->encoding) ||
+        (XarEncodingBzip2 == file->encoding) )
+    {
+        //flush
+        inflateChunk(file, NULL, 0, YES);
+        
+        //didn't (fully) decompress?
+        if( (YES != file->streamEnded) ||
+            (YES == file->streamFailed) )
+        {
+            file->extractedStatus = errSecCSSignatureFailed;
+        }
+        
+        //cleanup
+        endStream(file);
+    }
+    
+    //check archived checksum
+    file->archivedStatus = digestCheck(&file->archived, file->archivedChecksum, file->archivedChecksumLength);
+    
+    //check extracted checksum
+    // unless already failed, or encoding isn't supported
+    if(XarEncodingUnsupported == file->encoding)
+    {
+        file->extractedStatus = errSecCSUnimplemented;
+    }
+    else if(errSecSuccess == file->extractedStatus)
+    {
+        //same digest?
+        // extracted is archived, so just compare (expected) checksums
+        if(YES == file->sameDigest)
+        {
+            file->extractedStatus = ( (file->archivedChecksumLength == file->extractedChecksumLength) &&
+                                      (0 == memcmp(file->archivedChecksum, file->extractedChecksum, file->extractedChecksumLength)) ) ? file->archivedStatus : errSecCSSignatureFailed;
+        }
+        //check
+        else
+        {
+            file->extractedStatus = digestCheck(&file->extracted, file->extractedChecksum, file->extractedChecksumLength);
+        }
+        
+        //size should match too
+        if( (errSecSuccess == file->extractedStatus) &&
+            (XarEncodingNone != file->encoding) &&
+            (file->extractedSize != file->size) )
+        {
+            file->extractedStatus = errSecCSSignatureFailed;
+        }
+    }
+    
+    //done
+    file->done = YES;
+    
+    return;
+}
+
+//process (part of) a heap file
+// hashes (archived) bytes, and decompresses/hashes them too if needed
+static void processChunk(XarHeapFile* file, const uint8_t* bytes, size_t length)
+{
+    //hash (archived)
+    digestUpdate(&file->archived, bytes, length);
+    
+    //not encoded?
+    // only need to also hash, if extracted checksum uses another algorithm
+    if( (XarEncodingNone == file->encoding) &&
+        (YES != file->sameDigest) )
+    {
+        digestUpdate(&file->extracted, bytes, length);
+    }
+    
+    //not encoded payload?
+    // inspect bytes as is
+    if( (XarEncodingNone == file->encoding) &&
+        (NULL != file->inspector) )
+    {
+        [(__bridge PayloadInspector*)file->inspector update:bytes length:length];
+    }
+    
+    //compressed
+    if( (XarEncodingNone != file->encoding) &&
+        (XarEncodingUnsupported != file->encoding) )
+    {
+        inflateChunk(file, bytes, length, NO);
+    }
+    
+    //update
+    file->processed += length;
+    
+    //all of it?
+    if(file->processed == file->length)
+    {
+        //finish
+        finishFile(file);
+    }
+    
+    return;
+}
+
+//class implementation
+@implementation XarArchive
+{
+    //file descriptor
+    int fd;
+}
+
+@synthesize toc;
+@synthesize path;
+@synthesize heapOffset;
+@synthesize tocChecksum;
+@synthesize certificates;
+@synthesize checksumStyle;
+@synthesize signingTime;
+
+//init with path
+// reads header and (only) inflates the TOC
+-(instancetype)init:(NSString*)archivePath
+{
+    //header
+    uint8_t header[XAR_HEADER_SIZE] = {0};
+    
+    //header size
+    uint16_t headerSize = 0;
+    
+    //compressed TOC size
+    uint64_t compressedSize = 0;
+    
+    //uncompressed TOC size
+    uint64_t uncompressedSize = 0;
+    
+    //compressed TOC
+    NSMutableData* compressed = nil;
+    
+    //uncompressed TOC
+    NSMutableData* uncompressed = nil;
+    
+    //error
+    NSError* error = nil;
+    
+    //init
+    if(self = [super init])
+    {
+        //init fd
+        fd = -1;
+        
+        //save path
+        self.path = archivePath;
+        
+        //open
+        fd = open(archivePath.fileSystemRepresentation, O_RDONLY | O_CLOEXEC);
+        if(-1 == fd)
+        {
+            //bail
+            return nil;
+        }
+        
+        //read header
+        if(YES != readAt(fd, header, sizeof(header), 0))
+        {
+            //bail
+            return nil;
+        }
+        
+        //check magic
+        // all fields are big-endian
+        if(XAR_MAGIC != OSReadBigInt32(header, 0))
+        {
+            //bail
+            return nil;
+        }
+        
+        //extract sizes
+        headerSize = OSReadBigInt16(header, 4);
+        compressedSize = OSReadBigInt64(header, 8);
+        uncompressedSize = OSReadBigInt64(header, 16);
+        
+        //sanity check
+        if( (headerSize < XAR_HEADER_SIZE) ||
+            (compressedSize < 2) ||
+            (compressedSize > XAR_MAX_TOC_SIZE) ||
+            (0 == uncompressedSize) ||
+            (uncompressedSize > XAR_MAX_TOC_SIZE) )
+        {
+            //bail
+            return nil;
+        }
+        
+        //heap follows TOC
+        self.heapOffset = headerSize + compressedSize;
+        
+        //alloc
+        compressed = [NSMutableData dataWithLength:(NSUInteger)compressedSize];
+        uncompressed = [NSMutableData dataWithLength:(NSUInteger)uncompressedSize];
+        
+        //read compressed TOC
+        if(YES != readAt(fd, compressed.mutableBytes, compressed.length, headerSize))
+        {
+            //bail
+            return nil;
+        }
+        
+        //inflate
+        // skip zlib header, as 'COMPRESSION_ZLIB' is raw deflate
+        if(uncompressedSize != compression_decode_buffer(uncompressed.mutableBytes, uncompressed.length, (const uint8_t*)compressed.bytes + 2, compressed.length - 2, NULL, COMPRESSION_ZLIB))
+        {
+            //bail
+            return nil;
+        }
+        
+        //parse TOC
+        self.toc = [[NSXMLDocument alloc] initWithData:uncompressed options:0 error:&error];
+        if(nil == self.toc)
+        {
+            //dbg msg
+            os_log_debug(OS_LOG_DEFAULT, "WYS: failed to parse XAR TOC: %{public}@", error);
+            
+            //bail
+            return nil;
+        }
+        
+        //grab checksum style
+        // note: TOC is authoritative (header only knows 'sha1'/'md5')
+        self.checksumStyle = [[[self tocElement:@"checksum"] attributeForName:@"style"] stringValue];
+        if(nil == self.checksumStyle)
+        {
+            //default
+            self.checksumStyle = (XAR_CKSUM_MD5 == OSReadBigInt32(header, 24)) ? @"md5" : @"sha1";
+        }
+        
+        //compute checksum of compressed TOC
+        self.tocChecksum = digest(self.checksumStyle, compressed.bytes, compressed.length);
+        
+        //extract certificates
+        self.certificates = [self extractCertificates];
+        
+        //grab signing time
+        // seconds since reference date (2001)
+        if(nil != [self tocElement:@"signature-creation-time"])
+        {
+            self.signingTime = [NSDate dateWithTimeIntervalSinceReferenceDate:[[self tocElement:@"signature-creation-time"] stringValue].doubleValue];
+        }
+    }
+    
+    return self;
+}
+
+//get a top-level element from the TOC
+-(NSXMLElement*)tocElement:(NSString*)name
+{
+    return [[self.toc nodesForXPath:[NSString stringWithFormat:@"/xar/toc/%@", name] error:nil] firstObject];
+}
+
+//get (numeric) value of an element's child
+-(uint64_t)valueOf:(NSString*)name element:(NSXMLElement*)element
+{
+    return strtoull([[[element elementsForName:name] firstObject] stringValue].UTF8String ?: "0", NULL, 10);
+}
+
+//read bytes from the heap
+-(NSData*)readHeap:(uint64_t)offset length:(uint64_t)length
+{
+    //data
+    NSMutableData* data = nil;
+    
+    //sanity check
+    if(length > XAR_MAX_TOC_SIZE)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //alloc
+    data = [NSMutableData dataWithLength:(NSUInteger)length];
+    
+    //read
+    if(YES != readAt(fd, data.mutableBytes, data.length, self.heapOffset + offset))
+    {
+        //unset
+        data = nil;
+    }
+
+bail:
+    
+    return data;
+}
+
+//verify the TOC checksum
+// (re)hash of compressed TOC should match checksum stored in heap
+-(BOOL)verifyChecksum
+{
+    //checksum element
+    NSXMLElement* checksum = nil;
+    
+    //stored checksum
+    NSData* stored = nil;
+    
+    //get checksum element
+    checksum = [self tocElement:@"checksum"];
+    if( (nil == checksum) ||
+        (nil == self.tocChecksum) )
+    {
+        //fail
+        return NO;
+    }
+    
+    //read stored checksum
+    stored = [self readHeap:[self valueOf:@"offset" element:checksum] length:[self valueOf:@"size" element:checksum]];
+    
+    return [stored isEqualToData:self.tocChecksum];
+}
+
+//extract signature's certificates
+// base64'd, in 'signature/KeyInfo/X509Data/X509Certificate'
+-(NSArray*)extractCertificates
+{
+    //certs
+    NSMutableArray* certs = nil;
+    
+    //signature
+    NSXMLElement* signature = nil;
+    
+    //init
+    certs = [NSMutableArray array];
+    
+    //get signature
+    signature = [self tocElement:@"signature"];
+    if(nil == signature)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //extract each
+    // note: 'local-name()' as KeyInfo has its own namespace
+    for(NSXMLNode* node in [signature nodesForXPath:@".//*[local-name()='X509Certificate']" error:nil])
+    {
+        //cert data
+        NSData* data = nil;
+        
+        //cert
+        SecCertificateRef certificate = NULL;
+        
+        //decode
+        data = [[NSData alloc] initWithBase64EncodedString:node.stringValue options:NSDataBase64DecodingIgnoreUnknownCharacters];
+        if(0 == data.length)
+        {
+            //skip
+            continue;
+        }
+        
+        //create cert
+        certificate = SecCertificateCreateWithData(kCFAllocatorDefault, (__bridge CFDataRef)data);
+        if(NULL == certificate)
+        {
+            //skip
+            continue;
+        }
+        
+        //add
+        [certs addObject:CFBridgingRelease(certificate)];
+    }
+
+bail:
+    
+    return certs;
+}
+
+//verify the (RSA) signature over the TOC checksum
+// uses public key of leaf certificate
+-(OSStatus)verifySignature
+{
+    //status
+    OSStatus status = errSecCSSignatureFailed;
+    
+    //signature
+    NSXMLElement* signature = nil;
+    
+    //signature bytes
+    NSData* signatureBytes = nil;
+    
+    //key
+    SecKeyRef key = NULL;
+    
+    //algorithm
+    SecKeyAlgorithm algorithm = NULL;
+    
+    //get signature
+    signature = [self tocElement:@"signature"];
+    if( (nil == signature) ||
+        (0 == self.certificates.count) )
+    {
+        //unsigned
+        status = errSecCSUnsigned;
+        
+        //bail
+        goto bail;
+    }
+    
+    //signature is over the TOC checksum
+    // so pick (digest) algorithm that matches checksum style
+    if(NSOrderedSame == [self.checksumStyle caseInsensitiveCompare:@"sha1"])
+    {
+        algorithm = kSecKeyAlgorithmRSASignatureDigestPKCS1v15SHA1;
+    }
+    else if(NSOrderedSame == [self.checksumStyle caseInsensitiveCompare:@"sha256"])
+    {
+        algorithm = kSecKeyAlgorithmRSASignatureDigestPKCS1v15SHA256;
+    }
+    else if(NSOrderedSame == [self.checksumStyle caseInsensitiveCompare:@"sha512"])
+    {
+        algorithm = kSecKeyAlgorithmRSASignatureDigestPKCS1v15SHA512;
+    }
+    else
+    {
+        //unsupported
+        status = errSecCSUnsupportedDigestAlgorithm;
+        
+        //bail
+        goto bail;
+    }
+    
+    //read signature
+    signatureBytes = [self readHeap:[self valueOf:@"offset" element:signature] length:[self valueOf:@"size" element:signature]];
+    if(0 == signatureBytes.length)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //get leaf's public key
+    if(@available(macOS 10.14, *))
+    {
+        key = SecCertificateCopyKey((__bridge SecCertificateRef)self.certificates.firstObject);
+    }
+    else
+    {
+        SecCertificateCopyPublicKey((__bridge SecCertificateRef)self.certificates.firstObject, &key);
+    }
+    
+    //sanity check
+    if(NULL == key)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //verify
+    if(YES != SecKeyVerifySignature(key, algorithm, (__bridge CFDataRef)self.tocChecksum, (__bridge CFDataRef)signatureBytes, NULL))
+    {
+        //bail
+        goto bail;
+    }
+    
+    //happy
+    status = errSecSuccess;
+
+bail:
+    
+    //release key
+    if(NULL != key)
+    {
+        CFRelease(key);
+        key = NULL;
+    }
+    
+    return status;
+}
+
+//get path of a file (element)
+// built from its name, and names of its parent (directory) elements
+-(NSString*)pathOf:(NSXMLElement*)file
+{
+    //path components
+    NSMutableArray* components = nil;
+    
+    //init
+    components = [NSMutableArray array];
+    
+    //walk up
+    for(NSXMLNode* node = file; [node.name isEqualToString:@"file"]; node = node.parent)
+    {
+        //add
+        [components insertObject:([[(NSXMLElement*)node elementsForName:@"name"] firstObject].stringValue ?: @"?") atIndex:0];
+    }
+    
+    return [components componentsJoinedByString:@"/"];
+}
+
+//init a heap file from its (TOC) 'data' element
+// offsets, encoding, and expected checksums
+-(void)initFile:(XarHeapFile*)file data:(NSXMLElement*)data size:(uint64_t)heapSize
+{
+    //encoding
+    NSString* encoding = nil;
+    
+    //checksum elements
+    NSXMLElement* archivedChecksum = nil;
+    NSXMLElement* extractedChecksum = nil;
+    
+    //archived checksum style
+    NSString* archivedStyle = nil;
+    
+    //extracted checksum style
+    NSString* extractedStyle = nil;
+    
+    //init location/size
+    file->offset = [self valueOf:@"offset" element:data];
+    file->length = [self valueOf:@"length" element:data];
+    file->size = [self valueOf:@"size" element:data];
+    
+    //init encoding
+    encoding = [[[[data elementsForName:@"encoding"] firstObject] attributeForName:@"style"] stringValue] ?: XAR_ENCODING_NONE;
+    if(YES == [encoding isEqualToString:XAR_ENCODING_NONE])
+    {
+        file->encoding = XarEncodingNone;
+    }
+    else if(YES == [encoding isEqualToString:XAR_ENCODING_GZIP])
+    {
+        file->encoding = XarEncodingGzip;
+        file->headerSkip = 2;
+    }
+    else if(YES == [encoding isEqualToString:XAR_ENCODING_XZ])
+    {
+        file->encoding = XarEncodingXZ;
+    }
+    else if(YES == [encoding isEqualToString:XAR_ENCODING_BZIP2])
+    {
+        file->encoding = XarEncodingBzip2;
+    }
+    //e.g. lzma
+    else
+    {
+        file->encoding = XarEncodingUnsupported;
+    }
+    
+    //grab checksums
+    archivedChecksum = [[data elementsForName:@"archived-checksum"] firstObject];
+    extractedChecksum = [[data elementsForName:@"extracted-checksum"] firstObject];
+    
+    //and their styles
+    archivedStyle = [[archivedChecksum attributeForName:@"style"] stringValue];
+    extractedStyle = [[extractedChecksum attributeForName:@"style"] stringValue];
+    
+    //init expected checksums
+    file->archivedChecksumLength = hexToBytes(archivedChecksum.stringValue, file->archivedChecksum, sizeof(file->archivedChecksum));
+    file->extractedChecksumLength = hexToBytes(extractedChecksum.stringValue, file->extractedChecksum, sizeof(file->extractedChecksum));
+    
+    //init digests
+    // unknown algorithms are reported as unsupported
+    digestInit(&file->archived, archivedStyle);
+    
+    //not encoded, w/ same algorithm?
+    // no need to hash twice
+    if( (XarEncodingNone == file->encoding) &&
+        (NSOrderedSame == [archivedStyle caseInsensitiveCompare:extractedStyle]) )
+    {
+        file->sameDigest = YES;
+    }
+    else
+    {
+        digestInit(&file->extracted, extractedStyle);
+    }
+    
+    //default
+    // until something fails
+    file->archivedStatus = errSecSuccess;
+    file->extractedStatus = errSecSuccess;
+    
+    //outside heap?
+    // fail, and don't read it
+    if( (file->offset > heapSize) ||
+        (file->length > heapSize - file->offset) )
+    {
+        //failed
+        file->archivedStatus = errSecCSSignatureFailed;
+        file->extractedStatus = errSecCSSignatureFailed;
+        
+        //don't read
+        file->offset = 0;
+        file->length = 0;
+        file->done = YES;
+    }
+    
+    return;
+}
+
+//get all (TOC) files w/ data
+// sorted by (heap) offset
+-(NSArray*)heapFiles
+{
+    return [[self.toc nodesForXPath:@"/xar/toc//file[data]" error:nil] sortedArrayUsingComparator:^NSComparisonResult(NSXMLElement* first, NSXMLElement* second) {
+        
+        //offsets
+        uint64_t firstOffset = [self valueOf:@"offset" element:[[first elementsForName:@"data"] firstObject]];
+        uint64_t secondOffset = [self valueOf:@"offset" element:[[second elementsForName:@"data"] firstObject]];
+        
+        return (firstOffset < secondOffset) ? NSOrderedAscending : ((firstOffset > secondOffset) ? NSOrderedDescending : NSOrderedSame);
+    }];
+}
+
+//verify (all) files in the heap
+// heap is read once, sequentially, with files checked in parallel
+// returns each file's name, and results of checking its archived & extracted checksums
+-(NSArray*)verifyHeap
+{
+    //results
+    NSMutableArray* results = nil;
+    
+    //'file' elements (w/ data)
+    NSArray* elements = nil;
+    
+    //file info
+    struct stat info = {0};
+    
+    //heap size
+    uint64_t heapSize = 0;
+    
+    //heap files
+    XarHeapFile* files = NULL;
+    
+    //# of heap files
+    NSUInteger count = 0;
+    
+    //per-file queues
+    // serial, so each file's chunks are processed in order
+    NSMutableArray* queues = nil;
+    
+    //payload inspectors
+    // NSNull for files that aren't payloads
+    NSMutableArray* inspectors = nil;
+    
+    //result
+    NSMutableDictionary* result = nil;
+    
+    //ring of buffers
+    XarHeapRing ring = {0};
+    
+    //ring (for workers)
+    XarHeapRing* ringRef = &ring;
+    
+    //slot
+    XarHeapSlot* slot = NULL;
+    
+    //free slots
+    dispatch_semaphore_t freeSlots = NULL;
+    
+    //group for workers
+    dispatch_group_t group = NULL;
+    
+    //current position (in heap)
+    uint64_t position = 0;
+    
+    //end of (last file in) heap
+    uint64_t heapEnd = 0;
+    
+    //first file not yet fully read
+    NSUInteger next = 0;
+    
+    //bytes read
+    uint64_t bytesRead = 0;
+    
+    //error flag
+    BOOL readError = NO;
+    
+    //get file info
+    if( (0 != fstat(fd, &info)) ||
+        ((uint64_t)info.st_size < self.heapOffset) )
+    {
+        //bail
+        goto bail;
+    }
+    
+    //init heap size
+    heapSize = (uint64_t)info.st_size - self.heapOffset;
+    
+    //get all files w/ data
+    // sorted by offset, so heap can be read sequentially
+    elements = [self heapFiles];
+    
+    //init results
+    results = [NSMutableArray array];
+    
+    //none?
+    count = elements.count;
+    if(0 == count)
+    {
+        //done
+        goto bail;
+    }
+    
+    //alloc files
+    files = calloc(count, sizeof(XarHeapFile));
+    if(NULL == files)
+    {
+        //unset
+        results = nil;
+        
+        //bail
+        goto bail;
+    }
+    
+    //init queues
+    queues = [NSMutableArray array];
+    
+    //init inspectors
+    inspectors = [NSMutableArray array];
+    
+    //init each file
+    for(NSUInteger i = 0; i < count; i++)
+    {
+        //init
+        [self initFile:&files[i] data:[[elements[i] elementsForName:@"data"] firstObject] size:heapSize];
+        
+        //end of heap?
+        heapEnd = MAX(heapEnd, files[i].offset + files[i].length);
+        
+        //payload?
+        // inspect its binaries as it's streamed by
+        if( (0 != files[i].length) &&
+            (YES == [[[self pathOf:elements[i]] lastPathComponent] isEqualToString:@"Payload"]) )
+        {
+            //add
+            [inspectors addObject:[[PayloadInspector alloc] init] ?: [NSNull null]];
+        }
+        //not a payload
+        else
+        {
+            //add
+            [inspectors addObject:[NSNull null]];
+        }
+        
+        //save inspector
+        if([NSNull null] != inspectors[i])
+        {
+            files[i].inspector = (__bridge void*)inspectors[i];
+        }
+        
+        //init queue
+        // targets global (concurrent) queue, so files are processed in parallel
+        [queues addObject:dispatch_queue_create_with_target("com.objective-see.wys.xar", DISPATCH_QUEUE_SERIAL, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0))];
+    }
+    
+    //init ring
+    ring.lock = OS_UNFAIR_LOCK_INIT;
+    
+    //alloc ring buffers
+    // all slots start out free
+    for(NSUInteger i = 0; i < HASH_RING_SLOTS; i++)
+    {
+        //alloc
+        ring.slots[i].bytes = malloc(HASH_CHUNK_SIZE);
+        if(NULL == ring.slots[i].bytes)
+        {
+            //unset
+            results = nil;
+            
+            //bail
+            goto bail;
+        }
+        
+        //free
+        ring.available[ring.freeCount++] = &ring.slots[i];
+    }
+    
+    //heap is read sequentially
+    // so ask for aggressive read ahead
+    fcntl(fd, F_RDAHEAD, 1);
+    
+    //init semaphore
+    // all slots start out free
+    freeSlots = dispatch_semaphore_create(HASH_RING_SLOTS);
+    
+    //init group
+    group = dispatch_group_create();
+    
+    //read heap (once)
+    // each chunk is handed off to (the queues of) all files it overlaps
+    while(YES)
+    {
+        //chunk length
+        size_t chunkLength = 0;
+        
+        //skip files that were (fully) read
+        // note: files outside heap, are empty (at offset 0)
+        while( (next < count) &&
+               (files[next].offset + files[next].length <= position) )
+        {
+            next++;
+        }
+        
+        //all done?
+        if(next == count)
+        {
+            break;
+        }
+        
+        //skip gaps
+        // e.g. TOC checksum and signature, at start of heap
+        position = MAX(position, files[next].offset);
+        
+        //at end?
+        if(position >= heapEnd)
+        {
+            break;
+        }
+        
+        //init length
+        chunkLength = (size_t)MIN((uint64_t)HASH_CHUNK_SIZE, heapEnd - position);
+        
+        //wait for a free slot
+        dispatch_semaphore_wait(freeSlots, DISPATCH_TIME_FOREVER);
+        
+        //grab a free slot
+        // not just the next one, as slots are freed out of order
+        slot = ringAcquire(&ring);
+        
+        //read in chunk
+        if(YES != readAt(fd, slot->bytes, chunkLength, self.heapOffset + position))
+        {
+            //set flag
+            readError = YES;
+            
+            //release slot
+            ringRelease(&ring, slot);
+            dispatch_semaphore_signal(freeSlots);
+            
+            //done
+            break;
+        }
+        
+        //update
+        bytesRead += chunkLength;
+        
+        //init slot
+        // reader holds a reference, until it's handed off chunk to all files
+        slot->length = chunkLength;
+        atomic_store(&slot->pending, 1);
+        
+        //hand off to each (overlapping) file
+        for(NSUInteger i = next; (i < count) && (files[i].offset < position + chunkLength); i++)
+        {
+            //file
+            XarHeapFile* file = &files[i];
+            
+            //start of overlap
+            uint64_t start = MAX(file->offset, position);
+            
+            //end of overlap
+            uint64_t end = MIN(file->offset + file->length, position + chunkLength);
+            
+            //no overlap?
+            if(end <= start)
+            {
+                continue;
+            }
+            
+            //add reference
+            atomic_fetch_add(&slot->pending, 1);
+            
+            //process
+            // last one done w/ slot, frees it
+            dispatch_group_async(group, queues[i], ^{
+                processChunk(file, slot->bytes + (start - position), (size_t)(end - start));
+                if(1 == atomic_fetch_sub(&slot->pending, 1))
+                {
+                    ringRelease(ringRef, slot);
+                    dispatch_semaphore_signal(freeSlots);
+                }
+            });
+        }
+        
+        //release (reader's) reference
+        if(1 == atomic_fetch_sub(&slot->pending, 1))
+        {
+            ringRelease(&ring, slot);
+            dispatch_semaphore_signal(freeSlots);
+        }
+        
+        //advance
+        position += chunkLength;
+    }
+    
+    //wait for all workers to finish
+    dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+    
+    //read error?
+    if(YES == readError)
+    {
+        //unset
+        results = nil;
+        
+        //bail
+        goto bail;
+    }
+    
+    //dbg msg
+    os_log_debug(OS_LOG_DEFAULT, "WYS: verified %lu heap file(s), reading %llu of %llu heap bytes", (unsigned long)count, bytesRead, heapSize);
+    
+    //save results
+    for(NSUInteger i = 0; i < count; i++)
+    {
+        //not done?
+        // e.g. empty files
+        if(YES != files[i].done)
+        {
+            //finish
+            finishFile(&files[i]);
+        }
+        
+        //init
+        result = [@{KEY_COMPONENT_NAME:[self pathOf:elements[i]],
+                    KEY_COMPONENT_ARCHIVED:[NSNumber numberWithInt:files[i].archivedStatus],
+                    KEY_COMPONENT_EXTRACTED:[NSNumber numberWithInt:files[i].extractedStatus]} mutableCopy];
+        
+        //payload?
+        // add its binaries
+        if(NULL != files[i].inspector)
+        {
+            result[KEY_COMPONENT_BINARIES] = [(__bridge PayloadInspector*)files[i].inspector finish];
+        }
+        
+        //add
+        [results addObject:result];
+    }
+
+bail:
+    
+    //free ring buffers
+    for(NSUInteger i = 0; i < HASH_RING_SLOTS; i++)
+    {
+        //free
+        if(NULL != ring.slots[i].bytes)
+        {
+            free(ring.slots[i].bytes);
+            ring.slots[i].bytes = NULL;
+        }
+    }
+    
+    //free files
+    if(NULL != files)
+    {
+        //cleanup any (unfinished) streams
+        for(NSUInteger i = 0; i < count; i++)
+        {
+            //stream (and its buffer)
+            endStream(&files[i]);
+        }
+        
+        //free
+        free(files);
+        files = NULL;
+    }
+    
+    return results;
+}
+
+//dealloc
+// close file
+-(void)dealloc
+{
+    //close
+    if(-1 != fd)
+    {
+        close(fd);
+        fd = -1;
+    }
+}
+
+@end
@@ -16,6 +16,10 @@
 //process a XIP
 NSMutableDictionary* checkXIP(NSString* archive);
 
+//check if a (XIP's) cert chain has been revoked
+// consults local revocation store, falling back to 'spctl' if there isn't one
+BOOL isChainRevoked(NSArray* chain, NSString* path);
+
 //check if a file has a cert that has been revoked
 // exec 'spctl --assess <path to file>' and looks for 'CSSMERR_TP_CERT_REVOKED'
 BOOL isRevoked(NSString* path);
@@ -6,11 +6,32 @@
 //  Copyright (c) 2018 Objective-See. All rights reserved.
 //
 
+#import "Xar.h"
 #import "Xips.h"
+#import "Revocations.h"
 #import "Consts.h"
 #import "Utilities.h"
+#import "Trace.h"
+#import "X509.h"
 
-/* apple XIP
+@import Security;
+@import CommonCrypto;
+
+//'Apple Root CA'
+// SHA-256 fingerprint, as Apple's own XIPs (and third-party ones) are anchored by it
+static const uint8_t appleRootCA[CC_SHA256_DIGEST_LENGTH] = {0xB0, 0xB1, 0x73, 0x0E, 0xCB, 0xC7, 0xFF, 0x45, 0x05, 0x14, 0x2C, 0x49, 0xF1, 0x29, 0x5E, 0x6E, 0xDA, 0x6B, 0xCA, 0xED, 0x7E, 0x2C, 0x68, 0xC5, 0xBE, 0x91, 0xB5, 0xA1, 0x10, 0x01, 0xF0, 0x24};
+
+//marker (extension) of 'Developer ID Certification Authority'
+#define MARKER_DEVELOPER_ID_CA @"1.2.840.113635.100.6.2.6"
+
+//markers (extensions) of Apple-issued, but third-party, certificates
+// 'Apple Worldwide Developer Relations' and Developer ID CAs, and Developer ID (application, installer) leaves
+static NSString* const thirdPartyMarkers[] = {@"1.2.840.113635.100.6.2.1", MARKER_DEVELOPER_ID_CA, @"1.2.840.113635.100.6.1.13", @"1.2.840.113635.100.6.1.14"};
+
+/* XIPs are parsed directly (see 'Xar.m')
+   but results match what pkgutil reports, for example:
+ 
+ apple XIP
  
  $ pkgutil --check-signature ~/Downloads/Xcode_8_beta_5.xip
  Package "Xcode_8_beta_5.xip":
@@ -50,165 +71,293 @@
  
  */
 
-//process a XIP
-NSMutableDictionary* checkXIP(NSString* archive)
+//evaluate trust of a XIP's certificates
+// as of when it was signed (if known), as expired certs are fine if they were valid then
+// returns (evaluated) chain, which, unlike the XIP's, includes the anchor
+static NSArray* evaluateTrust(NSArray* certificates, NSDate* signingTime, BOOL* trusted)
 {
-    //info dictionary
-    NSMutableDictionary* signingStatus = nil;
-    
-    //results from 'pkgutil' cmd
-    NSMutableDictionary* results = nil;
+    //chain
+    NSMutableArray* chain = nil;
     
-    //array of parsed results
-    NSArray* parsedResults = nil;
+    //policy
+    SecPolicyRef policy = NULL;
     
-    //result
-    NSString* result = nil;
+    //trust
+    SecTrustRef trust = NULL;
     
-    //line number
-    NSUInteger lineNumber = 0;
+    //trust result
+    SecTrustResultType result = kSecTrustResultInvalid;
     
-    //trusted flag
-    BOOL trusted = NO;
+    //init
+    *trusted = NO;
     
-    //init signing status
-    signingStatus = [NSMutableDictionary dictionary];
+    //default to XIP's chain
+    chain = [certificates mutableCopy];
     
-    //exec 'pkgutil --check-signature' to check XIP signature
-    results = execTask(PKG_UTIL, @[@"--check-signature", archive]);
-    if( (0 != [results[EXIT_CODE] intValue]) ||
-       (0 == [results[STDOUT] length]) )
+    //create policy
+    policy = SecPolicyCreateBasicX509();
+    if(NULL == policy)
     {
         //bail
         goto bail;
     }
     
-    //parse results
-    // ->format: <file path>: <file types>
-    parsedResults = [[[NSString alloc] initWithData:results[STDOUT] encoding:NSUTF8StringEncoding] componentsSeparatedByCharactersInSet:[NSCharacterSet characterSetWithCharactersInString:@"\n"]];
-    
-    //sanity check
-    // ->should be two items in array, <file path> and <file type>
-    if(parsedResults.count < 2)
+    //create trust
+    if(errSecSuccess != SecTrustCreateWithCertificates((__bridge CFArrayRef)certificates, policy, &trust))
     {
         //bail
         goto bail;
     }
     
-    //signing status comes second
-    // ->also trim whitespace
-    result = [parsedResults[1] stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]];
+    //set signing time
+    if(nil != signingTime)
+    {
+        SecTrustSetVerifyDate(trust, (__bridge CFDateRef)signingTime);
+    }
     
-    //parse result
-    // ->first check if from apple
-    if(YES == [result containsString:@"signed Apple Software"])
+    //evaluate
+    if(@available(macOS 10.14, *))
     {
-        //signed
-        signingStatus[KEY_SIGNATURE_STATUS] = STATUS_SUCCESS;
-        
-        //by apple
-        signingStatus[KEY_SIGNING_IS_APPLE] = @YES;
-        
-        //set flag
-        trusted = YES;
+        *trusted = SecTrustEvaluateWithError(trust, NULL);
     }
-    //not apple
-    // ->but signed with trusted cert
-    else if(YES == [result containsString:@"signed by a certificate trusted by Mac OS X"])
+    else
     {
-        //signed
-        signingStatus[KEY_SIGNATURE_STATUS] = STATUS_SUCCESS;
-        
-        //not apple
-        signingStatus[KEY_SIGNING_IS_APPLE] = @NO;
+        *trusted = ( (errSecSuccess == SecTrustEvaluate(trust, &result)) &&
+                     ((kSecTrustResultProceed == result) || (kSecTrustResultUnspecified == result)) );
+    }
+    
+    //grab evaluated chain
+    if(0 != SecTrustGetCertificateCount(trust))
+    {
+        //reset
+        [chain removeAllObjects];
         
-        //trusted
-        trusted = YES;
+        //add each
+        for(CFIndex i = 0; i < SecTrustGetCertificateCount(trust); i++)
+        {
+            //add
+            [chain addObject:(__bridge id)SecTrustGetCertificateAtIndex(trust, i)];
+        }
+    }
+    
+bail:
+    
+    //release trust
+    if(NULL != trust)
+    {
+        CFRelease(trust);
+        trust = NULL;
+    }
+    
+    //release policy
+    if(NULL != policy)
+    {
+        CFRelease(policy);
+        policy = NULL;
     }
-    //not apple
-    // ->but signed with untrusted cert
-    else if(YES == [result containsString:@"signed by untrusted certificate"])
+    
+    return chain;
+}
+
+//check if a certificate has a marker (extension)
+static BOOL hasMarker(id certificate, NSString* marker)
+{
+    //values
+    CFDictionaryRef values = NULL;
+    
+    //flag
+    BOOL found = NO;
+    
+    //get value of marker
+    // only present if certificate has it
+    values = SecCertificateCopyValues((__bridge SecCertificateRef)certificate, (__bridge CFArrayRef)@[marker], NULL);
+    if(NULL != values)
     {
-        //signed
-        signingStatus[KEY_SIGNATURE_STATUS] = STATUS_SUCCESS;
+        //check
+        found = (nil != ((__bridge NSDictionary*)values)[marker]);
         
-        //not apple
-        signingStatus[KEY_SIGNING_IS_APPLE] = @NO;
+        //release
+        CFRelease(values);
     }
     
-    //error
-    // not signed, or something else, just bail
-    else
+    return found;
+}
+
+//check if an (evaluated) chain is anchored by Apple's root
+// by (pinned) fingerprint, not name
+static BOOL isAppleAnchored(NSArray* chain)
+{
+    //fingerprint
+    NSData* fingerprint = nil;
+    
+    //anchor is last
+    fingerprint = x509Info((__bridge SecCertificateRef)chain.lastObject)[KEY_CERT_SHA256];
+    
+    return (YES == [fingerprint isEqualToData:[NSData dataWithBytes:appleRootCA length:sizeof(appleRootCA)]]);
+}
+
+//check if an (evaluated) chain is Apple's own
+// i.e. anchored by Apple's root, w/ no certificate issued to (or for) third parties
+// ('signed Apple Software' in pkgutil parlance)
+static BOOL isAppleChain(NSArray* chain)
+{
+    //not anchored by Apple?
+    if( (chain.count < 2) ||
+        (YES != isAppleAnchored(chain)) )
+    {
+        return NO;
+    }
+    
+    //check (all but anchor)
+    for(NSUInteger i = 0; i < chain.count - 1; i++)
     {
-        //signed
-        signingStatus[KEY_SIGNATURE_STATUS] = [NSNumber numberWithInteger:errSecCSInternalError];
+        //check each marker
+        for(NSUInteger j = 0; j < sizeof(thirdPartyMarkers)/sizeof(thirdPartyMarkers[0]); j++)
+        {
+            //third-party?
+            if(YES == hasMarker(chain[i], thirdPartyMarkers[j]))
+            {
+                return NO;
+            }
+        }
+    }
+    
+    return YES;
+}
+
+//check if an (evaluated) chain is Developer ID
+// i.e. anchored by Apple's root, via 'Developer ID Certification Authority' (by its marker, not name)
+static BOOL isDeveloperIDChain(NSArray* chain)
+{
+    //not anchored by Apple?
+    if( (chain.count < 2) ||
+        (YES != isAppleAnchored(chain)) )
+    {
+        return NO;
+    }
+    
+    //check intermediates
+    for(NSUInteger i = 1; i < chain.count - 1; i++)
+    {
+        //Developer ID CA?
+        if(YES == hasMarker(chain[i], MARKER_DEVELOPER_ID_CA))
+        {
+            return YES;
+        }
+    }
+    
+    return NO;
+}
+
+//process a XIP
+// parses the XAR directly, mapping results to what 'pkgutil --check-signature' would report
+NSMutableDictionary* checkXIP(NSString* archive)
+{
+    //info dictionary
+    NSMutableDictionary* signingStatus = nil;
+    
+    //archive
+    XarArchive* xar = nil;
+    
+    //status
+    OSStatus status = -1;
+    
+    //(evaluated) cert chain
+    NSArray* chain = nil;
+    
+    //common name
+    NSString* commonName = nil;
+    
+    //trusted flag
+    BOOL trusted = NO;
+    
+    //span
+    TraceSpan span = traceBegin("checkXIP");
+    
+    //init signing status
+    signingStatus = [NSMutableDictionary dictionary];
+    
+    //default
+    // covers error cases, and 'no signature'
+    signingStatus[KEY_SIGNATURE_STATUS] = [NSNumber numberWithInteger:errSecCSInternalError];
+    
+    //parse XAR
+    // only header and TOC are read
+    xar = [[XarArchive alloc] init:archive];
+    if(nil == xar)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //unsigned?
+    if(0 == xar.certificates.count)
+    {
+        //bail
+        goto bail;
+    }
+    
+    //verify TOC checksum
+    // TOC in turn has checksums for all files in the heap
+    if(YES != [xar verifyChecksum])
+    {
+        //set
+        signingStatus[KEY_SIGNATURE_STATUS] = [NSNumber numberWithInteger:errSecCSSignatureFailed];
         
         //bail
         goto bail;
     }
     
-    //one more sanity check
-    // ->should be at least 3 lines for cert chain
-    if(parsedResults.count < 3)
+    //verify signature
+    // this is over the TOC checksum
+    status = [xar verifySignature];
+    if(errSecSuccess != status)
     {
+        //set
+        signingStatus[KEY_SIGNATURE_STATUS] = [NSNumber numberWithInteger:status];
+        
         //bail
         goto bail;
     }
     
+    //evaluate trust
+    // as of when it was signed
+    chain = evaluateTrust(xar.certificates, xar.signingTime, &trusted);
+    
+    //signed
+    signingStatus[KEY_SIGNATURE_STATUS] = [NSNumber numberWithInteger:errSecSuccess];
+    
     //init array for certificate names
     signingStatus[KEY_SIGNING_AUTHORITIES] = [NSMutableArray array];
     
-    //extract cert chain
-    // format: <digit>. auth
-    // for example: 1. Software Update
-    for(__strong NSString* line in parsedResults)
+    //extract cert chain names
+    for(id certificate in chain)
     {
-        //skip first three lines
-        if(lineNumber < 3)
-        {
-            //inc
-            lineNumber++;
-            
-            //next
-            continue;
-        }
-        
-        //trim line
-        line = [line stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]];
-        
-        //skip blank/too short lines
-        if( (nil == line) ||
-           (line.length < 4) )
-        {
-            //skip
-            continue;
-        }
-        
-        //start with <digit>.
-        if( (YES == [[NSCharacterSet decimalDigitCharacterSet] characterIsMember:[line characterAtIndex:0]]) &&
-           ('.' == [line characterAtIndex:1]) )
+        //get common name
+        commonName = x509CommonName((__bridge SecCertificateRef)certificate);
+        if(nil != commonName)
         {
             //add
-            [signingStatus[KEY_SIGNING_AUTHORITIES] addObject:[line substringFromIndex:3]];
+            [signingStatus[KEY_SIGNING_AUTHORITIES] addObject:commonName];
         }
     }
     
+    //signed by apple?
+    // trusted, and Apple's own chain (not just one anchored by Apple's root)
+    signingStatus[KEY_SIGNING_IS_APPLE] = [NSNumber numberWithBool:( (YES == trusted) && (YES == isAppleChain(chain)) )];
+    
     //check for developer ID?
-    // ->XIP has to be trusted and have certain strings
-    if(YES == trusted)
+    // ->XIP has to be trusted, and chain via Developer ID CA
+    if( (YES == trusted) &&
+        (YES == isDeveloperIDChain(chain)) )
     {
-        //check signing auths
-        if( (YES == [signingStatus[KEY_SIGNING_AUTHORITIES] containsObject:@"Apple Root CA"]) &&
-           (YES == [signingStatus[KEY_SIGNING_AUTHORITIES] containsObject:@"Developer ID Certification Authority"]) )
-        {
-            //set
-            signingStatus[KEY_SIGNING_IS_APPLE_DEV_ID] = @YES;
-        }
+        //set
+        signingStatus[KEY_SIGNING_IS_APPLE_DEV_ID] = @YES;
     }
     
     //finally check if its revoked
     // other APIs might not detect/catch this
-    if(YES == isRevoked(archive))
+    if(YES == isChainRevoked((0 != chain.count) ? chain : xar.certificates, archive))
     {
         //update status
         signingStatus[KEY_SIGNATURE_STATUS] = [NSNumber numberWithInteger:CSSMERR_TP_CERT_REVOKED];
@@ -219,9 +368,26 @@ NSMutableDictionary* checkXIP(NSString* archive)
     
 bail:
     
+    //end span
+    traceEnd(&span, traceFileSize(archive));
+    
     return signingStatus;
 }
 
+//check if a (XIP's) cert chain has been revoked
+// consults local revocation store, falling back to 'spctl' if there isn't one
+BOOL isChainRevoked(NSArray* chain, NSString* path)
+{
+    //no local store?
+    // fall back to exec'ing 'spctl'
+    if(YES != revocationStoreAvailable())
+    {
+        return isRevoked(path);
+    }
+    
+    return isCertificateChainRevoked(chain);
+}
+
 //check if a file has a cert that has been revoked
 // exec 'spctl --assess <path to file>' and looks for 'CSSMERR_TP_CERT_REVOKED'
 BOOL isRevoked(NSString* path)
@@ -232,8 +398,14 @@ BOOL isRevoked(NSString* path)
     //results
     NSMutableDictionary* results = nil;
     
+    //span
+    TraceSpan span = traceBegin("task.spctl");
+    
     //exec 'spctl --assess <path to file>'
-    results = execTask(SPCTL, @[@"--assess", path]);
+    results = execTaskWithTimeout(SPCTL, @[@"--assess", path], TASK_TIMEOUT);
+    
+    //end span
+    traceEnd(&span, [results[STDOUT] length] + [results[STDERR] length]);
     if(YES == [[[NSString alloc] initWithData:results[STDERR] encoding:NSUTF8StringEncoding] containsString:@"CSSMERR_TP_CERT_REVOKED"])
     {
         //revoked
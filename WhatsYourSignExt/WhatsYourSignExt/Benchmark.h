@@ -0,0 +1,48 @@
+//
+//  Benchmark.h
+//  WhatsYourSign
+//
+//  Created by Patrick Wardle on 10/17/26.
+//  Copyright (c) 2026 Objective-See. All rights reserved.
+//
+//  note: fixtures (mach-o's, xar/xip archives, receipts, bundles) are generated from a fixed seed
+//        so runs (of the same scale) are comparable across commits
+
+#ifndef Benchmark_h
+#define Benchmark_h
+
+@import Foundation;
+
+//cmdline flag to benchmark
+// e.g. 'WhatsYourSign -benchmark [iterations] [scale]'
+#define BENCHMARK_FLAG "-benchmark"
+
+//default # of (timed) iterations
+#define BENCHMARK_ITERATIONS 50
+
+//default scale of fixtures
+// roughly, MBs of hashed data, and (x64) # of bundle resources, entitlements, receipt attributes
+#define BENCHMARK_SCALE 16
+
+//# of (untimed) warmup iterations
+#define BENCHMARK_WARMUP 1
+
+//seed for fixtures
+#define BENCHMARK_SEED 0x5753595342454e43
+
+//fixtures
+// names, in (temporary) fixture directory
+#define BENCHMARK_FIXTURE_BLOB @"blob.bin"
+#define BENCHMARK_FIXTURE_THIN @"thin"
+#define BENCHMARK_FIXTURE_FAT @"fat"
+#define BENCHMARK_FIXTURE_PACKAGE @"Benchmark.pkg"
+#define BENCHMARK_FIXTURE_XIP @"Benchmark.xip"
+#define BENCHMARK_FIXTURE_BUNDLE @"Benchmark.app"
+
+/* FUNCTIONS */
+
+//benchmark
+// generates fixtures, then prints (to stdout) each benchmark's results as a JSON line
+int benchmark(NSUInteger iterations, NSUInteger scale);
+
+#endif /* Benchmark_h */
@@ -0,0 +1,431 @@
+//
+//  Benchmark.m
+//  WhatsYourSign
+//
+//  Created by Patrick Wardle on 10/17/26.
+//  Copyright (c) 2026 Objective-See. All rights reserved.
+//
+
+#import "Item.h"
+#import "Xips.h"
+#import "consts.h"
+#import "Signing.h"
+#import "Packages.h"
+#import "HashCache.h"
+#import "Fixtures.h"
+#import "Benchmark.h"
+#import "Trace.h"
+#import "utilities.h"
+#import "AppReceipt.h"
+#import "Entitlements.h"
+#import "VerdictCache.h"
+#import "CodeSignature.h"
+
+#import <time.h>
+#import <sys/stat.h>
+#import <mach/mach.h>
+
+//generate fixtures
+// all from a fixed seed, so they're identical across runs (of the same scale)
+static BOOL generateFixtures(NSString* directory, NSUInteger scale)
+{
+    //flag
+    BOOL generated = NO;
+    
+    //(pseudo-random) state
+    uint64_t state = BENCHMARK_SEED;
+    
+    //entitlements
+    NSDictionary* entitlements = nil;
+    
+    //data
+    NSMutableData* data = nil;
+    
+    //thin binary
+    NSData* thin = nil;
+    
+    //slices (of universal binary)
+    NSMutableArray* slices = nil;
+    
+    //payload
+    NSMutableData* payload = nil;
+    
+    //archive
+    NSData* archive = nil;
+    
+    //create directory
+    if(YES != [NSFileManager.defaultManager createDirectoryAtPath:directory withIntermediateDirectories:YES attributes:nil error:NULL])
+    {
+        //bail
+        goto bail;
+    }
+    
+    //init entitlements
+    entitlements = fixtureEntitlements(scale * 64);
+    
+    //blob
+    // 'scale' MBs of (random) data, to hash
+    data = [NSMutableData dataWithLength:scale * 1024 * 1024];
+    fixtureFillRandom(data.mutableBytes, data.length, &state);
+    if(YES != [data writeToFile:[directory stringByAppendingPathComponent:BENCHMARK_FIXTURE_BLOB] atomically:NO])
+    {
+        //bail
+        goto bail;
+    }
+    
+    //thin binary
+    // 'scale' MBs of code
+    thin = fixtureThin(CPU_TYPE_ARM64, CPU_SUBTYPE_ARM64_ALL, scale * 1024 * 1024, entitlements, &state);
+    if(YES != [thin writeToFile:[directory stringByAppendingPathComponent:BENCHMARK_FIXTURE_THIN] atomically:NO])
+    {
+        //bail
+        goto bail;
+    }
+    
+    //universal binary
+    // x86_64 and arm64 slices, each a (signed-looking) thin mach-o
+    slices = [NSMutableArray array];
+    [slices addObject:fixtureThin(CPU_TYPE_X86_64, CPU_SUBTYPE_X86_64_ALL, scale * 16 * FIXTURE_PAGE_SIZE, entitlements, &state)];
+    [slices addObject:fixtureThin(CPU_TYPE_ARM64, CPU_SUBTYPE_ARM64_ALL, scale * 16 * FIXTURE_PAGE_SIZE, entitlements, &state)];
+    if(YES != [fixtureFat(slices, NO) writeToFile:[directory stringByAppendingPathComponent:BENCHMARK_FIXTURE_FAT] atomically:NO])
+    {
+        //bail
+        goto bail;
+    }
+    
+    //package
+    // (cpio) payload w/ a binary, plus bom and package info
+    payload = [NSMutableData data];
+    fixtureAppendCpioMember(payload, @"./Benchmark.app/Contents/MacOS/Benchmark", 0100755, thin);
+    fixtureAppendCpioMember(payload, @"TRAILER!!!", 0, [NSData data]);
+    data = [NSMutableData dataWithLength:4096];
+    fixtureFillRandom(data.mutableBytes, data.length, &state);
+    archive = fixtureXar(@[@"Bom", @"PackageInfo", @"Payload"], @[data, [[NSString stringWithFormat:@"<pkg-info identifier=\"%@\" version=\"1.0\"/>", FIXTURE_IDENTIFIER] dataUsingEncoding:NSUTF8StringEncoding], payload]);
+    if( (nil == archive) ||
+        (YES != [archive writeToFile:[directory stringByAppendingPathComponent:BENCHMARK_FIXTURE_PACKAGE] atomically:NO]) )
+    {
+        //bail
+        goto bail;
+    }
+    
+    //xip
+    // content, plus metadata
+    data = [NSMutableData dataWithLength:scale * 64 * 1024];
+    fixtureFillRandom(data.mutableBytes, data.length, &state);
+    archive = fixtureXar(@[@"Content", @"Metadata"], @[data, [NSPropertyListSerialization dataWithPropertyList:@{@"Version":@1} format:NSPropertyListXMLFormat_v1_0 options:0 error:NULL]]);
+    if( (nil == archive) ||
+        (YES != [archive writeToFile:[directory stringByAppendingPathComponent:BENCHMARK_FIXTURE_XIP] atomically:NO]) )
+    {
+        //bail
+        goto bail;
+    }
+    
+    //bundle
+    // executable is smaller, as its resources are what's being scaled
+    if(YES != fixtureBundle([directory stringByAppendingPathComponent:BENCHMARK_FIXTURE_BUNDLE], fixtureThin(CPU_TYPE_ARM64, CPU_SUBTYPE_ARM64_ALL, scale * 16 * FIXTURE_PAGE_SIZE, entitlements, &state), scale * 64, &state))
+    {
+        //bail
+        goto bail;
+    }
+    
+    //happy
+    generated = YES;
+
+bail:
+    
+    return generated;
+}
+
+//compare latencies
+// for qsort
+static int compareLatencies(const void* first, const void* second)
+{
+    //compare
+    return (*(const uint64_t*)first > *(const uint64_t*)second) - (*(const uint64_t*)first < *(const uint64_t*)second);
+}
+
+//get (nearest-rank) percentile
+// latencies must be sorted
+static uint64_t percentile(const uint64_t* latencies, NSUInteger count, double rank)
+{
+    //index
+    NSUInteger index = (NSUInteger)ceil(rank * count);
+    
+    //clamp
+    index = MIN(MAX(index, 1), count) - 1;
+    
+    return latencies[index];
+}
+
+//get (current) physical footprint
+// unlike max RSS, this isn't a high-water mark for the process's lifetime, so can be diffed per benchmark
+static int64_t physFootprint(void)
+{
+    //info
+    task_vm_info_data_t info = {0};
+    
+    //count
+    mach_msg_type_number_t count = TASK_VM_INFO_COUNT;
+    
+    //get info
+    if(KERN_SUCCESS != task_info(mach_task_self(), TASK_VM_INFO, (task_info_t)&info, &count))
+    {
+        return 0;
+    }
+    
+    return (int64_t)info.phys_footprint;
+}
+
+//time an operation
+// runs it (after warmup) 'iterations' times, then reports latency percentiles, throughput, and footprint growth
+static NSDictionary* measure(NSString* name, NSUInteger iterations, uint64_t bytes, void (^operation)(NSUInteger iteration))
+{
+    //results
+    NSDictionary* results = nil;
+    
+    //latencies
+    uint64_t* latencies = NULL;
+    
+    //total (of timed iterations)
+    uint64_t total = 0;
+    
+    //start
+    uint64_t start = 0;
+    
+    //elapsed
+    double elapsed = 0;
+    
+    //footprint (before)
+    int64_t footprint = 0;
+    
+    //peak footprint
+    // sampled after each iteration
+    int64_t peakFootprint = 0;
+    
+    //alloc
+    latencies = calloc(iterations, sizeof(uint64_t));
+    if(NULL == latencies)
+    {
+        return nil;
+    }
+    
+    //init footprint
+    footprint = physFootprint();
+    peakFootprint = footprint;
+    
+    //run
+    for(NSUInteger i = 0; i < BENCHMARK_WARMUP + iterations; i++)
+    {
+        @autoreleasepool
+        {
+            //start
+            start = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+            
+            //run
+            operation(i);
+            
+            //timed?
+            // i.e. not a warmup
+            if(i >= BENCHMARK_WARMUP)
+            {
+                //save
+                latencies[i - BENCHMARK_WARMUP] = clock_gettime_nsec_np(CLOCK_UPTIME_RAW) - start;
+                total += latencies[i - BENCHMARK_WARMUP];
+            }
+        }
+        
+        //sample footprint
+        // outside of timing
+        peakFootprint = MAX(peakFootprint, physFootprint());
+    }
+    
+    //sort
+    qsort(latencies, iterations, sizeof(uint64_t), compareLatencies);
+    
+    //elapsed (seconds)
+    elapsed = MAX(total, 1) / (double)NSEC_PER_SEC;
+    
+    //init results
+    results = @{@"benchmark":name,
+                @"iterations":[NSNumber numberWithUnsignedInteger:iterations],
+                @"p50Ms":[NSNumber numberWithDouble:percentile(latencies, iterations, 0.50) / (double)NSEC_PER_MSEC],
+                @"p99Ms":[NSNumber numberWithDouble:percentile(latencies, iterations, 0.99) / (double)NSEC_PER_MSEC],
+                @"meanMs":[NSNumber numberWithDouble:(total / (double)iterations) / (double)NSEC_PER_MSEC],
+                @"opsPerSec":[NSNumber numberWithDouble:iterations / elapsed],
+                @"bytesPerSec":[NSNumber numberWithDouble:(bytes * iterations) / elapsed],
+                @"footprintDelta":[NSNumber numberWithLongLong:physFootprint() - footprint],
+                @"peakFootprintDelta":[NSNumber numberWithLongLong:peakFootprint - footprint]};
+    
+    //free
+    free(latencies);
+    
+    return results;
+}
+
+//write a JSON line
+// to stdout
+static void emit(NSDictionary* record)
+{
+    //JSON
+    NSData* json = nil;
+    
+    //serialize
+    json = [NSJSONSerialization dataWithJSONObject:record options:NSJSONWritingSortedKeys error:NULL];
+    if(nil == json)
+    {
+        return;
+    }
+    
+    //write
+    fwrite(json.bytes, 1, json.length, stdout);
+    fputc('\n', stdout);
+    fflush(stdout);
+    
+    return;
+}
+
+//get size of a file
+static uint64_t fileSize(NSString* path)
+{
+    //file info
+    struct stat info = {0};
+    
+    return (0 == stat(path.fileSystemRepresentation, &info)) ? (uint64_t)info.st_size : 0;
+}
+
+//run benchmarks
+// each over its fixture
+static void runBenchmarks(NSString* directory, NSUInteger iterations, NSUInteger scale)
+{
+    //(pseudo-random) state
+    // for in-memory fixtures
+    uint64_t state = BENCHMARK_SEED;
+    
+    //paths
+    NSString* blob = [directory stringByAppendingPathComponent:BENCHMARK_FIXTURE_BLOB];
+    NSString* thin = [directory stringByAppendingPathComponent:BENCHMARK_FIXTURE_THIN];
+    NSString* fat = [directory stringByAppendingPathComponent:BENCHMARK_FIXTURE_FAT];
+    NSString* package = [directory stringByAppendingPathComponent:BENCHMARK_FIXTURE_PACKAGE];
+    NSString* xip = [directory stringByAppendingPathComponent:BENCHMARK_FIXTURE_XIP];
+    NSString* bundle = [directory stringByAppendingPathComponent:BENCHMARK_FIXTURE_BUNDLE];
+    
+    //receipt payload
+    NSData* receipt = fixtureReceipt(scale * 64, &state);
+    
+    //hashing
+    emit(measure(@"hashFile", iterations, fileSize(blob), ^(NSUInteger iteration) {
+        hashFile(blob);
+    }));
+    
+    //finding best slice
+    emit(measure(@"bestArchOffset", iterations, 0, ^(NSUInteger iteration) {
+        bestArchOffset(fat);
+    }));
+    
+    //verifying (code) page hashes
+    emit(measure(@"pageHashes", iterations, fileSize(thin), ^(NSUInteger iteration) {
+        uint64_t badOffset = 0;
+        codeSignatureFirstBadPage(thin, &badOffset);
+    }));
+    
+    //decoding entitlements
+    emit(measure(@"entitlements", iterations, 0, ^(NSUInteger iteration) {
+        entitlementsForPath(thin);
+    }));
+    
+    //checking xip
+    emit(measure(@"checkXIP", iterations, fileSize(xip), ^(NSUInteger iteration) {
+        checkXIP(xip);
+    }));
+    
+    //checking package
+    emit(measure(@"checkPackage", iterations, fileSize(package), ^(NSUInteger iteration) {
+        checkPackage(package);
+    }));
+    
+    //parsing receipt
+    // payload is parsed directly, as (synthetic) receipts aren't signed by Apple
+    emit(measure(@"receipt", iterations, receipt.length, ^(NSUInteger iteration) {
+        AppReceipt* appReceipt = [[AppReceipt alloc] init];
+        appReceipt.decodedData = receipt;
+        [appReceipt parse];
+    }));
+    
+    //item, end to end
+    // (verdict, hash) caches are cleared each time, so none are hit
+    emit(measure(@"item", iterations, 0, ^(NSUInteger iteration) {
+        verdictCacheClear();
+        hashCacheClear();
+        Item* item = [[Item alloc] init:bundle verify:NO];
+        [item verify];
+    }));
+    
+    //write trace
+    // (if enabled) now, as process is about to exit
+    traceFlush();
+    
+    return;
+}
+
+//benchmark
+// generates fixtures, then prints (to stdout) each benchmark's results as a JSON line
+int benchmark(NSUInteger iterations, NSUInteger scale)
+{
+    //result
+    int result = -1;
+    
+    //fixture directory
+    NSString* directory = nil;
+    
+    //sanity check
+    if( (0 == iterations) ||
+        (0 == scale) )
+    {
+        //err msg
+        fprintf(stderr, "ERROR: iterations and scale must be non-zero\n");
+        
+        //bail
+        goto bail;
+    }
+    
+    //init fixture directory
+    directory = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSString stringWithFormat:@"WYS-benchmark-%d", getpid()]];
+    
+    //generate fixtures
+    if(YES != generateFixtures(directory, scale))
+    {
+        //err msg
+        fprintf(stderr, "ERROR: failed to generate fixtures in %s\n", directory.UTF8String);
+        
+        //bail
+        goto bail;
+    }
+    
+    //use fixture directory for (verdict, hash) caches
+    // so user's (app group) caches aren't touched
+    setCachesDirectory([NSURL fileURLWithPath:directory]);
+    
+    //emit configuration
+    // so runs can be matched up
+    emit(@{@"version":getAppVersion() ?: @"",
+           @"iterations":[NSNumber numberWithUnsignedInteger:iterations],
+           @"warmup":[NSNumber numberWithUnsignedInteger:BENCHMARK_WARMUP],
+           @"scale":[NSNumber numberWithUnsignedInteger:scale],
+           @"seed":[NSNumber numberWithUnsignedLongLong:BENCHMARK_SEED]});
+    
+    //run
+    runBenchmarks(directory, iterations, scale);
+    
+    //happy
+    result = 0;
+
+bail:
+    
+    //remove fixtures
+    if(nil != directory)
+    {
+        [NSFileManager.defaultManager removeItemAtPath:directory error:NULL];
+    }
+    
+    return result;
+}
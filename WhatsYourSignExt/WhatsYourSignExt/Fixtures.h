@@ -0,0 +1,97 @@
+//
+//  Fixtures.h
+//  WhatsYourSign
+//
+//  Created by Patrick Wardle on 10/17/26.
+//  Copyright (c) 2026 Objective-See. All rights reserved.
+//
+//  note: synthetic inputs for the parsers (mach-o's, code signatures, xar/pbzx/cpio, receipts, bundles, UDIF images)
+//        shared by the benchmark and the self test, and built from a caller's (pseudo-random) state, so they're reproducible
+
+#ifndef Fixtures_h
+#define Fixtures_h
+
+@import Foundation;
+
+#import <mach/machine.h>
+
+//size of (fixture) code pages
+#define FIXTURE_PAGE_SIZE 4096
+
+//size of each (fixture) bundle resource
+#define FIXTURE_RESOURCE_SIZE 4096
+
+//# of directories (fixture) bundle resources are spread over
+#define FIXTURE_RESOURCE_DIRECTORIES 8
+
+//alignment of slices in (fixture) universal binary
+// as a power of 2
+#define FIXTURE_FAT_ALIGN 14
+
+//size of (fixture) pbzx chunks
+// uncompressed
+#define FIXTURE_PBZX_CHUNK_SIZE (64*1024)
+
+//# of sectors in each (fixture) UDIF chunk
+#define FIXTURE_UDIF_CHUNK_SECTORS 8
+
+//identifier of fixtures
+#define FIXTURE_IDENTIFIER @"com.objective-see.fixture"
+
+/* FUNCTIONS */
+
+//next (pseudo-random) value
+// xorshift, so fixtures are the same for every run
+uint64_t fixtureRandom(uint64_t* state);
+
+//fill buffer w/ (pseudo-random) bytes
+void fixtureFillRandom(uint8_t* bytes, size_t length, uint64_t* state);
+
+//append a DER item
+// tag, (definite) length, then contents
+void fixtureAppendDER(NSMutableData* output, uint8_t tag, const void* bytes, size_t length);
+
+//append a DER integer
+// (minimal) two's complement, big-endian
+void fixtureAppendDERInteger(NSMutableData* output, int64_t value);
+
+//append a DER (UTF-8) string
+void fixtureAppendDERString(NSMutableData* output, NSString* string);
+
+//build (fixture) entitlements
+// a few real ones, plus 'count' strings
+NSDictionary* fixtureEntitlements(NSUInteger count);
+
+//build (fixture) thin mach-o
+// header, (random) code, then a signed-looking code signature w/ valid page and entitlement hashes
+NSData* fixtureThin(cpu_type_t cpuType, cpu_subtype_t cpuSubType, size_t codeSize, NSDictionary* entitlements, uint64_t* state);
+
+//build (fixture) universal binary
+// from (thin) slices, w/ 32 or 64-bit fat header
+NSData* fixtureFat(NSArray* slices, BOOL fat64);
+
+//append a (cpio) member
+// odc format: octal (ASCII) header, name (incl. NUL), then contents
+void fixtureAppendCpioMember(NSMutableData* archive, NSString* name, uint32_t mode, NSData* contents);
+
+//build (fixture) xar archive
+// (uncompressed) files, w/ sha1 checksums of TOC, and of each file
+NSData* fixtureXar(NSArray* names, NSArray* contents);
+
+//build (fixture) pbzx stream
+// chunks are xz compressed, or (if 'compress' is NO, or it doesn't help) stored plain
+NSData* fixturePbzx(NSData* contents, BOOL compress);
+
+//build (fixture) receipt payload
+// set of attributes: the ones WYS parses, plus 'count' others
+NSData* fixtureReceipt(NSUInteger count, uint64_t* state);
+
+//build (fixture) bundle
+// executable, Info.plist, resources, and a CodeResources that seals them
+BOOL fixtureBundle(NSString* bundlePath, NSData* executable, NSUInteger resourceCount, uint64_t* state);
+
+//build (fixture) UDIF image
+// one partition, w/ contents (padded to a sector) as zlib, raw, and zero chunks, and valid CRC32s
+NSData* fixtureUdif(NSData* contents);
+
+#endif /* Fixtures_h */
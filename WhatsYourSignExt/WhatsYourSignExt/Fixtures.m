@@ -0,0 +1,1078 @@
+//
+//  Fixtures.m
+//  WhatsYourSign
+//
+//  Created by Patrick Wardle on 10/17/26.
+//  Copyright (c) 2026 Objective-See. All rights reserved.
+//
+
+#import "Der.h"
+#import "Xar.h"
+#import "Udif.h"
+#import "Payload.h"
+#import "Fixtures.h"
+#import "utilities.h"
+#import "AppReceipt.h"
+#import "Entitlements.h"
+#import "CodeSignature.h"
+
+#import <sys/stat.h>
+#import <mach-o/fat.h>
+#import <compression.h>
+#import <mach-o/loader.h>
+#import <CommonCrypto/CommonDigest.h>
+
+@import Security;
+
+//fwd decl
+static void appendDERValue(NSMutableData* output, id value);
+
+//next (pseudo-random) value
+// xorshift, so fixtures are the same for every run
+uint64_t fixtureRandom(uint64_t* state)
+{
+    //shift
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    
+    return *state;
+}
+
+//fill buffer w/ (pseudo-random) bytes
+void fixtureFillRandom(uint8_t* bytes, size_t length, uint64_t* state)
+{
+    //value
+    uint64_t value = 0;
+    
+    //fill
+    for(size_t i = 0; i < length; i++)
+    {
+        //refill
+        if(0 == (i % sizeof(uint64_t)))
+        {
+            value = fixtureRandom(state);
+        }
+        
+        //save
+        bytes[i] = (uint8_t)(value >> ((i % sizeof(uint64_t)) * 8));
+    }
+    
+    return;
+}
+
+//adler-32
+// trailer of zlib streams
+static uint32_t adler32(const uint8_t* bytes, size_t length)
+{
+    //sums
+    uint32_t a = 1, b = 0;
+    
+    //sum
+    for(size_t i = 0; i < length; i++)
+    {
+        a = (a + bytes[i]) % 65521;
+        b = (b + a) % 65521;
+    }
+    
+    return (b << 16) | a;
+}
+
+//append a DER item
+// tag, (definite) length, then contents
+void fixtureAppendDER(NSMutableData* output, uint8_t tag, const void* bytes, size_t length)
+{
+    //header
+    uint8_t header[6] = {0};
+    
+    //size of header
+    size_t headerSize = 0;
+    
+    //# of length bytes
+    uint8_t count = 0;
+    
+    //tag
+    header[headerSize++] = tag;
+    
+    //short form?
+    if(length < 0x80)
+    {
+        header[headerSize++] = (uint8_t)length;
+    }
+    //long form
+    // # of length bytes, then length (big-endian)
+    else
+    {
+        //# of length bytes
+        count = (length > 0xFFFFFF) ? 4 : (length > 0xFFFF) ? 3 : (length > 0xFF) ? 2 : 1;
+        
+        //save
+        header[headerSize++] = 0x80 | count;
+        for(uint8_t i = count; i > 0; i--)
+        {
+            header[headerSize++] = (uint8_t)(length >> ((i - 1) * 8));
+        }
+    }
+    
+    //append
+    [output appendBytes:header length:headerSize];
+    [output appendBytes:bytes length:length];
+    
+    return;
+}
+
+//append a DER integer
+// (minimal) two's complement, big-endian
+void fixtureAppendDERInteger(NSMutableData* output, int64_t value)
+{
+    //bytes
+    uint8_t bytes[sizeof(int64_t)] = {0};
+    
+    //first (significant) byte
+    size_t first = 0;
+    
+    //encode
+    OSWriteBigInt64(bytes, 0, (uint64_t)value);
+    
+    //skip redundant leading bytes
+    // i.e. those that are just sign extension
+    while( (first < sizeof(bytes) - 1) &&
+           ( ((0x00 == bytes[first]) && (0 == (bytes[first + 1] & 0x80))) ||
+             ((0xFF == bytes[first]) && (0 != (bytes[first + 1] & 0x80))) ) )
+    {
+        first++;
+    }
+    
+    //append
+    fixtureAppendDER(output, DER_TAG_INTEGER, bytes + first, sizeof(bytes) - first);
+    
+    return;
+}
+
+//append a DER (UTF-8) string
+void fixtureAppendDERString(NSMutableData* output, NSString* string)
+{
+    //append
+    fixtureAppendDER(output, DER_TAG_UTF8_STRING, string.UTF8String, strlen(string.UTF8String));
+    
+    return;
+}
+
+//append a (DER) entitlements dictionary
+// '[CONTEXT 16]', w/ (sorted) key/value sequences
+static void appendDERDictionary(NSMutableData* output, NSDictionary* dictionary)
+{
+    //contents
+    NSMutableData* contents = nil;
+    
+    //init
+    contents = [NSMutableData data];
+    
+    //add each
+    for(NSString* key in [dictionary.allKeys sortedArrayUsingSelector:@selector(compare:)])
+    {
+        //pair
+        NSMutableData* pair = [NSMutableData data];
+        
+        //key, value
+        fixtureAppendDERString(pair, key);
+        appendDERValue(pair, dictionary[key]);
+        
+        //append
+        fixtureAppendDER(contents, DER_TAG_SEQUENCE, pair.bytes, pair.length);
+    }
+    
+    //append
+    fixtureAppendDER(output, ENTITLEMENTS_DER_TAG_DICTIONARY, contents.bytes, contents.length);
+    
+    return;
+}
+
+//append a (DER) entitlement's value
+// boolean, integer, string, array (sequence), or dictionary
+static void appendDERValue(NSMutableData* output, id value)
+{
+    //contents
+    NSMutableData* contents = nil;
+    
+    //boolean
+    uint8_t boolean = 0;
+    
+    //boolean?
+    if(CFGetTypeID((__bridge CFTypeRef)value) == CFBooleanGetTypeID())
+    {
+        //init
+        boolean = (YES == [value boolValue]) ? 0xFF : 0x00;
+        
+        //append
+        fixtureAppendDER(output, DER_TAG_BOOLEAN, &boolean, sizeof(boolean));
+    }
+    //integer?
+    else if(YES == [value isKindOfClass:[NSNumber class]])
+    {
+        //append
+        fixtureAppendDERInteger(output, [value longLongValue]);
+    }
+    //string?
+    else if(YES == [value isKindOfClass:[NSString class]])
+    {
+        //append
+        fixtureAppendDERString(output, value);
+    }
+    //array?
+    else if(YES == [value isKindOfClass:[NSArray class]])
+    {
+        //init
+        contents = [NSMutableData data];
+        
+        //add each
+        for(id element in value)
+        {
+            appendDERValue(contents, element);
+        }
+        
+        //append
+        fixtureAppendDER(output, DER_TAG_SEQUENCE, contents.bytes, contents.length);
+    }
+    //dictionary?
+    else if(YES == [value isKindOfClass:[NSDictionary class]])
+    {
+        //append
+        appendDERDictionary(output, value);
+    }
+    
+    return;
+}
+
+//build a (code signature) blob
+// magic, length (incl. header), then contents, all big-endian
+static NSData* buildBlob(uint32_t magic, NSData* contents)
+{
+    //blob
+    NSMutableData* blob = nil;
+    
+    //init
+    blob = [NSMutableData dataWithLength:ENTITLEMENTS_HEADER_SIZE];
+    
+    //header
+    OSWriteBigInt32(blob.mutableBytes, 0, magic);
+    OSWriteBigInt32(blob.mutableBytes, 4, (uint32_t)(ENTITLEMENTS_HEADER_SIZE + contents.length));
+    
+    //contents
+    [blob appendData:contents];
+    
+    return blob;
+}
+
+//build (fixture) entitlements
+// a few real ones, plus 'count' strings
+NSDictionary* fixtureEntitlements(NSUInteger count)
+{
+    //entitlements
+    NSMutableDictionary* entitlements = nil;
+    
+    //init
+    entitlements = [NSMutableDictionary dictionary];
+    
+    //add real ones
+    entitlements[@"com.apple.security.app-sandbox"] = @YES;
+    entitlements[@"com.apple.security.application-groups"] = @[FIXTURE_IDENTIFIER];
+    entitlements[@"com.apple.security.temporary-exception.files.absolute-path.read-only"] = @[@"/", @"/Applications/"];
+    
+    //add strings
+    for(NSUInteger i = 0; i < count; i++)
+    {
+        entitlements[[NSString stringWithFormat:@"%@.entitlement-%04lu", FIXTURE_IDENTIFIER, (unsigned long)i]] = [NSString stringWithFormat:@"value-%lu", (unsigned long)i];
+    }
+    
+    return entitlements;
+}
+
+//build (fixture) thin mach-o
+// header, (random) code, then a signed-looking code signature
+// note: code directory's page hashes, and entitlement (special slot) hashes, are valid
+NSData* fixtureThin(cpu_type_t cpuType, cpu_subtype_t cpuSubType, size_t codeSize, NSDictionary* entitlements, uint64_t* state)
+{
+    //binary
+    NSMutableData* binary = nil;
+    
+    //(XML) entitlements blob
+    NSData* xml = nil;
+    
+    //(DER) entitlements blob
+    NSData* der = nil;
+    
+    //(DER) entitlements
+    NSMutableData* derContents = nil;
+    
+    //(DER) entitlements wrapper
+    NSMutableData* derWrapper = nil;
+    
+    //identifier
+    // incl. NUL
+    NSMutableData* identifier = nil;
+    
+    //code directory
+    NSMutableData* codeDirectory = nil;
+    
+    //code signature
+    NSMutableData* signature = nil;
+    
+    //code directory header
+    CodeDirectory header = {0};
+    
+    //mach-o header
+    struct mach_header_64* machHeader = NULL;
+    
+    //(text) segment
+    struct segment_command_64* segment = NULL;
+    
+    //code signature command
+    struct linkedit_data_command* signatureCommand = NULL;
+    
+    //code limit
+    uint32_t codeLimit = 0;
+    
+    //# of (code) pages
+    uint32_t pageCount = 0;
+    
+    //offset of (code) hashes
+    uint32_t hashOffset = 0;
+    
+    //length of code directory
+    uint32_t codeDirectoryLength = 0;
+    
+    //length of code signature
+    uint32_t signatureLength = 0;
+    
+    //hash
+    uint8_t hash[CC_SHA256_DIGEST_LENGTH] = {0};
+    
+    //build (XML) entitlements
+    xml = buildBlob(CODESIGN_MAGIC_ENTITLEMENTS, [NSPropertyListSerialization dataWithPropertyList:entitlements format:NSPropertyListXMLFormat_v1_0 options:0 error:NULL]);
+    
+    //build (DER) entitlements
+    // '[APPLICATION 16]', holding version and dictionary
+    derContents = [NSMutableData data];
+    fixtureAppendDERInteger(derContents, ENTITLEMENTS_DER_VERSION);
+    appendDERDictionary(derContents, entitlements);
+    derWrapper = [NSMutableData data];
+    fixtureAppendDER(derWrapper, ENTITLEMENTS_DER_TAG_WRAPPER, derContents.bytes, derContents.length);
+    der = buildBlob(CODESIGN_MAGIC_DER_ENTITLEMENTS, derWrapper);
+    
+    //init identifier
+    identifier = [[FIXTURE_IDENTIFIER dataUsingEncoding:NSUTF8StringEncoding] mutableCopy];
+    [identifier increaseLengthBy:1];
+    
+    //init sizes
+    // code is (16-byte) aligned, and signature follows it
+    codeLimit = (uint32_t)((MAX(codeSize, FIXTURE_PAGE_SIZE) + 15) & ~(size_t)15);
+    pageCount = (codeLimit + FIXTURE_PAGE_SIZE - 1) / FIXTURE_PAGE_SIZE;
+    hashOffset = (uint32_t)(sizeof(CodeDirectory) + identifier.length + CODESIGN_SLOT_DER_ENTITLEMENTS * CC_SHA256_DIGEST_LENGTH);
+    codeDirectoryLength = hashOffset + pageCount * CC_SHA256_DIGEST_LENGTH;
+    signatureLength = (uint32_t)(12 + 3 * 8 + codeDirectoryLength + xml.length + der.length);
+    
+    //init code
+    binary = [NSMutableData dataWithLength:codeLimit];
+    fixtureFillRandom(binary.mutableBytes, binary.length, state);
+    
+    //init mach-o header
+    machHeader = binary.mutableBytes;
+    memset(machHeader, 0, sizeof(*machHeader) + sizeof(*segment) + sizeof(*signatureCommand));
+    machHeader->magic = MH_MAGIC_64;
+    machHeader->cputype = cpuType;
+    machHeader->cpusubtype = cpuSubType;
+    machHeader->filetype = MH_EXECUTE;
+    machHeader->ncmds = 2;
+    machHeader->sizeofcmds = sizeof(*segment) + sizeof(*signatureCommand);
+    
+    //init (text) segment
+    segment = (struct segment_command_64*)(machHeader + 1);
+    segment->cmd = LC_SEGMENT_64;
+    segment->cmdsize = sizeof(*segment);
+    strlcpy(segment->segname, SEG_TEXT, sizeof(segment->segname));
+    segment->vmaddr = 0x100000000;
+    segment->vmsize = codeLimit;
+    segment->filesize = codeLimit;
+    segment->maxprot = VM_PROT_READ | VM_PROT_EXECUTE;
+    segment->initprot = VM_PROT_READ | VM_PROT_EXECUTE;
+    
+    //init code signature command
+    signatureCommand = (struct linkedit_data_command*)(segment + 1);
+    signatureCommand->cmd = LC_CODE_SIGNATURE;
+    signatureCommand->cmdsize = sizeof(*signatureCommand);
+    signatureCommand->dataoff = codeLimit;
+    signatureCommand->datasize = signatureLength;
+    
+    //init code directory header
+    // all fields are big-endian
+    header.magic = OSSwapHostToBigInt32(CODESIGN_MAGIC_CODEDIRECTORY);
+    header.length = OSSwapHostToBigInt32(codeDirectoryLength);
+    header.version = OSSwapHostToBigInt32(CODESIGN_SUPPORTS_CODELIMIT64);
+    header.flags = OSSwapHostToBigInt32(kSecCodeSignatureAdhoc);
+    header.hashOffset = OSSwapHostToBigInt32(hashOffset);
+    header.identOffset = OSSwapHostToBigInt32((uint32_t)sizeof(CodeDirectory));
+    header.nSpecialSlots = OSSwapHostToBigInt32(CODESIGN_SLOT_DER_ENTITLEMENTS);
+    header.nCodeSlots = OSSwapHostToBigInt32(pageCount);
+    header.codeLimit = OSSwapHostToBigInt32(codeLimit);
+    header.hashSize = CC_SHA256_DIGEST_LENGTH;
+    header.hashType = CODESIGN_HASHTYPE_SHA256;
+    header.pageSize = (uint8_t)__builtin_ctz(FIXTURE_PAGE_SIZE);
+    
+    //init code directory
+    // header, identifier, then (zero'd) special slots
+    codeDirectory = [NSMutableData dataWithBytes:&header length:sizeof(header)];
+    [codeDirectory appendData:identifier];
+    [codeDirectory increaseLengthBy:CODESIGN_SLOT_DER_ENTITLEMENTS * CC_SHA256_DIGEST_LENGTH];
+    
+    //hash entitlements
+    // special slots are (negatively) indexed from code hashes
+    CC_SHA256(xml.bytes, (CC_LONG)xml.length, (uint8_t*)codeDirectory.mutableBytes + hashOffset - CODESIGN_SLOT_ENTITLEMENTS * CC_SHA256_DIGEST_LENGTH);
+    CC_SHA256(der.bytes, (CC_LONG)der.length, (uint8_t*)codeDirectory.mutableBytes + hashOffset - CODESIGN_SLOT_DER_ENTITLEMENTS * CC_SHA256_DIGEST_LENGTH);
+    
+    //hash (code) pages
+    // incl. header, as it's now final
+    for(uint32_t i = 0; i < pageCount; i++)
+    {
+        //hash
+        CC_SHA256((const uint8_t*)binary.bytes + i * FIXTURE_PAGE_SIZE, (CC_LONG)MIN(FIXTURE_PAGE_SIZE, codeLimit - i * FIXTURE_PAGE_SIZE), hash);
+        
+        //append
+        [codeDirectory appendBytes:hash length:sizeof(hash)];
+    }
+    
+    //init code signature
+    // (super blob) magic, length, count, then index of blobs
+    signature = [NSMutableData dataWithLength:12 + 3 * 8];
+    OSWriteBigInt32(signature.mutableBytes, 0, CODESIGN_MAGIC_EMBEDDED_SIGNATURE);
+    OSWriteBigInt32(signature.mutableBytes, 4, signatureLength);
+    OSWriteBigInt32(signature.mutableBytes, 8, 3);
+    OSWriteBigInt32(signature.mutableBytes, 12, CODESIGN_SLOT_CODEDIRECTORY);
+    OSWriteBigInt32(signature.mutableBytes, 16, 12 + 3 * 8);
+    OSWriteBigInt32(signature.mutableBytes, 20, CODESIGN_SLOT_ENTITLEMENTS);
+    OSWriteBigInt32(signature.mutableBytes, 24, 12 + 3 * 8 + codeDirectoryLength);
+    OSWriteBigInt32(signature.mutableBytes, 28, CODESIGN_SLOT_DER_ENTITLEMENTS);
+    OSWriteBigInt32(signature.mutableBytes, 32, (uint32_t)(12 + 3 * 8 + codeDirectoryLength + xml.length));
+    
+    //add blobs
+    [signature appendData:codeDirectory];
+    [signature appendData:xml];
+    [signature appendData:der];
+    
+    //add code signature
+    [binary appendData:signature];
+    
+    return binary;
+}
+
+//build (fixture) universal binary
+// from (thin) slices, w/ 32 or 64-bit fat header; cpu (sub)types are taken from each slice's mach header
+NSData* fixtureFat(NSArray* slices, BOOL fat64)
+{
+    //binary
+    NSMutableData* binary = nil;
+    
+    //# of slices
+    uint32_t count = (uint32_t)slices.count;
+    
+    //size of each arch
+    size_t archSize = (YES == fat64) ? sizeof(struct fat_arch_64) : sizeof(struct fat_arch);
+    
+    //fat header
+    struct fat_header* header = NULL;
+    
+    //fat arch
+    uint8_t* arch = NULL;
+    
+    //slice's mach header
+    const struct mach_header_64* machHeader = NULL;
+    
+    //offset of slice
+    uint64_t offset = 0;
+    
+    //init
+    binary = [NSMutableData dataWithLength:sizeof(struct fat_header) + count * archSize];
+    
+    //init header
+    // all fields are big-endian
+    header = binary.mutableBytes;
+    header->magic = OSSwapHostToBigInt32((YES == fat64) ? FAT_MAGIC_64 : FAT_MAGIC);
+    header->nfat_arch = OSSwapHostToBigInt32(count);
+    
+    //add slices
+    for(uint32_t i = 0; i < count; i++)
+    {
+        //slice
+        NSData* slice = slices[i];
+        
+        //init
+        machHeader = slice.bytes;
+        
+        //align
+        offset = (binary.length + (1 << FIXTURE_FAT_ALIGN) - 1) & ~(uint64_t)((1 << FIXTURE_FAT_ALIGN) - 1);
+        binary.length = (NSUInteger)offset;
+        
+        //init arch
+        // note: (re)init pointer, as data may have moved
+        arch = (uint8_t*)binary.mutableBytes + sizeof(struct fat_header) + i * archSize;
+        OSWriteBigInt32(arch, offsetof(struct fat_arch, cputype), (uint32_t)machHeader->cputype);
+        OSWriteBigInt32(arch, offsetof(struct fat_arch, cpusubtype), (uint32_t)machHeader->cpusubtype);
+        if(YES == fat64)
+        {
+            OSWriteBigInt64(arch, offsetof(struct fat_arch_64, offset), offset);
+            OSWriteBigInt64(arch, offsetof(struct fat_arch_64, size), slice.length);
+            OSWriteBigInt32(arch, offsetof(struct fat_arch_64, align), FIXTURE_FAT_ALIGN);
+        }
+        else
+        {
+            OSWriteBigInt32(arch, offsetof(struct fat_arch, offset), (uint32_t)offset);
+            OSWriteBigInt32(arch, offsetof(struct fat_arch, size), (uint32_t)slice.length);
+            OSWriteBigInt32(arch, offsetof(struct fat_arch, align), FIXTURE_FAT_ALIGN);
+        }
+        
+        //add
+        [binary appendData:slice];
+    }
+    
+    return binary;
+}
+
+//append a (cpio) member
+// odc format: octal (ASCII) header, name (incl. NUL), then contents
+void fixtureAppendCpioMember(NSMutableData* archive, NSString* name, uint32_t mode, NSData* contents)
+{
+    //header
+    NSString* header = nil;
+    
+    //init header
+    // magic, dev, ino, mode, uid, gid, nlink, rdev, mtime, name size, file size
+    header = [NSString stringWithFormat:@"070707%06o%06o%06o%06o%06o%06o%06o%011o%06o%011llo", 0, 1, mode, 0, 0, 1, 0, 0, (unsigned int)strlen(name.UTF8String) + 1, (unsigned long long)contents.length];
+    
+    //append
+    [archive appendData:[header dataUsingEncoding:NSASCIIStringEncoding]];
+    [archive appendBytes:name.UTF8String length:strlen(name.UTF8String) + 1];
+    [archive appendData:contents];
+    
+    return;
+}
+
+//build (fixture) xar archive
+// (uncompressed) files, w/ sha1 checksums of TOC, and of each file
+NSData* fixtureXar(NSArray* names, NSArray* contents)
+{
+    //archive
+    NSMutableData* archive = nil;
+    
+    //TOC
+    NSMutableString* toc = nil;
+    
+    //TOC (data)
+    NSData* tocData = nil;
+    
+    //compressed TOC
+    NSMutableData* compressed = nil;
+    
+    //heap
+    NSMutableData* heap = nil;
+    
+    //size of compressed TOC
+    size_t compressedSize = 0;
+    
+    //header
+    uint8_t header[XAR_HEADER_SIZE] = {0};
+    
+    //digest
+    uint8_t digest[CC_SHA1_DIGEST_LENGTH] = {0};
+    
+    //init TOC
+    // its checksum is first in heap
+    toc = [NSMutableString stringWithFormat:@"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<xar>\n<toc>\n<checksum style=\"sha1\"><offset>0</offset><size>%d</size></checksum>\n", CC_SHA1_DIGEST_LENGTH];
+    
+    //init heap
+    heap = [NSMutableData dataWithLength:CC_SHA1_DIGEST_LENGTH];
+    
+    //add files
+    for(NSUInteger i = 0; i < names.count; i++)
+    {
+        //hash
+        // archived and extracted checksums match, as file isn't encoded
+        CC_SHA1([contents[i] bytes], (CC_LONG)[contents[i] length], digest);
+        
+        //add to TOC
+        [toc appendFormat:@"<file id=\"%lu\"><name>%@</name><type>file</type><data><offset>%lu</offset><size>%lu</size><length>%lu</length><encoding style=\"%@\"/><archived-checksum style=\"sha1\">%@</archived-checksum><extracted-checksum style=\"sha1\">%@</extracted-checksum></data></file>\n", (unsigned long)(i + 1), names[i], (unsigned long)heap.length, (unsigned long)[contents[i] length], (unsigned long)[contents[i] length], XAR_ENCODING_NONE, bytesToHex(digest, sizeof(digest), NO), bytesToHex(digest, sizeof(digest), NO)];
+        
+        //add to heap
+        [heap appendData:contents[i]];
+    }
+    
+    //close TOC
+    [toc appendString:@"</toc>\n</xar>\n"];
+    tocData = [toc dataUsingEncoding:NSUTF8StringEncoding];
+    
+    //compress TOC
+    // zlib header, (raw) deflate, then adler-32 trailer
+    compressed = [NSMutableData dataWithLength:tocData.length + 1024];
+    ((uint8_t*)compressed.mutableBytes)[0] = 0x78;
+    ((uint8_t*)compressed.mutableBytes)[1] = 0x9C;
+    compressedSize = compression_encode_buffer((uint8_t*)compressed.mutableBytes + 2, compressed.length - 6, tocData.bytes, tocData.length, NULL, COMPRESSION_ZLIB);
+    if(0 == compressedSize)
+    {
+        //failed
+        return nil;
+    }
+    OSWriteBigInt32(compressed.mutableBytes, 2 + compressedSize, adler32(tocData.bytes, tocData.length));
+    compressed.length = 2 + compressedSize + 4;
+    
+    //checksum (compressed) TOC
+    CC_SHA1(compressed.bytes, (CC_LONG)compressed.length, heap.mutableBytes);
+    
+    //init header
+    // magic, size, version, TOC (compressed, uncompressed) sizes, checksum algorithm
+    OSWriteBigInt32(header, 0, XAR_MAGIC);
+    OSWriteBigInt16(header, 4, XAR_HEADER_SIZE);
+    OSWriteBigInt16(header, 6, 1);
+    OSWriteBigInt64(header, 8, compressed.length);
+    OSWriteBigInt64(header, 16, tocData.length);
+    OSWriteBigInt32(header, 24, XAR_CKSUM_SHA1);
+    
+    //build
+    archive = [NSMutableData dataWithBytes:header length:sizeof(header)];
+    [archive appendData:compressed];
+    [archive appendData:heap];
+    
+    return archive;
+}
+
+//build (fixture) pbzx stream
+// header ('pbzx', flags), then chunks: uncompressed size, length, and data (xz, or plain if length is size)
+NSData* fixturePbzx(NSData* contents, BOOL compress)
+{
+    //stream
+    NSMutableData* stream = nil;
+    
+    //compressed chunk
+    NSMutableData* compressed = nil;
+    
+    //size of compressed chunk
+    size_t compressedSize = 0;
+    
+    //header
+    uint8_t header[16] = {0};
+    
+    //init
+    // flags are the (max) chunk size
+    stream = [NSMutableData data];
+    OSWriteBigInt32(header, 0, PBZX_MAGIC);
+    OSWriteBigInt64(header, 4, FIXTURE_PBZX_CHUNK_SIZE);
+    [stream appendBytes:header length:12];
+    
+    //add chunks
+    for(NSUInteger offset = 0; offset < contents.length; offset += FIXTURE_PBZX_CHUNK_SIZE)
+    {
+        //chunk
+        const uint8_t* chunk = (const uint8_t*)contents.bytes + offset;
+        
+        //size of chunk
+        size_t chunkSize = MIN(contents.length - offset, (NSUInteger)FIXTURE_PBZX_CHUNK_SIZE);
+        
+        //compress
+        // as an xz stream
+        compressedSize = 0;
+        if(YES == compress)
+        {
+            compressed = [NSMutableData dataWithLength:chunkSize + 1024];
+            compressedSize = compression_encode_buffer(compressed.mutableBytes, compressed.length, chunk, chunkSize, NULL, COMPRESSION_LZMA);
+        }
+        
+        //didn't help?
+        // store plain
+        if( (0 == compressedSize) ||
+            (compressedSize >= chunkSize) )
+        {
+            OSWriteBigInt64(header, 0, chunkSize);
+            OSWriteBigInt64(header, 8, chunkSize);
+            [stream appendBytes:header length:sizeof(header)];
+            [stream appendBytes:chunk length:chunkSize];
+        }
+        //xz
+        else
+        {
+            OSWriteBigInt64(header, 0, chunkSize);
+            OSWriteBigInt64(header, 8, compressedSize);
+            [stream appendBytes:header length:sizeof(header)];
+            [stream appendBytes:compressed.bytes length:compressedSize];
+        }
+    }
+    
+    return stream;
+}
+
+//append a receipt attribute
+// sequence of type, version, and value (octet string)
+static void appendReceiptAttribute(NSMutableData* output, int64_t type, NSData* value)
+{
+    //fields
+    NSMutableData* fields = nil;
+    
+    //init
+    fields = [NSMutableData data];
+    
+    //add fields
+    fixtureAppendDERInteger(fields, type);
+    fixtureAppendDERInteger(fields, 1);
+    fixtureAppendDER(fields, DER_TAG_OCTET_STRING, value.bytes, value.length);
+    
+    //append
+    fixtureAppendDER(output, DER_TAG_SEQUENCE, fields.bytes, fields.length);
+    
+    return;
+}
+
+//build (fixture) receipt payload
+// set of attributes: the ones WYS parses, plus 'count' others
+NSData* fixtureReceipt(NSUInteger count, uint64_t* state)
+{
+    //payload
+    NSMutableData* payload = nil;
+    
+    //attributes
+    NSMutableData* attributes = nil;
+    
+    //value
+    NSMutableData* value = nil;
+    
+    //init
+    attributes = [NSMutableData data];
+    
+    //add bundle id
+    value = [NSMutableData data];
+    fixtureAppendDERString(value, FIXTURE_IDENTIFIER);
+    appendReceiptAttribute(attributes, RECEIPT_ATTR_BUNDLE_ID, value);
+    
+    //add app version
+    value = [NSMutableData data];
+    fixtureAppendDERString(value, @"1.0");
+    appendReceiptAttribute(attributes, RECEIPT_ATTR_APP_VERSION, value);
+    
+    //add opaque value
+    value = [NSMutableData dataWithLength:16];
+    fixtureFillRandom(value.mutableBytes, value.length, state);
+    appendReceiptAttribute(attributes, RECEIPT_ATTR_OPAQUE_VALUE, value);
+    
+    //add receipt hash
+    value = [NSMutableData dataWithLength:CC_SHA1_DIGEST_LENGTH];
+    fixtureFillRandom(value.mutableBytes, value.length, state);
+    appendReceiptAttribute(attributes, RECEIPT_ATTR_RECEIPT_HASH, value);
+    
+    //add others
+    // e.g. in-app purchases, that WYS skips
+    for(NSUInteger i = 0; i < count; i++)
+    {
+        value = [NSMutableData dataWithLength:32];
+        fixtureFillRandom(value.mutableBytes, value.length, state);
+        appendReceiptAttribute(attributes, 1000 + (int64_t)i, value);
+    }
+    
+    //init payload
+    payload = [NSMutableData data];
+    fixtureAppendDER(payload, DER_TAG_SET, attributes.bytes, attributes.length);
+    
+    return payload;
+}
+
+//build (fixture) bundle
+// executable, Info.plist, resources, and a CodeResources that seals them
+BOOL fixtureBundle(NSString* bundlePath, NSData* executable, NSUInteger resourceCount, uint64_t* state)
+{
+    //flag
+    BOOL built = NO;
+    
+    //contents
+    NSString* contents = nil;
+    
+    //seals
+    NSMutableDictionary* seals = nil;
+    
+    //manifest
+    NSDictionary* manifest = nil;
+    
+    //resource
+    NSMutableData* resource = nil;
+    
+    //digest
+    uint8_t digest[CC_SHA256_DIGEST_LENGTH] = {0};
+    
+    //init
+    contents = [bundlePath stringByAppendingPathComponent:@"Contents"];
+    seals = [NSMutableDictionary dictionary];
+    resource = [NSMutableData dataWithLength:FIXTURE_RESOURCE_SIZE];
+    
+    //create directories
+    for(NSString* directory in @[@"MacOS", @"_CodeSignature", @"Resources"])
+    {
+        if(YES != [NSFileManager.defaultManager createDirectoryAtPath:[contents stringByAppendingPathComponent:directory] withIntermediateDirectories:YES attributes:nil error:NULL])
+        {
+            //bail
+            goto bail;
+        }
+    }
+    
+    //create resource directories
+    for(NSUInteger i = 0; i < FIXTURE_RESOURCE_DIRECTORIES; i++)
+    {
+        if(YES != [NSFileManager.defaultManager createDirectoryAtPath:[contents stringByAppendingPathComponent:[NSString stringWithFormat:@"Resources/%lu", (unsigned long)i]] withIntermediateDirectories:YES attributes:nil error:NULL])
+        {
+            //bail
+            goto bail;
+        }
+    }
+    
+    //write executable
+    if( (YES != [executable writeToFile:[contents stringByAppendingPathComponent:@"MacOS/Fixture"] atomically:NO]) ||
+        (0 != chmod([contents stringByAppendingPathComponent:@"MacOS/Fixture"].fileSystemRepresentation, 0755)) )
+    {
+        //bail
+        goto bail;
+    }
+    
+    //write Info.plist
+    if(YES != [[NSPropertyListSerialization dataWithPropertyList:@{@"CFBundleExecutable":@"Fixture", @"CFBundleIdentifier":FIXTURE_IDENTIFIER, @"CFBundleName":@"Fixture", @"CFBundlePackageType":@"APPL", @"CFBundleShortVersionString":@"1.0"} format:NSPropertyListXMLFormat_v1_0 options:0 error:NULL] writeToFile:[contents stringByAppendingPathComponent:@"Info.plist"] atomically:NO])
+    {
+        //bail
+        goto bail;
+    }
+    
+    //write resources
+    // and seal each
+    for(NSUInteger i = 0; i < resourceCount; i++)
+    {
+        //name
+        NSString* name = [NSString stringWithFormat:@"Resources/%lu/resource-%lu.dat", (unsigned long)(i % FIXTURE_RESOURCE_DIRECTORIES), (unsigned long)i];
+        
+        //generate
+        fixtureFillRandom(resource.mutableBytes, resource.length, state);
+        
+        //write
+        if(YES != [resource writeToFile:[contents stringByAppendingPathComponent:name] atomically:NO])
+        {
+            //bail
+            goto bail;
+        }
+        
+        //seal
+        CC_SHA256(resource.bytes, (CC_LONG)resource.length, digest);
+        seals[name] = @{@"hash2":[NSData dataWithBytes:digest length:sizeof(digest)]};
+    }
+    
+    //init manifest
+    manifest = @{@"files":@{}, @"files2":seals, @"rules":@{@"^Resources/":@YES}, @"rules2":@{@"^Resources/":@YES}};
+    
+    //write CodeResources
+    if(YES != [[NSPropertyListSerialization dataWithPropertyList:manifest format:NSPropertyListXMLFormat_v1_0 options:0 error:NULL] writeToFile:[contents stringByAppendingPathComponent:@"_CodeSignature/CodeResources"] atomically:NO])
+    {
+        //bail
+        goto bail;
+    }
+    
+    //happy
+    built = YES;
+
+bail:
+    
+    return built;
+}
+
+//CRC32
+// bitwise (zlib's polynomial), so it's independent of UDIF parser's (table-driven) one
+static uint32_t crc32Bitwise(uint32_t crc, const uint8_t* bytes, size_t length)
+{
+    //init
+    crc = ~crc;
+    
+    //process each byte
+    for(size_t i = 0; i < length; i++)
+    {
+        crc ^= bytes[i];
+        for(int bit = 0; bit < 8; bit++)
+        {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+    }
+    
+    return ~crc;
+}
+
+//write a (UDIF) checksum
+// type, size (in bits), then value
+static void writeChecksum(uint8_t* checksum, uint32_t crc)
+{
+    //write
+    OSWriteBigInt32(checksum, 0, UDIF_CHECKSUM_CRC32);
+    OSWriteBigInt32(checksum, 4, 32);
+    OSWriteBigInt32(checksum, 8, crc);
+    
+    return;
+}
+
+//build (fixture) UDIF image
+// data fork, (XML) plist w/ one partition's 'mish' table, then 'koly' trailer
+// chunks are zlib and raw (alternately), or zero if all of a chunk's sectors are
+NSData* fixtureUdif(NSData* contents)
+{
+    //image
+    NSMutableData* image = nil;
+    
+    //(padded) contents
+    NSMutableData* padded = nil;
+    
+    //partition table
+    NSMutableData* table = nil;
+    
+    //chunk (entry)
+    uint8_t entry[UDIF_MISH_CHUNK_SIZE] = {0};
+    
+    //compressed chunk
+    NSMutableData* compressed = nil;
+    
+    //size of compressed chunk
+    size_t compressedSize = 0;
+    
+    //(XML) plist
+    NSData* xml = nil;
+    
+    //trailer
+    uint8_t trailer[UDIF_TRAILER_SIZE] = {0};
+    
+    //# of sectors
+    uint64_t sectorCount = 0;
+    
+    //# of chunks
+    uint32_t chunkCount = 0;
+    
+    //stored (partition) CRC
+    uint8_t storedCRC[sizeof(uint32_t)] = {0};
+    
+    //pad contents
+    // to a whole # of sectors
+    padded = [contents mutableCopy];
+    padded.length = (contents.length + UDIF_SECTOR_SIZE - 1) / UDIF_SECTOR_SIZE * UDIF_SECTOR_SIZE;
+    sectorCount = padded.length / UDIF_SECTOR_SIZE;
+    
+    //init
+    image = [NSMutableData data];
+    table = [NSMutableData dataWithLength:UDIF_MISH_HEADER_SIZE];
+    
+    //add chunks
+    // to data fork, and partition table
+    for(uint64_t sector = 0; sector < sectorCount; sector += FIXTURE_UDIF_CHUNK_SECTORS)
+    {
+        //chunk
+        const uint8_t* chunk = (const uint8_t*)padded.bytes + sector * UDIF_SECTOR_SIZE;
+        
+        //# of sectors in chunk
+        uint64_t chunkSectors = MIN(sectorCount - sector, (uint64_t)FIXTURE_UDIF_CHUNK_SECTORS);
+        
+        //size of chunk
+        size_t chunkSize = (size_t)(chunkSectors * UDIF_SECTOR_SIZE);
+        
+        //all zeros?
+        BOOL zeros = YES;
+        for(size_t i = 0; (YES == zeros) && (i < chunkSize); i++)
+        {
+            zeros = (0 == chunk[i]);
+        }
+        
+        //init entry
+        // type, comment, sector, # of sectors, offset (in data fork), length
+        memset(entry, 0, sizeof(entry));
+        OSWriteBigInt64(entry, 0x08, sector);
+        OSWriteBigInt64(entry, 0x10, chunkSectors);
+        OSWriteBigInt64(entry, 0x18, image.length);
+        
+        //zeros
+        // nothing in data fork
+        if(YES == zeros)
+        {
+            OSWriteBigInt32(entry, 0, UDIF_CHUNK_ZERO);
+        }
+        //zlib
+        // zlib header, (raw) deflate, then adler-32 trailer
+        else if(0 == (chunkCount % 2))
+        {
+            compressed = [NSMutableData dataWithLength:chunkSize + 1024];
+            ((uint8_t*)compressed.mutableBytes)[0] = 0x78;
+            ((uint8_t*)compressed.mutableBytes)[1] = 0x9C;
+            compressedSize = compression_encode_buffer((uint8_t*)compressed.mutableBytes + 2, compressed.length - 6, chunk, chunkSize, NULL, COMPRESSION_ZLIB);
+            if(0 == compressedSize)
+            {
+                //failed
+                return nil;
+            }
+            OSWriteBigInt32(compressed.mutableBytes, 2 + compressedSize, adler32(chunk, chunkSize));
+            compressed.length = 2 + compressedSize + 4;
+            
+            OSWriteBigInt32(entry, 0, UDIF_CHUNK_ZLIB);
+            OSWriteBigInt64(entry, 0x20, compressed.length);
+            [image appendData:compressed];
+        }
+        //raw
+        else
+        {
+            OSWriteBigInt32(entry, 0, UDIF_CHUNK_RAW);
+            OSWriteBigInt64(entry, 0x20, chunkSize);
+            [image appendBytes:chunk length:chunkSize];
+        }
+        
+        //add entry
+        [table appendBytes:entry length:sizeof(entry)];
+        chunkCount++;
+    }
+    
+    //add terminator
+    memset(entry, 0, sizeof(entry));
+    OSWriteBigInt32(entry, 0, UDIF_CHUNK_TERMINATOR);
+    OSWriteBigInt64(entry, 0x08, sectorCount);
+    OSWriteBigInt64(entry, 0x18, image.length);
+    [table appendBytes:entry length:sizeof(entry)];
+    chunkCount++;
+    
+    //init table's header
+    // magic, version, first sector, # of sectors, data offset, checksum (of decompressed contents), # of chunks
+    OSWriteBigInt32(table.mutableBytes, 0, UDIF_MISH_MAGIC);
+    OSWriteBigInt32(table.mutableBytes, 4, 1);
+    OSWriteBigInt64(table.mutableBytes, 0x10, sectorCount);
+    writeChecksum((uint8_t*)table.mutableBytes + UDIF_MISH_CHECKSUM, crc32Bitwise(0, padded.bytes, padded.length));
+    OSWriteBigInt32(table.mutableBytes, UDIF_MISH_HEADER_SIZE - 4, chunkCount);
+    
+    //init plist
+    xml = [NSPropertyListSerialization dataWithPropertyList:@{@"resource-fork":@{@"blkx":@[@{@"Name":@"Fixture (Apple_HFS : 1)", @"Data":table}]}} format:NSPropertyListXMLFormat_v1_0 options:0 error:NULL];
+    if(nil == xml)
+    {
+        //failed
+        return nil;
+    }
+    
+    //init trailer
+    // magic, version, size, flags, data fork, segment (1 of 1), data fork checksum, plist, master checksum, # of sectors
+    OSWriteBigInt32(trailer, 0, UDIF_MAGIC);
+    OSWriteBigInt32(trailer, 4, 4);
+    OSWriteBigInt32(trailer, 8, UDIF_TRAILER_SIZE);
+    OSWriteBigInt32(trailer, 0x0C, 1);
+    OSWriteBigInt64(trailer, UDIF_DATA_FORK_OFFSET, 0);
+    OSWriteBigInt64(trailer, UDIF_DATA_FORK_LENGTH, image.length);
+    OSWriteBigInt32(trailer, 0x38, 1);
+    OSWriteBigInt32(trailer, 0x3C, 1);
+    writeChecksum(trailer + UDIF_DATA_CHECKSUM, crc32Bitwise(0, image.bytes, image.length));
+    OSWriteBigInt64(trailer, UDIF_XML_OFFSET, image.length);
+    OSWriteBigInt64(trailer, UDIF_XML_LENGTH, xml.length);
+    memcpy(storedCRC, (const uint8_t*)table.bytes + UDIF_MISH_CHECKSUM + 8, sizeof(storedCRC));
+    writeChecksum(trailer + UDIF_MASTER_CHECKSUM, crc32Bitwise(0, storedCRC, sizeof(storedCRC)));
+    OSWriteBigInt32(trailer, 0x1E8, 1);
+    OSWriteBigInt64(trailer, 0x1EC, sectorCount);
+    
+    //add plist, and trailer
+    [image appendData:xml];
+    [image appendBytes:trailer length:sizeof(trailer)];
+    
+    return image;
+}
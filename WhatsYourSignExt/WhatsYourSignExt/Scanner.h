@@ -0,0 +1,27 @@
+//
+//  Scanner.h
+//  WhatsYourSign
+//
+//  Created by Patrick Wardle on 10/17/26.
+//  Copyright (c) 2026 Objective-See. All rights reserved.
+//
+
+#ifndef Scanner_h
+#define Scanner_h
+
+@import Foundation;
+
+//cmdline flag to scan
+// e.g. 'WhatsYourSign -scan /Applications'
+#define SCAN_FLAG "-scan"
+
+//max # of directories listed at once
+#define SCAN_MAX_LISTINGS 8
+
+/* FUNCTIONS */
+
+//scan (recursively) a file or directory
+// each item's results are printed (to stdout) as a JSON line, then stats (to stderr)
+int scan(NSString* path);
+
+#endif /* Scanner_h */
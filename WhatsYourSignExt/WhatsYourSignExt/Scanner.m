@@ -0,0 +1,389 @@
+//
+//  Scanner.m
+//  WhatsYourSign
+//
+//  Created by Patrick Wardle on 10/17/26.
+//  Copyright (c) 2026 Objective-See. All rights reserved.
+//
+
+#import "Item.h"
+#import "consts.h"
+#import "Scanner.h"
+#import "Trace.h"
+#import "utilities.h"
+
+#import <os/lock.h>
+#import <sys/stat.h>
+#import <stdatomic.h>
+
+//items waiting to be verified
+static NSMutableArray* pending = nil;
+
+//lock for pending items (and next directories)
+static os_unfair_lock pendingLock = OS_UNFAIR_LOCK_INIT;
+
+//# of pending items
+// signaled once per item, and once per worker when traversal is done
+static dispatch_semaphore_t available = NULL;
+
+//lock for output
+static os_unfair_lock outputLock = OS_UNFAIR_LOCK_INIT;
+
+//# of items verified
+static atomic_uint_fast64_t filesScanned = 0;
+
+//# of bytes hashed
+static atomic_uint_fast64_t bytesScanned = 0;
+
+//convert (cd) hash to hex string
+// nil if there isn't one
+static NSString* cdHashString(NSData* cdHash)
+{
+    return (0 != cdHash.length) ? bytesToHex(cdHash.bytes, cdHash.length, NO) : nil;
+}
+
+//write a JSON line
+// to stdout (items) or stderr (stats)
+static void emit(NSDictionary* record, FILE* stream)
+{
+    //JSON
+    NSData* json = nil;
+    
+    //serialize
+    json = [NSJSONSerialization dataWithJSONObject:record options:NSJSONWritingSortedKeys error:NULL];
+    if(nil == json)
+    {
+        return;
+    }
+    
+    //write
+    // lock, so lines from workers don't interleave
+    os_unfair_lock_lock(&outputLock);
+    fwrite(json.bytes, 1, json.length, stream);
+    fputc('\n', stream);
+    fflush(stream);
+    os_unfair_lock_unlock(&outputLock);
+    
+    return;
+}
+
+//build (JSON-safe) record for a verified item
+static NSDictionary* describe(Item* item)
+{
+    //record
+    NSMutableDictionary* record = nil;
+    
+    //init
+    record = [NSMutableDictionary dictionary];
+    
+    //path, name, type
+    record[@"path"] = item.path;
+    record[@"name"] = item.name ?: item.path.lastPathComponent;
+    record[@"type"] = item.type ?: @"";
+    
+    //signature status
+    record[@"status"] = item.signingInfo[KEY_SIGNATURE_STATUS] ?: [NSNumber numberWithInteger:errSecCSInternalError];
+    
+    //signing auths
+    record[@"authorities"] = item.signingInfo[KEY_SIGNING_AUTHORITIES] ?: @[];
+    
+    //cs flags
+    record[@"flags"] = item.signingInfo[KEY_SIGNING_FLAGS] ?: @0;
+    
+    //signer
+    record[@"apple"] = [NSNumber numberWithBool:[item.signingInfo[KEY_SIGNING_IS_APPLE] boolValue]];
+    record[@"appStore"] = [NSNumber numberWithBool:[item.signingInfo[KEY_SIGNING_IS_APP_STORE] boolValue]];
+    record[@"devID"] = [NSNumber numberWithBool:[item.signingInfo[KEY_SIGNING_IS_APPLE_DEV_ID] boolValue]];
+    
+    //notarization
+    // null if not checked (e.g. unsigned)
+    record[@"notarized"] = item.signingInfo[KEY_SIGNING_IS_NOTARIZED] ?: [NSNull null];
+    
+    //cd hashes
+    record[@"cdhashSHA1"] = cdHashString(item.signingInfo[KEY_SIGNING_CDHASH_SHA1]) ?: [NSNull null];
+    record[@"cdhashSHA256"] = cdHashString(item.signingInfo[KEY_SIGNING_CDHASH_SHA256]) ?: [NSNull null];
+    
+    //file hashes
+    record[@"hashes"] = item.hashes ?: @{};
+    
+    //package components
+    // pkgs only, w/ result of checking each one
+    if(nil != item.signingInfo[KEY_PACKAGE_COMPONENTS])
+    {
+        record[@"components"] = item.signingInfo[KEY_PACKAGE_COMPONENTS];
+    }
+    
+    //disk image checks
+    // dmgs only, w/ result of checking its checksums
+    if(nil != item.signingInfo[KEY_DISKIMAGE])
+    {
+        record[@"diskImage"] = item.signingInfo[KEY_DISKIMAGE];
+    }
+    
+    return record;
+}
+
+//add an item
+// and wake up a worker
+static void enqueue(NSString* path)
+{
+    //add
+    os_unfair_lock_lock(&pendingLock);
+    [pending addObject:path];
+    os_unfair_lock_unlock(&pendingLock);
+    
+    //signal
+    dispatch_semaphore_signal(available);
+    
+    return;
+}
+
+//list a directory
+// files and packages are queued for verification, (other) directories are returned
+static NSArray* listDirectory(NSString* directory)
+{
+    //sub directories
+    NSMutableArray* directories = nil;
+    
+    //keys
+    NSArray* keys = @[NSURLIsDirectoryKey, NSURLIsPackageKey, NSURLIsSymbolicLinkKey];
+    
+    //init
+    directories = [NSMutableArray array];
+    
+    //process each
+    for(NSURL* url in [NSFileManager.defaultManager contentsOfDirectoryAtURL:[NSURL fileURLWithPath:directory] includingPropertiesForKeys:keys options:0 error:NULL])
+    {
+        //values
+        NSDictionary* values = [url resourceValuesForKeys:keys error:NULL];
+        
+        //skip symlinks
+        // avoids loops (and scanning items twice)
+        if(YES == [values[NSURLIsSymbolicLinkKey] boolValue])
+        {
+            continue;
+        }
+        
+        //(plain) directory?
+        // packages (.apps, etc) are verified as a whole
+        if( (YES == [values[NSURLIsDirectoryKey] boolValue]) &&
+            (YES != [values[NSURLIsPackageKey] boolValue]) )
+        {
+            [directories addObject:url.path];
+            continue;
+        }
+        
+        //queue
+        enqueue(url.path);
+    }
+    
+    return directories;
+}
+
+//walk a directory tree
+// each level's directories are listed concurrently
+static void traverse(NSString* root)
+{
+    //current level
+    NSArray* level = @[root];
+    
+    //walk
+    while(0 != level.count)
+    {
+        //next level
+        NSMutableArray* next = [NSMutableArray array];
+        
+        //list (this level's) directories
+        // strided, so only a few listings are in flight
+        dispatch_apply(MIN(level.count, SCAN_MAX_LISTINGS), dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t stripe) {
+            
+            for(NSUInteger i = stripe; i < level.count; i += SCAN_MAX_LISTINGS)
+            {
+                @autoreleasepool
+                {
+                    //list
+                    NSArray* directories = listDirectory(level[i]);
+                    
+                    //save
+                    os_unfair_lock_lock(&pendingLock);
+                    [next addObjectsFromArray:directories];
+                    os_unfair_lock_unlock(&pendingLock);
+                }
+            }
+        });
+        
+        //go deeper
+        level = next;
+    }
+    
+    return;
+}
+
+//verify items (until there are none)
+// blocks for more, while traversal is still running
+static void work(void)
+{
+    //path
+    NSString* path = nil;
+    
+    //item
+    Item* item = nil;
+    
+    //file info
+    struct stat info = {0};
+    
+    while(YES)
+    {
+        @autoreleasepool
+        {
+            //wait
+            dispatch_semaphore_wait(available, DISPATCH_TIME_FOREVER);
+            
+            //grab next
+            os_unfair_lock_lock(&pendingLock);
+            path = pending.firstObject;
+            if(nil != path)
+            {
+                [pending removeObjectAtIndex:0];
+            }
+            os_unfair_lock_unlock(&pendingLock);
+            
+            //none?
+            // traversal is done
+            if(nil == path)
+            {
+                break;
+            }
+            
+            //init item
+            // and verify (synchronously)
+            item = [[Item alloc] init:path verify:NO];
+            [item verify];
+            
+            //emit
+            emit(describe(item), stdout);
+            
+            //update stats
+            // bytes are those of the file that was hashed
+            atomic_fetch_add(&filesScanned, 1);
+            if(0 == stat((hashablePath(path) ?: path).fileSystemRepresentation, &info))
+            {
+                atomic_fetch_add(&bytesScanned, (uint64_t)info.st_size);
+            }
+        }
+    }
+    
+    return;
+}
+
+//scan (recursively) a file or directory
+// each item's results are printed (to stdout) as a JSON line, then stats (to stderr)
+int scan(NSString* path)
+{
+    //result
+    int result = -1;
+    
+    //directory flag
+    BOOL isDirectory = NO;
+    
+    //# of workers
+    NSUInteger workers = 0;
+    
+    //workers' group
+    dispatch_group_t group = NULL;
+    
+    //start
+    CFAbsoluteTime start = 0;
+    
+    //elapsed
+    CFAbsoluteTime elapsed = 0;
+    
+    //(per-stage) counters
+    NSDictionary* counters = nil;
+    
+    //full path
+    path = path.stringByStandardizingPath;
+    
+    //sanity check
+    if(YES != [NSFileManager.defaultManager fileExistsAtPath:path isDirectory:&isDirectory])
+    {
+        //err msg
+        fprintf(stderr, "ERROR: %s not found\n", path.UTF8String);
+        
+        //bail
+        goto bail;
+    }
+    
+    //init
+    pending = [NSMutableArray array];
+    available = dispatch_semaphore_create(0);
+    group = dispatch_group_create();
+    
+    //workers
+    // one per core, as verification is mostly I/O bound
+    workers = NSProcessInfo.processInfo.activeProcessorCount;
+    
+    //start
+    start = CFAbsoluteTimeGetCurrent();
+    
+    //start workers
+    for(NSUInteger i = 0; i < workers; i++)
+    {
+        dispatch_group_async(group, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+            work();
+        });
+    }
+    
+    //file or package?
+    // just verify it
+    if( (YES != isDirectory) ||
+        (YES == [NSWorkspace.sharedWorkspace isFilePackageAtPath:path]) )
+    {
+        enqueue(path);
+    }
+    //directory
+    // walk it, queuing items as they are found
+    else
+    {
+        traverse(path);
+    }
+    
+    //traversal is done
+    // so wake each worker, once it's out of items
+    for(NSUInteger i = 0; i < workers; i++)
+    {
+        dispatch_semaphore_signal(available);
+    }
+    
+    //wait for workers
+    dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+    
+    //elapsed
+    elapsed = MAX(CFAbsoluteTimeGetCurrent() - start, 0.001);
+    
+    //emit stats
+    emit(@{@"files":[NSNumber numberWithUnsignedLongLong:filesScanned],
+           @"bytes":[NSNumber numberWithUnsignedLongLong:bytesScanned],
+           @"seconds":[NSNumber numberWithDouble:elapsed],
+           @"filesPerSec":[NSNumber numberWithDouble:filesScanned / elapsed],
+           @"bytesPerSec":[NSNumber numberWithDouble:bytesScanned / elapsed]}, stderr);
+    
+    //emit (per-stage) counters
+    // only if tracing is enabled
+    counters = traceCounters();
+    if(0 != counters.count)
+    {
+        emit(@{@"stages":counters}, stderr);
+    }
+    
+    //write trace
+    // now, as process is about to exit
+    traceFlush();
+    
+    //happy
+    result = 0;
+
+bail:
+    
+    return result;
+}
@@ -0,0 +1,43 @@
+//
+//  SelfTest.h
+//  WhatsYourSign
+//
+//  Created by Patrick Wardle on 10/17/26.
+//  Copyright (c) 2026 Objective-See. All rights reserved.
+//
+//  note: parsers are run over (generated) fixtures, both intact and corrupted, and checked against how they were built
+//        nothing is needed but the app itself, so this can run headless (e.g. on a CI box)
+
+#ifndef SelfTest_h
+#define SelfTest_h
+
+@import Foundation;
+
+//cmdline flag to self test
+// e.g. 'WhatsYourSign -selftest'
+#define SELFTEST_FLAG "-selftest"
+
+//seed for fixtures
+#define SELFTEST_SEED 0x5753595354455354
+
+//size of updates, when feeding payloads to their inspector
+// odd, so headers (cpio, pbzx) straddle updates
+#define SELFTEST_FEED_SIZE 4093
+
+//# of (random) mutations, when fuzzing receipt payloads
+#define SELFTEST_FUZZ_ITERATIONS 10000
+
+//timeout for (headless) scan of fixture tree
+#define SELFTEST_SCAN_TIMEOUT 120.0
+
+//timeout for (other) processes
+// so a deadlock fails its case, rather than hanging the self test
+#define SELFTEST_TASK_TIMEOUT 30.0
+
+/* FUNCTIONS */
+
+//self test
+// prints (to stdout) each case's result as a JSON line, then returns 0 only if all passed
+int selfTest(void);
+
+#endif /* SelfTest_h */
@@ -0,0 +1,1106 @@
+//
+//  SelfTest.m
+//  WhatsYourSign
+//
+//  Created by Patrick Wardle on 10/17/26.
+//  Copyright (c) 2026 Objective-See. All rights reserved.
+//
+
+#import "Der.h"
+#import "Xar.h"
+#import "Udif.h"
+#import "MachO.h"
+#import "consts.h"
+#import "Payload.h"
+#import "AppReceipt.h"
+#import "Fixtures.h"
+#import "SelfTest.h"
+#import "HashCache.h"
+#import "utilities.h"
+#import "Entitlements.h"
+#import "CodeSignature.h"
+
+#import <fcntl.h>
+#import <unistd.h>
+#import <sys/mman.h>
+#import <mach-o/fat.h>
+#import <CommonCrypto/CommonDigest.h>
+
+@import Security;
+
+//# of failed cases
+static NSUInteger failures = 0;
+
+//write a JSON line
+// to stdout
+static void emit(NSDictionary* record)
+{
+    //JSON
+    NSData* json = nil;
+    
+    //serialize
+    json = [NSJSONSerialization dataWithJSONObject:record options:NSJSONWritingSortedKeys error:NULL];
+    if(nil == json)
+    {
+        return;
+    }
+    
+    //write
+    fwrite(json.bytes, 1, json.length, stdout);
+    fputc('\n', stdout);
+    fflush(stdout);
+    
+    return;
+}
+
+//record (result of) a case
+// 'detail' describes what was seen, to help w/ failures
+static void expect(NSString* test, BOOL passed, NSString* detail)
+{
+    //emit
+    emit(@{@"test":test,
+           @"passed":[NSNumber numberWithBool:passed],
+           @"detail":detail ?: @""});
+    
+    //failed?
+    if(YES != passed)
+    {
+        failures++;
+    }
+    
+    return;
+}
+
+//write a fixture
+// returns its path, or nil on error
+static NSString* writeFixture(NSString* directory, NSString* name, NSData* data)
+{
+    //path
+    NSString* path = [directory stringByAppendingPathComponent:name];
+    
+    return (YES == [data writeToFile:path atomically:NO]) ? path : nil;
+}
+
+//corrupt a byte of a fixture
+static NSData* corrupt(NSData* data, NSUInteger offset)
+{
+    //copy
+    NSMutableData* corrupted = [data mutableCopy];
+    
+    //flip
+    ((uint8_t*)corrupted.mutableBytes)[offset] ^= 0xFF;
+    
+    return corrupted;
+}
+
+//get (uppercase hex) SHA-256 of data
+// as reported for binaries in payloads
+static NSString* sha256(NSData* data)
+{
+    //digest
+    uint8_t digest[CC_SHA256_DIGEST_LENGTH] = {0};
+    
+    //hash
+    CC_SHA256(data.bytes, (CC_LONG)data.length, digest);
+    
+    return bytesToHex(digest, sizeof(digest), YES);
+}
+
+//feed a payload to an inspector
+// in (odd-sized) updates, as if it was being streamed from a xar heap
+static NSArray* inspectPayload(NSData* payload)
+{
+    //inspector
+    PayloadInspector* inspector = nil;
+    
+    //init
+    inspector = [[PayloadInspector alloc] init];
+    
+    //feed
+    for(NSUInteger offset = 0; offset < payload.length; offset += SELFTEST_FEED_SIZE)
+    {
+        [inspector update:(const uint8_t*)payload.bytes + offset length:MIN(payload.length - offset, (NSUInteger)SELFTEST_FEED_SIZE)];
+    }
+    
+    return [inspector finish];
+}
+
+//check that a payload's (only) binary is the fixture
+// path, hash, identifier, and that its pages were verified
+static BOOL isFixtureBinary(NSArray* binaries, NSString* path, NSData* binary)
+{
+    //binary (summary)
+    NSDictionary* summary = binaries.firstObject;
+    
+    return (1 == binaries.count) &&
+           (YES == [summary[KEY_BINARY_PATH] isEqualToString:path]) &&
+           (YES == [summary[KEY_BINARY_SHA256] isEqualToString:sha256(binary)]) &&
+           (YES == [summary[KEY_BINARY_IDENTIFIER] isEqualToString:FIXTURE_IDENTIFIER]) &&
+           (YES == [summary[KEY_BINARY_PAGES_VERIFIED] boolValue]);
+}
+
+//cpu type the loader prefers
+// i.e. that of this (native) process
+static cpu_type_t hostCPUType(void)
+{
+#if defined(__arm64__)
+    return CPU_TYPE_ARM64;
+#else
+    return CPU_TYPE_X86_64;
+#endif
+}
+
+//describe an index
+// for (failed) cases' details
+static NSString* describeIndex(BOOL indexed, const MachOIndex* index)
+{
+    //description
+    NSMutableString* description = nil;
+    
+    //not indexed?
+    if(YES != indexed)
+    {
+        return @"not indexed";
+    }
+    
+    //init
+    description = [NSMutableString stringWithFormat:@"kind %ld, %u slice(s)", (long)index->kind, index->count];
+    
+    //add each slice
+    for(uint32_t i = 0; i < index->count; i++)
+    {
+        [description appendFormat:@"; cpu %d @%llu (%llu bytes)%@, signature @%llu (%u bytes)", index->slices[i].cpuType, index->slices[i].offset, index->slices[i].size, (YES == index->slices[i].invalid) ? @" invalid" : @"", index->slices[i].signatureOffset, index->slices[i].signatureSize];
+    }
+    
+    return description;
+}
+
+//patch (offset of) a slice in a universal binary
+// 32-bit fat header
+static void setSliceOffset(NSMutableData* binary, int slice, uint32_t offset)
+{
+    //patch
+    OSWriteBigInt32(binary.mutableBytes, sizeof(struct fat_header) + slice * sizeof(struct fat_arch) + offsetof(struct fat_arch, offset), offset);
+    
+    return;
+}
+
+//test mach-o parser
+// thin, universal (32/64-bit), w/ bad slices, and not mach-o's at all
+static void testMachO(NSString* directory, uint64_t* state)
+{
+    //entitlements
+    NSDictionary* entitlements = nil;
+    
+    //slices
+    NSData* arm64 = nil;
+    NSData* x86_64 = nil;
+    
+    //universal binary
+    NSMutableData* fat = nil;
+    
+    //junk
+    NSMutableData* junk = nil;
+    
+    //index
+    MachOIndex index = {0};
+    
+    //flag
+    BOOL indexed = NO;
+    
+    //best slice
+    const MachOSlice* best = NULL;
+    
+    //host's slice, and the other one
+    int hostSlice = -1;
+    int otherSlice = -1;
+    
+    //init
+    entitlements = fixtureEntitlements(4);
+    arm64 = fixtureThin(CPU_TYPE_ARM64, CPU_SUBTYPE_ARM64_ALL, 4 * FIXTURE_PAGE_SIZE, entitlements, state);
+    x86_64 = fixtureThin(CPU_TYPE_X86_64, CPU_SUBTYPE_X86_64_ALL, 4 * FIXTURE_PAGE_SIZE, entitlements, state);
+    
+    //thin
+    // signature is last thing in file
+    indexed = machoIndexPath(writeFixture(directory, @"thin", arm64), &index);
+    expect(@"macho.thin", (YES == indexed) &&
+                          (MachOKindThin == index.kind) &&
+                          (1 == index.count) &&
+                          (CPU_TYPE_ARM64 == index.slices[0].cpuType) &&
+                          (YES == index.slices[0].is64Bit) &&
+                          (0 != index.slices[0].signatureSize) &&
+                          (index.slices[0].signatureOffset + index.slices[0].signatureSize == arm64.length) &&
+                          (&index.slices[0] == machoBestSlice(&index)), describeIndex(indexed, &index));
+    
+    //universal
+    // 32 and 64-bit fat headers, w/ slices aligned, and signatures at (file) offsets
+    for(int i = 0; i < 2; i++)
+    {
+        //64-bit?
+        BOOL fat64 = (1 == i);
+        
+        //build, index
+        fat = [fixtureFat(@[x86_64, arm64], fat64) mutableCopy];
+        memset(&index, 0, sizeof(index));
+        indexed = machoIndexPath(writeFixture(directory, (YES == fat64) ? @"fat64" : @"fat", fat), &index);
+        best = machoBestSlice(&index);
+        
+        //check
+        expect((YES == fat64) ? @"macho.fat64" : @"macho.fat", (YES == indexed) &&
+                                                              (((YES == fat64) ? MachOKindFat64 : MachOKindFat) == index.kind) &&
+                                                              (2 == index.count) &&
+                                                              (CPU_TYPE_X86_64 == index.slices[0].cpuType) &&
+                                                              (CPU_TYPE_ARM64 == index.slices[1].cpuType) &&
+                                                              (0 == index.slices[1].offset % (1 << FIXTURE_FAT_ALIGN)) &&
+                                                              (arm64.length == index.slices[1].size) &&
+                                                              (index.slices[0].signatureOffset + index.slices[0].signatureSize == index.slices[0].offset + index.slices[0].size) &&
+                                                              (index.slices[1].signatureOffset + index.slices[1].signatureSize == index.slices[1].offset + index.slices[1].size) &&
+                                                              (NULL != best) &&
+                                                              (hostCPUType() == best->cpuType), describeIndex(indexed, &index));
+    }
+    
+    //slices (of 32-bit universal)
+    hostSlice = (CPU_TYPE_ARM64 == hostCPUType()) ? 1 : 0;
+    otherSlice = 1 - hostSlice;
+    
+    //other slice is out of bounds
+    // still indexed (flagged invalid), and host's slice is picked
+    fat = [fixtureFat(@[x86_64, arm64], NO) mutableCopy];
+    setSliceOffset(fat, otherSlice, (uint32_t)fat.length + (1 << FIXTURE_FAT_ALIGN));
+    memset(&index, 0, sizeof(index));
+    indexed = machoIndexPath(writeFixture(directory, @"fat-bad-other", fat), &index);
+    best = machoBestSlice(&index);
+    expect(@"macho.fat.badOtherSlice", (YES == indexed) &&
+                                       (2 == index.count) &&
+                                       (YES == index.slices[otherSlice].invalid) &&
+                                       (YES != index.slices[hostSlice].invalid) &&
+                                       (&index.slices[hostSlice] == best), describeIndex(indexed, &index));
+    
+    //host's slice isn't a mach-o
+    // still indexed, but it's never picked
+    fat = [fixtureFat(@[x86_64, arm64], NO) mutableCopy];
+    memset((uint8_t*)fat.mutableBytes + OSReadBigInt32(fat.bytes, sizeof(struct fat_header) + hostSlice * sizeof(struct fat_arch) + offsetof(struct fat_arch, offset)), 0xA5, sizeof(struct mach_header_64));
+    memset(&index, 0, sizeof(index));
+    indexed = machoIndexPath(writeFixture(directory, @"fat-bad-host", fat), &index);
+    best = machoBestSlice(&index);
+    expect(@"macho.fat.badHostSlice", (YES == indexed) &&
+                                      (2 == index.count) &&
+                                      (YES == index.slices[hostSlice].invalid) &&
+                                      (YES != index.slices[otherSlice].invalid) &&
+                                      ( (NULL == best) || (YES != best->invalid) ), describeIndex(indexed, &index));
+    
+    //all slices out of bounds
+    fat = [fixtureFat(@[x86_64, arm64], NO) mutableCopy];
+    setSliceOffset(fat, 0, (uint32_t)fat.length + (1 << FIXTURE_FAT_ALIGN));
+    setSliceOffset(fat, 1, (uint32_t)fat.length + (1 << FIXTURE_FAT_ALIGN));
+    memset(&index, 0, sizeof(index));
+    indexed = machoIndexPath(writeFixture(directory, @"fat-bad-all", fat), &index);
+    expect(@"macho.fat.badAllSlices", (YES != indexed), describeIndex(indexed, &index));
+    
+    //too many slices
+    // e.g. a java class file (same magic)
+    fat = [fixtureFat(@[x86_64, arm64], NO) mutableCopy];
+    OSWriteBigInt32(fat.mutableBytes, offsetof(struct fat_header, nfat_arch), MACHO_MAX_SLICES + 1);
+    memset(&index, 0, sizeof(index));
+    indexed = machoIndexPath(writeFixture(directory, @"fat-too-many", fat), &index);
+    expect(@"macho.fat.tooManySlices", (YES != indexed), describeIndex(indexed, &index));
+    
+    //truncated
+    memset(&index, 0, sizeof(index));
+    indexed = machoIndexPath(writeFixture(directory, @"truncated", [arm64 subdataWithRange:NSMakeRange(0, 16)]), &index);
+    expect(@"macho.truncated", (YES != indexed), describeIndex(indexed, &index));
+    
+    //not a mach-o
+    junk = [NSMutableData dataWithLength:FIXTURE_PAGE_SIZE];
+    fixtureFillRandom(junk.mutableBytes, junk.length, state);
+    memset(&index, 0, sizeof(index));
+    indexed = machoIndexPath(writeFixture(directory, @"junk", junk), &index);
+    expect(@"macho.notMachO", (YES != indexed), describeIndex(indexed, &index));
+    
+    return;
+}
+
+//test code signature parser
+// page hashes (intact, modified), and (XML, DER) entitlement blobs
+static void testCodeSignature(NSString* directory, uint64_t* state)
+{
+    //entitlements
+    NSDictionary* entitlements = nil;
+    
+    //binary
+    NSData* binary = nil;
+    
+    //path
+    NSString* path = nil;
+    
+    //signature
+    NSData* signature = nil;
+    
+    //blob
+    NSData* blob = nil;
+    
+    //index
+    MachOIndex index = {0};
+    
+    //file descriptor
+    int fd = -1;
+    
+    //first bad page
+    int64_t badPage = 0;
+    
+    //its offset
+    uint64_t badOffset = 0;
+    
+    //init
+    entitlements = fixtureEntitlements(16);
+    binary = fixtureThin(CPU_TYPE_ARM64, CPU_SUBTYPE_ARM64_ALL, 8 * FIXTURE_PAGE_SIZE, entitlements, state);
+    path = writeFixture(directory, @"signed", binary);
+    
+    //intact
+    badPage = codeSignatureFirstBadPage(path, &badOffset);
+    expect(@"codesign.pages", (CODESIGN_PAGES_VALID == badPage), [NSString stringWithFormat:@"first bad page: %lld", badPage]);
+    
+    //modified page
+    // reported w/ its offset
+    badPage = codeSignatureFirstBadPage(writeFixture(directory, @"signed-modified", corrupt(binary, 5 * FIXTURE_PAGE_SIZE + 123)), &badOffset);
+    expect(@"codesign.pages.modified", (5 == badPage) && (5 * FIXTURE_PAGE_SIZE == badOffset), [NSString stringWithFormat:@"first bad page: %lld @%llu", badPage, badOffset]);
+    
+    //read signature
+    fd = open(path.fileSystemRepresentation, O_RDONLY | O_CLOEXEC);
+    if( (-1 != fd) &&
+        (YES == machoIndexFile(fd, &index)) )
+    {
+        signature = codeSignatureRead(fd, &index.slices[0]);
+    }
+    if(-1 != fd)
+    {
+        close(fd);
+    }
+    
+    //code directory
+    expect(@"codesign.codeDirectory", (nil != codeSignatureBestCodeDirectory(signature)), [NSString stringWithFormat:@"signature: %lu bytes", (unsigned long)signature.length]);
+    
+    //(XML) entitlements
+    blob = codeSignatureBlob(signature, CODESIGN_SLOT_ENTITLEMENTS);
+    expect(@"codesign.entitlements.xml", (YES == [entitlementsDecode(blob.bytes, blob.length) isEqualToDictionary:entitlements]), [NSString stringWithFormat:@"blob: %lu bytes", (unsigned long)blob.length]);
+    
+    //(DER) entitlements
+    blob = codeSignatureBlob(signature, CODESIGN_SLOT_DER_ENTITLEMENTS);
+    expect(@"codesign.entitlements.der", (YES == [entitlementsDecode(blob.bytes, blob.length) isEqualToDictionary:entitlements]), [NSString stringWithFormat:@"blob: %lu bytes", (unsigned long)blob.length]);
+    
+    //no CMS blob
+    // as fixture is ad hoc
+    expect(@"codesign.adhoc", (nil == codeSignatureBlob(signature, CODESIGN_SLOT_SIGNATURE)), nil);
+    
+    return;
+}
+
+//test xar parser
+// TOC and heap checksums, intact and corrupted, w/ payload's binary found as heap is streamed
+static void testXar(NSString* directory, uint64_t* state)
+{
+    //binary
+    NSData* binary = nil;
+    
+    //payload
+    NSMutableData* payload = nil;
+    
+    //bom
+    NSMutableData* bom = nil;
+    
+    //archive
+    NSData* archive = nil;
+    
+    //xar
+    XarArchive* xar = nil;
+    
+    //components
+    NSArray* components = nil;
+    
+    //# of intact components
+    NSUInteger intact = 0;
+    
+    //init
+    binary = fixtureThin(CPU_TYPE_ARM64, CPU_SUBTYPE_ARM64_ALL, 16 * FIXTURE_PAGE_SIZE, fixtureEntitlements(4), state);
+    payload = [NSMutableData data];
+    fixtureAppendCpioMember(payload, @"./Fixture.app/Contents/MacOS/Fixture", 0100755, binary);
+    fixtureAppendCpioMember(payload, @"TRAILER!!!", 0, [NSData data]);
+    bom = [NSMutableData dataWithLength:4096];
+    fixtureFillRandom(bom.mutableBytes, bom.length, state);
+    archive = fixtureXar(@[@"Bom", @"PackageInfo", @"Payload"], @[bom, [[NSString stringWithFormat:@"<pkg-info identifier=\"%@\" version=\"1.0\"/>", FIXTURE_IDENTIFIER] dataUsingEncoding:NSUTF8StringEncoding], payload]);
+    
+    //intact
+    xar = [[XarArchive alloc] init:writeFixture(directory, @"Fixture.pkg", archive)];
+    expect(@"xar.checksum", (YES == [xar verifyChecksum]), nil);
+    
+    //heap
+    // each component's (archived, extracted) checksums match, and payload's binary is found
+    components = [xar verifyHeap];
+    for(NSDictionary* component in components)
+    {
+        if( (errSecSuccess == [component[KEY_COMPONENT_ARCHIVED] intValue]) &&
+            (errSecSuccess == [component[KEY_COMPONENT_EXTRACTED] intValue]) )
+        {
+            intact++;
+        }
+    }
+    expect(@"xar.heap", (3 == components.count) &&
+                        (3 == intact) &&
+                        (YES == isFixtureBinary(components[2][KEY_COMPONENT_BINARIES], @"Fixture.app/Contents/MacOS/Fixture", binary)), components.description);
+    
+    //corrupted TOC
+    // first byte of (compressed) TOC is right after header
+    xar = [[XarArchive alloc] init:writeFixture(directory, @"Fixture-toc.pkg", corrupt(archive, XAR_HEADER_SIZE + 4))];
+    expect(@"xar.checksum.corrupted", (YES != [xar verifyChecksum]), nil);
+    
+    //corrupted heap
+    // last byte of archive is (end of) payload, so only its checksums fail
+    xar = [[XarArchive alloc] init:writeFixture(directory, @"Fixture-heap.pkg", corrupt(archive, archive.length - 1))];
+    components = (YES == [xar verifyChecksum]) ? [xar verifyHeap] : nil;
+    expect(@"xar.heap.corrupted", (3 == components.count) &&
+                                  (errSecSuccess == [components[0][KEY_COMPONENT_ARCHIVED] intValue]) &&
+                                  (errSecSuccess == [components[1][KEY_COMPONENT_ARCHIVED] intValue]) &&
+                                  (errSecSuccess != [components[2][KEY_COMPONENT_ARCHIVED] intValue]), components.description);
+    
+    return;
+}
+
+//test payload inspector
+// cpio, and pbzx (plain and xz chunks) wrapping it, each streamed in odd-sized updates
+static void testPayload(uint64_t* state)
+{
+    //binary
+    NSData* binary = nil;
+    
+    //cpio archive
+    NSMutableData* cpio = nil;
+    
+    //binaries
+    NSArray* binaries = nil;
+    
+    //init
+    binary = fixtureThin(CPU_TYPE_ARM64, CPU_SUBTYPE_ARM64_ALL, 64 * FIXTURE_PAGE_SIZE, fixtureEntitlements(4), state);
+    cpio = [NSMutableData data];
+    fixtureAppendCpioMember(cpio, @"./Fixture.app/Contents/Resources/readme.txt", 0100644, [@"not a binary" dataUsingEncoding:NSUTF8StringEncoding]);
+    fixtureAppendCpioMember(cpio, @"./Fixture.app/Contents/MacOS/Fixture", 0100755, binary);
+    fixtureAppendCpioMember(cpio, @"TRAILER!!!", 0, [NSData data]);
+    
+    //cpio
+    binaries = inspectPayload(cpio);
+    expect(@"payload.cpio", isFixtureBinary(binaries, @"Fixture.app/Contents/MacOS/Fixture", binary), binaries.description);
+    
+    //pbzx, plain chunks
+    binaries = inspectPayload(fixturePbzx(cpio, NO));
+    expect(@"payload.pbzx.plain", isFixtureBinary(binaries, @"Fixture.app/Contents/MacOS/Fixture", binary), binaries.description);
+    
+    //pbzx, xz chunks
+    binaries = inspectPayload(fixturePbzx(cpio, YES));
+    expect(@"payload.pbzx.xz", isFixtureBinary(binaries, @"Fixture.app/Contents/MacOS/Fixture", binary), binaries.description);
+    
+    //modified binary
+    // a page (past signature's header) no longer matches
+    binaries = inspectPayload(corrupt(cpio, cpio.length - binary.length / 2));
+    expect(@"payload.cpio.modified", (1 == binaries.count) && (YES != [binaries.firstObject[KEY_BINARY_PAGES_VERIFIED] boolValue]), binaries.description);
+    
+    //truncated
+    // binary never ends, so isn't reported
+    binaries = inspectPayload([cpio subdataWithRange:NSMakeRange(0, cpio.length / 2)]);
+    expect(@"payload.cpio.truncated", (nil != binaries) && (0 == binaries.count), binaries.description);
+    
+    return;
+}
+
+//test UDIF parser
+// data fork, partition, and master checksums, intact and corrupted
+static void testUdif(NSString* directory, uint64_t* state)
+{
+    //contents
+    NSMutableData* contents = nil;
+    
+    //image
+    NSData* image = nil;
+    
+    //(parsed) image
+    UdifImage* udif = nil;
+    
+    //results
+    NSDictionary* results = nil;
+    
+    //init contents
+    // random, then zeros, then random (w/ a partial sector)
+    contents = [NSMutableData dataWithLength:64 * 1024];
+    fixtureFillRandom(contents.mutableBytes, contents.length, state);
+    [contents increaseLengthBy:32 * 1024];
+    [contents increaseLengthBy:32 * 1024 + 100];
+    fixtureFillRandom((uint8_t*)contents.mutableBytes + 96 * 1024, 32 * 1024 + 100, state);
+    image = fixtureUdif(contents);
+    
+    //intact
+    udif = [[UdifImage alloc] init:writeFixture(directory, @"Fixture.dmg", image)];
+    results = [udif verify];
+    expect(@"udif.verify", (1 == udif.partitions.count) &&
+                           (errSecSuccess == [results[KEY_DISKIMAGE_DATA_FORK] intValue]) &&
+                           (1 == [results[KEY_DISKIMAGE_PARTITIONS] count]) &&
+                           (errSecSuccess == [results[KEY_DISKIMAGE_PARTITIONS][0][KEY_COMPONENT_EXTRACTED] intValue]) &&
+                           (errSecSuccess == [results[KEY_DISKIMAGE_MASTER] intValue]), results.description);
+    
+    //corrupted data fork
+    // first chunk (zlib)
+    udif = [[UdifImage alloc] init:writeFixture(directory, @"Fixture-data.dmg", corrupt(image, 10))];
+    results = [udif verify];
+    expect(@"udif.verify.dataFork", (nil != results) &&
+                                    (errSecSuccess != [results[KEY_DISKIMAGE_DATA_FORK] intValue]) &&
+                                    (errSecSuccess != [results[KEY_DISKIMAGE_PARTITIONS][0][KEY_COMPONENT_EXTRACTED] intValue]), results.description);
+    
+    //corrupted master checksum
+    // only it fails
+    udif = [[UdifImage alloc] init:writeFixture(directory, @"Fixture-master.dmg", corrupt(image, image.length - UDIF_TRAILER_SIZE + UDIF_MASTER_CHECKSUM + 8))];
+    results = [udif verify];
+    expect(@"udif.verify.master", (errSecSuccess == [results[KEY_DISKIMAGE_DATA_FORK] intValue]) &&
+                                  (errSecSuccess == [results[KEY_DISKIMAGE_PARTITIONS][0][KEY_COMPONENT_EXTRACTED] intValue]) &&
+                                  (errSecCSSignatureFailed == [results[KEY_DISKIMAGE_MASTER] intValue]), results.description);
+    
+    //not an image
+    // no trailer
+    udif = [[UdifImage alloc] init:writeFixture(directory, @"Fixture-truncated.dmg", [image subdataWithRange:NSMakeRange(0, image.length - 1)])];
+    expect(@"udif.notImage", (nil == udif), nil);
+    
+    return;
+}
+
+//test DER reader
+// lengths (short, long, overflowing, indefinite), tags, integers, and poisoned cursors
+static void testDer(void)
+{
+    //item
+    DERItem item = {0};
+    
+    //cursor
+    DERCursor cursor = {0};
+    
+    //value
+    int64_t value = 0;
+    
+    //buffer
+    // tag, (up to 9) length bytes, contents
+    uint8_t buffer[2 + 9 + 256] = {0};
+    
+    //indefinite length
+    uint8_t indefinite[] = {DER_TAG_SEQUENCE, 0x80, DER_TAG_NULL, 0x00, 0x00, 0x00};
+    
+    //high tag number
+    uint8_t highTag[] = {0x1F, 0x81, 0x01, 0x00};
+    
+    //integers
+    // negative, max, too big, empty
+    uint8_t negative[] = {DER_TAG_INTEGER, 0x01, 0xFF};
+    uint8_t max[] = {DER_TAG_INTEGER, 0x08, 0x7F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+    uint8_t tooBig[] = {DER_TAG_INTEGER, 0x09, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+    uint8_t empty[] = {DER_TAG_INTEGER, 0x00};
+    
+    //sequence w/ a malformed (second) item
+    uint8_t sequence[] = {DER_TAG_NULL, 0x00, DER_TAG_OCTET_STRING, 0x05, 0x00};
+    
+    //long form (1 byte) length
+    buffer[0] = DER_TAG_OCTET_STRING;
+    buffer[1] = 0x81;
+    buffer[2] = 0x80;
+    expect(@"der.length.long1", (YES == derDecode(buffer, 3 + 0x80, DER_TAG_OCTET_STRING, &item)) && (0x80 == item.length) && (buffer + 3 == item.data), nil);
+    
+    //long form (2 byte) length
+    buffer[1] = 0x82;
+    buffer[2] = 0x01;
+    buffer[3] = 0x00;
+    expect(@"der.length.long2", (YES == derDecode(buffer, 4 + 0x100, DER_TAG_OCTET_STRING, &item)) && (0x100 == item.length), nil);
+    
+    //length runs past end
+    expect(@"der.length.pastEnd", (YES != derDecode(buffer, 4 + 0xFF, DER_TAG_OCTET_STRING, &item)), nil);
+    
+    //trailing bytes
+    expect(@"der.length.trailing", (YES != derDecode(buffer, 4 + 0x101, DER_TAG_OCTET_STRING, &item)), nil);
+    
+    //length that wraps a pointer
+    // i.e. 8 bytes of 0xFF
+    buffer[1] = 0x88;
+    memset(buffer + 2, 0xFF, 8);
+    expect(@"der.length.overflow", (YES != derDecode(buffer, sizeof(buffer), DER_TAG_OCTET_STRING, &item)), nil);
+    
+    //more length bytes than fit in a size_t
+    buffer[1] = 0x89;
+    memset(buffer + 2, 0x00, 9);
+    expect(@"der.length.tooManyBytes", (YES != derDecode(buffer, 2 + 9, DER_TAG_OCTET_STRING, &item)), nil);
+    
+    //indefinite length
+    // not valid DER
+    expect(@"der.length.indefinite", (YES != derDecode(indefinite, sizeof(indefinite), DER_TAG_SEQUENCE, &item)), nil);
+    
+    //high tag number
+    expect(@"der.tag.high", (YES != derDecode(highTag, sizeof(highTag), 0x1F, &item)), nil);
+    
+    //integers
+    expect(@"der.integer.negative", (YES == derDecode(negative, sizeof(negative), DER_TAG_INTEGER, &item)) && (YES == derInteger(&item, &value)) && (-1 == value), nil);
+    expect(@"der.integer.max", (YES == derDecode(max, sizeof(max), DER_TAG_INTEGER, &item)) && (YES == derInteger(&item, &value)) && (INT64_MAX == value), nil);
+    expect(@"der.integer.tooBig", (YES == derDecode(tooBig, sizeof(tooBig), DER_TAG_INTEGER, &item)) && (YES != derInteger(&item, &value)), nil);
+    expect(@"der.integer.empty", (YES == derDecode(empty, sizeof(empty), DER_TAG_INTEGER, &item)) && (YES != derInteger(&item, &value)), nil);
+    
+    //malformed item poisons cursor
+    // so caller can tell it from the end
+    derInit(&cursor, sequence, sizeof(sequence));
+    expect(@"der.cursor.poisoned", (YES == derNext(&cursor, &item)) && (YES != derNext(&cursor, &item)) && (YES != derNext(&cursor, &item)) && (YES != derDone(&cursor)), nil);
+    
+    return;
+}
+
+//parse a receipt payload
+// copied to end of (guarded) buffer, so any read past its end faults
+static NSDictionary* parseGuarded(uint8_t* guard, const uint8_t* bytes, size_t length)
+{
+    //receipt
+    AppReceipt* receipt = nil;
+    
+    //copy
+    memcpy(guard - length, bytes, length);
+    
+    //init
+    receipt = [[AppReceipt alloc] init];
+    receipt.decodedData = [NSData dataWithBytesNoCopy:guard - length length:length freeWhenDone:NO];
+    
+    return [receipt parse];
+}
+
+//check (parsed) receipt's components are well-formed
+// i.e. any that were found are of the right type
+static BOOL isWellFormedReceipt(NSDictionary* items)
+{
+    return (nil == items) ||
+           ( ( (nil == items[KEY_BUNDLE_ID]) || (YES == [items[KEY_BUNDLE_ID] isKindOfClass:[NSString class]]) ) &&
+             ( (nil == items[KEY_BUNDLE_DATA]) || (YES == [items[KEY_BUNDLE_DATA] isKindOfClass:[NSData class]]) ) &&
+             ( (nil == items[KEY_APP_VERSION]) || (YES == [items[KEY_APP_VERSION] isKindOfClass:[NSString class]]) ) &&
+             ( (nil == items[KEY_OPAQUE_VALUE]) || (YES == [items[KEY_OPAQUE_VALUE] isKindOfClass:[NSData class]]) ) &&
+             ( (nil == items[KEY_RECEIPT_HASH]) || (YES == [items[KEY_RECEIPT_HASH] isKindOfClass:[NSData class]]) ) );
+}
+
+//test receipt parser
+// intact, then fuzzed (truncated, bit flips, bogus lengths) w/ payload right before a guard page
+static void testReceipt(uint64_t* state)
+{
+    //payload
+    NSData* payload = nil;
+    
+    //mutated payload
+    NSMutableData* mutated = nil;
+    
+    //items
+    NSDictionary* items = nil;
+    
+    //guarded region
+    uint8_t* region = NULL;
+    
+    //its (accessible) size
+    size_t size = 0;
+    
+    //page size
+    size_t pageSize = (size_t)getpagesize();
+    
+    //failed (fuzz) case
+    // as description
+    NSString* failed = nil;
+    
+    //bogus length bytes
+    // (too) long forms, indefinite, and max short form
+    uint8_t lengths[] = {0x7F, 0x80, 0x81, 0x84, 0x88, 0x89, 0xFF};
+    
+    //init
+    payload = fixtureReceipt(16, state);
+    
+    //init guarded region
+    // payload's size (rounded to pages), then a guard page
+    size = (payload.length + 1 + pageSize - 1) / pageSize * pageSize;
+    region = mmap(NULL, size + pageSize, PROT_READ | PROT_WRITE, MAP_ANON | MAP_PRIVATE, -1, 0);
+    if( (MAP_FAILED == region) ||
+        (0 != mprotect(region + size, pageSize, PROT_NONE)) )
+    {
+        //failed
+        expect(@"receipt.parse", NO, @"failed to map guarded region");
+        
+        //unset
+        if(MAP_FAILED == region)
+        {
+            region = NULL;
+        }
+        
+        //bail
+        goto bail;
+    }
+    
+    //intact
+    items = parseGuarded(region + size, payload.bytes, payload.length);
+    expect(@"receipt.parse", (YES == [items[KEY_BUNDLE_ID] isEqualToString:FIXTURE_IDENTIFIER]) &&
+                             (YES == [items[KEY_APP_VERSION] isEqualToString:@"1.0"]) &&
+                             (16 == [items[KEY_OPAQUE_VALUE] length]) &&
+                             (NSNotFound != [payload rangeOfData:items[KEY_OPAQUE_VALUE] options:0 range:NSMakeRange(0, payload.length)].location) &&
+                             (CC_SHA1_DIGEST_LENGTH == [items[KEY_RECEIPT_HASH] length]) &&
+                             (NSNotFound != [payload rangeOfData:items[KEY_RECEIPT_HASH] options:0 range:NSMakeRange(0, payload.length)].location), items.description);
+    
+    //trailing byte
+    // set must span payload
+    mutated = [payload mutableCopy];
+    [mutated increaseLengthBy:1];
+    expect(@"receipt.trailing", (nil == parseGuarded(region + size, mutated.bytes, mutated.length)), nil);
+    
+    //every truncation
+    // outer set then runs past end, so all must fail
+    failed = nil;
+    for(NSUInteger length = 0; (nil == failed) && (length < payload.length); length++)
+    {
+        if(nil != parseGuarded(region + size, payload.bytes, length))
+        {
+            failed = [NSString stringWithFormat:@"truncated to %lu bytes: parsed", (unsigned long)length];
+        }
+    }
+    expect(@"receipt.fuzz.truncated", (nil == failed), failed);
+    
+    //bogus length bytes
+    // at every offset, so each item's length (and its length's length) is hit
+    failed = nil;
+    for(NSUInteger offset = 0; (nil == failed) && (offset < payload.length); offset++)
+    {
+        for(NSUInteger i = 0; (nil == failed) && (i < sizeof(lengths)); i++)
+        {
+            mutated = [payload mutableCopy];
+            ((uint8_t*)mutated.mutableBytes)[offset] = lengths[i];
+            if(YES != isWellFormedReceipt(parseGuarded(region + size, mutated.bytes, mutated.length)))
+            {
+                failed = [NSString stringWithFormat:@"0x%02x @%lu: malformed components", lengths[i], (unsigned long)offset];
+            }
+        }
+    }
+    expect(@"receipt.fuzz.lengths", (nil == failed), failed);
+    
+    //random bit flips
+    // 1-4 per iteration, and (sometimes) truncated too
+    failed = nil;
+    for(NSUInteger i = 0; (nil == failed) && (i < SELFTEST_FUZZ_ITERATIONS); i++)
+    {
+        //# of flips
+        uint64_t flips = 1 + fixtureRandom(state) % 4;
+        
+        //length
+        NSUInteger length = payload.length;
+        
+        //mutate
+        mutated = [payload mutableCopy];
+        for(uint64_t j = 0; j < flips; j++)
+        {
+            uint64_t bits = fixtureRandom(state);
+            ((uint8_t*)mutated.mutableBytes)[bits % mutated.length] ^= (uint8_t)(1 << ((bits >> 32) % 8));
+        }
+        if(0 == (i % 8))
+        {
+            length = (NSUInteger)(fixtureRandom(state) % payload.length);
+        }
+        
+        //parse
+        if(YES != isWellFormedReceipt(parseGuarded(region + size, mutated.bytes, length)))
+        {
+            failed = [NSString stringWithFormat:@"iteration %lu: malformed components", (unsigned long)i];
+        }
+    }
+    expect(@"receipt.fuzz.bitflips", (nil == failed), failed);
+
+bail:
+    
+    //unmap
+    if(NULL != region)
+    {
+        munmap(region, size + pageSize);
+    }
+    
+    return;
+}
+
+//get (uppercase hex) digests of data
+// same keys as 'hashFile()'
+static NSDictionary* digests(NSData* data)
+{
+    //digests
+    uint8_t md5[CC_MD5_DIGEST_LENGTH] = {0};
+    uint8_t sha1[CC_SHA1_DIGEST_LENGTH] = {0};
+    uint8_t sha512[CC_SHA512_DIGEST_LENGTH] = {0};
+    
+    //hash
+    CC_MD5(data.bytes, (CC_LONG)data.length, md5);
+    CC_SHA1(data.bytes, (CC_LONG)data.length, sha1);
+    CC_SHA512(data.bytes, (CC_LONG)data.length, sha512);
+    
+    return @{KEY_HASH_MD5:bytesToHex(md5, sizeof(md5), YES),
+             KEY_HASH_SHA1:bytesToHex(sha1, sizeof(sha1), YES),
+             KEY_HASH_SHA256:sha256(data),
+             KEY_HASH_SHA512:bytesToHex(sha512, sizeof(sha512), YES)};
+}
+
+//test hashing
+// (pipelined) hashes match CommonCrypto's one-shot ones, for files, bundles, and via the cache
+static void testHashing(NSString* directory, uint64_t* state)
+{
+    //data
+    NSMutableData* data = nil;
+    
+    //path
+    NSString* path = nil;
+    
+    //executable
+    NSData* executable = nil;
+    
+    //bundle
+    NSString* bundle = nil;
+    
+    //hashes
+    NSDictionary* hashes = nil;
+    
+    //sizes
+    // empty, less than a read, and (unaligned) multiple reads
+    NSUInteger sizes[] = {0, 1000, 3 * 1024 * 1024 + 17};
+    
+    //hash each
+    for(NSUInteger i = 0; i < sizeof(sizes)/sizeof(sizes[0]); i++)
+    {
+        //init
+        data = [NSMutableData dataWithLength:sizes[i]];
+        fixtureFillRandom(data.mutableBytes, data.length, state);
+        
+        //hash
+        hashes = hashFile(writeFixture(directory, [NSString stringWithFormat:@"blob-%lu.bin", (unsigned long)sizes[i]], data));
+        expect([NSString stringWithFormat:@"hash.file.%lu", (unsigned long)sizes[i]], (YES == [hashes isEqualToDictionary:digests(data)]), hashes.description);
+    }
+    
+    //bundle
+    // its executable is hashed
+    bundle = [directory stringByAppendingPathComponent:@"Hashed.app"];
+    executable = fixtureThin(CPU_TYPE_ARM64, CPU_SUBTYPE_ARM64_ALL, 8 * FIXTURE_PAGE_SIZE, fixtureEntitlements(4), state);
+    hashes = (YES == fixtureBundle(bundle, executable, 4, state)) ? hashFile(bundle) : nil;
+    expect(@"hash.bundle", (YES == [hashes isEqualToDictionary:digests(executable)]), hashes.description);
+    
+    //cached
+    // miss, then hit
+    path = writeFixture(directory, @"cached.bin", data);
+    hashCacheClear();
+    expect(@"hash.cached.miss", (YES == [hashFileCached(path) isEqualToDictionary:digests(data)]), nil);
+    expect(@"hash.cached.hit", (YES == [hashFileCached(path) isEqualToDictionary:digests(data)]), nil);
+    
+    //cached, but file since modified
+    // same size and inode, so only its (modification, change) times differ
+    fixtureFillRandom(data.mutableBytes, data.length, state);
+    [data writeToFile:path atomically:NO];
+    hashes = hashFileCached(path);
+    expect(@"hash.cached.modified", (YES == [hashes isEqualToDictionary:digests(data)]), hashes.description);
+    
+    return;
+}
+
+//test (headless) scanner
+// runs this binary's '-scan' over a fixture tree, expecting one (JSON) line per item
+static void testScanner(NSString* directory, uint64_t* state)
+{
+    //tree
+    NSString* tree = nil;
+    
+    //binary
+    NSData* binary = nil;
+    
+    //data
+    NSMutableData* data = nil;
+    
+    //results
+    NSDictionary* results = nil;
+    
+    //output
+    NSString* output = nil;
+    
+    //names of scanned items
+    NSMutableSet* scanned = nil;
+    
+    //expected
+    // bundles are a single item, symlinks are skipped
+    NSSet* expected = [NSSet setWithArray:@[@"blob.bin", @"thin", @"fat", @"thin2", @"Scanned.app"]];
+    
+    //init
+    tree = [directory stringByAppendingPathComponent:@"tree"];
+    binary = fixtureThin(CPU_TYPE_ARM64, CPU_SUBTYPE_ARM64_ALL, 4 * FIXTURE_PAGE_SIZE, fixtureEntitlements(4), state);
+    data = [NSMutableData dataWithLength:64 * 1024];
+    fixtureFillRandom(data.mutableBytes, data.length, state);
+    
+    //build tree
+    // files at several depths, a bundle, an empty directory, and a symlink (back up the tree)
+    if( (YES != [NSFileManager.defaultManager createDirectoryAtPath:[tree stringByAppendingPathComponent:@"bin/deep/deeper"] withIntermediateDirectories:YES attributes:nil error:NULL]) ||
+        (YES != [NSFileManager.defaultManager createDirectoryAtPath:[tree stringByAppendingPathComponent:@"empty"] withIntermediateDirectories:YES attributes:nil error:NULL]) ||
+        (nil == writeFixture(tree, @"blob.bin", data)) ||
+        (nil == writeFixture(tree, @"bin/thin", binary)) ||
+        (nil == writeFixture(tree, @"bin/fat", fixtureFat(@[binary], NO))) ||
+        (nil == writeFixture(tree, @"bin/deep/deeper/thin2", binary)) ||
+        (YES != fixtureBundle([tree stringByAppendingPathComponent:@"Scanned.app"], binary, 4, state)) ||
+        (YES != [NSFileManager.defaultManager createSymbolicLinkAtPath:[tree stringByAppendingPathComponent:@"bin/deep/up"] withDestinationPath:tree error:NULL]) )
+    {
+        //failed
+        expect(@"scan.tree", NO, @"failed to build fixture tree");
+        
+        return;
+    }
+    
+    //scan
+    results = execTaskWithTimeout(NSBundle.mainBundle.executablePath, @[@SCAN_FLAG, tree], SELFTEST_SCAN_TIMEOUT);
+    output = [[NSString alloc] initWithData:results[STDOUT] ?: [NSData data] encoding:NSUTF8StringEncoding];
+    
+    //parse
+    // each line is an item
+    scanned = [NSMutableSet set];
+    for(NSString* line in [output componentsSeparatedByString:@"\n"])
+    {
+        //item
+        NSDictionary* item = nil;
+        
+        //skip blank
+        if(0 == line.length)
+        {
+            continue;
+        }
+        
+        //parse
+        item = [NSJSONSerialization JSONObjectWithData:[line dataUsingEncoding:NSUTF8StringEncoding] options:0 error:NULL];
+        if(YES != [item isKindOfClass:[NSDictionary class]])
+        {
+            //invalid
+            [scanned addObject:line];
+            continue;
+        }
+        
+        //add
+        [scanned addObject:[item[@"path"] lastPathComponent] ?: @"?"];
+    }
+    
+    //check
+    expect(@"scan.tree", (0 == [results[EXIT_CODE] intValue]) &&
+                         (YES != [results[TASK_TIMED_OUT] boolValue]) &&
+                         (expected.count == [output componentsSeparatedByString:@"\n"].count - 1) &&
+                         (YES == [scanned isEqualToSet:expected]), [NSString stringWithFormat:@"exit code: %@, scanned: %@", results[EXIT_CODE], [scanned.allObjects componentsJoinedByString:@", "]]);
+    
+    return;
+}
+
+//test process runner
+// output, exit codes, both pipes flooded, timeouts, output cap, and parallel processes
+static void testProcesses(void)
+{
+    //results
+    NSDictionary* results = nil;
+    
+    //(parallel) results
+    NSArray* allResults = nil;
+    
+    //# of (parallel) processes that exited cleanly
+    NSUInteger exited = 0;
+    
+    //start
+    CFAbsoluteTime start = 0;
+    
+    //elapsed
+    CFAbsoluteTime elapsed = 0;
+    
+    //output
+    results = execTask(@"/bin/echo", @[@"hello"]);
+    expect(@"exec.output", (0 == [results[EXIT_CODE] intValue]) && (YES == [results[STDOUT] isEqualToData:[@"hello\n" dataUsingEncoding:NSUTF8StringEncoding]]) && (nil == results[STDERR]), results.description);
+    
+    //exit code
+    results = execTask(@"/bin/sh", @[@"-c", @"exit 3"]);
+    expect(@"exec.exitCode", (3 == [results[EXIT_CODE] intValue]), results.description);
+    
+    //can't spawn
+    results = execTask(@"/nonexistent/binary", @[]);
+    expect(@"exec.spawnFailed", (nil == results[EXIT_CODE]), results.description);
+    
+    //both pipes flooded
+    // more than a pipe's buffer on each, so a reader that blocks on one deadlocks
+    results = execTaskWithTimeout(@"/bin/sh", @[@"-c", @"head -c 1000000 /dev/zero >&2; head -c 1000000 /dev/zero; head -c 1000000 /dev/zero >&2; echo"], SELFTEST_TASK_TIMEOUT);
+    expect(@"exec.flood", (0 == [results[EXIT_CODE] intValue]) &&
+                          (YES != [results[TASK_TIMED_OUT] boolValue]) &&
+                          (1000001 == [results[STDOUT] length]) &&
+                          (2000000 == [results[STDERR] length]), [NSString stringWithFormat:@"exit code: %@, stdout: %lu bytes, stderr: %lu bytes", results[EXIT_CODE], (unsigned long)[results[STDOUT] length], (unsigned long)[results[STDERR] length]]);
+    
+    //timeout
+    // process is killed, and (quickly) reaped
+    start = CFAbsoluteTimeGetCurrent();
+    results = execTaskWithTimeout(@"/bin/sleep", @[@"30"], 0.5);
+    elapsed = CFAbsoluteTimeGetCurrent() - start;
+    expect(@"exec.timeout", (YES == [results[TASK_TIMED_OUT] boolValue]) && (elapsed < 5), [NSString stringWithFormat:@"elapsed: %.2fs, %@", elapsed, results]);
+    
+    //output cap
+    // rest is dropped, but pipe is still drained, so process exits
+    results = execTaskWithTimeout(@"/bin/sh", @[@"-c", [NSString stringWithFormat:@"head -c %d /dev/zero", TASK_MAX_OUTPUT + 1024 * 1024]], SELFTEST_TASK_TIMEOUT);
+    expect(@"exec.truncated", (0 == [results[EXIT_CODE] intValue]) &&
+                              (YES != [results[TASK_TIMED_OUT] boolValue]) &&
+                              (YES == [results[TASK_TRUNCATED] boolValue]) &&
+                              (TASK_MAX_OUTPUT == [results[STDOUT] length]), [NSString stringWithFormat:@"exit code: %@, stdout: %lu bytes", results[EXIT_CODE], (unsigned long)[results[STDOUT] length]]);
+    
+    //parallel
+    // 4 one-second sleeps should take about one second, not four
+    start = CFAbsoluteTimeGetCurrent();
+    allResults = execTasks(@[@[@"/bin/sleep", @[@"1"]], @[@"/bin/sleep", @[@"1"]], @[@"/bin/sleep", @[@"1"]], @[@"/bin/sleep", @[@"1"]]], SELFTEST_TASK_TIMEOUT);
+    elapsed = CFAbsoluteTimeGetCurrent() - start;
+    for(NSDictionary* taskResults in allResults)
+    {
+        if( (nil != taskResults[EXIT_CODE]) &&
+            (0 == [taskResults[EXIT_CODE] intValue]) )
+        {
+            exited++;
+        }
+    }
+    expect(@"exec.parallel", (4 == allResults.count) && (4 == exited) && (elapsed < 3), [NSString stringWithFormat:@"elapsed: %.2fs, %lu exited", elapsed, (unsigned long)exited]);
+    
+    return;
+}
+
+//self test
+// prints (to stdout) each case's result as a JSON line, then returns 0 only if all passed
+int selfTest(void)
+{
+    //(pseudo-random) state
+    uint64_t state = SELFTEST_SEED;
+    
+    //fixture directory
+    NSString* directory = nil;
+    
+    //init fixture directory
+    directory = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSString stringWithFormat:@"WYS-selftest-%d", getpid()]];
+    if(YES != [NSFileManager.defaultManager createDirectoryAtPath:directory withIntermediateDirectories:YES attributes:nil error:NULL])
+    {
+        //err msg
+        fprintf(stderr, "ERROR: failed to create %s\n", directory.UTF8String);
+        
+        return -1;
+    }
+    
+    //use fixture directory for (verdict, hash) caches
+    // so user's (app group) caches aren't touched
+    setCachesDirectory([NSURL fileURLWithPath:directory]);
+    
+    //run
+    testMachO(directory, &state);
+    testCodeSignature(directory, &state);
+    testXar(directory, &state);
+    testPayload(&state);
+    testUdif(directory, &state);
+    testDer();
+    testReceipt(&state);
+    testHashing(directory, &state);
+    testScanner(directory, &state);
+    testProcesses();
+    
+    //remove fixtures
+    [NSFileManager.defaultManager removeItemAtPath:directory error:NULL];
+    
+    //summary
+    // to stderr, so stdout is only cases
+    fprintf(stderr, "%lu case(s) failed\n", (unsigned long)failures);
+    
+    return (0 == failures) ? 0 : 1;
+}
@@ -8,7 +8,47 @@
 
 @import Cocoa;
 
+#import "Scanner.h"
+#import "Benchmark.h"
+#import "SelfTest.h"
+
 int main(int argc, const char * argv[])
 {
+    //headless scan?
+    // e.g. 'WhatsYourSign -scan <path>'
+    if( (argc >= 3) &&
+        (0 == strcmp(argv[1], SCAN_FLAG)) )
+    {
+        @autoreleasepool
+        {
+            //scan
+            return scan([NSString stringWithUTF8String:argv[2]]);
+        }
+    }
+    
+    //benchmark?
+    // e.g. 'WhatsYourSign -benchmark [iterations] [scale]'
+    if( (argc >= 2) &&
+        (0 == strcmp(argv[1], BENCHMARK_FLAG)) )
+    {
+        @autoreleasepool
+        {
+            //benchmark
+            return benchmark((argc >= 3) ? strtoul(argv[2], NULL, 10) : BENCHMARK_ITERATIONS, (argc >= 4) ? strtoul(argv[3], NULL, 10) : BENCHMARK_SCALE);
+        }
+    }
+    
+    //self test?
+    // e.g. 'WhatsYourSign -selftest'
+    if( (argc >= 2) &&
+        (0 == strcmp(argv[1], SELFTEST_FLAG)) )
+    {
+        @autoreleasepool
+        {
+            //self test
+            return selfTest();
+        }
+    }
+    
     return NSApplicationMain(argc, argv);
 }